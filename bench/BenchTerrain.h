@@ -0,0 +1,109 @@
+/**
+ * BenchTerrain.h — Chunk sets shared by the chunk benchmarks.
+ *
+ *   - terrainChunk: noise heightmap over stone with dirt/grass/sand, sea level
+ *     water, bedrock, ore pockets, noise caves and a sky light column (what a
+ *     generated world holds and sends);
+ *   - flatChunk: the default superflat layers.
+ *
+ * Call Block::registerBlocks() first.
+ */
+#pragma once
+
+#include "block/Block.h"
+#include "world/Chunk.h"
+#include "worldgen/NoiseGen.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace mccpp {
+namespace bench {
+
+constexpr int SEA_LEVEL = 63;
+
+inline std::unique_ptr<Chunk> terrainChunk(int cx, int cz, const NoiseGeneratorSimplex& height,
+                                    const NoiseGeneratorSimplex& detail,
+                                    const NoiseGeneratorImproved& caves, std::mt19937& rng) {
+    Block* stone = Block::getBlockById(1);
+    Block* grass = Block::getBlockById(2);
+    Block* dirt = Block::getBlockById(3);
+    Block* bedrock = Block::getBlockById(7);
+    Block* water = Block::getBlockById(9);
+    Block* sand = Block::getBlockById(12);
+    Block* coal = Block::getBlockById(16);
+    Block* iron = Block::getBlockById(15);
+    Block* air = Block::getBlockById(0);
+
+    auto chunk = std::make_unique<Chunk>(cx, cz);
+    std::vector<double> density(16 * 16 * 128, 0.0);
+    caves.populateNoiseArray(density, cx * 16.0, 0.0, cz * 16.0, 16, 128, 16, 0.06, 0.09, 0.06, 1.0);
+
+    std::uniform_int_distribution<int> ore(0, 99);
+    for (int x = 0; x < 16; ++x) {
+        for (int z = 0; z < 16; ++z) {
+            double wx = cx * 16 + x, wz = cz * 16 + z;
+            int top = 64 + static_cast<int>(height.getValue(wx / 180.0, wz / 180.0) * 18.0 +
+                                            detail.getValue(wx / 40.0, wz / 40.0) * 4.0);
+            top = std::clamp(top, 40, 120);
+            bool beach = top <= SEA_LEVEL + 1;
+
+            for (int y = 0; y <= std::max(top, SEA_LEVEL); ++y) {
+                Block* block;
+                if (y == 0) block = bedrock;
+                else if (y > top) block = water;
+                else if (y == top) block = beach ? sand : grass;
+                else if (y > top - 4) block = beach ? sand : dirt;
+                else {
+                    int roll = ore(rng);
+                    block = roll == 0 ? iron : roll < 3 ? coal : stone;
+                }
+                if (y > 4 && y < 128 && y < top - 3 &&
+                    density[(x * 16 + z) * 128 + y] > 0.55) {
+                    block = air;
+                }
+                chunk->setBlock(x, y, z, block);
+            }
+
+            // Full daylight down to the surface (through water), dark below
+            int lit = std::max(top, SEA_LEVEL) + 1;
+            for (auto& section : chunk->sections) {
+                if (!section) continue;
+                for (int y = 0; y < 16; ++y) {
+                    section->setSkyLight(x, y, z, section->getYBase() + y >= lit ? 15 : 0);
+                }
+            }
+            chunk->biomes[z * 16 + x] = static_cast<uint8_t>(beach ? 16 : 1);
+        }
+    }
+    // Sections lit all through drop their sky light buffer, as after a light pass
+    for (auto& section : chunk->sections) {
+        if (section && section->getSkylightArray()) section->getSkylightArray()->compact();
+    }
+    return chunk;
+}
+
+inline std::unique_ptr<Chunk> flatChunk(int cx, int cz) {
+    static const int LAYERS[4] = {7, 3, 3, 2};   // bedrock, dirt, dirt, grass
+    auto chunk = std::make_unique<Chunk>(cx, cz);
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 16; ++x) {
+            for (int z = 0; z < 16; ++z) chunk->setBlock(x, y, z, Block::getBlockById(LAYERS[y]));
+        }
+    }
+    for (auto& section : chunk->sections) {
+        if (!section) continue;
+        for (int y = 0; y < 16; ++y) {
+            for (int x = 0; x < 16; ++x) {
+                for (int z = 0; z < 16; ++z) section->setSkyLight(x, y, z, y >= 4 ? 15 : 0);
+            }
+        }
+    }
+    chunk->biomes.fill(1);
+    return chunk;
+}
+
+} // namespace bench
+} // namespace mccpp
@@ -0,0 +1,587 @@
+/**
+ * BotSwarm.cpp — Headless protocol-5 bot swarm for load-testing the server.
+ *
+ * Logs in N offline-mode bots over one epoll loop, walks them along scripted
+ * or random paths at 20 Hz, places and breaks blocks, and chats. Every report
+ * interval it prints:
+ *   - server-side MSPT (mean / max of the last 100 ticks), queried over the
+ *     MCCPP|TickTime plugin channel
+ *   - client-observed latency: chat round trip (send → own broadcast back)
+ *     and plugin-channel round trip
+ *   - received / sent bytes and packets per second, chunk arrival rate
+ *
+ * The server must run in offline mode and without the per-IP connection
+ * throttle, since every bot connects from the same address, and in creative
+ * mode, since a survival server refuses the bots' placing and breaking:
+ *   minecppaft-server --offline-mode --connection-throttle 0 --gamemode creative
+ * A bot that joins a survival server with --build-interval above 0 gives up.
+ *
+ * Usage: bot-swarm [--host 127.0.0.1] [--port 25565] [--bots 50]
+ *                  [--duration 60] [--login-rate 20] [--path random|circle|line]
+ *                  [--radius 48] [--chat-interval 5] [--build-interval 2]
+ *                  [--report-interval 5]
+ */
+
+#include "networking/InboundBuffer.h"
+#include "networking/PacketBuilder.h"
+#include "networking/PacketHandler.h"
+#include "networking/PacketReader.h"
+#include "networking/PlayPackets.h"
+#include "types/VarInt.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace mccpp;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int TICK_MS = 50;
+constexpr double WALK_PER_TICK = 0.2;   // ~4.3 blocks/s, vanilla walking speed
+constexpr double PI = 3.14159265358979323846;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    uint16_t port = 25565;
+    int bots = 50;
+    int durationSec = 60;
+    double loginRate = 20.0;       // new connections per second
+    std::string path = "random";
+    double radius = 48.0;
+    double chatInterval = 5.0;     // seconds per bot, 0 = never
+    double buildInterval = 2.0;    // seconds per bot, 0 = never
+    double reportInterval = 5.0;
+};
+
+enum class BotState { Idle, Connecting, Login, Play, Dead };
+
+struct Bot {
+    int index = 0;
+    std::string name;
+    int fd = -1;
+    BotState state = BotState::Idle;
+    InboundBuffer in;
+    std::vector<uint8_t> out;
+    size_t outOffset = 0;
+    bool wantWrite = false;
+
+    // Movement
+    bool spawned = false;           // first S08 received
+    double x = 0, y = 0, z = 0, originX = 0, originZ = 0;
+    double heading = 0;
+    int64_t tick = 0;
+
+    // Scheduled actions (ms since start)
+    int64_t nextChatMs = 0;
+    int64_t nextBuildMs = 0;
+    bool placeNext = true;
+    int chatSeq = 0;
+    std::unordered_map<int, Clock::time_point> chatsInFlight;
+};
+
+// Per-report-interval counters
+struct Interval {
+    uint64_t rxBytes = 0, txBytes = 0, rxPackets = 0, txPackets = 0, chunks = 0;
+    std::vector<double> chatRttMs;
+    std::vector<double> tickRttMs;
+    double mspt = -1.0, msptMax = -1.0;
+};
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int) { g_stop = 1; }
+
+double percentile(std::vector<double>& samples, double q) {
+    if (samples.empty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    size_t rank = static_cast<size_t>(q * (samples.size() - 1) + 0.5);
+    return samples[std::min(rank, samples.size() - 1)];
+}
+
+class Swarm {
+public:
+    explicit Swarm(const Options& opt) : opt_(opt), rng_(12345) {
+        bots_.resize(static_cast<size_t>(opt.bots));
+        for (int i = 0; i < opt.bots; ++i) {
+            auto& b = bots_[static_cast<size_t>(i)];
+            b = std::make_unique<Bot>();
+            b->index = i;
+            char name[17];
+            std::snprintf(name, sizeof(name), "Bot%04d", i);
+            b->name = name;
+        }
+    }
+
+    int run();
+
+private:
+    int64_t nowMs() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_).count();
+    }
+
+    bool connectBot(Bot& b);
+    void kill(Bot& b, const std::string& reason);
+    void onReadable(Bot& b);
+    void onWritable(Bot& b);
+    void handlePacket(Bot& b, int32_t packetId, const uint8_t* data, size_t length);
+    void send(Bot& b, PacketBuffer packet);
+    void updateInterest(Bot& b);
+    void tickBot(Bot& b);
+    void report(bool final);
+
+    const Options& opt_;
+    std::mt19937 rng_;
+    std::vector<std::unique_ptr<Bot>> bots_;
+    int epollFd_ = -1;
+    Clock::time_point start_;
+    sockaddr_in addr_{};
+
+    Interval interval_;
+    Interval total_;
+    int64_t lastReportMs_ = 0;
+    int64_t nextTickQueryMs_ = 0;
+    Clock::time_point tickQuerySent_;
+    bool tickQueryPending_ = false;
+    int failures_ = 0;
+};
+
+bool Swarm::connectBot(Bot& b) {
+    b.fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (b.fd < 0) {
+        kill(b, std::string("socket: ") + std::strerror(errno));
+        return false;
+    }
+    int flag = 1;
+    ::setsockopt(b.fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    if (::connect(b.fd, reinterpret_cast<sockaddr*>(&addr_), sizeof(addr_)) < 0 && errno != EINPROGRESS) {
+        kill(b, std::string("connect: ") + std::strerror(errno));
+        return false;
+    }
+
+    b.state = BotState::Connecting;
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.ptr = &b;
+    b.wantWrite = true;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, b.fd, &ev);
+
+    // Handshake (next state 2 = Login) and Login Start, sent once connected
+    PacketWriter hs(HandshakePacket::Handshake);
+    hs.writeVarInt(5);
+    hs.writeString(opt_.host);
+    hs.writeShort(static_cast<int16_t>(opt_.port));
+    hs.writeVarInt(2);
+    send(b, hs.finish());
+
+    PacketWriter login(LoginPacket::LoginStart);
+    login.writeString(b.name);
+    send(b, login.finish());
+    return true;
+}
+
+void Swarm::kill(Bot& b, const std::string& reason) {
+    if (b.state == BotState::Dead) return;
+    if (!g_stop) {
+        std::fprintf(stderr, "[BotSwarm] %s: %s\n", b.name.c_str(), reason.c_str());
+        ++failures_;
+    }
+    if (b.fd >= 0) {
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, b.fd, nullptr);
+        ::close(b.fd);
+        b.fd = -1;
+    }
+    b.state = BotState::Dead;
+}
+
+void Swarm::send(Bot& b, PacketBuffer packet) {
+    if (b.state == BotState::Dead) return;
+    b.out.insert(b.out.end(), packet.data(), packet.data() + packet.size());
+    interval_.txBytes += packet.size();
+    ++interval_.txPackets;
+}
+
+void Swarm::updateInterest(Bot& b) {
+    bool want = b.outOffset < b.out.size();
+    if (want == b.wantWrite || b.fd < 0) return;
+    epoll_event ev{};
+    ev.events = EPOLLIN | (want ? EPOLLOUT : 0u);
+    ev.data.ptr = &b;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_MOD, b.fd, &ev);
+    b.wantWrite = want;
+}
+
+void Swarm::onWritable(Bot& b) {
+    if (b.state == BotState::Connecting) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        ::getsockopt(b.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0) {
+            kill(b, std::string("connect: ") + std::strerror(err));
+            return;
+        }
+        b.state = BotState::Login;
+    }
+    while (b.outOffset < b.out.size()) {
+        ssize_t n = ::send(b.fd, b.out.data() + b.outOffset, b.out.size() - b.outOffset, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            kill(b, std::string("send: ") + std::strerror(errno));
+            return;
+        }
+        b.outOffset += static_cast<size_t>(n);
+    }
+    if (b.outOffset == b.out.size()) {
+        b.out.clear();
+        b.outOffset = 0;
+    }
+    updateInterest(b);
+}
+
+void Swarm::onReadable(Bot& b) {
+    for (;;) {
+        uint8_t* tail = b.in.prepareWrite(65536);
+        ssize_t n = ::recv(b.fd, tail, b.in.writableBytes(), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            kill(b, std::string("recv: ") + std::strerror(errno));
+            return;
+        }
+        if (n == 0) {
+            kill(b, "connection closed by server");
+            return;
+        }
+        b.in.commitWrite(static_cast<size_t>(n));
+        interval_.rxBytes += static_cast<uint64_t>(n);
+
+        FrameView frame;
+        FrameStatus status;
+        while ((status = b.in.nextFrame(frame)) == FrameStatus::Complete) {
+            ++interval_.rxPackets;
+            try {
+                auto id = readVarInt(frame.data, frame.length);
+                handlePacket(b, id.value, frame.data + id.bytesRead, frame.length - static_cast<size_t>(id.bytesRead));
+            } catch (const std::exception& e) {
+                kill(b, std::string("bad packet: ") + e.what());
+            }
+            if (b.state == BotState::Dead) return;
+        }
+        if (status != FrameStatus::NeedMore) {
+            kill(b, "bad frame");
+            return;
+        }
+        b.in.compactIfDrained();
+    }
+}
+
+void Swarm::handlePacket(Bot& b, int32_t packetId, const uint8_t* data, size_t length) {
+    PacketReader r(data, length);
+
+    if (b.state != BotState::Play) {
+        if (packetId == LoginPacket::LoginSuccess) {
+            b.state = BotState::Play;
+        } else if (packetId == LoginPacket::EncryptionRequest) {
+            kill(b, "server is in online mode (start it with --offline-mode)");
+        } else if (packetId == LoginPacket::Disconnect) {
+            kill(b, "kicked during login: " + r.readString());
+        }
+        return;
+    }
+
+    switch (packetId) {
+        case ClientboundPacket::KeepAlive: {
+            // Java: NetHandlerPlayClient.handleKeepAlive() echoes the ID
+            send(b, SB_KeepAlive{r.readInt()}.write());
+            break;
+        }
+        case ClientboundPacket::JoinGame: {
+            r.readInt();   // entity ID
+            // A survival server reverts every placement and timed dig
+            if ((r.readByte() & 0x07) != 1 && opt_.buildInterval > 0) {
+                kill(b, "server is in survival mode and would revert every block change "
+                        "(start it with --gamemode creative, or use --build-interval 0)");
+            }
+            break;
+        }
+        case ClientboundPacket::PlayerPosAndLook: {
+            b.x = r.readDouble();
+            b.y = r.readDouble();
+            b.z = r.readDouble();
+            float yaw = r.readFloat();
+            float pitch = r.readFloat();
+            if (!b.spawned) {
+                b.spawned = true;
+                b.originX = b.x;
+                b.originZ = b.z;
+                b.heading = std::uniform_real_distribution<double>(0, 2 * PI)(rng_);
+            }
+            // Java: the client confirms with C06 (its y is the feet position)
+            send(b, SB_PlayerPosAndLook{b.x, b.y, b.y + 1.62, b.z, yaw, pitch, true}.write());
+            break;
+        }
+        case ClientboundPacket::ChatMessage: {
+            // Our own messages come back as <BotNNNN> lg:<seq>
+            std::string json = r.readString();
+            std::string tag = "<" + b.name + "> lg:";
+            size_t pos = json.find(tag);
+            if (pos != std::string::npos) {
+                int seq = std::atoi(json.c_str() + pos + tag.size());
+                auto it = b.chatsInFlight.find(seq);
+                if (it != b.chatsInFlight.end()) {
+                    interval_.chatRttMs.push_back(
+                        std::chrono::duration<double, std::milli>(Clock::now() - it->second).count());
+                    b.chatsInFlight.erase(it);
+                }
+            }
+            break;
+        }
+        case ClientboundPacket::ChunkData:
+            ++interval_.chunks;
+            break;
+        case ClientboundPacket::MapChunkBulk:
+            interval_.chunks += static_cast<uint64_t>(r.readShort());
+            break;
+        case ClientboundPacket::PluginMessage: {
+            std::string channel = r.readString();
+            if (channel == PlayHandler::TICK_TIME_CHANNEL && tickQueryPending_) {
+                r.readShort();   // payload length
+                r.readInt();     // tick count
+                interval_.mspt = r.readDouble();
+                interval_.msptMax = std::max(interval_.msptMax, r.readDouble());
+                interval_.tickRttMs.push_back(
+                    std::chrono::duration<double, std::milli>(Clock::now() - tickQuerySent_).count());
+                tickQueryPending_ = false;
+            }
+            break;
+        }
+        case ClientboundPacket::Disconnect:
+            kill(b, "kicked: " + r.readString());
+            break;
+        default:
+            break;
+    }
+}
+
+void Swarm::tickBot(Bot& b) {
+    if (b.state != BotState::Play || !b.spawned) return;
+    ++b.tick;
+
+    // ─── Movement ───
+    if (opt_.path == "circle") {
+        double phase = 2 * PI * b.index / std::max(1, opt_.bots);
+        double angle = phase + b.tick * WALK_PER_TICK / opt_.radius;
+        b.x = b.originX + opt_.radius * std::cos(angle);
+        b.z = b.originZ + opt_.radius * std::sin(angle);
+    } else if (opt_.path == "line") {
+        double span = 4 * opt_.radius;
+        double t = std::fmod(b.tick * WALK_PER_TICK, span);
+        b.x = b.originX + (t < span / 2 ? t : span - t) - opt_.radius;
+    } else {
+        // Random walk: turn now and then, steer home outside the radius
+        if (std::uniform_int_distribution<int>(0, 39)(rng_) == 0) {
+            b.heading += std::uniform_real_distribution<double>(-PI / 2, PI / 2)(rng_);
+        }
+        double dx = b.x - b.originX, dz = b.z - b.originZ;
+        if (dx * dx + dz * dz > opt_.radius * opt_.radius) {
+            b.heading = std::atan2(-dz, -dx);
+        }
+        b.x += WALK_PER_TICK * std::cos(b.heading);
+        b.z += WALK_PER_TICK * std::sin(b.heading);
+    }
+    send(b, SB_PlayerPosition{b.x, b.y, b.y + 1.62, b.z, true}.write());
+
+    int64_t now = nowMs();
+
+    // ─── Chat ───
+    if (opt_.chatInterval > 0 && now >= b.nextChatMs) {
+        int seq = ++b.chatSeq;
+        send(b, SB_ChatMessage{"lg:" + std::to_string(seq)}.write());
+        b.chatsInFlight[seq] = Clock::now();
+        if (b.chatsInFlight.size() > 64) b.chatsInFlight.erase(b.chatsInFlight.begin());
+        b.nextChatMs = now + static_cast<int64_t>(opt_.chatInterval * 1000);
+    }
+
+    // ─── Place / break the block in front of the feet ───
+    if (opt_.buildInterval > 0 && now >= b.nextBuildMs) {
+        int32_t bx = static_cast<int32_t>(std::floor(b.x + std::cos(b.heading)));
+        int32_t bz = static_cast<int32_t>(std::floor(b.z + std::sin(b.heading)));
+        int32_t by = static_cast<int32_t>(std::floor(b.y));
+        if (b.placeNext) {
+            // Stone x1 on the top face of the block below the feet
+            SlotData stone;
+            stone.itemId = 1;
+            stone.count = 1;
+            send(b, SB_PlayerBlockPlace{bx, static_cast<uint8_t>(by - 1), bz, 1, stone, 8, 16, 8}.write());
+        } else {
+            // Start and finish digging
+            send(b, SB_PlayerDigging{0, bx, static_cast<uint8_t>(by), bz, 1}.write());
+            send(b, SB_PlayerDigging{2, bx, static_cast<uint8_t>(by), bz, 1}.write());
+        }
+        send(b, SB_Animation{b.index, 1}.write());
+        b.placeNext = !b.placeNext;
+        b.nextBuildMs = now + static_cast<int64_t>(opt_.buildInterval * 1000);
+    }
+}
+
+void Swarm::report(bool final) {
+    int64_t now = nowMs();
+    double secs = std::max(1, static_cast<int>(now - lastReportMs_)) / 1000.0;
+    lastReportMs_ = now;
+
+    int inPlay = 0;
+    for (auto& b : bots_) inPlay += (b->state == BotState::Play);
+
+    Interval& iv = final ? total_ : interval_;
+    if (final) {
+        secs = std::max(1, static_cast<int>(now)) / 1000.0;
+    } else {
+        total_.rxBytes += iv.rxBytes;
+        total_.txBytes += iv.txBytes;
+        total_.rxPackets += iv.rxPackets;
+        total_.txPackets += iv.txPackets;
+        total_.chunks += iv.chunks;
+        total_.chatRttMs.insert(total_.chatRttMs.end(), iv.chatRttMs.begin(), iv.chatRttMs.end());
+        total_.tickRttMs.insert(total_.tickRttMs.end(), iv.tickRttMs.begin(), iv.tickRttMs.end());
+        if (iv.mspt >= 0) total_.mspt = iv.mspt;
+        total_.msptMax = std::max(total_.msptMax, iv.msptMax);
+    }
+
+    std::printf("[%s %5.1fs] bots %d/%d | MSPT %.2f (max %.2f) | chat RTT p50 %.1f p99 %.1f ms"
+                " | tick RTT p50 %.1f ms | rx %.1f KiB/s %.0f pkt/s | tx %.1f KiB/s | chunks %.1f/s"
+                " | failed %d\n",
+                final ? "total" : "swarm", now / 1000.0, inPlay, opt_.bots,
+                iv.mspt, iv.msptMax,
+                percentile(iv.chatRttMs, 0.50), percentile(iv.chatRttMs, 0.99),
+                percentile(iv.tickRttMs, 0.50),
+                iv.rxBytes / 1024.0 / secs, iv.rxPackets / secs, iv.txBytes / 1024.0 / secs,
+                iv.chunks / secs, failures_);
+    std::fflush(stdout);
+
+    if (!final) {
+        double mspt = interval_.mspt;
+        interval_ = Interval();
+        interval_.mspt = mspt;   // carry the last reading into quiet intervals
+    }
+}
+
+int Swarm::run() {
+    addr_.sin_family = AF_INET;
+    addr_.sin_port = htons(opt_.port);
+    if (::inet_pton(AF_INET, opt_.host.c_str(), &addr_.sin_addr) <= 0) {
+        std::fprintf(stderr, "Invalid IPv4 address: %s\n", opt_.host.c_str());
+        return 1;
+    }
+    epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    start_ = Clock::now();
+
+    size_t launched = 0;
+    int64_t nextTickMs = 0;
+    epoll_event events[256];
+
+    while (!g_stop && nowMs() < opt_.durationSec * 1000LL) {
+        int64_t now = nowMs();
+
+        // Ramp up logins at --login-rate
+        size_t due = std::min(bots_.size(), static_cast<size_t>(now * opt_.loginRate / 1000.0) + 1);
+        while (launched < due) {
+            Bot& b = *bots_[launched++];
+            b.nextChatMs = now + std::uniform_int_distribution<int64_t>(0, static_cast<int64_t>(opt_.chatInterval * 1000))(rng_);
+            b.nextBuildMs = now + std::uniform_int_distribution<int64_t>(0, static_cast<int64_t>(opt_.buildInterval * 1000))(rng_);
+            connectBot(b);
+        }
+
+        if (now >= nextTickMs) {
+            nextTickMs = now + TICK_MS;
+            for (auto& b : bots_) tickBot(*b);
+
+            // One bot at a time asks for the server's tick times, once a second
+            if (now >= nextTickQueryMs_) {
+                for (auto& b : bots_) {
+                    if (b->state != BotState::Play) continue;
+                    send(*b, SB_PluginMessage{PlayHandler::TICK_TIME_CHANNEL, {}}.write());
+                    tickQuerySent_ = Clock::now();
+                    tickQueryPending_ = true;
+                    break;
+                }
+                nextTickQueryMs_ = now + 1000;
+            }
+            for (auto& b : bots_) {
+                if (b->state == BotState::Login || b->state == BotState::Play) onWritable(*b);
+            }
+        }
+
+        if (now - lastReportMs_ >= static_cast<int64_t>(opt_.reportInterval * 1000)) report(false);
+
+        int timeout = static_cast<int>(std::max<int64_t>(0, nextTickMs - nowMs()));
+        int n = ::epoll_wait(epollFd_, events, 256, timeout);
+        for (int i = 0; i < n; ++i) {
+            Bot& b = *static_cast<Bot*>(events[i].data.ptr);
+            if (b.state == BotState::Dead) continue;
+            if (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) onWritable(b);
+            if (b.state != BotState::Dead && (events[i].events & EPOLLIN)) onReadable(b);
+        }
+    }
+
+    report(false);
+    report(true);
+    g_stop = 1;
+    for (auto& b : bots_) kill(*b, "done");
+    ::close(epollFd_);
+    return failures_ == 0 ? 0 : 1;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string next = (i + 1 < argc) ? argv[i + 1] : "";
+        bool hasNext = i + 1 < argc;
+        if (arg == "--host" && hasNext) { opt.host = next; ++i; }
+        else if (arg == "--port" && hasNext) { opt.port = static_cast<uint16_t>(std::atoi(next.c_str())); ++i; }
+        else if (arg == "--bots" && hasNext) { opt.bots = std::max(1, std::atoi(next.c_str())); ++i; }
+        else if (arg == "--duration" && hasNext) { opt.durationSec = std::atoi(next.c_str()); ++i; }
+        else if (arg == "--login-rate" && hasNext) { opt.loginRate = std::max(0.1, std::atof(next.c_str())); ++i; }
+        else if (arg == "--path" && hasNext) { opt.path = next; ++i; }
+        else if (arg == "--radius" && hasNext) { opt.radius = std::max(1.0, std::atof(next.c_str())); ++i; }
+        else if (arg == "--chat-interval" && hasNext) { opt.chatInterval = std::atof(next.c_str()); ++i; }
+        else if (arg == "--build-interval" && hasNext) { opt.buildInterval = std::atof(next.c_str()); ++i; }
+        else if (arg == "--report-interval" && hasNext) { opt.reportInterval = std::max(0.5, std::atof(next.c_str())); ++i; }
+        else {
+            std::printf("Usage: bot-swarm [--host 127.0.0.1] [--port 25565] [--bots 50] [--duration 60]\n"
+                        "                 [--login-rate 20] [--path random|circle|line] [--radius 48]\n"
+                        "                 [--chat-interval 5] [--build-interval 2] [--report-interval 5]\n"
+                        "Server: minecppaft-server --offline-mode --connection-throttle 0 --gamemode creative\n");
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::printf("Bot swarm: %d bots -> %s:%u for %ds, path %s\n", opt.bots, opt.host.c_str(),
+                opt.port, opt.durationSec, opt.path.c_str());
+    Swarm swarm(opt);
+    return swarm.run();
+}
@@ -0,0 +1,288 @@
+/**
+ * ChunkMemoryBench.cpp — Loaded-chunk memory: Anvil arrays vs. palette storage.
+ *
+ * Loads chunks the way the server holds them and reports bytes per chunk for
+ * the block IDs + metadata, the light buffers and the whole Chunk (sections,
+ * height map, biomes; not the packet payload cache), next to what the same
+ * chunks took with flat Anvil arrays in each section (4096-byte LSB, 2048-byte
+ * metadata, MSB where used, and 2048 bytes per light array). Also shows how
+ * the sections split between the storage modes and how many light arrays are
+ * uniform.
+ *
+ * Chunks come from a world's region directory (every r.X.Z.mca in it) or,
+ * without one, the generated terrain and flat sets (BenchTerrain.h).
+ *
+ * Every chunk is checked first: its S21 extraction must match the blocks read
+ * through getBlock/getBlockMetadata, and an NBT round trip must extract the
+ * same bytes. A churn test then sets random blocks and metadata in one section
+ * against a plain array, through every storage mode, and checks that a full
+ * palette drops the states no longer used; a NibbleArray gets the same
+ * treatment across its uniform and buffered forms.
+ *
+ * Usage: bench-chunk-memory [region-dir | chunks]   (default 400 chunks)
+ */
+
+#include "BenchTerrain.h"
+#include "networking/ChunkSerializer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace mccpp;
+
+namespace {
+
+constexpr int BLOCKS = BlockStateStorage::SIZE;
+
+// Bytes the block data of `section` took before: LSB array inline, metadata
+// NibbleArray, MSB pointer plus the array if the section had one.
+size_t anvilBlockBytes(const ChunkSection& section) {
+    size_t bytes = BLOCKS + sizeof(NibbleArray) + BLOCKS / 2 + sizeof(std::unique_ptr<NibbleArray>);
+    if (section.hasBlockMSB()) bytes += sizeof(NibbleArray) + BLOCKS / 2;
+    return bytes;
+}
+
+size_t paletteBlockBytes(const ChunkSection& section) {
+    return sizeof(BlockStateStorage) + section.getBlockStorage().getHeapBytes();
+}
+
+// Light buffers: 2048 bytes per array before, only non-uniform ones now
+size_t flatLightBytes(const ChunkSection& section) {
+    return NibbleArray::MAX_SHARED_BYTES * (section.getSkylightArray() ? 2 : 1);
+}
+
+size_t lightHeapBytes(const ChunkSection& section) {
+    const NibbleArray* sky = section.getSkylightArray();
+    return section.getBlocklightArray().getHeapBytes() + (sky ? sky->getHeapBytes() : 0);
+}
+
+// S21 data (sky light included) expected from the block accessors
+bool extractionMatches(const Chunk& chunk) {
+    ChunkExtracted extracted = ChunkSerializer::extract(chunk, true, true);
+    const uint8_t* lsb = extracted.data.data();
+    int count = 0;
+    for (int i = 0; i < Chunk::SECTION_COUNT; ++i) count += (extracted.primaryBitmask >> i) & 1;
+    const uint8_t* meta = lsb + static_cast<size_t>(count) * BLOCKS;
+    const uint8_t* msb = meta + static_cast<size_t>(count) * BLOCKS / 2 * 3;
+
+    for (int i = 0; i < Chunk::SECTION_COUNT; ++i) {
+        if (!(extracted.primaryBitmask & (1 << i))) continue;
+        const ChunkSection& section = *chunk.sections[i];
+        bool hasMsb = extracted.addBitmask & (1 << i);
+        for (int index = 0; index < BLOCKS; ++index) {
+            int x = index & 15, z = (index >> 4) & 15, y = index >> 8;
+            Block* block = section.getBlock(x, y, z);
+            int id = block ? Block::getIdFromBlock(block) : section.getBlockStorage().get(index) >> 4;
+            int shift = (index & 1) << 2;
+            int gotId = lsb[index] | (hasMsb ? ((msb[index >> 1] >> shift) & 15) << 8 : 0);
+            if (gotId != id || ((meta[index >> 1] >> shift) & 15) != section.getBlockMetadata(x, y, z)) {
+                return false;
+            }
+        }
+        lsb += BLOCKS;
+        meta += BLOCKS / 2;
+        if (hasMsb) msb += BLOCKS / 2;
+    }
+    return true;
+}
+
+bool roundTripMatches(const Chunk& chunk) {
+    auto level = chunk.writeToNBT();
+    auto back = Chunk::readFromNBT(*level);
+    return ChunkSerializer::extract(chunk, true, true).data == ChunkSerializer::extract(*back, true, true).data;
+}
+
+void report(const char* label, const std::vector<std::unique_ptr<Chunk>>& chunks) {
+    size_t sections = 0, modes[17] = {}, anvilBlocks = 0, paletteBlocks = 0, total = 0;
+    size_t lightArrays = 0, uniformLight = 0, flatLight = 0, lightHeap = 0;
+    for (const auto& chunk : chunks) {
+        if (!extractionMatches(*chunk) || !roundTripMatches(*chunk)) {
+            std::printf("%s: chunk %d,%d does not extract or round-trip correctly\n", label,
+                        chunk->xPosition, chunk->zPosition);
+            std::exit(1);
+        }
+        total += chunk->getMemoryUsage();
+        for (const auto& section : chunk->sections) {
+            if (!section) continue;
+            ++sections;
+            ++modes[section->getBlockStorage().getBits()];
+            anvilBlocks += anvilBlockBytes(*section);
+            paletteBlocks += paletteBlockBytes(*section);
+            flatLight += flatLightBytes(*section);
+            lightHeap += lightHeapBytes(*section);
+            for (const NibbleArray* light : {&section->getBlocklightArray(), section->getSkylightArray()}) {
+                if (!light) continue;
+                ++lightArrays;
+                uniformLight += light->isUniform();
+            }
+        }
+    }
+
+    double n = static_cast<double>(chunks.size());
+    size_t before = total - paletteBlocks - lightHeap + anvilBlocks + flatLight;
+    std::printf("%s: %zu chunks, %zu sections (%.1f per chunk)\n", label, chunks.size(), sections,
+                static_cast<double>(sections) / n);
+    std::printf("  sections: %zu single value, %zu 1-bit, %zu 2-bit, %zu 4-bit, %zu 8-bit, %zu direct\n",
+                modes[0], modes[1], modes[2], modes[4], modes[8], modes[16]);
+    std::printf("  light arrays: %zu of %zu uniform\n", uniformLight, lightArrays);
+    auto saved = [](size_t before, size_t after) {
+        return 100.0 * (1.0 - static_cast<double>(after) / static_cast<double>(before));
+    };
+    std::printf("  %-22s %12s %12s %8s\n", "bytes per chunk", "flat arrays", "now", "saved");
+    std::printf("  %-22s %12.0f %12.0f %7.1f%%\n", "block IDs + metadata", anvilBlocks / n, paletteBlocks / n,
+                saved(anvilBlocks, paletteBlocks));
+    std::printf("  %-22s %12.0f %12.0f %7.1f%%\n", "light buffers", flatLight / n, lightHeap / n,
+                saved(flatLight, lightHeap));
+    std::printf("  %-22s %12.0f %12.0f %7.1f%%\n", "whole chunk", before / n, total / n, saved(before, total));
+}
+
+// Random sets against a plain array, widening the block pool each phase so the
+// section passes through every mode; then a full palette shrinking back.
+bool churn() {
+    std::vector<int> ids;
+    for (int id = 1; id < 4096; ++id) {
+        if (Block::getBlockById(id)) ids.push_back(id);
+    }
+    std::mt19937 rng(20140623);
+    ChunkSection section(0, true);
+    std::vector<uint16_t> mirror(BLOCKS, 0);
+    bool seen[17] = {};
+
+    auto check = [&]() {
+        uint8_t lsb[BLOCKS], msb[BLOCKS / 2], meta[BLOCKS / 2];
+        section.getBlockArrays(lsb, msb, meta);
+        for (int index = 0; index < BLOCKS; ++index) {
+            int shift = (index & 1) << 2;
+            uint16_t state = static_cast<uint16_t>(
+                (lsb[index] | ((msb[index >> 1] >> shift) & 15) << 8) << 4 | ((meta[index >> 1] >> shift) & 15));
+            if (state != mirror[index] || section.getBlockStorage().get(index) != mirror[index]) return false;
+        }
+        seen[section.getBlockStorage().getBits()] = true;
+        return true;
+    };
+
+    if (!check()) return false;
+    const std::pair<size_t, int> phases[] = {{1, 2}, {2, 2}, {4, 4}, {12, 16}, {ids.size(), 16}};
+    for (auto [pool, metas] : phases) {
+        std::uniform_int_distribution<size_t> pick(0, std::min(pool, ids.size()) - 1);
+        for (int op = 0; op < 40000; ++op) {
+            int index = static_cast<int>(rng() % BLOCKS);
+            int x = index & 15, z = (index >> 4) & 15, y = index >> 8;
+            if (op & 1) {
+                int meta = static_cast<int>(rng() % static_cast<unsigned>(metas));
+                section.setBlockMetadata(x, y, z, meta);
+                mirror[index] = static_cast<uint16_t>((mirror[index] & 0xFFF0) | meta);
+            } else {
+                int id = ids[pick(rng)];
+                section.setBlock(x, y, z, Block::getBlockById(id));
+                mirror[index] = static_cast<uint16_t>(id << 4 | (mirror[index] & 15));
+            }
+            if (op % 250 == 0 && !check()) return false;
+        }
+        if (!check()) return false;
+    }
+
+    // A full 8-bit palette, then everything overwritten with one of its states:
+    // the next new state finds the palette full and drops it back to 1 bit
+    BlockStateStorage shrink;
+    for (int index = 0; index < BLOCKS; ++index) shrink.set(index, static_cast<uint16_t>(index & 255));
+    bool full = shrink.getBits() == 8 && shrink.getPaletteSize() == 256;
+    for (int index = 0; index < BLOCKS; ++index) shrink.set(index, 0x10);
+    shrink.set(0, 0x1230);
+    if (!full || shrink.getBits() != 1 || shrink.get(0) != 0x1230 || shrink.get(1) != 0x10) return false;
+
+    std::printf("churn: ok, %zu block types; modes seen:%s%s%s%s%s%s\n", ids.size(), seen[0] ? " single" : "",
+                seen[1] ? " 1-bit" : "", seen[2] ? " 2-bit" : "", seen[4] ? " 4-bit" : "",
+                seen[8] ? " 8-bit" : "", seen[16] ? " direct" : "");
+    return true;
+}
+
+// NibbleArray against a plain array: uniform until a different value is
+// written, uniform again after compact() once every nibble matches
+bool lightChurn() {
+    std::mt19937 rng(20140623);
+    NibbleArray light(BLOCKS, 4, 15);
+    std::vector<uint8_t> mirror(BLOCKS, 15);
+    auto check = [&]() {
+        const uint8_t* bytes = light.bytes();
+        for (int index = 0; index < BLOCKS; ++index) {
+            int x = index & 15, z = (index >> 4) & 15, y = index >> 8;
+            if (light.get(x, y, z) != mirror[index] ||
+                ((bytes[index >> 1] >> ((index & 1) << 2)) & 15) != mirror[index]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    light.set(1, 2, 3, 15);
+    if (!light.isUniform() || !check()) return false;
+    for (int op = 0; op < 20000; ++op) {
+        int index = static_cast<int>(rng() % BLOCKS), value = static_cast<int>(rng() % 16);
+        light.set(index & 15, index >> 8, (index >> 4) & 15, value);
+        mirror[index] = static_cast<uint8_t>(value);
+    }
+    if (light.isUniform() || light.compact() || !check()) return false;
+    for (int index = 0; index < BLOCKS; ++index) light.set(index & 15, index >> 8, (index >> 4) & 15, 7);
+    std::fill(mirror.begin(), mirror.end(), 7);
+    return light.compact() && light.isUniform() && light.getHeapBytes() == 0 && check();
+}
+
+std::vector<std::unique_ptr<Chunk>> loadRegions(const std::filesystem::path& dir) {
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.path().extension() != ".mca") continue;
+        RegionFile region(entry.path().string());
+        for (int z = 0; z < 32; ++z) {
+            for (int x = 0; x < 32; ++x) {
+                auto data = region.readChunkData(x, z);
+                if (!data) continue;
+                auto root = nbt::deserializeNBT(data->data(), data->size());
+                if (auto* level = root ? root->getCompoundTag("Level") : nullptr) {
+                    chunks.push_back(Chunk::readFromNBT(*level));
+                }
+            }
+        }
+    }
+    return chunks;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Block::registerBlocks();
+
+    if (argc > 1 && std::filesystem::is_directory(argv[1])) {
+        auto chunks = loadRegions(argv[1]);
+        if (chunks.empty()) {
+            std::printf("no chunks in %s\n", argv[1]);
+            return 1;
+        }
+        report(argv[1], chunks);
+    } else {
+        int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 400;
+        int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+        std::mt19937 rng(20140623);
+        NoiseGeneratorSimplex height(rng), detail(rng);
+        NoiseGeneratorImproved caves(rng);
+
+        std::vector<std::unique_ptr<Chunk>> terrain, flat;
+        for (int i = 0; i < count; ++i) {
+            int cx = i % side - side / 2, cz = i / side - side / 2;
+            terrain.push_back(bench::terrainChunk(cx, cz, height, detail, caves, rng));
+            flat.push_back(bench::flatChunk(cx, cz));
+        }
+        report("terrain", terrain);
+        report("flat", flat);
+    }
+    if (!lightChurn()) {
+        std::printf("light churn: NibbleArray does not match\n");
+        return 1;
+    }
+    return churn() ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+/**
+ * DeflateBench.cpp — Chunk packet compression: ratio vs. CPU per backend.
+ *
+ * Builds the terrain and flat chunk sets (BenchTerrain.h) and extracts them
+ * in S26 layout, five chunks per packet as ChunkSendPipeline sends them.
+ * Each DeflateEngine backend compresses every packet at several levels (one
+ * reused context per backend, like the chunk-send workers). The output is
+ * inflated and compared with the input before timing. Reports the ratio,
+ * ns per input byte and MB/s; the old per-packet deflateInit/deflateEnd path
+ * at the default level is measured alongside.
+ *
+ * Usage: bench-deflate [terrain-chunks]   (default 400; flat uses the same)
+ */
+
+#include "BenchTerrain.h"
+#include "block/Block.h"
+#include "networking/ChunkSerializer.h"
+#include "networking/DeflateEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <zlib.h>
+
+using namespace mccpp;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t CHUNKS_PER_PACKET = 5;
+
+// Extracted S26 data, one entry per packet
+std::vector<std::vector<uint8_t>> packetPayloads(const std::vector<std::unique_ptr<Chunk>>& chunks) {
+    std::vector<std::vector<uint8_t>> packets;
+    for (size_t i = 0; i < chunks.size(); i += CHUNKS_PER_PACKET) {
+        std::vector<uint8_t> raw;
+        for (size_t c = i; c < std::min(chunks.size(), i + CHUNKS_PER_PACKET); ++c) {
+            ChunkExtracted masks;
+            ChunkSerializer::extractInto(*chunks[c], true, true, 0xFFFF, raw, masks);
+        }
+        packets.push_back(std::move(raw));
+    }
+    return packets;
+}
+
+struct Result {
+    size_t in = 0;
+    size_t out = 0;
+    double seconds = 0;
+};
+
+template <typename Fn>
+Result measure(const std::vector<std::vector<uint8_t>>& packets, int rounds, Fn compressOne) {
+    Result r;
+    std::vector<uint8_t> out;
+    auto start = Clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto& raw : packets) {
+            r.out += compressOne(raw, out);
+            r.in += raw.size();
+        }
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return r;
+}
+
+bool verify(const std::vector<std::vector<uint8_t>>& packets, const DeflateSettings& settings) {
+    for (const auto& raw : packets) {
+        std::vector<uint8_t> compressed = ChunkSerializer::compress(raw, settings);
+        std::vector<uint8_t> back(raw.size());
+        uLongf backLen = static_cast<uLongf>(back.size());
+        if (uncompress(back.data(), &backLen, compressed.data(), static_cast<uLong>(compressed.size())) != Z_OK ||
+            backLen != raw.size() || back != raw) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void report(const char* name, int level, const Result& r) {
+    std::printf("  %-22s %2d  %7.2fx  %7.2f ns/B  %8.1f MB/s\n", name, level,
+                static_cast<double>(r.in) / static_cast<double>(r.out),
+                r.seconds * 1e9 / static_cast<double>(r.in),
+                static_cast<double>(r.in) / r.seconds / 1e6);
+}
+
+void runSet(const char* label, const std::vector<std::unique_ptr<Chunk>>& chunks) {
+    auto packets = packetPayloads(chunks);
+    size_t rawBytes = 0;
+    for (const auto& p : packets) rawBytes += p.size();
+    // Roughly 64 MiB of input per measurement
+    int rounds = std::max(1, static_cast<int>((64u << 20) / std::max<size_t>(rawBytes, 1)));
+    std::printf("%s: %zu chunks, %zu packets, %.1f MiB extracted, %d rounds\n", label, chunks.size(),
+                packets.size(), static_cast<double>(rawBytes) / (1 << 20), rounds);
+    std::printf("  %-22s %2s  %8s  %12s  %13s\n", "backend", "lv", "ratio", "cpu", "throughput");
+
+    Result old = measure(packets, rounds, [](const std::vector<uint8_t>& raw, std::vector<uint8_t>& out) {
+        z_stream strm = {};
+        deflateInit(&strm, Z_DEFAULT_COMPRESSION);
+        out.resize(deflateBound(&strm, static_cast<uLong>(raw.size())));
+        strm.next_in = const_cast<Bytef*>(raw.data());
+        strm.avail_in = static_cast<uInt>(raw.size());
+        strm.next_out = out.data();
+        strm.avail_out = static_cast<uInt>(out.size());
+        deflate(&strm, Z_FINISH);
+        size_t produced = strm.total_out;
+        deflateEnd(&strm);
+        return produced;
+    });
+    report("zlib, init per packet", 6, old);
+
+    static const int LEVELS[] = {1, 2, 4, 6, 9};
+    for (DeflateBackend backend : {DeflateBackend::Zlib, DeflateBackend::Fast}) {
+        for (int level : LEVELS) {
+            DeflateSettings settings{backend, level};
+            if (!verify(packets, settings)) {
+                std::printf("  %s level %d: output does not inflate back to the input\n",
+                            deflateBackendName(backend), level);
+                std::exit(1);
+            }
+            DeflateEngine& engine = DeflateEngine::forThread(backend);
+            Result r = measure(packets, rounds, [&](const std::vector<uint8_t>& raw, std::vector<uint8_t>& out) {
+                out.resize(engine.bound(raw.size()));
+                return engine.compress(raw.data(), raw.size(), out.data(), level, true) + 6;
+            });
+            report(deflateBackendName(backend), level, r);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::max(5, std::atoi(argv[1])) : 400;
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+
+    Block::registerBlocks();
+
+    std::mt19937 rng(20140623);
+    NoiseGeneratorSimplex height(rng), detail(rng);
+    NoiseGeneratorImproved caves(rng);
+
+    std::vector<std::unique_ptr<Chunk>> terrain, flat;
+    for (int i = 0; i < count; ++i) {
+        int cx = i % side - side / 2, cz = i / side - side / 2;
+        terrain.push_back(bench::terrainChunk(cx, cz, height, detail, caves, rng));
+        flat.push_back(bench::flatChunk(cx, cz));
+    }
+
+    runSet("terrain", terrain);
+    runSet("flat", flat);
+    return 0;
+}
@@ -0,0 +1,205 @@
+/**
+ * EntityMovementBench.cpp — Entity movement packets: bytes and CPU per tick.
+ *
+ * Simulates mobs wandering around players on a 384x384 block area and runs
+ * EntityTracker each tick: updateTrackedEntities (who sees what), then
+ * sendLocationUpdates into an EntityUpdateBatch (one buffer per player).
+ * The same run is repeated with one buffer per packet and recipient, the way
+ * a packet per sendToAllTrackingEntity call would be queued, to show what the
+ * batching saves. Both runs use the same seed and send identical bytes; the
+ * per-packet run splits the batch, so its time includes the grouping too.
+ *
+ * Reports per tick: bytes, frames by type, buffers handed to connections and
+ * the CPU time of the encode + grouping step, plus what the movement frames
+ * would cost as absolute S18 teleports.
+ *
+ * Usage: bench-entity-movement [mobs] [players] [ticks]   (default 2000 100 400)
+ */
+
+#include "entity/EntityTracker.h"
+#include "networking/PlayPackets.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace mccpp;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr double AREA = 384.0;
+constexpr int    WARMUP_TICKS = 20;
+constexpr size_t TELEPORT_FRAME_BYTES = 20;   // length, ID, Int ID, 3 Int, 2 Byte
+
+struct Walker {
+    TrackedEntityInfo info;
+    double speed;
+    int    turnIn;
+    float  lookOffset;
+};
+
+struct Totals {
+    uint64_t bytes = 0;
+    uint64_t buffers = 0;
+    uint64_t frames[256] = {};
+    double   encodeSeconds = 0;
+    double   visibilitySeconds = 0;
+    int      ticks = 0;
+};
+
+enum class Mode { Batched, PerPacket };
+
+void step(Walker& w, std::mt19937& rng, bool player) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    if (--w.turnIn <= 0) {
+        // New heading; some mobs stop for a while, as wandering AI does
+        w.info.yaw = static_cast<float>(unit(rng) * 360.0);
+        w.speed = !player && unit(rng) < 0.4 ? 0.0 : (player ? 0.28 : 0.1 + unit(rng) * 0.15);
+        w.turnIn = 20 + static_cast<int>(unit(rng) * 80);
+        w.lookOffset = static_cast<float>((unit(rng) - 0.5) * 60.0);
+        w.info.pitch = static_cast<float>((unit(rng) - 0.5) * 20.0);
+    }
+    double rad = w.info.yaw * 3.14159265358979 / 180.0;
+    w.info.motionX = -std::sin(rad) * w.speed;
+    w.info.motionZ = std::cos(rad) * w.speed;
+    w.info.posX = std::clamp(w.info.posX + w.info.motionX, 0.0, AREA);
+    w.info.posZ = std::clamp(w.info.posZ + w.info.motionZ, 0.0, AREA);
+    // The head turns towards where the mob looks, a few degrees per tick
+    float target = w.info.yaw + w.lookOffset;
+    w.info.headYaw += std::clamp(target - w.info.headYaw, -10.0f, 10.0f);
+}
+
+Totals run(Mode mode, int mobCount, int playerCount, int ticks) {
+    std::mt19937 rng(20140623);
+    std::uniform_real_distribution<double> pos(0.0, AREA);
+
+    std::vector<Walker> walkers;
+    for (int i = 0; i < playerCount + mobCount; ++i) {
+        bool player = i < playerCount;
+        Walker w{};
+        w.info.entityId = i + 1;
+        w.info.type = player ? TrackedEntityType::Player : TrackedEntityType::Animal;
+        w.info.isPlayer = player;
+        w.info.posX = pos(rng);
+        w.info.posY = 4.0;
+        w.info.posZ = pos(rng);
+        walkers.push_back(w);
+    }
+
+    // Java: entity view distance for the default view radius of 10
+    EntityTracker tracker(10 * 16 - 16);
+    for (const auto& w : walkers) tracker.trackEntity(w.info);
+
+    std::vector<TrackedEntityInfo> players(static_cast<size_t>(playerCount));
+    EntityUpdateBatch batch;
+    std::vector<PacketBuffer> sent;
+    Totals totals;
+
+    for (int tick = 0; tick < ticks + WARMUP_TICKS; ++tick) {
+        for (int i = 0; i < static_cast<int>(walkers.size()); ++i) {
+            Walker& w = walkers[static_cast<size_t>(i)];
+            step(w, rng, i < playerCount);
+            tracker.updateEntityPosition(w.info.entityId, w.info.posX, w.info.posY, w.info.posZ,
+                                         w.info.yaw, w.info.pitch, w.info.headYaw);
+            tracker.updateEntityMotion(w.info.entityId, w.info.motionX, w.info.motionY, w.info.motionZ);
+            if (i < playerCount) players[static_cast<size_t>(i)] = w.info;
+        }
+
+        auto visibilityStart = Clock::now();
+        tracker.updateTrackedEntities(players);
+        auto encodeStart = Clock::now();
+
+        sent.clear();
+        tracker.sendLocationUpdates(batch);
+        if (mode == Mode::Batched) {
+            batch.drain([&](int32_t, PacketBuffer&& buffer) { sent.push_back(std::move(buffer)); });
+        } else {
+            // One buffer per packet and recipient
+            batch.drain([&](int32_t, PacketBuffer&& buffer) {
+                const uint8_t* p = buffer.data();
+                const uint8_t* end = p + buffer.size();
+                while (p < end) {
+                    size_t length = 0;
+                    int shift = 0, prefix = 0;
+                    do { length |= static_cast<size_t>(p[prefix] & 0x7F) << shift; shift += 7; }
+                    while (p[prefix++] & 0x80);
+                    PacketBuffer one = PacketBuffer::acquire(length);
+                    one.append(p + prefix, length);
+                    one.finishFrame();
+                    sent.push_back(std::move(one));
+                    p += prefix + length;
+                }
+            });
+        }
+        auto end = Clock::now();
+
+        if (tick < WARMUP_TICKS) continue;
+        ++totals.ticks;
+        totals.visibilitySeconds += std::chrono::duration<double>(encodeStart - visibilityStart).count();
+        totals.encodeSeconds += std::chrono::duration<double>(end - encodeStart).count();
+        totals.buffers += sent.size();
+        for (const auto& buffer : sent) {
+            totals.bytes += buffer.size();
+            const uint8_t* p = buffer.data();
+            const uint8_t* stop = p + buffer.size();
+            while (p < stop) {
+                size_t length = 0;
+                int shift = 0, prefix = 0;
+                do { length |= static_cast<size_t>(p[prefix] & 0x7F) << shift; shift += 7; }
+                while (p[prefix++] & 0x80);
+                ++totals.frames[p[prefix]];
+                p += prefix + length;
+            }
+        }
+    }
+    return totals;
+}
+
+void report(const char* label, const Totals& t) {
+    double ticks = t.ticks;
+    std::printf("%-11s %9.1f KiB/tick  %8.0f buffers/tick  %8.3f ms/tick encode+group  "
+                "(visibility %.3f ms/tick)\n",
+                label, t.bytes / ticks / 1024.0, t.buffers / ticks, t.encodeSeconds * 1e3 / ticks,
+                t.visibilitySeconds * 1e3 / ticks);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int mobs = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+    int players = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100;
+    int ticks = argc > 3 ? std::max(1, std::atoi(argv[3])) : 400;
+
+    std::printf("%d mobs, %d players, %d ticks on %.0fx%.0f blocks\n", mobs, players, ticks, AREA, AREA);
+    Totals batched = run(Mode::Batched, mobs, players, ticks);
+    Totals perPacket = run(Mode::PerPacket, mobs, players, ticks);
+    report("batched", batched);
+    report("per-packet", perPacket);
+
+    double n = batched.ticks;
+    const auto& f = batched.frames;
+    std::printf("frames/tick: rel-move %.0f, look %.0f, look+move %.0f, teleport %.0f, "
+                "velocity %.0f, head %.0f\n",
+                f[ClientboundPacket::EntityRelMove] / n, f[ClientboundPacket::EntityLook] / n,
+                f[ClientboundPacket::EntityLookAndRelMove] / n, f[ClientboundPacket::EntityTeleport] / n,
+                f[ClientboundPacket::EntityVelocity] / n, f[ClientboundPacket::EntityHeadLook] / n);
+
+    // The same updates with every move or look sent as an absolute teleport
+    uint64_t relative = f[ClientboundPacket::EntityRelMove] + f[ClientboundPacket::EntityLook] +
+                        f[ClientboundPacket::EntityLookAndRelMove];
+    uint64_t relativeBytes = f[ClientboundPacket::EntityRelMove] * 9 + f[ClientboundPacket::EntityLook] * 8 +
+                             f[ClientboundPacket::EntityLookAndRelMove] * 11;
+    double absolute = static_cast<double>(batched.bytes - relativeBytes + relative * TELEPORT_FRAME_BYTES);
+    std::printf("as teleports: %.1f KiB/tick (%.2fx)\n", absolute / n / 1024.0,
+                absolute / static_cast<double>(batched.bytes));
+
+    if (batched.bytes != perPacket.bytes) {
+        std::printf("batched and per-packet runs sent different bytes\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * FrameDecoderBench.cpp — Inbound framing throughput microbenchmark.
+ *
+ * Feeds a pipelined stream of serverbound packets (movement spam, then a
+ * mix with larger chat/plugin frames) through InboundBuffer in recv()-sized
+ * chunks and reports the bytes/s and packets/s the decoder sustains. The
+ * previous std::vector append + front-erase decoder is measured alongside
+ * for comparison.
+ *
+ * Usage: bench-frame-decoder [megabytes]
+ */
+
+#include "networking/InboundBuffer.h"
+#include "types/VarInt.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace mccpp;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// C04PacketPlayerPosition: 4 doubles + bool = 33 bytes payload
+std::vector<uint8_t> buildStream(size_t targetBytes, bool mixed) {
+    std::vector<uint8_t> stream;
+    stream.reserve(targetBytes + 4096);
+    size_t n = 0;
+    while (stream.size() < targetBytes) {
+        std::vector<uint8_t> body;
+        if (mixed && n % 16 == 15) {
+            writeVarInt(body, 0x17);                     // plugin message
+            body.resize(body.size() + 1500, 0x5A);
+        } else if (mixed && n % 4 == 3) {
+            writeVarInt(body, 0x01);                     // chat
+            writeString(body, std::string(60, 'x'));
+        } else {
+            writeVarInt(body, 0x04);                     // player position
+            body.resize(body.size() + 33, 0x3F);
+        }
+        writeVarInt(stream, static_cast<int32_t>(body.size()));
+        stream.insert(stream.end(), body.begin(), body.end());
+        ++n;
+    }
+    return stream;
+}
+
+// The decoder Connection::readLoop used before: append, parse, erase front.
+size_t decodeLegacy(const std::vector<uint8_t>& stream, size_t chunk, uint64_t& checksum) {
+    std::vector<uint8_t> buffer;
+    size_t packets = 0;
+    for (size_t pos = 0; pos < stream.size(); pos += chunk) {
+        size_t len = std::min(chunk, stream.size() - pos);
+        buffer.insert(buffer.end(), stream.data() + pos, stream.data() + pos + len);
+        while (!buffer.empty()) {
+            int32_t length = 0;
+            int offset = 0;
+            bool complete = false;
+            for (size_t i = 0; i < buffer.size() && i < 5; ++i) {
+                length |= static_cast<int32_t>(buffer[i] & 0x7F) << (7 * i);
+                ++offset;
+                if ((buffer[i] & 0x80) == 0) { complete = true; break; }
+            }
+            if (!complete) break;
+            size_t total = static_cast<size_t>(offset) + static_cast<size_t>(length);
+            if (buffer.size() < total) break;
+            checksum += buffer[static_cast<size_t>(offset)];
+            ++packets;
+            buffer.erase(buffer.begin(), buffer.begin() + static_cast<long>(total));
+        }
+    }
+    return packets;
+}
+
+size_t decodeInbound(const std::vector<uint8_t>& stream, size_t chunk, uint64_t& checksum) {
+    InboundBuffer buffer;
+    size_t packets = 0;
+    FrameView frame;
+    for (size_t pos = 0; pos < stream.size(); pos += chunk) {
+        size_t len = std::min(chunk, stream.size() - pos);
+        buffer.append(stream.data() + pos, len);   // stands in for recv()
+        while (buffer.nextFrame(frame) == FrameStatus::Complete) {
+            checksum += frame.data[0];
+            ++packets;
+        }
+        buffer.compactIfDrained();
+    }
+    return packets;
+}
+
+template <typename Fn>
+void run(const char* name, const std::vector<uint8_t>& stream, size_t chunk, Fn fn) {
+    uint64_t checksum = 0;
+    auto start = Clock::now();
+    size_t packets = fn(stream, chunk, checksum);
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    std::printf("  %-8s chunk=%6zu  %9.1f MB/s  %8.2f Mpkt/s  (%zu packets, checksum %llu)\n",
+                name, chunk, stream.size() / secs / 1e6, packets / secs / 1e6, packets,
+                static_cast<unsigned long long>(checksum));
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 64;
+    size_t bytes = megabytes * 1024 * 1024;
+
+    for (bool mixed : {false, true}) {
+        auto stream = buildStream(bytes, mixed);
+        std::printf("%s stream, %zu MiB\n", mixed ? "Mixed" : "Movement-only", megabytes);
+        for (size_t chunk : {size_t(1460), size_t(8192), size_t(65536)}) {
+            run("ring", stream, chunk, decodeInbound);
+            run("legacy", stream, chunk, decodeLegacy);
+        }
+    }
+    return 0;
+}
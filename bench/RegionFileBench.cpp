@@ -0,0 +1,472 @@
+/**
+ * RegionFileBench.cpp — Region file save/load throughput, sync vs. io_uring.
+ *
+ * Saves N chunks (default 10,000; 1024 per r.X.0.mca) into a scratch
+ * directory, rewrites them all, then loads them back, once per RegionIoMode.
+ * Payloads are generated terrain chunks (BenchTerrain.h) serialized the way
+ * AnvilChunkLoader stores them ({Level: ...}); 256 distinct chunks are reused
+ * across the coordinates. Every load is compared with what was saved.
+ *
+ * Phases (each through RegionFile::writeChunks / readChunks, one region at
+ * a time):
+ *   - save new:    empty directory, files grow as chunks are appended;
+ *   - rewrite:     same chunks again into the existing files; nothing is
+ *                  synced in between, so the old copies stay allocated;
+ *   - load cold:   after flush(sync) and POSIX_FADV_DONTNEED on each file;
+ *   - load warm:   page cache hot;
+ *   - load xT:     T threads reading interleaved chunks of the same regions.
+ *
+ * Compression dominates the save and load CPU time, so a "zlib only" row
+ * shows the deflate/inflate cost of the same payloads on their own.
+ *
+ * Fragmentation: the chunks are then saved CHURN_PASSES more times with
+ * 0-9 sectors of incompressible padding each (a stand-in for chunks that
+ * gain and lose entities and tile entities), written and synced in batches
+ * of CHURN_BATCH as AnvilChunkLoader does with ChunkSyncPolicy::PerRegion,
+ * and the files are measured
+ * after the churn, after RegionFile::compact() and after compactFile().
+ * An allocator run replays 200,000 chunk resizes on one region through the
+ * former first-fit vector<bool> scan and through SectorBitmap best fit.
+ *
+ * Before timing anything, a region with a crafted header (slots without
+ * sectors, zero and oversized chunk lengths) must load as empty in both
+ * modes; the run stops otherwise.
+ *
+ * Usage: bench-region-io [dir] [chunks] [threads]   (default ./region-bench 10000 4)
+ */
+
+#include "BenchTerrain.h"
+#include "world/IoUring.h"
+#include "world/SectorBitmap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+
+using namespace mccpp;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+namespace fs = std::filesystem;
+
+constexpr int UNIQUE_CHUNKS = 256;
+constexpr int CHUNKS_PER_REGION = 1024;
+constexpr size_t CHURN_BATCH = 32;      // AnvilChunkLoader::MAX_BATCH
+constexpr int CHURN_PASSES = 3;
+
+struct Setup {
+    fs::path dir;
+    int chunks;
+    int threads;
+    std::vector<std::vector<uint8_t>> payloads;
+    uint64_t payloadBytes = 0;   // over all N chunks
+};
+
+const std::vector<uint8_t>& payloadFor(const Setup& setup, int chunk) {
+    return setup.payloads[static_cast<size_t>(chunk % UNIQUE_CHUNKS)];
+}
+
+int regionCount(const Setup& setup) {
+    return (setup.chunks + CHUNKS_PER_REGION - 1) / CHUNKS_PER_REGION;
+}
+
+fs::path regionPath(const Setup& setup, int region) {
+    return setup.dir / ("r." + std::to_string(region) + ".0.mca");
+}
+
+// Chunks of `region` as local coordinates (chunk index = region * 1024 + x + z * 32)
+std::vector<std::pair<int, int>> regionCoords(const Setup& setup, int region, int stride = 1,
+                                              int first = 0) {
+    std::vector<std::pair<int, int>> coords;
+    int end = std::min(setup.chunks - region * CHUNKS_PER_REGION, CHUNKS_PER_REGION);
+    for (int i = first; i < end; i += stride) coords.emplace_back(i % 32, i / 32);
+    return coords;
+}
+
+std::vector<std::unique_ptr<RegionFile>> openRegions(const Setup& setup, RegionIoMode mode) {
+    std::vector<std::unique_ptr<RegionFile>> regions;
+    for (int r = 0; r < regionCount(setup); ++r) {
+        regions.push_back(std::make_unique<RegionFile>(regionPath(setup, r).string(), mode));
+    }
+    return regions;
+}
+
+bool save(const Setup& setup, RegionIoMode mode) {
+    auto regions = openRegions(setup, mode);
+    for (int r = 0; r < regionCount(setup); ++r) {
+        std::vector<RegionFile::ChunkWrite> writes;
+        for (auto [x, z] : regionCoords(setup, r)) {
+            writes.push_back({x, z, &payloadFor(setup, r * CHUNKS_PER_REGION + x + z * 32)});
+        }
+        if (regions[static_cast<size_t>(r)]->writeChunks(writes) != writes.size()) return false;
+    }
+    return true;   // headers are written as the regions close
+}
+
+bool load(const Setup& setup, std::vector<std::unique_ptr<RegionFile>>& regions, int stride,
+          int first) {
+    for (int r = 0; r < regionCount(setup); ++r) {
+        auto coords = regionCoords(setup, r, stride, first);
+        auto results = regions[static_cast<size_t>(r)]->readChunks(coords);
+        for (size_t i = 0; i < coords.size(); ++i) {
+            auto [x, z] = coords[i];
+            if (!results[i] || *results[i] != payloadFor(setup, r * CHUNKS_PER_REGION + x + z * 32)) {
+                std::printf("region %d chunk %d,%d did not load back\n", r, x, z);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void dropPageCache(const Setup& setup) {
+    for (int r = 0; r < regionCount(setup); ++r) {
+        int fd = ::open(regionPath(setup, r).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        ::fdatasync(fd);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+}
+
+uint64_t directoryBytes(const Setup& setup) {
+    uint64_t bytes = 0;
+    for (int r = 0; r < regionCount(setup); ++r) bytes += fs::file_size(regionPath(setup, r));
+    return bytes;
+}
+
+void row(const char* label, const Setup& setup, double seconds) {
+    std::printf("  %-12s %8.1f ms  %8.0f chunks/s  %7.1f MiB/s (NBT)\n", label, seconds * 1e3,
+                setup.chunks / seconds, setup.payloadBytes / seconds / (1024.0 * 1024.0));
+}
+
+template <typename F>
+double timed(F&& fn) {
+    auto start = Clock::now();
+    if (!fn()) std::exit(1);
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void run(const Setup& setup, RegionIoMode mode) {
+    fs::remove_all(setup.dir);
+    fs::create_directories(setup.dir);
+
+    // Report the mode the files really run in (IoUring falls back to Sync)
+    bool uring = mode == RegionIoMode::IoUring && IoUring::forThisThread();
+    std::printf("%s:\n", uring ? "io_uring" : "pread/pwrite");
+
+    row("save new", setup, timed([&] { return save(setup, mode); }));
+    uint64_t grownBytes = directoryBytes(setup);
+    row("rewrite", setup, timed([&] { return save(setup, mode); }));
+    uint64_t rewrittenBytes = directoryBytes(setup);
+
+    auto regions = openRegions(setup, mode);
+    for (auto& region : regions) region->flush(true);
+    dropPageCache(setup);
+    row("load cold", setup, timed([&] { return load(setup, regions, 1, 0); }));
+    row("load warm", setup, timed([&] { return load(setup, regions, 1, 0); }));
+
+    char label[32];
+    std::snprintf(label, sizeof(label), "load x%d", setup.threads);
+    row(label, setup, timed([&] {
+        std::vector<std::thread> workers;
+        std::vector<char> ok(static_cast<size_t>(setup.threads), 0);
+        for (int t = 0; t < setup.threads; ++t) {
+            workers.emplace_back([&, t] {
+                ok[static_cast<size_t>(t)] = load(setup, regions, setup.threads, t);
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        return std::find(ok.begin(), ok.end(), 0) == ok.end();
+    }));
+
+    std::printf("  files: %.1f MiB after save, %.1f MiB after rewrite\n",
+                grownBytes / (1024.0 * 1024.0), rewrittenBytes / (1024.0 * 1024.0));
+}
+
+// Chunk `chunk` as saved by churn pass `pass`: its payload plus 0-9 sectors of random bytes
+std::vector<uint8_t> churnPayload(const Setup& setup, int chunk, int pass) {
+    std::mt19937 rng(static_cast<uint32_t>(chunk * 31 + pass));
+    std::vector<uint8_t> payload = payloadFor(setup, chunk);
+    size_t padding = rng() % 10 * RegionFile::SECTOR_BYTES;
+    for (size_t i = 0; i < padding; ++i) payload.push_back(static_cast<uint8_t>(rng()));
+    return payload;
+}
+
+bool churnSave(const Setup& setup, int pass) {
+    auto regions = openRegions(setup, RegionIoMode::Sync);
+    for (int r = 0; r < regionCount(setup); ++r) {
+        std::vector<std::vector<uint8_t>> payloads;
+        std::vector<RegionFile::ChunkWrite> writes;
+        auto coords = regionCoords(setup, r);
+        payloads.reserve(coords.size());
+        for (auto [x, z] : coords) {
+            payloads.push_back(churnPayload(setup, r * CHUNKS_PER_REGION + x + z * 32, pass));
+            writes.push_back({x, z, &payloads.back()});
+        }
+        RegionFile& region = *regions[static_cast<size_t>(r)];
+        for (size_t begin = 0; begin < writes.size(); begin += CHURN_BATCH) {
+            std::vector<RegionFile::ChunkWrite> batch(
+                writes.begin() + static_cast<std::ptrdiff_t>(begin),
+                writes.begin() + static_cast<std::ptrdiff_t>(std::min(begin + CHURN_BATCH, writes.size())));
+            if (region.writeChunks(batch) != batch.size() || !region.flush(true)) return false;
+        }
+    }
+    return true;
+}
+
+// Timed load of every chunk, checked afterwards against the last churn pass
+void churnLoad(const char* label, const Setup& setup) {
+    auto regions = openRegions(setup, RegionIoMode::Sync);
+    std::vector<std::vector<std::optional<std::vector<uint8_t>>>> loaded;
+    double seconds = timed([&] {
+        for (int r = 0; r < regionCount(setup); ++r) {
+            loaded.push_back(regions[static_cast<size_t>(r)]->readChunks(regionCoords(setup, r)));
+        }
+        return true;
+    });
+    for (int r = 0; r < regionCount(setup); ++r) {
+        auto coords = regionCoords(setup, r);
+        for (size_t i = 0; i < coords.size(); ++i) {
+            int chunk = r * CHUNKS_PER_REGION + coords[i].first + coords[i].second * 32;
+            const auto& data = loaded[static_cast<size_t>(r)][i];
+            if (!data || *data != churnPayload(setup, chunk, CHURN_PASSES - 1)) {
+                std::printf("%s: chunk %d did not load back\n", label, chunk);
+                std::exit(1);
+            }
+        }
+    }
+
+    int sectors = 0, free = 0;
+    for (auto& region : regions) {
+        sectors += region->getSectorCount();
+        free += region->getFreeSectorCount();
+    }
+    std::printf("  %-16s %7.1f MiB  %5.1f%% free sectors  load %7.1f ms\n", label,
+                directoryBytes(setup) / (1024.0 * 1024.0), 100.0 * free / sectors, seconds * 1e3);
+}
+
+void fragmentation(const Setup& setup) {
+    fs::remove_all(setup.dir);
+    fs::create_directories(setup.dir);
+    std::printf("fragmentation (%d saves with 0-9 sectors of padding):\n", CHURN_PASSES);
+    for (int pass = 0; pass < CHURN_PASSES; ++pass) {
+        if (!churnSave(setup, pass)) std::exit(1);
+    }
+    churnLoad("after churn", setup);
+
+    int moved = 0;
+    double onlineSeconds = timed([&] {
+        auto regions = openRegions(setup, RegionIoMode::Sync);
+        for (auto& region : regions) moved += region->compact().chunksMoved;
+        return true;
+    });
+    std::printf("  compact():  %d chunks moved in %.1f ms\n", moved, onlineSeconds * 1e3);
+    churnLoad("online compact", setup);
+
+    double offlineSeconds = timed([&] {
+        for (int r = 0; r < regionCount(setup); ++r) {
+            if (!RegionFile::compactFile(regionPath(setup, r).string())) return false;
+        }
+        return true;
+    });
+    std::printf("  compactFile(): %.1f ms\n", offlineSeconds * 1e3);
+    churnLoad("offline compact", setup);
+}
+
+// Header slots a damaged file may hold; each must read as "not saved"
+void malformedHeader(const Setup& setup) {
+    fs::remove_all(setup.dir);
+    fs::create_directories(setup.dir);
+    fs::path path = regionPath(setup, 0);
+
+    constexpr int SECTOR = RegionFile::SECTOR_BYTES;
+    std::vector<uint8_t> file(static_cast<size_t>(SECTOR) * 4, 0);
+    auto put32 = [&](size_t at, uint32_t v) {
+        for (int b = 0; b < 4; ++b) file[at + b] = static_cast<uint8_t>(v >> (24 - 8 * b));
+    };
+    put32(0 * 4, 2u << 8);            // 0,0: sector 2, no sectors
+    put32(1 * 4, 2u << 8 | 1);        // 1,0: chunk length 0
+    put32(2 * 4, 3u << 8 | 1);        // 2,0: chunk length past its sector
+    put32(3 * 4, 9u << 8 | 1);        // 3,0: beyond the end of the file
+    put32(static_cast<size_t>(SECTOR) * 3, 0x7FFFFFFF);
+    file[static_cast<size_t>(SECTOR) * 3 + 4] = 2;
+    std::FILE* out = std::fopen(path.string().c_str(), "wb");
+    if (!out || std::fwrite(file.data(), 1, file.size(), out) != file.size()) std::exit(1);
+    std::fclose(out);
+
+    const std::vector<std::pair<int, int>> coords = {{0, 0}, {1, 0}, {2, 0}, {3, 0}};
+    for (RegionIoMode mode : {RegionIoMode::Sync, RegionIoMode::IoUring}) {
+        RegionFile region(path.string(), mode);
+        auto batch = region.readChunks(coords);
+        for (size_t i = 0; i < coords.size(); ++i) {
+            auto [x, z] = coords[i];
+            if (region.readChunkData(x, z) || batch[i] || (i == 0 && region.isChunkSaved(x, z))) {
+                std::printf("malformed header: slot %d,%d did not read as empty\n", x, z);
+                std::exit(1);
+            }
+        }
+    }
+    std::printf("malformed header: all slots read as empty\n");
+}
+
+// 200,000 resizes of random chunks (1-10 sectors) in one region
+void allocatorChurn() {
+    constexpr int OPS = 200000;
+    constexpr int HEADER = RegionFile::HEADER_SECTORS;
+
+    struct Result { double ns; int sectors; int free; };
+    auto replay = [](auto&& allocate, auto&& release, auto&& size, auto&& freeCount, auto&& onWrite) {
+        std::mt19937 rng(20140623);
+        std::vector<std::pair<int, int>> runs(1024, {0, 0});
+        auto start = Clock::now();
+        for (int op = 0; op < OPS; ++op) {
+            auto& run = runs[rng() % 1024];
+            int count = 1 + static_cast<int>(rng() % 10);
+            int to = allocate(run.first, run.second, count);
+            if (run.second != 0 && to != run.first) release(run.first, run.second);
+            run = {to, count};
+            onWrite();
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / OPS;
+        return Result{ns, size(), freeCount()};
+    };
+
+    // RegionFile before: free the old run, reuse it if the size matches, else
+    // first fit over a vector<bool>, else append sectors one at a time
+    std::vector<bool> sectorFree(HEADER, false);
+    Result firstFit = replay(
+        [&](int oldStart, int oldCount, int count) {
+            for (int i = 0; i < oldCount; ++i) sectorFree[static_cast<size_t>(oldStart + i)] = true;
+            if (oldCount == count) {
+                for (int i = 0; i < count; ++i) sectorFree[static_cast<size_t>(oldStart + i)] = false;
+                return oldStart;
+            }
+            int runStart = -1, runLength = 0;
+            for (int i = HEADER; i < static_cast<int>(sectorFree.size()); ++i) {
+                if (!sectorFree[static_cast<size_t>(i)]) { runLength = 0; continue; }
+                if (runLength++ == 0) runStart = i;
+                if (runLength == count) {
+                    for (int s = 0; s < count; ++s) sectorFree[static_cast<size_t>(runStart + s)] = false;
+                    return runStart;
+                }
+            }
+            int end = static_cast<int>(sectorFree.size());
+            for (int i = 0; i < count; ++i) sectorFree.push_back(false);
+            return end;
+        },
+        [&](int, int) {},
+        [&] { return static_cast<int>(sectorFree.size()); },
+        [&] { return static_cast<int>(std::count(sectorFree.begin(), sectorFree.end(), true)); },
+        [] {});
+
+    // RegionFile now: copy-on-write, best fit, old runs freed with the next
+    // header write (every HEADER_FLUSH_UPDATES writes), free tail cut off
+    SectorBitmap bitmap;
+    bitmap.resize(HEADER);
+    std::vector<std::pair<int, int>> pending;
+    int writes = 0;
+    Result bestFit = replay(
+        [&](int, int, int count) {
+            int start = bitmap.findBestFit(count);
+            if (start < 0) {
+                start = bitmap.size() - bitmap.trailingFree();
+                bitmap.resize(start + count);
+            }
+            bitmap.markUsed(start, count);
+            return start;
+        },
+        [&](int start, int count) { pending.emplace_back(start, count); },
+        [&] { return bitmap.size(); },
+        [&] { return bitmap.freeCount(); },
+        [&] {
+            if (++writes % RegionFile::HEADER_FLUSH_UPDATES != 0) return;
+            for (auto [start, count] : pending) bitmap.markFree(start, count);
+            pending.clear();
+            bitmap.resize(std::max(bitmap.usedEnd(), HEADER));
+        });
+
+    std::printf("allocator (%d resizes, 1-10 sectors, 1024 chunks):\n", OPS);
+    std::printf("  first fit    %7.1f ns/op  %6d sectors  %5d free\n", firstFit.ns, firstFit.sectors,
+                firstFit.free);
+    std::printf("  bitmap best  %7.1f ns/op  %6d sectors  %5d free\n", bestFit.ns, bestFit.sectors,
+                bestFit.free);
+}
+
+// Deflate + inflate of the same payloads, without any file I/O
+void zlibOnly(const Setup& setup) {
+    std::vector<std::vector<uint8_t>> compressed(UNIQUE_CHUNKS);
+    double deflateSeconds = timed([&] {
+        for (int i = 0; i < setup.chunks; ++i) {
+            const auto& payload = payloadFor(setup, i);
+            auto& out = compressed[static_cast<size_t>(i % UNIQUE_CHUNKS)];
+            out.resize(compressBound(static_cast<uLong>(payload.size())));
+            uLongf length = static_cast<uLongf>(out.size());
+            if (compress2(out.data(), &length, payload.data(), static_cast<uLong>(payload.size()),
+                          Z_DEFAULT_COMPRESSION) != Z_OK) return false;
+            out.resize(length);
+        }
+        return true;
+    });
+    std::vector<uint8_t> inflated;
+    double inflateSeconds = timed([&] {
+        for (int i = 0; i < setup.chunks; ++i) {
+            const auto& payload = payloadFor(setup, i);
+            const auto& in = compressed[static_cast<size_t>(i % UNIQUE_CHUNKS)];
+            inflated.resize(payload.size());
+            uLongf length = static_cast<uLongf>(inflated.size());
+            if (uncompress(inflated.data(), &length, in.data(), static_cast<uLong>(in.size())) != Z_OK) {
+                return false;
+            }
+        }
+        return true;
+    });
+    std::printf("zlib only:\n");
+    row("deflate", setup, deflateSeconds);
+    row("inflate", setup, inflateSeconds);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Block::registerBlocks();
+
+    Setup setup;
+    setup.dir = argc > 1 ? fs::path(argv[1]) : fs::path("region-bench");
+    setup.chunks = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10000;
+    setup.threads = argc > 3 ? std::max(1, std::atoi(argv[3])) : 4;
+
+    std::mt19937 rng(20140623);
+    NoiseGeneratorSimplex height(rng), detail(rng);
+    NoiseGeneratorImproved caves(rng);
+    for (int i = 0; i < UNIQUE_CHUNKS; ++i) {
+        auto chunk = bench::terrainChunk(i % 16, i / 16, height, detail, caves, rng);
+        nbt::NBTTagCompound root;
+        root.setTag("Level", chunk->writeToNBT()->copy());
+        setup.payloads.push_back(nbt::serializeNBT(root));
+    }
+    for (int i = 0; i < setup.chunks; ++i) setup.payloadBytes += payloadFor(setup, i).size();
+
+    std::printf("%d chunks in %d regions, %.1f KiB NBT per chunk, %s\n", setup.chunks,
+                regionCount(setup), setup.payloadBytes / 1024.0 / setup.chunks,
+                setup.dir.string().c_str());
+    malformedHeader(setup);
+    zlibOnly(setup);
+    run(setup, RegionIoMode::Sync);
+    run(setup, RegionIoMode::IoUring);
+    fragmentation(setup);
+    allocatorChurn();
+    fs::remove_all(setup.dir);
+    return 0;
+}
@@ -9,6 +9,9 @@
  * The registry is populated once at startup via Block::registerBlocks().
  * After that, it is read-only and thread-safe without locks.
  *
+ * Each Block also stores its own ID, and the properties hot loops need are
+ * copied into flat ID-indexed tables (BlockProperties).
+ *
  * JNI readiness: flat property layout, int IDs for fast array lookup.
  */
 #pragma once
@@ -58,6 +61,38 @@ enum class Material : uint8_t {
     Carpet,
 };
 
+/**
+ * CollisionClass — how a block takes part in entity collision.
+ * Java reference: Block.getCollisionBoundingBoxFromPool() (null, the unit cube
+ * or the block's own bounds)
+ */
+enum class CollisionClass : uint8_t {
+    None,     // no collision box (air, fluids, plants, circuits, portal...)
+    Cube,     // the full unit cube
+    Shaped,   // the block's own bounds; ask the Block
+};
+
+/**
+ * BlockProperties — flat, ID-indexed block property tables.
+ *
+ * One array per property, filled from the registered blocks at the end of
+ * Block::registerBlocks(); IDs without a block read as air. Section ref
+ * counts, lighting, fluid and collision loops index these by block ID instead
+ * of dereferencing a Block* per block. Read-only after registration.
+ */
+struct BlockProperties {
+    static constexpr int32_t ID_COUNT = 4096;   // 12-bit block IDs
+
+    static inline uint8_t        lightOpacity[ID_COUNT] = {};   // 0-255
+    static inline uint8_t        lightValue[ID_COUNT] = {};     // emission, 0-15
+    static inline Material       material[ID_COUNT] = {};
+    static inline bool           ticksRandomly[ID_COUNT] = {};
+    static inline bool           normalCube[ID_COUNT] = {};
+    static inline CollisionClass collision[ID_COUNT] = {};
+
+    static bool isAir(int32_t id) { return material[id] == Material::Air; }
+};
+
 /**
  * Block — base block type with vanilla 1.7.10 properties.
  *
@@ -85,11 +120,12 @@ public:
     }
 
     /**
-     * Get numeric ID from block pointer.
-     * Java reference: Block.getIdFromBlock(Block)
+     * Get numeric ID from block pointer; -1 for null or an unregistered block.
+     * Java reference: Block.getIdFromBlock(Block) — a registry map lookup in
+     * Java; here the ID stored in the block at registration.
      */
-    static int32_t getIdFromBlock(Block* block) {
-        return blockRegistry.getIDForObject(block);
+    static int32_t getIdFromBlock(const Block* block) {
+        return block ? block->id_ : -1;
     }
 
     /**
@@ -116,6 +152,7 @@ public:
 
     // ─── Property getters ───────────────────────────────────────────────
 
+    int32_t getId() const { return id_; }
     Material getMaterial() const { return material_; }
     float getHardness() const { return hardness_; }
     float getResistance() const { return resistance_; }
@@ -138,6 +175,15 @@ public:
     double getMaxY() const { return maxY_; }
     double getMaxZ() const { return maxZ_; }
 
+    /**
+     * Java reference: Block.isNormalCube() — opaque material, rendered as a
+     * full opaque cube. (Java also excludes power sources, which are not
+     * modelled here.)
+     */
+    bool isNormalCube() const;
+
+    CollisionClass getCollisionClass() const;
+
     /**
      * Explosion resistance.
      * Java reference: Block.getExplosionResistance() — resistance / 5.0f
@@ -148,6 +194,10 @@ public:
     void setBlockBounds(float x1, float y1, float z1, float x2, float y2, float z2);
 
 protected:
+    // Copy the registered blocks' properties into BlockProperties.
+    static void fillPropertyTables();
+
+    int32_t  id_ = -1;   // set by registerBlocks()
     Material material_;
 
     // Properties — exact Java field names and defaults
@@ -8,12 +8,14 @@
  *   - net.minecraft.command.CommandHandler
  *   - net.minecraft.command.server.CommandStop
  *   - net.minecraft.command.server.CommandSay
+ *   - net.minecraft.command.server.CommandSaveAll
  *   - net.minecraft.command.CommandHelp
  *   - net.minecraft.command.CommandGameMode
  *   - net.minecraft.command.CommandTime
  *   - net.minecraft.command.CommandGive
  *   - net.minecraft.command.CommandTeleport
  *   - net.minecraft.command.CommandGameRule
+ *   - net.minecraft.command.CommandDebug (analog for /netstats)
  *
  * Thread safety:
  *   - CommandHandler is accessed from multiple threads (console + network).
@@ -157,6 +159,19 @@ public:
     void processCommand(ICommandSender& sender, const std::vector<std::string>& args) override;
 };
 
+// /save-all — Saves all worlds and waits until the chunks are on disk
+// Java: net.minecraft.command.server.CommandSaveAll (always "flush")
+class CommandSaveAll : public ICommand {
+public:
+    // `saveAll` runs on the caller's thread and returns false on a write error
+    explicit CommandSaveAll(std::function<bool()> saveAll) : saveAll_(std::move(saveAll)) {}
+    std::string getCommandName() const override { return "save-all"; }
+    std::string getCommandUsage() const override { return "commands.save.usage"; }
+    void processCommand(ICommandSender& sender, const std::vector<std::string>& args) override;
+private:
+    std::function<bool()> saveAll_;
+};
+
 // /say <message> — Broadcasts a message
 // Java: net.minecraft.command.server.CommandSay
 class CommandSay : public ICommand {
@@ -283,4 +298,13 @@ public:
     }
 };
 
+// /netstats [reset|dump [file]|top <n>] — Per-packet traffic and handler time
+// Java analog: net.minecraft.command.CommandDebug (profiler results file)
+class CommandNetStats : public ICommand {
+public:
+    std::string getCommandName() const override { return "netstats"; }
+    std::string getCommandUsage() const override { return "/netstats [reset|dump [file]|top <n>]"; }
+    void processCommand(ICommandSender& sender, const std::vector<std::string>& args) override;
+};
+
 } // namespace mccpp
@@ -163,6 +163,13 @@ public:
         isAirBorne = true;
     }
 
+    /**
+     * Take the next entity ID for something that is not (yet) an Entity
+     * object, such as a connected player. Thread-safe.
+     * Java: Entity.nextEntityID++
+     */
+    static int allocateEntityId() { return nextEntityID_.fetch_add(1, std::memory_order_relaxed); }
+
 private:
     int entityId_;
 
@@ -20,15 +20,30 @@
  *   XPOrb:         range=160, interval=20
  *   EnderCrystal:  range=256, interval=MAX
  *
+ * Movement is sent as in Java's EntityTrackerEntry: positions in 32nds of a
+ * block and angles in 256ths of a turn, as relative moves while the change
+ * stays under 4 blocks, with a full teleport beyond that and at least every
+ * 400 updates. Each entity's packets are encoded once per tick and appended
+ * to every watcher's buffer in an EntityUpdateBatch, so a player receives all
+ * of the tick's entity movement as one outbound buffer.
+ *
+ * Not driven by the tick loop yet: the server neither spawns entities nor
+ * shows players to each other, so only bench-entity-movement runs it.
+ *
  * Thread safety: Mutex-protected for add/remove/update.
  * Use shared_mutex for read-heavy operations (sending to trackers).
  */
 #pragma once
 
+#include "networking/PacketBuffer.h"
+#include "networking/PacketBuilder.h"
+
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <unordered_map>
@@ -136,12 +151,20 @@ struct TrackedEntityInfo {
 
 class EntityTrackerEntry {
 public:
+    // Java: sendLocationToAllClients — relative moves carry a Byte per axis
+    // (under 4 blocks); a teleport is forced after this many updates
+    static constexpr int32_t MAX_RELATIVE_MOVE = 128;
+    static constexpr int32_t FORCED_TELEPORT_TICKS = 400;
+
     TrackedEntityInfo entity;
     TrackingParams params;
 
-    // Last sent position/rotation (for delta computation)
-    double lastPosX = 0.0, lastPosY = 0.0, lastPosZ = 0.0;
-    float lastYaw = 0.0f, lastPitch = 0.0f, lastHeadYaw = 0.0f;
+    // Last sent position (32nds of a block) and angles (256ths of a turn).
+    // Java: lastScaledXPosition.. lastYaw, lastPitch, lastHeadMotion
+    int32_t lastScaledX = 0, lastScaledY = 0, lastScaledZ = 0;
+    int32_t lastScaledYaw = 0, lastScaledPitch = 0, lastScaledHeadYaw = 0;
+    double lastMotionX = 0.0, lastMotionY = 0.0, lastMotionZ = 0.0;
+    int32_t ticksSinceLastForcedTeleport = 0;
 
     int32_t updateCounter = 0;
     bool playerEntitiesUpdated = false;
@@ -158,12 +181,25 @@ public:
         if (params.trackingRange > maxRange) {
             params.trackingRange = maxRange;
         }
-        lastPosX = info.posX;
-        lastPosY = info.posY;
-        lastPosZ = info.posZ;
-        lastYaw = info.yaw;
-        lastPitch = info.pitch;
-        lastHeadYaw = info.headYaw;
+        lastScaledX = scalePosition(info.posX);
+        lastScaledY = scalePosition(info.posY);
+        lastScaledZ = scalePosition(info.posZ);
+        lastScaledYaw = scaleAngle(info.yaw);
+        lastScaledPitch = scaleAngle(info.pitch);
+        lastScaledHeadYaw = scaleAngle(info.headYaw);
+        lastMotionX = info.motionX;
+        lastMotionY = info.motionY;
+        lastMotionZ = info.motionZ;
+    }
+
+    // Java: MathHelper.floor_double(pos * 32.0D)
+    static int32_t scalePosition(double pos) {
+        return static_cast<int32_t>(std::floor(pos * 32.0));
+    }
+
+    // Java: MathHelper.floor_float(angle * 256.0F / 360.0F)
+    static int32_t scaleAngle(float degrees) {
+        return static_cast<int32_t>(std::floor(degrees * 256.0f / 360.0f));
     }
 
     // Check if a player is within tracking range
@@ -174,24 +210,130 @@ public:
         return dx >= -range && dx <= range && dz >= -range && dz <= range;
     }
 
-    // Compute position deltas (fixed-point * 32)
-    bool hasPositionChanged() const {
-        return entity.posX != lastPosX || entity.posY != lastPosY || entity.posZ != lastPosZ;
+    /**
+     * Append this tick's movement packets (complete frames) to `frames` and
+     * remember what was sent. `counter` is the update count before this tick.
+     * Java: sendLocationToAllClients — the movement part, plus the head look
+     */
+    void encodeLocationUpdate(int32_t counter, std::vector<uint8_t>& frames) {
+        if (counter % params.updateInterval == 0) {
+            ++ticksSinceLastForcedTeleport;
+            int32_t x = scalePosition(entity.posX);
+            int32_t y = scalePosition(entity.posY);
+            int32_t z = scalePosition(entity.posZ);
+            int32_t yaw = scaleAngle(entity.yaw);
+            int32_t pitch = scaleAngle(entity.pitch);
+            int32_t dx = x - lastScaledX, dy = y - lastScaledY, dz = z - lastScaledZ;
+
+            // Under 4/32 of a block or 4/256 of a turn is not worth a packet;
+            // every 60 updates the position goes out regardless
+            bool moved = std::abs(dx) >= 4 || std::abs(dy) >= 4 || std::abs(dz) >= 4 ||
+                         counter % 60 == 0;
+            bool turned = std::abs(yaw - lastScaledYaw) >= 4 || std::abs(pitch - lastScaledPitch) >= 4;
+            bool teleported = false;
+
+            if (counter > 0) {
+                bool relative = dx >= -MAX_RELATIVE_MOVE && dx < MAX_RELATIVE_MOVE &&
+                                dy >= -MAX_RELATIVE_MOVE && dy < MAX_RELATIVE_MOVE &&
+                                dz >= -MAX_RELATIVE_MOVE && dz < MAX_RELATIVE_MOVE &&
+                                ticksSinceLastForcedTeleport <= FORCED_TELEPORT_TICKS;
+                if (!relative) {
+                    ticksSinceLastForcedTeleport = 0;
+                    teleported = true;
+                    appendFrame(frames, PacketBuilder::entityTeleportScaled(entity.entityId, x, y, z,
+                        static_cast<int8_t>(yaw), static_cast<int8_t>(pitch)));
+                } else if (moved && turned) {
+                    appendFrame(frames, PacketBuilder::entityLookRelMove(entity.entityId,
+                        static_cast<int8_t>(dx), static_cast<int8_t>(dy), static_cast<int8_t>(dz),
+                        static_cast<int8_t>(yaw), static_cast<int8_t>(pitch)));
+                } else if (moved) {
+                    appendFrame(frames, PacketBuilder::entityRelMove(entity.entityId,
+                        static_cast<int8_t>(dx), static_cast<int8_t>(dy), static_cast<int8_t>(dz)));
+                } else if (turned) {
+                    appendFrame(frames, PacketBuilder::entityLook(entity.entityId,
+                        static_cast<int8_t>(yaw), static_cast<int8_t>(pitch)));
+                }
+            }
+
+            if (params.sendVelocityUpdates) {
+                double mx = entity.motionX - lastMotionX;
+                double my = entity.motionY - lastMotionY;
+                double mz = entity.motionZ - lastMotionZ;
+                double change = mx * mx + my * my + mz * mz;
+                bool stopped = entity.motionX == 0.0 && entity.motionY == 0.0 && entity.motionZ == 0.0;
+                if (change > 0.0004 || (change > 0.0 && stopped)) {
+                    lastMotionX = entity.motionX;
+                    lastMotionY = entity.motionY;
+                    lastMotionZ = entity.motionZ;
+                    appendFrame(frames, PacketBuilder::entityVelocity(entity.entityId,
+                        entity.motionX, entity.motionY, entity.motionZ));
+                }
+            }
+
+            if (moved || teleported) {
+                lastScaledX = x;
+                lastScaledY = y;
+                lastScaledZ = z;
+            }
+            if (turned || teleported) {
+                lastScaledYaw = yaw;
+                lastScaledPitch = pitch;
+            }
+
+            int32_t headYaw = scaleAngle(entity.headYaw);
+            if (std::abs(headYaw - lastScaledHeadYaw) >= 4) {
+                appendFrame(frames, PacketBuilder::entityHeadLook(entity.entityId, entity.headYaw));
+                lastScaledHeadYaw = headYaw;
+            }
+        }
+    }
+
+private:
+    static void appendFrame(std::vector<uint8_t>& frames, PacketBuffer packet) {
+        packet.finishFrame();
+        frames.insert(frames.end(), packet.data(), packet.data() + packet.size());
     }
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+// EntityUpdateBatch — One tick's entity packets, grouped per recipient.
+// Not in Java (sendToAllTrackingEntity queues every packet per player).
+// ═══════════════════════════════════════════════════════════════════════════
 
-    bool hasRotationChanged() const {
-        return entity.yaw != lastYaw || entity.pitch != lastPitch;
+class EntityUpdateBatch {
+public:
+    /**
+     * Append complete frames to `playerId`'s buffer.
+     */
+    void append(int32_t playerId, const uint8_t* frames, size_t length) {
+        auto [slot, added] = slots_.try_emplace(playerId, buffers_.size());
+        if (added) buffers_.emplace_back(playerId, PacketBuffer::acquire(length * 8));
+        buffers_[slot->second].second.append(frames, length);
+        bytes_ += length;
     }
 
-    // Update last-sent values
-    void snapshotPosition() {
-        lastPosX = entity.posX;
-        lastPosY = entity.posY;
-        lastPosZ = entity.posZ;
-        lastYaw = entity.yaw;
-        lastPitch = entity.pitch;
-        lastHeadYaw = entity.headYaw;
+    size_t recipientCount() const { return buffers_.size(); }
+    size_t byteCount() const { return bytes_; }
+
+    /**
+     * Hand each recipient's buffer to `send(playerId, PacketBuffer&&)`, ready
+     * to queue on its connection, and empty the batch.
+     */
+    template <typename Fn>
+    void drain(Fn&& send) {
+        for (auto& [playerId, buffer] : buffers_) {
+            buffer.finishFrames();
+            send(playerId, std::move(buffer));
+        }
+        buffers_.clear();
+        slots_.clear();
+        bytes_ = 0;
     }
+
+private:
+    std::unordered_map<int32_t, size_t> slots_;   // player → index in buffers_
+    std::vector<std::pair<int32_t, PacketBuffer>> buffers_;
+    size_t bytes_ = 0;
 };
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -308,6 +450,16 @@ public:
         }
     }
 
+    // Java: Entity.motionX/Y/Z, read for velocity updates
+    void updateEntityMotion(int32_t entityId, double motionX, double motionY, double motionZ) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = entriesById_.find(entityId);
+        if (it != entriesById_.end()) {
+            auto& e = it->second->entity;
+            e.motionX = motionX; e.motionY = motionY; e.motionZ = motionZ;
+        }
+    }
+
     // Mark entity as dead
     void markDead(int32_t entityId) {
         std::unique_lock<std::shared_mutex> lock(mutex_);
@@ -394,53 +546,20 @@ public:
         return entriesById_.size();
     }
 
-    // Check if entity needs position/rotation update packets
-    struct MovementUpdate {
-        int32_t entityId;
-        double dx, dy, dz;
-        float yaw, pitch, headYaw;
-        bool posChanged;
-        bool rotChanged;
-        bool sendVelocity;
-        double motionX, motionY, motionZ;
-        std::vector<int32_t> watchers;
-    };
-
-    std::vector<MovementUpdate> getMovementUpdates() {
+    // Java: EntityTrackerEntry.sendLocationToAllClients for every entry —
+    // call after updateTrackedEntities. Each entity's packets are encoded
+    // once and appended to the buffer of every player tracking it.
+    void sendLocationUpdates(EntityUpdateBatch& batch) {
         std::unique_lock<std::shared_mutex> lock(mutex_);
-        std::vector<MovementUpdate> updates;
-
         for (auto& [id, entry] : entriesById_) {
-            if (entry->trackingPlayers.empty()) continue;
-            if (entry->updateCounter % entry->params.updateInterval != 0 &&
-                entry->params.updateInterval != INT32_MAX) continue;
-
-            bool posChanged = entry->hasPositionChanged();
-            bool rotChanged = entry->hasRotationChanged();
-
-            if (!posChanged && !rotChanged) continue;
-
-            MovementUpdate upd;
-            upd.entityId = id;
-            upd.dx = entry->entity.posX - entry->lastPosX;
-            upd.dy = entry->entity.posY - entry->lastPosY;
-            upd.dz = entry->entity.posZ - entry->lastPosZ;
-            upd.yaw = entry->entity.yaw;
-            upd.pitch = entry->entity.pitch;
-            upd.headYaw = entry->entity.headYaw;
-            upd.posChanged = posChanged;
-            upd.rotChanged = rotChanged;
-            upd.sendVelocity = entry->params.sendVelocityUpdates;
-            upd.motionX = entry->entity.motionX;
-            upd.motionY = entry->entity.motionY;
-            upd.motionZ = entry->entity.motionZ;
-            upd.watchers.assign(entry->trackingPlayers.begin(),
-                                 entry->trackingPlayers.end());
-
-            entry->snapshotPosition();
-            updates.push_back(std::move(upd));
+            frames_.clear();
+            // updateTrackedEntities already counted this tick
+            entry->encodeLocationUpdate(entry->updateCounter - 1, frames_);
+            if (frames_.empty()) continue;
+            for (int32_t playerId : entry->trackingPlayers) {
+                batch.append(playerId, frames_.data(), frames_.size());
+            }
         }
-        return updates;
     }
 
 private:
@@ -448,6 +567,7 @@ private:
     int32_t maxTrackingDistance_;
     std::unordered_map<int32_t, std::unique_ptr<EntityTrackerEntry>> entriesById_;
     std::vector<int32_t> lastUntracked_;
+    std::vector<uint8_t> frames_;   // scratch for sendLocationUpdates
 };
 
 } // namespace mccpp
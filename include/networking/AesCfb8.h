@@ -0,0 +1,76 @@
+/**
+ * AesCfb8.h — AES-128 in CFB8 mode, the Minecraft protocol stream cipher.
+ *
+ * Java reference: net.minecraft.util.CryptManager.func_151229_a()
+ * ("AES/CFB8/NoPadding", the shared secret used as both key and IV),
+ * applied by NettyEncryptingEncoder / NettyEncryptingDecoder.
+ *
+ * CFB8 runs one AES block encryption per byte:
+ *   O = AES_K(R);  c = p ^ O[0];  R = (R << 8) | c
+ * Encryption is inherently serial. Decryption is not: every shift register
+ * value is made of ciphertext bytes that are already known, so the AES-NI
+ * path decrypts eight bytes at a time with interleaved AES pipelines.
+ *
+ * Backends:
+ *   - AesNi:    x86 AES-NI + SSSE3, picked at runtime when the CPU has it
+ *   - Portable: table-driven C++ (T-tables; not constant-time)
+ *
+ * Thread safety: one instance per direction per connection, single owner.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mccpp {
+
+class AesCfb8 {
+public:
+    static constexpr size_t KEY_SIZE = 16;
+
+    enum class Backend : uint8_t {
+        Portable,
+        AesNi,
+    };
+
+    /**
+     * True if this build has the AES-NI path and the CPU supports it.
+     */
+    static bool aesNiSupported();
+
+    /**
+     * AesNi when supported, otherwise Portable.
+     */
+    static Backend defaultBackend();
+
+    static const char* backendName(Backend backend);
+
+    /**
+     * @param key  16-byte AES key
+     * @param iv   16-byte initial shift register (Minecraft: the key again)
+     * @param backend  Falls back to Portable if AesNi is not supported.
+     */
+    AesCfb8(const uint8_t* key, const uint8_t* iv, Backend backend = defaultBackend());
+
+    /**
+     * Encrypt `length` bytes. `in` and `out` may be the same buffer.
+     */
+    void encrypt(const uint8_t* in, uint8_t* out, size_t length);
+
+    /**
+     * Decrypt `length` bytes. `in` and `out` may be the same buffer.
+     */
+    void decrypt(const uint8_t* in, uint8_t* out, size_t length);
+
+    Backend getBackend() const { return backend_; }
+
+private:
+    void encryptBlock(const uint8_t* in, uint8_t* out) const;   // portable
+
+    Backend backend_;
+    alignas(16) uint8_t roundKeys_[11 * 16];   // expanded key, byte order
+    uint32_t encKeys_[44];                     // same schedule as big-endian words
+    alignas(16) uint8_t shift_[16];            // CFB shift register
+};
+
+} // namespace mccpp
@@ -0,0 +1,124 @@
+/**
+ * ChunkPayloadCache.h — Deflated chunk data kept with the chunk for reuse.
+ *
+ * Java reference: none — vanilla deflates every S21/S26 payload afresh, so
+ * forty players around spawn cost forty extractions and deflates of the same
+ * unchanged chunks.
+ *
+ * Each chunk's full-column data (every non-empty section plus biomes, the
+ * S26 layout) is deflated once into a raw deflate segment that ends on a byte
+ * boundary (Z_SYNC_FLUSH) without a final block. Segments never refer back
+ * past their own start, so any sequence of them framed by a zlib header, an
+ * empty final block and the Adler-32 of all the data (combined from the
+ * per-segment checksums) is one valid zlib stream. ChunkSerializer splices
+ * them that way into S21 and S26 packets instead of recompressing.
+ *
+ * A payload is valid for one Chunk::getModificationCount() and sky-light
+ * flag; any block, light or biome write makes it stale. The cache belongs to
+ * the chunk (Chunk::payloadCache) and goes away with it.
+ *
+ * Thread safety: get() and put() lock a mutex — the tick thread looks
+ * payloads up, chunk-send workers store the ones they deflated.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mccpp {
+
+/**
+ * One chunk's deflated S26 data.
+ */
+struct ChunkPayload {
+    uint64_t version = 0;          // Chunk::getModificationCount() when extracted
+    bool     hasSkyLight = true;
+    uint16_t primaryBitmask = 0;
+    uint16_t addBitmask = 0;
+    uint32_t rawSize = 0;          // extracted bytes
+    uint32_t adler = 1;            // Adler-32 of the extracted bytes
+    std::vector<uint8_t> deflated; // raw deflate segment, sync-flushed, not final
+};
+
+/**
+ * Process-wide counters.
+ */
+struct ChunkPayloadCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t hitRawBytes = 0;       // extracted bytes served from the cache
+    uint64_t deflatedRawBytes = 0;  // extracted bytes deflated for the cache
+    uint64_t deflateNanos = 0;      // time spent deflating them
+
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+
+    // Deflate time the hits would have cost at the measured rate
+    uint64_t savedNanos() const {
+        if (deflatedRawBytes == 0) return 0;
+        return static_cast<uint64_t>(static_cast<double>(hitRawBytes) *
+                                     static_cast<double>(deflateNanos) /
+                                     static_cast<double>(deflatedRawBytes));
+    }
+};
+
+struct ChunkPayloadCache {
+    /**
+     * The payload for `version`, or null (a miss) if there is none yet or it
+     * is stale.
+     */
+    std::shared_ptr<const ChunkPayload> get(uint64_t version, bool hasSkyLight) const {
+        std::shared_ptr<const ChunkPayload> payload;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (payload_ && payload_->version == version && payload_->hasSkyLight == hasSkyLight) {
+                payload = payload_;
+            }
+        }
+        if (payload) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            hitRawBytes_.fetch_add(payload->rawSize, std::memory_order_relaxed);
+        } else {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return payload;
+    }
+
+    /**
+     * Keep `payload` unless a newer one is already stored. `deflateNanos` is
+     * the time it took to produce, for the statistics.
+     */
+    void put(std::shared_ptr<const ChunkPayload> payload, uint64_t deflateNanos) {
+        deflatedRawBytes_.fetch_add(payload->rawSize, std::memory_order_relaxed);
+        deflateNanos_.fetch_add(deflateNanos, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!payload_ || payload_->version <= payload->version) payload_ = std::move(payload);
+    }
+
+    static ChunkPayloadCacheStats getStats() {
+        ChunkPayloadCacheStats stats;
+        stats.hits = hits_.load(std::memory_order_relaxed);
+        stats.misses = misses_.load(std::memory_order_relaxed);
+        stats.hitRawBytes = hitRawBytes_.load(std::memory_order_relaxed);
+        stats.deflatedRawBytes = deflatedRawBytes_.load(std::memory_order_relaxed);
+        stats.deflateNanos = deflateNanos_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::shared_ptr<const ChunkPayload> payload_;
+
+    static inline std::atomic<uint64_t> hits_{0};
+    static inline std::atomic<uint64_t> misses_{0};
+    static inline std::atomic<uint64_t> hitRawBytes_{0};
+    static inline std::atomic<uint64_t> deflatedRawBytes_{0};
+    static inline std::atomic<uint64_t> deflateNanos_{0};
+};
+
+} // namespace mccpp
@@ -17,102 +17,35 @@
  *
  * Full chunk also includes 256 bytes of biome data.
  *
- * The uncompressed data is zlib deflated before sending.
+ * Extraction reads the world's Chunk sections (world/Chunk.h), expanding
+ * their palette-compressed blocks to the arrays above; the uncompressed data is deflated (DeflateEngine, backend and level
+ * from DeflateSettings) straight into the pooled packet buffer, which is
+ * framed in place and sent without further copies.
+ * The two steps are separate so that the copy can be taken on the thread that
+ * owns the chunk and the deflate done elsewhere (see ChunkSendPipeline).
+ * Full columns are deflated once per chunk version and the cached segments
+ * spliced into later packets (ChunkPayloadCache.h).
  *
- * Thread safety: Stateless — each call produces an independent buffer.
+ * Thread safety: each call produces an independent buffer. extract(),
+ * appendToBulk() and cachedPayload() must run on the thread that owns the
+ * chunk (the tick thread); buildBulkChunkPacket(ChunkBulkData) may run anywhere.
  */
 #pragma once
 
+#include "ChunkPayloadCache.h"
+#include "DeflateEngine.h"
 #include "PacketBuilder.h"
+#include "world/Chunk.h"
 
+#include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <vector>
 #include <zlib.h>
 
 namespace mccpp {
 
-// ═══════════════════════════════════════════════════════════════════════════
-// ChunkSection — 16×16×16 block storage.
-// Java reference: net.minecraft.world.chunk.storage.ExtendedBlockStorage
-// ═══════════════════════════════════════════════════════════════════════════
-
-struct ChunkSection {
-    static constexpr int32_t BLOCKS = 4096;     // 16*16*16
-    static constexpr int32_t NIBBLE = 2048;     // 4096/2
-
-    uint8_t blockLSB[BLOCKS] = {};     // Block ID low 8 bits
-    uint8_t metadata[NIBBLE] = {};     // 4-bit metadata (nibble array)
-    uint8_t blockLight[NIBBLE] = {};   // 4-bit block light
-    uint8_t skyLight[NIBBLE] = {};     // 4-bit sky light
-    uint8_t blockMSB[NIBBLE] = {};     // Block ID high 4 bits (for ID > 255)
-    bool hasMSB = false;               // Whether MSB array is populated
-    bool isEmpty_ = true;              // Java: ExtendedBlockStorage.isEmpty()
-
-    // Get block ID at local coordinates
-    int32_t getBlockId(int32_t x, int32_t y, int32_t z) const {
-        int32_t idx = y * 256 + z * 16 + x;
-        int32_t lsb = blockLSB[idx];
-        if (!hasMSB) return lsb;
-        int32_t nibIdx = idx >> 1;
-        int32_t msb = (idx & 1) ? (blockMSB[nibIdx] >> 4) : (blockMSB[nibIdx] & 0x0F);
-        return (msb << 8) | lsb;
-    }
-
-    // Set block ID at local coordinates
-    void setBlockId(int32_t x, int32_t y, int32_t z, int32_t id) {
-        int32_t idx = y * 256 + z * 16 + x;
-        blockLSB[idx] = static_cast<uint8_t>(id & 0xFF);
-        if (id > 255) {
-            hasMSB = true;
-            int32_t nibIdx = idx >> 1;
-            uint8_t msb4 = static_cast<uint8_t>((id >> 8) & 0x0F);
-            if (idx & 1) {
-                blockMSB[nibIdx] = (blockMSB[nibIdx] & 0x0F) | (msb4 << 4);
-            } else {
-                blockMSB[nibIdx] = (blockMSB[nibIdx] & 0xF0) | msb4;
-            }
-        }
-        isEmpty_ = false;
-    }
-
-    // Get 4-bit metadata
-    uint8_t getMetadata(int32_t x, int32_t y, int32_t z) const {
-        int32_t idx = y * 256 + z * 16 + x;
-        int32_t nibIdx = idx >> 1;
-        return (idx & 1) ? (metadata[nibIdx] >> 4) : (metadata[nibIdx] & 0x0F);
-    }
-
-    void setMetadata(int32_t x, int32_t y, int32_t z, uint8_t val) {
-        int32_t idx = y * 256 + z * 16 + x;
-        int32_t nibIdx = idx >> 1;
-        if (idx & 1) {
-            metadata[nibIdx] = (metadata[nibIdx] & 0x0F) | ((val & 0x0F) << 4);
-        } else {
-            metadata[nibIdx] = (metadata[nibIdx] & 0xF0) | (val & 0x0F);
-        }
-    }
-
-    bool isEmpty() const { return isEmpty_; }
-};
-
-// ═══════════════════════════════════════════════════════════════════════════
-// ChunkData — Full chunk column (16 sections + biome).
-// ═══════════════════════════════════════════════════════════════════════════
-
-struct ChunkData {
-    int32_t chunkX = 0;
-    int32_t chunkZ = 0;
-    ChunkSection sections[16];
-    uint8_t biomes[256] = {};          // One byte per column (16×16)
-    bool hasSkyLight = true;           // true for overworld/end
-
-    // Check if a section exists (non-null equivalent)
-    bool hasSection(int32_t y) const {
-        return y >= 0 && y < 16 && !sections[y].isEmpty();
-    }
-};
-
 // ═══════════════════════════════════════════════════════════════════════════
 // ChunkExtracted — Intermediate extracted data before compression.
 // Java reference: S21PacketChunkData$Extracted
@@ -124,6 +57,32 @@ struct ChunkExtracted {
     uint16_t addBitmask = 0;       // Which sections have MSB data
 };
 
+// ═══════════════════════════════════════════════════════════════════════════
+// ChunkBulkData — Extracted chunks for one S26 packet, ready to deflate.
+// Java reference: S26PacketMapChunkBulk(List) constructor
+// ═══════════════════════════════════════════════════════════════════════════
+
+struct ChunkBulkData {
+    struct Entry {
+        int32_t  chunkX = 0, chunkZ = 0;
+        uint16_t primaryBitmask = 0, addBitmask = 0;
+        size_t   rawOffset = 0;    // into raw, if not cached
+        uint32_t rawSize = 0;
+
+        // Either the cached deflated payload, or the cache to store it into
+        // once deflated (with the chunk version it was extracted at)
+        std::shared_ptr<const ChunkPayload> payload;
+        std::shared_ptr<ChunkPayloadCache>  cache;
+        uint64_t version = 0;
+    };
+
+    std::vector<uint8_t> raw;      // Uncached chunks' extracted data, concatenated
+    std::vector<Entry>   entries;
+    bool hasSkyLight = true;
+
+    bool empty() const { return entries.empty(); }
+};
+
 // ═══════════════════════════════════════════════════════════════════════════
 // ChunkSerializer — Extracts and compresses chunk data.
 // Java reference: S21PacketChunkData.func_149269_a
@@ -131,127 +90,293 @@ struct ChunkExtracted {
 
 namespace ChunkSerializer {
 
-    // Java: func_149269_a — Extract chunk section data in wire order.
+    // Bytes extractInto() will append for `chunk` (to reserve up front).
+    inline size_t extractedSize(const Chunk& chunk, bool fullChunk, bool hasSkyLight,
+                                uint16_t sectionMask = 0xFFFF) {
+        size_t perSection = 4096 + 2048 + 2048 + (hasSkyLight ? 2048 : 0);
+        size_t size = fullChunk ? Chunk::BIOME_ARRAY_SIZE : 0;
+        for (int32_t i = 0; i < Chunk::SECTION_COUNT; ++i) {
+            const ChunkSection* section = chunk.sections[i].get();
+            if (!section || !(sectionMask & (1 << i))) continue;
+            if (fullChunk && section->isEmpty()) continue;
+            size += perSection + (section->hasBlockMSB() ? 2048 : 0);
+        }
+        return size;
+    }
+
+    // Java: func_149269_a — Append chunk section data in wire order to `out`.
     // sectionMask = which sections to include (0xFFFF = all)
     // fullChunk = include biome data
-    inline ChunkExtracted extract(const ChunkData& chunk, bool fullChunk,
-                                    uint16_t sectionMask = 0xFFFF) {
-        ChunkExtracted result;
+    // hasSkyLight = include sky light (false in the Nether)
+    // Sets the bitmasks in `result`; result.data is not touched.
+    inline void extractInto(const Chunk& chunk, bool fullChunk, bool hasSkyLight,
+                            uint16_t sectionMask, std::vector<uint8_t>& out,
+                            ChunkExtracted& result) {
+        constexpr size_t BLOCKS = 4096;
+        constexpr size_t NIBBLE = 2048;
+        result.primaryBitmask = 0;
+        result.addBitmask = 0;
 
         // Pass 1: Determine which sections to include
-        for (int32_t i = 0; i < 16; ++i) {
-            if (!(sectionMask & (1 << i))) continue;
-            if (fullChunk && chunk.sections[i].isEmpty()) continue;
-            if (!chunk.hasSection(i) && !fullChunk) continue;
+        // Java: storage != null && (!fullChunk || !storage.isEmpty()) && (mask & 1 << i) != 0
+        const ChunkSection* sections[Chunk::SECTION_COUNT] = {};
+        int32_t sectionCount = 0;
+        int32_t msbCount = 0;
+        for (int32_t i = 0; i < Chunk::SECTION_COUNT; ++i) {
+            const ChunkSection* section = chunk.sections[i].get();
+            if (!section || !(sectionMask & (1 << i))) continue;
+            if (fullChunk && section->isEmpty()) continue;
 
+            sections[i] = section;
             result.primaryBitmask |= (1 << i);
-            if (chunk.sections[i].hasMSB) {
+            ++sectionCount;
+            if (section->hasBlockMSB()) {
                 result.addBitmask |= (1 << i);
+                ++msbCount;
             }
         }
 
-        // Calculate total size
-        int32_t sectionCount = 0;
-        int32_t msbCount = 0;
-        for (int32_t i = 0; i < 16; ++i) {
-            if (result.primaryBitmask & (1 << i)) {
-                ++sectionCount;
-                if (result.addBitmask & (1 << i)) ++msbCount;
-            }
-        }
-
-        size_t totalSize = static_cast<size_t>(sectionCount) * ChunkSection::BLOCKS;  // blockLSB
-        totalSize += static_cast<size_t>(sectionCount) * ChunkSection::NIBBLE;        // metadata
-        totalSize += static_cast<size_t>(sectionCount) * ChunkSection::NIBBLE;        // blockLight
-        if (chunk.hasSkyLight) {
-            totalSize += static_cast<size_t>(sectionCount) * ChunkSection::NIBBLE;    // skyLight
-        }
-        totalSize += static_cast<size_t>(msbCount) * ChunkSection::NIBBLE;            // blockMSB
-        if (fullChunk) totalSize += 256;                                              // biomes
-
-        result.data.resize(totalSize);
-        size_t offset = 0;
-
-        // Pass 2: Block ID LSB arrays
-        for (int32_t i = 0; i < 16; ++i) {
-            if (!(result.primaryBitmask & (1 << i))) continue;
-            std::memcpy(result.data.data() + offset, chunk.sections[i].blockLSB, ChunkSection::BLOCKS);
-            offset += ChunkSection::BLOCKS;
+        size_t totalSize = static_cast<size_t>(sectionCount) * BLOCKS;   // blockLSB
+        totalSize += static_cast<size_t>(sectionCount) * NIBBLE;         // metadata
+        totalSize += static_cast<size_t>(sectionCount) * NIBBLE;         // blockLight
+        if (hasSkyLight) {
+            totalSize += static_cast<size_t>(sectionCount) * NIBBLE;     // skyLight
         }
+        totalSize += static_cast<size_t>(msbCount) * NIBBLE;             // blockMSB
+        if (fullChunk) totalSize += Chunk::BIOME_ARRAY_SIZE;             // biomes
+
+        size_t offset = out.size();
+        out.resize(offset + totalSize);
+        uint8_t* dst = out.data();
+
+        // Uniform arrays (all sky light 15, all block light 0) read from the
+        // shared constant buffers (NibbleArray::bytes)
+        auto copyNibbles = [&](const NibbleArray* arr) {
+            if (arr && arr->size() == NIBBLE) std::memcpy(dst + offset, arr->bytes(), NIBBLE);
+            else std::memset(dst + offset, 0, NIBBLE);
+            offset += NIBBLE;
+        };
 
-        // Pass 3: Metadata nibble arrays
-        for (int32_t i = 0; i < 16; ++i) {
-            if (!(result.primaryBitmask & (1 << i))) continue;
-            std::memcpy(result.data.data() + offset, chunk.sections[i].metadata, ChunkSection::NIBBLE);
-            offset += ChunkSection::NIBBLE;
+        // Passes 2, 3 and 6: block ID LSB, metadata and MSB arrays, expanded
+        // from each section's palette in one go. The MSB arrays come after
+        // the light arrays, so their offset is worked out up front.
+        size_t lsbOffset = offset;
+        size_t metaOffset = lsbOffset + static_cast<size_t>(sectionCount) * BLOCKS;
+        size_t msbOffset = metaOffset + static_cast<size_t>(sectionCount) * NIBBLE * (hasSkyLight ? 3 : 2);
+        for (const ChunkSection* section : sections) {
+            if (!section) continue;
+            bool msb = section->hasBlockMSB();
+            section->getBlockArrays(dst + lsbOffset, msb ? dst + msbOffset : nullptr, dst + metaOffset);
+            lsbOffset += BLOCKS;
+            metaOffset += NIBBLE;
+            if (msb) msbOffset += NIBBLE;
         }
+        offset = metaOffset;
 
         // Pass 4: Block light nibble arrays
-        for (int32_t i = 0; i < 16; ++i) {
-            if (!(result.primaryBitmask & (1 << i))) continue;
-            std::memcpy(result.data.data() + offset, chunk.sections[i].blockLight, ChunkSection::NIBBLE);
-            offset += ChunkSection::NIBBLE;
+        for (const ChunkSection* section : sections) {
+            if (section) copyNibbles(&section->getBlocklightArray());
         }
 
         // Pass 5: Sky light nibble arrays (overworld/end only)
-        if (chunk.hasSkyLight) {
-            for (int32_t i = 0; i < 16; ++i) {
-                if (!(result.primaryBitmask & (1 << i))) continue;
-                std::memcpy(result.data.data() + offset, chunk.sections[i].skyLight, ChunkSection::NIBBLE);
-                offset += ChunkSection::NIBBLE;
+        if (hasSkyLight) {
+            for (const ChunkSection* section : sections) {
+                if (section) copyNibbles(section->getSkylightArray());
             }
         }
 
-        // Pass 6: Block ID MSB nibble arrays (for IDs > 255)
-        for (int32_t i = 0; i < 16; ++i) {
-            if (!(result.addBitmask & (1 << i))) continue;
-            std::memcpy(result.data.data() + offset, chunk.sections[i].blockMSB, ChunkSection::NIBBLE);
-            offset += ChunkSection::NIBBLE;
-        }
+        offset += static_cast<size_t>(msbCount) * NIBBLE;   // Pass 6, written above
 
         // Pass 7: Biome data (full chunk only)
         if (fullChunk) {
-            std::memcpy(result.data.data() + offset, chunk.biomes, 256);
-            offset += 256;
+            std::memcpy(dst + offset, chunk.biomes.data(), Chunk::BIOME_ARRAY_SIZE);
+            offset += Chunk::BIOME_ARRAY_SIZE;
         }
+    }
 
+    inline ChunkExtracted extract(const Chunk& chunk, bool fullChunk, bool hasSkyLight,
+                                  uint16_t sectionMask = 0xFFFF) {
+        ChunkExtracted result;
+        extractInto(chunk, fullChunk, hasSkyLight, sectionMask, result.data, result);
         return result;
     }
 
-    // Compress extracted data with zlib deflate.
-    inline std::vector<uint8_t> compress(const std::vector<uint8_t>& raw) {
-        std::vector<uint8_t> compressed(raw.size() + 128); // Generous initial size
-        z_stream strm = {};
-        deflateInit(&strm, Z_DEFAULT_COMPRESSION);
-        strm.avail_in = static_cast<uInt>(raw.size());
-        strm.next_in = const_cast<Bytef*>(raw.data());
-        strm.avail_out = static_cast<uInt>(compressed.size());
-        strm.next_out = compressed.data();
-        deflate(&strm, Z_FINISH);
-        compressed.resize(strm.total_out);
-        deflateEnd(&strm);
+    // ─── Payload cache ───
+    // Full-column payloads (S26 layout) are deflated once per chunk version
+    // into segments that splice into any S21/S26 (networking/ChunkPayloadCache.h).
+
+    // The chunk's cached payload for its current contents, or null.
+    // Tick thread only (reads the chunk).
+    inline std::shared_ptr<const ChunkPayload> cachedPayload(const Chunk& chunk, bool hasSkyLight) {
+        if (!chunk.payloadCache) chunk.payloadCache = std::make_shared<ChunkPayloadCache>();
+        return chunk.payloadCache->get(chunk.getModificationCount(), hasSkyLight);
+    }
+
+    // Java: S26PacketMapChunkBulk — add one full chunk to a bulk packet: the
+    // cached payload if `cached` is set, else its extracted data, which
+    // buildBulkChunkPacket() deflates and stores in the chunk's cache.
+    inline void appendToBulk(ChunkBulkData& bulk, const Chunk& chunk,
+                             std::shared_ptr<const ChunkPayload> cached) {
+        ChunkBulkData::Entry e;
+        e.chunkX = chunk.xPosition;
+        e.chunkZ = chunk.zPosition;
+        if (cached) {
+            e.primaryBitmask = cached->primaryBitmask;
+            e.addBitmask = cached->addBitmask;
+            e.rawSize = cached->rawSize;
+            e.payload = std::move(cached);
+        } else {
+            ChunkExtracted masks;
+            e.rawOffset = bulk.raw.size();
+            extractInto(chunk, true, bulk.hasSkyLight, 0xFFFF, bulk.raw, masks);
+            e.primaryBitmask = masks.primaryBitmask;
+            e.addBitmask = masks.addBitmask;
+            e.rawSize = static_cast<uint32_t>(bulk.raw.size() - e.rawOffset);
+            if (!chunk.payloadCache) chunk.payloadCache = std::make_shared<ChunkPayloadCache>();
+            e.cache = chunk.payloadCache;
+            e.version = chunk.getModificationCount();
+        }
+        bulk.entries.push_back(std::move(e));
+    }
+
+    inline void appendToBulk(ChunkBulkData& bulk, const Chunk& chunk) {
+        appendToBulk(bulk, chunk, cachedPayload(chunk, bulk.hasSkyLight));
+    }
+
+    // ─── zlib framing ───
+    // Deflate output comes from a DeflateEngine (raw deflate); the zlib header
+    // and Adler-32 trailer are added here, which is also what lets cached
+    // segments be spliced: header, segment..., empty final block, Adler-32.
+
+    inline void writeZlibHeader(PacketWriter& w) {
+        w.writeUByte(0x78);   // deflate, 32K window
+        w.writeUByte(0x9C);   // default level, check bits
+    }
+
+    inline void writeZlibTrailer(PacketWriter& w, uint32_t adler) {
+        w.writeUByte(0x03);   // final fixed-Huffman block holding only end-of-block
+        w.writeUByte(0x00);
+        w.writeInt(static_cast<int32_t>(adler));
+    }
+
+    // Compress extracted data into a zlib stream.
+    inline std::vector<uint8_t> compress(const std::vector<uint8_t>& raw,
+                                         const DeflateSettings& settings = {}) {
+        DeflateEngine& engine = DeflateEngine::forThread(settings.backend);
+        std::vector<uint8_t> compressed(2 + engine.bound(raw.size()) + 4);
+        compressed[0] = 0x78;
+        compressed[1] = 0x9C;
+        size_t produced = engine.compress(raw.data(), raw.size(), compressed.data() + 2,
+                                          settings.level, true);
+        storeBigEndian(compressed.data() + 2 + produced,
+                       static_cast<uint32_t>(adler32(adler32(0, nullptr, 0), raw.data(),
+                                                     static_cast<uInt>(raw.size()))));
+        compressed.resize(2 + produced + 4);
         return compressed;
     }
 
+    // Deflate `raw` straight into the packet body as a zlib stream; returns
+    // the compressed size. Saves the intermediate vector and the copy that
+    // writeBytes() would make.
+    inline size_t deflateInto(PacketWriter& w, const uint8_t* raw, size_t rawLen,
+                              const DeflateSettings& settings = {}) {
+        DeflateEngine& engine = DeflateEngine::forThread(settings.backend);
+        size_t start = w.size();
+        writeZlibHeader(w);
+        size_t bound = engine.bound(rawLen);
+        w.commitWrite(engine.compress(raw, rawLen, w.prepareWrite(bound), settings.level, true));
+        w.writeInt(static_cast<int32_t>(adler32(adler32(0, nullptr, 0), raw, static_cast<uInt>(rawLen))));
+        return w.size() - start;
+    }
+
+    // Deflate one segment (sync-flushed, not final) into the packet and, if
+    // the entry has a cache, store a copy there as the chunk's payload.
+    inline void deflateSegment(DeflateEngine& engine, int level, PacketWriter& w,
+                               const uint8_t* raw, const ChunkBulkData::Entry& e, bool hasSkyLight) {
+        auto start = std::chrono::steady_clock::now();
+        uint8_t* out = w.prepareWrite(engine.bound(e.rawSize));
+        size_t produced = engine.compress(raw, e.rawSize, out, level, false);
+        w.commitWrite(produced);
+
+        if (!e.cache) return;
+        auto payload = std::make_shared<ChunkPayload>();
+        payload->version = e.version;
+        payload->hasSkyLight = hasSkyLight;
+        payload->primaryBitmask = e.primaryBitmask;
+        payload->addBitmask = e.addBitmask;
+        payload->rawSize = e.rawSize;
+        payload->adler = static_cast<uint32_t>(adler32(adler32(0, nullptr, 0), raw, e.rawSize));
+        payload->deflated.assign(out, out + produced);
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        e.cache->put(std::move(payload), static_cast<uint64_t>(nanos));
+    }
+
+    // The bulk's chunks as one zlib stream: cached segments are copied,
+    // the others deflated (and cached). Returns the compressed size.
+    inline size_t writeBulkPayload(PacketWriter& w, const ChunkBulkData& bulk,
+                                   const DeflateSettings& settings = {}) {
+        DeflateEngine& engine = DeflateEngine::forThread(settings.backend);
+        size_t start = w.size();
+        writeZlibHeader(w);
+        uLong adler = adler32(0, nullptr, 0);
+        for (const auto& e : bulk.entries) {
+            if (e.payload) {
+                w.writeBytes(e.payload->deflated);
+                adler = adler32_combine(adler, e.payload->adler, static_cast<z_off_t>(e.rawSize));
+                continue;
+            }
+            const uint8_t* raw = bulk.raw.data() + e.rawOffset;
+            deflateSegment(engine, settings.level, w, raw, e, bulk.hasSkyLight);
+            adler = adler32(adler, raw, e.rawSize);
+        }
+        writeZlibTrailer(w, static_cast<uint32_t>(adler));
+        return w.size() - start;
+    }
+
     // ─── S21 Chunk Data — Single chunk packet ───
     // Java: S21PacketChunkData.writePacketData
     // Wire: int chunkX, int chunkZ, bool fullChunk, short primaryBitmask,
     //       short addBitmask, int compressedLen, byte[] compressed
-    inline std::vector<uint8_t> buildChunkDataPacket(const ChunkData& chunk,
-                                                       bool fullChunk,
-                                                       uint16_t sectionMask = 0xFFFF) {
-        auto extracted = extract(chunk, fullChunk, sectionMask);
-        auto compressed = compress(extracted.data);
+    // Full columns (fullChunk, all sections) go through the payload cache.
+    inline PacketBuffer buildChunkDataPacket(const Chunk& chunk,
+                                             bool fullChunk,
+                                             bool hasSkyLight,
+                                             uint16_t sectionMask = 0xFFFF,
+                                             const DeflateSettings& settings = {}) {
+        if (fullChunk && sectionMask == 0xFFFF) {
+            ChunkBulkData column;
+            column.hasSkyLight = hasSkyLight;
+            appendToBulk(column, chunk);
+            const auto& e = column.entries.front();
+
+            PacketWriter w(ClientboundPacket::ChunkData, e.payload ? e.payload->deflated.size() + 32
+                                                                   : column.raw.size() / 2);
+            w.writeInt(chunk.xPosition);
+            w.writeInt(chunk.zPosition);
+            w.writeBool(true);
+            w.writeShort(static_cast<int16_t>(e.primaryBitmask));
+            w.writeShort(static_cast<int16_t>(e.addBitmask));
+            size_t lengthAt = w.size();
+            w.writeInt(0);   // compressed length, patched below
+            size_t compressedLen = writeBulkPayload(w, column, settings);
+            w.writeIntAt(lengthAt, static_cast<int32_t>(compressedLen));
+            return w.finish();
+        }
 
-        PacketWriter w(ClientboundPacket::ChunkData);
-        w.writeInt(chunk.chunkX);
-        w.writeInt(chunk.chunkZ);
+        auto extracted = extract(chunk, fullChunk, hasSkyLight, sectionMask);
+
+        PacketWriter w(ClientboundPacket::ChunkData, extracted.data.size() / 2);
+        w.writeInt(chunk.xPosition);
+        w.writeInt(chunk.zPosition);
         w.writeBool(fullChunk);
         w.writeShort(static_cast<int16_t>(extracted.primaryBitmask));
         w.writeShort(static_cast<int16_t>(extracted.addBitmask));
-        w.writeInt(static_cast<int32_t>(compressed.size()));
-        w.writeBytes(compressed);
-        return w.toFramed();
+        size_t lengthAt = w.size();
+        w.writeInt(0);   // compressed length, patched below
+        size_t compressedLen = deflateInto(w, extracted.data.data(), extracted.data.size(), settings);
+        w.writeIntAt(lengthAt, static_cast<int32_t>(compressedLen));
+        return w.finish();
     }
 
     // ─── S26 Map Chunk Bulk — Multiple chunks in one packet ───
@@ -259,64 +384,55 @@ namespace ChunkSerializer {
     // Wire: short chunkCount, int compressedLen, bool hasSkyLight,
     //       byte[] compressed, then per-chunk: int chunkX, int chunkZ,
     //       short primaryBitmask, short addBitmask
-    inline std::vector<uint8_t> buildBulkChunkPacket(
-            const std::vector<const ChunkData*>& chunks,
-            bool fullChunk) {
-
-        // Extract all chunks
-        struct BulkEntry {
-            ChunkExtracted extracted;
-            int32_t chunkX, chunkZ;
-        };
-        std::vector<BulkEntry> entries;
-        entries.reserve(chunks.size());
-
-        // Concatenate all uncompressed data
-        std::vector<uint8_t> allRaw;
-        bool hasSky = false;
-        for (const auto* chunk : chunks) {
-            BulkEntry e;
-            e.chunkX = chunk->chunkX;
-            e.chunkZ = chunk->chunkZ;
-            e.extracted = extract(*chunk, fullChunk);
-            allRaw.insert(allRaw.end(), e.extracted.data.begin(), e.extracted.data.end());
-            if (chunk->hasSkyLight) hasSky = true;
-            entries.push_back(std::move(e));
+    // Safe on any thread: only touches the bulk and the chunks' caches.
+    inline PacketBuffer buildBulkChunkPacket(const ChunkBulkData& bulk,
+                                             const DeflateSettings& settings = {}) {
+        size_t cachedBytes = 0;
+        for (const auto& e : bulk.entries) {
+            if (e.payload) cachedBytes += e.payload->deflated.size();
         }
-
-        auto compressed = compress(allRaw);
-
-        PacketWriter w(ClientboundPacket::MapChunkBulk);
-        w.writeShort(static_cast<int16_t>(entries.size()));
-        w.writeInt(static_cast<int32_t>(compressed.size()));
-        w.writeBool(hasSky);
-        w.writeBytes(compressed);
+        PacketWriter w(ClientboundPacket::MapChunkBulk,
+                       cachedBytes + bulk.raw.size() / 2 + bulk.entries.size() * 12 + 16);
+        w.writeShort(static_cast<int16_t>(bulk.entries.size()));
+        size_t lengthAt = w.size();
+        w.writeInt(0);   // compressed length, patched below
+        w.writeBool(bulk.hasSkyLight);
+        size_t compressedLen = writeBulkPayload(w, bulk, settings);
+        w.writeIntAt(lengthAt, static_cast<int32_t>(compressedLen));
 
         // Per-chunk metadata
-        for (const auto& e : entries) {
+        for (const auto& e : bulk.entries) {
             w.writeInt(e.chunkX);
             w.writeInt(e.chunkZ);
-            w.writeShort(static_cast<int16_t>(e.extracted.primaryBitmask));
-            w.writeShort(static_cast<int16_t>(e.extracted.addBitmask));
+            w.writeShort(static_cast<int16_t>(e.primaryBitmask));
+            w.writeShort(static_cast<int16_t>(e.addBitmask));
         }
 
-        return w.toFramed();
+        return w.finish();
+    }
+
+    inline PacketBuffer buildBulkChunkPacket(const std::vector<const Chunk*>& chunks,
+                                             bool hasSkyLight) {
+        ChunkBulkData bulk;
+        bulk.hasSkyLight = hasSkyLight;
+        for (const auto* chunk : chunks) appendToBulk(bulk, *chunk);
+        return buildBulkChunkPacket(bulk);
     }
 
     // ─── Unload chunk (send empty S21 with primaryBitmask=0) ───
-    inline std::vector<uint8_t> buildUnloadChunkPacket(int32_t chunkX, int32_t chunkZ) {
+    inline PacketBuffer buildUnloadChunkPacket(int32_t chunkX, int32_t chunkZ) {
         PacketWriter w(ClientboundPacket::ChunkData);
         w.writeInt(chunkX);
         w.writeInt(chunkZ);
         w.writeBool(true); // full chunk
         w.writeShort(0);   // no sections
         w.writeShort(0);   // no add data
-        // Compressed empty data: just biome array (256 zeroes)
-        std::vector<uint8_t> biomes(256, 0);
-        auto compressed = compress(biomes);
-        w.writeInt(static_cast<int32_t>(compressed.size()));
-        w.writeBytes(compressed);
-        return w.toFramed();
+        // Compressed empty data: just biome array (256 zeroes), deflated once
+        static const std::vector<uint8_t> emptyColumn =
+            compress(std::vector<uint8_t>(Chunk::BIOME_ARRAY_SIZE, 0));
+        w.writeInt(static_cast<int32_t>(emptyColumn.size()));
+        w.writeBytes(emptyColumn);
+        return w.finish();
     }
 
 } // namespace ChunkSerializer
@@ -4,23 +4,31 @@
  * Reference: net.minecraft.network.NetworkManager
  * Manages a single client through Handshake → Status → Login → Play states.
  *
- * C++ adaptation: two threads per connection (read + write), with a
- * thread-safe packet queue for outbound packets. Uses VarInt length-prefixed
- * framing per the protocol specification.
+ * C++ adaptation: the non-blocking socket is driven by an EventLoop from the
+ * NetworkReactor pool, with a thread-safe packet queue for outbound packets
+ * and an optional AES-128/CFB8 stage on both directions (online mode).
+ * Uses VarInt length-prefixed framing per the protocol specification.
  */
 #pragma once
 
+#include "networking/AesCfb8.h"
+#include "networking/InboundBuffer.h"
+#include "networking/PacketBuffer.h"
+#include "networking/PacketInbox.h"
+
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
 #include <vector>
 
 namespace mccpp {
 
+class EventLoop;     // forward decl
+class PacketCapture; // forward decl
 class PacketHandler; // forward decl
 
 /**
@@ -34,20 +42,69 @@ enum class ConnectionState : int {
     Play      = 3,
 };
 
+/**
+ * Outbound priority class. Queued frames are written Control first, then
+ * Gameplay, then Bulk; order is preserved within a class.
+ *
+ * Bulk carries chunk data and the packets that must stay ordered with it
+ * (block changes, block entities), so a block update never overtakes the
+ * chunk it applies to. Packets that change the player's state (JoinGame,
+ * Respawn, UpdateHealth, ChangeGameState, PlayerAbilities) are Control, so
+ * they never arrive after the position and world updates that follow them;
+ * stop sending the old dimension's chunks before queueing a Respawn.
+ * Outside Play state everything is Control.
+ */
+enum class PacketPriority : uint8_t {
+    Control  = 0,   // KeepAlive, chat, Disconnect, player state changes
+    Gameplay = 1,   // entities, inventory, everything else
+    Bulk     = 2,   // chunk data and block updates
+};
+
+constexpr size_t PRIORITY_CLASSES = 3;
+
+/**
+ * Outbound queue depth of one connection.
+ */
+struct OutboundQueueStats {
+    size_t queuedFrames[PRIORITY_CLASSES] = {};
+    size_t queuedBytes[PRIORITY_CLASSES] = {};
+    size_t bytesInFlight = 0;    // taken for writing, not yet accepted by the socket
+    bool   bulkThrottled = false;
+};
+
 /**
  * Connection — manages a single client socket.
  *
  * Java reference: net.minecraft.network.NetworkManager
  *
  * Thread model (multi-threaded adaptation):
- *   - Read thread:  reads VarInt-framed packets, dispatches to PacketHandler
- *   - Write thread: drains outbound queue and writes to socket
+ *   - The owning EventLoop reads VarInt-framed packets when the socket becomes
+ *     readable. Handshake/Status/Login packets are dispatched to the
+ *     PacketHandler on the loop thread; Play packets are queued in a
+ *     lock-free SPSC inbox and handled on the tick thread by
+ *     processReceivedPackets(), so Play handlers never race world state.
+ *   - sendPacket() may be called from any thread; it only queues the pooled,
+ *     pre-framed buffer, or a reference to a shared broadcast frame (no copy).
+ *     flush() wakes the loop, which drains every queued frame with vectored
+ *     sendmsg() calls until EAGAIN and resumes on the next EPOLLOUT edge.
+ *     The server flushes all connections once at the end of each tick;
+ *     Handshake/Status/Login replies are flushed right after the read batch.
+ *
+ * Backpressure:
+ *   - Frames wait in one queue per PacketPriority. Each write pass takes all
+ *     Control and Gameplay frames and at most BULK_WRITE_WINDOW bytes of Bulk,
+ *     so a KeepAlive waits behind at most one window of chunk data.
+ *   - A per-connection token bucket (byte budget) is charged for every frame;
+ *     Bulk frames are only taken while it is positive.
+ *   - Queued plus in-flight bytes above BACKLOG_SOFT_LIMIT mark the connection
+ *     bulk-throttled (chunk producers should check isBulkThrottled()); staying
+ *     there for OVER_BUDGET_TIMEOUT_MS, or exceeding MAX_QUEUED_BYTES, disconnects.
  *
  * Lifecycle:
- *   1. Constructed by TcpListener accept callback
- *   2. Call start() to spawn read/write threads
+ *   1. Constructed by TcpListener accept callback (socket is non-blocking)
+ *   2. Call start() to register the socket with an EventLoop
  *   3. Call disconnect() to cleanly close (sends optional kick reason)
- *   4. Destructor joins threads and closes socket
+ *   4. The loop flushes what it can and closes the socket
  */
 class Connection : public std::enable_shared_from_this<Connection> {
 public:
@@ -59,9 +116,9 @@ public:
     Connection& operator=(const Connection&) = delete;
 
     /**
-     * Start read/write threads with the given initial handler.
+     * Install the initial handler and register the socket with `loop`.
      */
-    void start(std::shared_ptr<PacketHandler> handler);
+    void start(std::shared_ptr<PacketHandler> handler, EventLoop& loop);
 
     /**
      * Swap the active packet handler (state transition).
@@ -71,11 +128,51 @@ public:
     void setHandler(std::shared_ptr<PacketHandler> handler);
 
     /**
-     * Queue a raw packet (VarInt packetId + payload) for sending.
+     * Queue a packet (built with PacketWriter/PacketBuilder) for sending.
      * Java reference: NetworkManager.scheduleOutboundPacket()
+     * Thread-safe. The buffer is framed in place if it is not already, and is
+     * written on the next flush() and returned to its pool once sent.
+     * The priority class is derived from the packet ID unless given.
+     */
+    void sendPacket(PacketBuffer packet);
+    void sendPacket(PacketBuffer packet, PacketPriority priority);
+
+    /**
+     * Queue a shared broadcast frame. Only the reference is queued; the same
+     * bytes are written to every connection that holds it.
      * Thread-safe.
      */
-    void sendPacket(std::vector<uint8_t> data);
+    void sendPacket(SharedPacket packet);
+    void sendPacket(SharedPacket packet, PacketPriority priority);
+
+    /**
+     * Ask the event loop to write everything queued so far (Bulk frames as
+     * far as the byte budget allows), after applying the backlog policy.
+     * Java reference: NetworkManager.flush() (Channel.flush())
+     * Thread-safe; coalesces with a flush that is already pending.
+     */
+    void flush();
+
+    /**
+     * Log every inbound frame of this connection to `capture`. Call before start().
+     */
+    void setCapture(std::shared_ptr<PacketCapture> capture);
+
+    /**
+     * Byte budget refill rate and burst size. Call before start().
+     */
+    void setByteBudget(size_t bytesPerSecond, size_t burstBytes);
+
+    /**
+     * True while the outbound backlog is over BACKLOG_SOFT_LIMIT; producers of
+     * Bulk data should hold back until it clears. Thread-safe.
+     */
+    bool isBulkThrottled() const { return bulkThrottled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Queue depth per priority class and bytes in flight. Thread-safe.
+     */
+    OutboundQueueStats getOutboundStats() const;
 
     /**
      * Close the connection, optionally sending a disconnect/kick reason first.
@@ -89,44 +186,150 @@ public:
      */
     void setState(ConnectionState state);
 
+    /**
+     * Switch both directions to AES-128/CFB8 (key = IV = shared secret).
+     * Java reference: NetworkManager.enableEncryption()
+     * Loop thread only — called while handling C01PacketEncryptionResponse.
+     * Bytes already received past that packet are decrypted in place; every
+     * frame written from now on is encrypted.
+     */
+    void enableEncryption(const uint8_t* sharedSecret);
+
+    bool isEncrypted() const { return encrypted_.load(std::memory_order_acquire); }
+
     ConnectionState getState() const { return state_.load(std::memory_order_acquire); }
     bool isConnected() const { return connected_.load(std::memory_order_relaxed); }
 
     const std::string& getRemoteAddress() const { return remoteAddress_; }
     uint16_t getRemotePort() const { return remotePort_; }
 
+    /**
+     * When the socket was accepted; used for the handshake/login timeouts.
+     */
+    std::chrono::steady_clock::time_point getConnectedAt() const { return connectedAt_; }
+
     /**
      * Check if there are pending outbound packets.
      */
     bool hasOutboundData() const;
 
+    /**
+     * Handle up to `budget` queued Play packets on the calling (tick) thread.
+     * Runs of consecutive Player/Position/Look packets are coalesced into a
+     * single handler call carrying the final position, look and onGround.
+     * Java reference: NetworkManager.processReceivedPackets() — 1000 per tick
+     * Ends with the handler's onNetworkTick().
+     * @return number of received packets consumed
+     */
+    int processReceivedPackets(int budget);
+
+    /**
+     * Tell the handler the server has dropped this (closed) connection.
+     * Tick thread only; called once.
+     */
+    void notifyRemoved();
+
 private:
-    void readLoop();
-    void writeLoop();
+    friend class EventLoop;
+
+    // ─── Loop-thread only ───
+    void onReadable();
+    void onWritable();
+    void flushOutbound();
+    void flushEncrypted();
+    bool takeOutbound();
+    void publishInFlight();
+    bool checkBacklog();
+    void processInbound();
+    void dispatchPacket(const FrameView& frame);
+    void handleSafely(PacketHandler& handler, int32_t packetId,
+                      const uint8_t* data, size_t length);
     void closeSocket();
 
     // Socket
     int            socketFd_;
     std::string    remoteAddress_;
     uint16_t       remotePort_;
+    std::chrono::steady_clock::time_point connectedAt_;
 
     // State
     std::atomic<ConnectionState> state_{ConnectionState::Handshake};
     std::atomic<bool> connected_{true};
 
-    // Threads
-    std::thread readThread_;
-    std::thread writeThread_;
+    // Owning event loop (set once by start())
+    EventLoop* loop_ = nullptr;
 
     // Handler — mutex-protected for thread-safe swaps
     mutable std::mutex handlerMutex_;
     std::shared_ptr<PacketHandler> handler_;
 
-    // Outbound queue (mutex-protected)
+    // One queued frame: either owned by this connection or a shared broadcast.
+    struct OutboundFrame {
+        PacketBuffer owned;
+        SharedPacket shared;
+
+        const uint8_t* data() const { return shared ? shared->data() : owned.data(); }
+        size_t size() const { return shared ? shared->size() : owned.size(); }
+    };
+
+    // Outbound queues, one per PacketPriority (mutex-protected)
     mutable std::mutex          outMutex_;
-    std::deque<std::vector<uint8_t>> outQueue_;
+    std::deque<OutboundFrame>   outQueues_[PRIORITY_CLASSES];
+    size_t                      queuedBytes_[PRIORITY_CLASSES] = {};
+    std::atomic<size_t>         queuedTotal_{0};
+    std::atomic<bool>           flushScheduled_{false};
+
+    // Frames taken from outQueues_ and not yet fully written (loop thread).
+    // writeOffset_ is the number of bytes of the front frame already sent.
+    std::deque<OutboundFrame> writeQueue_;
+    size_t               writeOffset_ = 0;
+    size_t               writeQueueBytes_ = 0;
+    std::atomic<size_t>  inFlightBytes_{0};
+    std::atomic<bool>    writeBlocked_{false};
+
+    // Byte budget token bucket (loop thread; configured before start())
+    size_t  budgetRate_  = DEFAULT_BYTE_BUDGET_RATE;
+    size_t  budgetBurst_ = DEFAULT_BYTE_BUDGET_BURST;
+    double  budgetTokens_ = DEFAULT_BYTE_BUDGET_BURST;
+    std::chrono::steady_clock::time_point budgetRefill_;
+
+    // Backlog policy state (any thread calling flush())
+    std::atomic<bool>    bulkThrottled_{false};
+    std::atomic<int64_t> overBudgetSinceMs_{0};   // 0 = within budget
+
+    static constexpr size_t DEFAULT_BYTE_BUDGET_RATE  = 4 * 1024 * 1024;   // bytes per second
+    static constexpr size_t DEFAULT_BYTE_BUDGET_BURST = 1024 * 1024;
+    static constexpr size_t BULK_WRITE_WINDOW   = 64 * 1024;
+    static constexpr size_t BACKLOG_SOFT_LIMIT  = 1024 * 1024;
+    static constexpr size_t MAX_QUEUED_BYTES    = 32 * 1024 * 1024;
+    static constexpr int    OVER_BUDGET_TIMEOUT_MS = 30000;
+
+    // Frames per sendmsg() call (Linux IOV_MAX is 1024)
+    static constexpr size_t MAX_IOV = 64;
+
+    // Inbound traffic capture (optional; set before start())
+    std::shared_ptr<PacketCapture> capture_;
+    uint32_t                       captureSession_ = 0;
+
+    // Received bytes; recv() writes into its tail, frames are views into it (loop thread)
+    InboundBuffer inBuffer_;
+
+    // Play packets awaiting the tick thread. Created by setState(Play) before
+    // the state is published, immutable afterwards.
+    std::unique_ptr<PacketInbox> inbox_;
+    static constexpr size_t INBOX_CAPACITY = 2048;
+
+    // Protocol encryption (loop thread). Outbound frames are encrypted in queue
+    // order into cipherOut_, which is then written with plain send() calls.
+    std::unique_ptr<AesCfb8> decryptor_;
+    std::unique_ptr<AesCfb8> encryptor_;
+    std::atomic<bool>        encrypted_{false};
+    std::vector<uint8_t>     cipherOut_;
+    size_t                   cipherOffset_ = 0;   // bytes of cipherOut_ already sent
+    uint64_t                 cipherFrames_ = 0;   // frames held in cipherOut_
+    static constexpr size_t  CIPHER_SHRINK_THRESHOLD = 262144;
 
-    // Read buffer
+    // Minimum free space offered to each recv() call
     static constexpr size_t READ_BUF_SIZE = 8192;
 };
 
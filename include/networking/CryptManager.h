@@ -0,0 +1,78 @@
+/**
+ * CryptManager.h — RSA key pair, shared-secret decryption and server hash
+ * for the online-mode login handshake.
+ *
+ * Java reference: net.minecraft.util.CryptManager
+ *   - createNewKeyPair()          → 1024-bit RSA
+ *   - decryptSharedKey()/decryptData() → RSA/ECB/PKCS1Padding
+ *   - getServerIdHash()           → SHA-1(serverId + secret + public key)
+ *
+ * Backed by OpenSSL libcrypto. The stream cipher itself is AesCfb8.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct evp_pkey_st; // OpenSSL EVP_PKEY
+
+namespace mccpp {
+
+/**
+ * ServerKeyPair — the server's RSA key pair, created once at startup.
+ *
+ * Thread safety: immutable after generate(); decrypt() may be called from
+ * any thread.
+ */
+class ServerKeyPair {
+public:
+    static constexpr int KEY_BITS = 1024;
+
+    /**
+     * Java: CryptManager.createNewKeyPair(). Returns nullptr on failure.
+     */
+    static std::unique_ptr<ServerKeyPair> generate();
+
+    ~ServerKeyPair();
+
+    ServerKeyPair(const ServerKeyPair&) = delete;
+    ServerKeyPair& operator=(const ServerKeyPair&) = delete;
+
+    /**
+     * X.509 SubjectPublicKeyInfo (DER), as sent in S01PacketEncryptionRequest.
+     */
+    const std::vector<uint8_t>& getPublicKeyDer() const { return publicKeyDer_; }
+
+    /**
+     * RSA/ECB/PKCS1Padding decryption. Returns false on a malformed block.
+     */
+    bool decrypt(const uint8_t* data, size_t length, std::vector<uint8_t>& out) const;
+
+private:
+    explicit ServerKeyPair(evp_pkey_st* key);
+
+    evp_pkey_st* key_;
+    std::vector<uint8_t> publicKeyDer_;
+};
+
+namespace CryptManager {
+
+    /**
+     * Fill `out` with cryptographically secure random bytes.
+     */
+    bool randomBytes(uint8_t* out, size_t length);
+
+    /**
+     * Java: new BigInteger(CryptManager.getServerIdHash(serverId, publicKey, secret)).toString(16)
+     * SHA-1 digest printed as a signed two's-complement number in hex.
+     */
+    std::string serverIdHash(const std::string& serverId,
+                             const uint8_t* sharedSecret, size_t secretLength,
+                             const std::vector<uint8_t>& publicKeyDer);
+
+} // namespace CryptManager
+
+} // namespace mccpp
@@ -0,0 +1,111 @@
+/**
+ * DeflateEngine.h — Raw deflate compressors for chunk packets.
+ *
+ * Java reference: java.util.zip.Deflater, as used by S21PacketChunkData and
+ * S26PacketMapChunkBulk (a new Deflater(-1) per packet, default level).
+ *
+ * Backends:
+ *   - Zlib: zlib's deflate, levels 1-9 (6 = the vanilla default).
+ *   - Fast: the in-tree compressor (DeflateEngine.cpp). Greedy LZ77 over a
+ *     hash-chained 32K window, emitted as one fixed-Huffman block: no
+ *     Huffman tree construction, no lazy matching. Levels 1-9 set the hash
+ *     chain depth. Chunk data is long runs of a few byte values, which fixed
+ *     codes handle nearly as well as dynamic ones at a fraction of the cost.
+ *
+ * Engines produce raw deflate only; ChunkSerializer adds the zlib header and
+ * Adler-32 trailer (which lets it splice cached segments, see
+ * ChunkPayloadCache.h). An engine keeps its compression state (zlib stream,
+ * hash tables) between calls instead of allocating it per packet.
+ *
+ * DeflatePolicy picks backend and level; with level AUTO the level drops as
+ * server load rises, trading bandwidth for CPU.
+ *
+ * Thread safety: an engine is single-threaded; forThread() hands each thread
+ * its own, created on first use and kept for the thread's lifetime.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mccpp {
+
+enum class DeflateBackend : uint8_t {
+    Zlib,
+    Fast,
+};
+
+const char* deflateBackendName(DeflateBackend backend);
+
+/**
+ * "zlib" or "fast"; false if `name` is neither.
+ */
+bool parseDeflateBackend(const std::string& name, DeflateBackend& out);
+
+class DeflateEngine {
+public:
+    static constexpr int MIN_LEVEL = 1;
+    static constexpr int MAX_LEVEL = 9;
+    static constexpr int DEFAULT_LEVEL = 6;
+
+    virtual ~DeflateEngine() = default;
+
+    /**
+     * The calling thread's engine for `backend`.
+     */
+    static DeflateEngine& forThread(DeflateBackend backend);
+
+    virtual DeflateBackend getBackend() const = 0;
+
+    /**
+     * Largest output compress() can produce for `rawLen` input bytes.
+     */
+    virtual size_t bound(size_t rawLen) = 0;
+
+    /**
+     * Raw deflate `raw` into `out`, which must hold bound(rawLen) bytes, at
+     * `level` (clamped to 1-9). With `finish` the last block is final;
+     * otherwise the output ends byte-aligned after a sync flush (an empty
+     * stored block) so more deflate data may follow it. The output never
+     * refers back to data from earlier calls. Returns the bytes written.
+     */
+    virtual size_t compress(const uint8_t* raw, size_t rawLen, uint8_t* out,
+                            int level, bool finish) = 0;
+};
+
+/**
+ * What to compress one packet with.
+ */
+struct DeflateSettings {
+    DeflateBackend backend = DeflateBackend::Zlib;
+    int            level   = DeflateEngine::DEFAULT_LEVEL;
+};
+
+/**
+ * Backend and level for chunk packets.
+ */
+struct DeflatePolicy {
+    static constexpr int AUTO = 0;
+
+    DeflateBackend backend = DeflateBackend::Zlib;
+    int            level   = AUTO;   // 1-9, or AUTO
+
+    /**
+     * The settings to use under `pressure` — 0 when idle, 1 or more when the
+     * tick budget is used up or the compressors are falling behind. AUTO
+     * steps from the default level at rest down to 1 under full load.
+     */
+    DeflateSettings settingsFor(double pressure) const {
+        DeflateSettings settings;
+        settings.backend = backend;
+        if (level != AUTO) settings.level = level;
+        else if (pressure < 0.25) settings.level = DeflateEngine::DEFAULT_LEVEL;
+        else if (pressure < 0.50) settings.level = 4;
+        else if (pressure < 0.75) settings.level = 2;
+        else settings.level = DeflateEngine::MIN_LEVEL;
+        return settings;
+    }
+};
+
+} // namespace mccpp
@@ -0,0 +1,160 @@
+/**
+ * InboundBuffer.h — Receive buffer and zero-copy VarInt frame decoder.
+ *
+ * Java reference: net.minecraft.util.MessageDeserializer2 (the Netty
+ * ByteToMessageDecoder that splits the stream on VarInt length prefixes).
+ *
+ * recv() writes straight into the buffer's free tail; complete frames are
+ * handed out as non-owning views into the buffer and the read cursor simply
+ * advances past them. Bytes only move when the free tail runs out, and then
+ * only the trailing partial frame is moved to the front, so the cost per
+ * received byte is constant no matter how many packets a client pipelines.
+ *
+ * Header-only. Thread safety: single owner (the connection's event loop).
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace mccpp {
+
+/**
+ * A complete packet frame inside an InboundBuffer (length prefix stripped).
+ * Valid until the next prepareWrite() on the buffer it came from.
+ */
+struct FrameView {
+    const uint8_t* data = nullptr;   // VarInt packetId + payload
+    size_t         length = 0;
+};
+
+enum class FrameStatus : uint8_t {
+    Complete,      // `out` holds a frame; the read cursor moved past it
+    NeedMore,      // prefix or body incomplete
+    BadLength,     // length prefix longer than 3 bytes (21 bits) or negative
+    TooLarge,      // frame exceeds MAX_FRAME_LENGTH
+    Empty,         // zero-length frame (no packet ID)
+};
+
+class InboundBuffer {
+public:
+    static constexpr size_t MAX_FRAME_LENGTH = 2097152;   // 2 MiB
+    static constexpr size_t DEFAULT_CAPACITY = 16384;
+    static constexpr size_t SHRINK_THRESHOLD = 65536;
+
+    explicit InboundBuffer(size_t initialCapacity = DEFAULT_CAPACITY)
+        : storage_(new uint8_t[initialCapacity])
+        , capacity_(initialCapacity)
+        , initialCapacity_(initialCapacity) {}
+
+    InboundBuffer(const InboundBuffer&) = delete;
+    InboundBuffer& operator=(const InboundBuffer&) = delete;
+
+    /**
+     * Make at least `minSpace` bytes writable at the tail and return a pointer
+     * to them. Moves the unread bytes to the front and/or grows the storage
+     * only when the tail is too small. Invalidates outstanding FrameViews.
+     */
+    uint8_t* prepareWrite(size_t minSpace) {
+        if (capacity_ - writePos_ >= minSpace) return storage_.get() + writePos_;
+
+        size_t readable = readableBytes();
+        if (readable == 0) {
+            readPos_ = writePos_ = 0;
+            if (capacity_ >= minSpace) return storage_.get();
+        }
+
+        if (capacity_ - readable >= minSpace) {
+            // Compact: only the trailing partial frame is ever moved.
+            std::memmove(storage_.get(), storage_.get() + readPos_, readable);
+        } else {
+            size_t newCapacity = capacity_ * 2;
+            while (newCapacity - readable < minSpace) newCapacity *= 2;
+            std::unique_ptr<uint8_t[]> grown(new uint8_t[newCapacity]);
+            std::memcpy(grown.get(), storage_.get() + readPos_, readable);
+            storage_ = std::move(grown);
+            capacity_ = newCapacity;
+        }
+        readPos_ = 0;
+        writePos_ = readable;
+        return storage_.get() + writePos_;
+    }
+
+    size_t writableBytes() const { return capacity_ - writePos_; }
+
+    /**
+     * Commit `n` bytes written into the region returned by prepareWrite().
+     */
+    void commitWrite(size_t n) { writePos_ += n; }
+
+    /**
+     * Append a copy of `len` bytes (for callers that do not recv() in place).
+     */
+    void append(const uint8_t* src, size_t len) {
+        std::memcpy(prepareWrite(len), src, len);
+        commitWrite(len);
+    }
+
+    /**
+     * Decode the next frame. On Complete, `out` views the frame body and the
+     * read cursor is advanced past it; no bytes are copied.
+     */
+    FrameStatus nextFrame(FrameView& out) {
+        const uint8_t* p = storage_.get() + readPos_;
+        size_t available = readableBytes();
+
+        // VarInt length prefix, at most 3 bytes (MessageDeserializer2 limit)
+        uint32_t length = 0;
+        size_t prefix = 0;
+        for (;;) {
+            if (prefix == available) return FrameStatus::NeedMore;
+            if (prefix == 3) return FrameStatus::BadLength;
+            uint8_t byte = p[prefix];
+            length |= static_cast<uint32_t>(byte & 0x7F) << (7 * prefix);
+            ++prefix;
+            if ((byte & 0x80) == 0) break;
+        }
+
+        if (length > MAX_FRAME_LENGTH) return FrameStatus::TooLarge;
+        if (available - prefix < length) return FrameStatus::NeedMore;
+        if (length == 0) return FrameStatus::Empty;
+
+        out.data = p + prefix;
+        out.length = length;
+        readPos_ += prefix + length;
+        return FrameStatus::Complete;
+    }
+
+    /**
+     * Reset cursors once everything has been consumed, and hand oversized
+     * storage (left behind by a large frame) back to the allocator.
+     */
+    void compactIfDrained() {
+        if (readPos_ != writePos_) return;
+        readPos_ = writePos_ = 0;
+        if (capacity_ > SHRINK_THRESHOLD && capacity_ > initialCapacity_) {
+            storage_.reset(new uint8_t[initialCapacity_]);
+            capacity_ = initialCapacity_;
+        }
+    }
+
+    /**
+     * Unconsumed bytes, for in-place transforms (e.g. decrypting what was
+     * received past the frame that switched encryption on).
+     */
+    uint8_t* readableData() { return storage_.get() + readPos_; }
+
+    size_t readableBytes() const { return writePos_ - readPos_; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    std::unique_ptr<uint8_t[]> storage_;
+    size_t capacity_;
+    size_t initialCapacity_;
+    size_t readPos_ = 0;
+    size_t writePos_ = 0;
+};
+
+} // namespace mccpp
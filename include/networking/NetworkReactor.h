@@ -0,0 +1,173 @@
+/**
+ * NetworkReactor.h — epoll-driven event loops for client connections.
+ *
+ * Reference: net.minecraft.network.NetworkSystem — the Netty NioEventLoopGroup
+ * ("Netty Server IO #n") that every NetworkManager channel is registered on.
+ *
+ * C++ adaptation: a small fixed pool of event-loop threads. Each loop owns an
+ * edge-triggered epoll instance and the set of non-blocking sockets assigned
+ * to it. A connection's socket is only ever read, written and closed on its
+ * owning loop thread; other threads (tick thread, other loops) reach it by
+ * posting a task to the loop, which is woken through an eventfd.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mccpp {
+
+class Connection; // forward decl
+
+/**
+ * Cumulative outbound write counters, summed over event loops.
+ * Sampled once per tick by the server to report syscalls/tick and bytes/syscall.
+ */
+struct NetworkWriteStats {
+    uint64_t syscalls = 0;   // sendmsg() calls that wrote data
+    uint64_t bytes    = 0;   // bytes accepted by the kernel
+    uint64_t frames   = 0;   // complete packet frames retired
+    uint64_t flushes  = 0;   // flush passes run (scheduled or EPOLLOUT-driven)
+};
+
+/**
+ * EventLoop — one network thread driving many connections.
+ *
+ * Java reference: io.netty.channel.nio.NioEventLoop
+ *
+ * Thread safety: attach(), scheduleFlush() and scheduleClose() may be called
+ * from any thread. Everything else runs on the loop thread.
+ */
+class EventLoop {
+public:
+    explicit EventLoop(int index);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * Create the epoll/eventfd descriptors and spawn the loop thread.
+     */
+    bool start();
+
+    /**
+     * Close every owned connection and join the loop thread.
+     */
+    void stop();
+
+    /**
+     * Register a connection's socket with this loop (edge-triggered).
+     */
+    void attach(std::shared_ptr<Connection> conn);
+
+    /**
+     * Ask the loop to drain the connection's outbound queue.
+     */
+    void scheduleFlush(std::shared_ptr<Connection> conn);
+
+    /**
+     * Ask the loop to flush what it can and close the connection's socket.
+     */
+    void scheduleClose(std::shared_ptr<Connection> conn);
+
+    /**
+     * Account one successful sendmsg() call. Loop thread only.
+     */
+    void recordWrite(uint64_t bytes, uint64_t frames) {
+        writeSyscalls_.fetch_add(1, std::memory_order_relaxed);
+        bytesWritten_.fetch_add(bytes, std::memory_order_relaxed);
+        framesWritten_.fetch_add(frames, std::memory_order_relaxed);
+    }
+
+    NetworkWriteStats getWriteStats() const;
+
+    bool inLoopThread() const { return std::this_thread::get_id() == threadId_.load(); }
+
+    size_t connectionCount() const { return connectionCount_.load(std::memory_order_relaxed); }
+    int getIndex() const { return index_; }
+
+private:
+    enum class TaskType : uint8_t { Attach, Flush, Close };
+
+    struct Task {
+        TaskType type;
+        std::shared_ptr<Connection> conn;
+    };
+
+    void run();
+    void post(TaskType type, std::shared_ptr<Connection> conn);
+    void runPendingTasks();
+    void registerConnection(const std::shared_ptr<Connection>& conn);
+    void closeConnection(Connection* conn);
+
+    int index_;
+    int epollFd_ = -1;
+    int wakeFd_  = -1;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    std::atomic<std::thread::id> threadId_{};
+
+    // Cross-thread task queue (mutex-protected, eventfd wakeup)
+    std::mutex tasksMutex_;
+    std::vector<Task> tasks_;
+    std::atomic<bool> wakePending_{false};
+
+    // Loop-thread state
+    std::unordered_map<Connection*, std::shared_ptr<Connection>> connections_;
+    std::vector<Connection*> closing_;
+    std::atomic<size_t> connectionCount_{0};
+
+    // Write counters (written by the loop thread, read by anyone)
+    std::atomic<uint64_t> writeSyscalls_{0};
+    std::atomic<uint64_t> bytesWritten_{0};
+    std::atomic<uint64_t> framesWritten_{0};
+    std::atomic<uint64_t> flushes_{0};
+};
+
+/**
+ * NetworkReactor — fixed pool of EventLoops.
+ *
+ * Java reference: NetworkSystem.eventLoops (LazyLoadBase<NioEventLoopGroup>)
+ *
+ * New connections are assigned to the loop with the fewest connections.
+ */
+class NetworkReactor {
+public:
+    /**
+     * Default pool size: a quarter of the hardware threads, between 1 and 4.
+     */
+    static int defaultThreadCount();
+
+    explicit NetworkReactor(int threadCount);
+    ~NetworkReactor();
+
+    NetworkReactor(const NetworkReactor&) = delete;
+    NetworkReactor& operator=(const NetworkReactor&) = delete;
+
+    bool start();
+    void stop();
+
+    /**
+     * Pick the least-loaded loop for a new connection.
+     */
+    EventLoop& nextLoop();
+
+    /**
+     * Sum of the write counters of every loop.
+     */
+    NetworkWriteStats getWriteStats() const;
+
+    size_t getThreadCount() const { return loops_.size(); }
+
+private:
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+};
+
+} // namespace mccpp
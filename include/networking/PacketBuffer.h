@@ -0,0 +1,226 @@
+/**
+ * PacketBuffer.h — Pooled, pre-framed outbound packet buffer.
+ *
+ * Java reference: net.minecraft.util.MessageSerializer (encodes the packet
+ * into a pooled ByteBuf) + MessageSerializer2 (prepends the VarInt length).
+ *
+ * A PacketBuffer keeps HEADROOM bytes free in front of the packet body. The
+ * body (VarInt packetId + payload) is written exactly once; finishFrame() then
+ * writes the VarInt length backwards into the headroom, so the complete frame
+ * is contiguous in the same block and is handed to sendmsg() as-is.
+ *
+ * Blocks come from PacketBufferPool and go back to it when the buffer is
+ * destroyed — normally on the event loop, right after the socket write has
+ * retired the frame.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace mccpp {
+
+/**
+ * Cumulative pool counters (all threads).
+ */
+struct PacketPoolStats {
+    uint64_t acquired  = 0;   // blocks handed out
+    uint64_t reused    = 0;   // ... of which came from a free list
+    uint64_t released  = 0;   // blocks returned to a free list
+    uint64_t discarded = 0;   // blocks freed (unpooled size or free lists full)
+};
+
+/**
+ * PacketBufferPool — size-classed free lists of raw byte blocks.
+ *
+ * Each thread keeps its own free lists, so acquire/release are lock-free in
+ * the common case. Because packets are built on the tick thread and freed on
+ * the event loops, a thread whose list overflows hands half of it to a shared
+ * depot, and a thread whose list is empty refills from the depot.
+ */
+class PacketBufferPool {
+public:
+    // Pooled block sizes; larger requests are allocated exactly and freed on release.
+    static constexpr size_t SIZE_CLASSES = 4;
+    static constexpr size_t CLASS_SIZES[SIZE_CLASSES] = { 256, 4096, 65536, 1048576 };
+
+    /**
+     * Get a block of at least `minCapacity` bytes; `capacity` receives its real size.
+     */
+    static std::unique_ptr<uint8_t[]> acquire(size_t minCapacity, size_t& capacity);
+
+    /**
+     * Return a block obtained from acquire() (with the capacity it reported).
+     */
+    static void release(std::unique_ptr<uint8_t[]> block, size_t capacity);
+
+    static PacketPoolStats getStats();
+};
+
+/**
+ * PacketBuffer — one outbound packet, written in place and framed in place.
+ *
+ * Move-only. Not thread-safe: built by one thread, then handed over whole
+ * (Connection::sendPacket) to the thread that writes and frees it.
+ */
+class PacketBuffer {
+public:
+    // Vanilla caps the frame length prefix at 3 VarInt bytes (MessageSerializer2).
+    static constexpr size_t HEADROOM = 3;
+    static constexpr size_t MAX_BODY_LENGTH = (1u << 21) - 1;
+
+    PacketBuffer() = default;
+
+    /**
+     * Take a pooled block with room for at least `bodyHint` body bytes.
+     */
+    static PacketBuffer acquire(size_t bodyHint = 128) {
+        PacketBuffer buf;
+        buf.block_ = PacketBufferPool::acquire(bodyHint + HEADROOM, buf.capacity_);
+        buf.size_ = buf.begin_ = HEADROOM;
+        return buf;
+    }
+
+    ~PacketBuffer() { releaseBlock(); }
+
+    PacketBuffer(PacketBuffer&& other) noexcept { *this = std::move(other); }
+
+    PacketBuffer& operator=(PacketBuffer&& other) noexcept {
+        if (this != &other) {
+            releaseBlock();
+            block_ = std::move(other.block_);
+            capacity_ = other.capacity_;
+            size_ = other.size_;
+            begin_ = other.begin_;
+            framed_ = other.framed_;
+            other.capacity_ = other.size_ = other.begin_ = 0;
+            other.framed_ = false;
+        }
+        return *this;
+    }
+
+    PacketBuffer(const PacketBuffer&) = delete;
+    PacketBuffer& operator=(const PacketBuffer&) = delete;
+
+    // ─── Body writes (before finishFrame) ───
+
+    void put(uint8_t byte) {
+        if (size_ == capacity_) reserveBody(bodySize() + 1);
+        block_[size_++] = byte;
+    }
+
+    void append(const uint8_t* src, size_t len) {
+        std::memcpy(prepareWrite(len), src, len);
+        size_ += len;
+    }
+
+    /**
+     * Make `maxBytes` writable at the end of the body and return a pointer to
+     * them; commitWrite() then keeps the bytes actually produced. Lets encoders
+     * such as deflate write straight into the packet.
+     */
+    uint8_t* prepareWrite(size_t maxBytes) {
+        if (capacity_ - size_ < maxBytes) reserveBody(bodySize() + maxBytes);
+        return block_.get() + size_;
+    }
+
+    void commitWrite(size_t n) { size_ += n; }
+
+    uint8_t* body() { return block_.get() + HEADROOM; }
+    size_t bodySize() const { return size_ > HEADROOM ? size_ - HEADROOM : 0; }
+
+    /**
+     * Ensure capacity for `bodyLength` body bytes. Growth moves to a block of
+     * the next size class and returns the old one to the pool.
+     */
+    void reserveBody(size_t bodyLength) {
+        size_t needed = bodyLength + HEADROOM;
+        if (needed <= capacity_) return;
+        size_t target = capacity_ * 2 > needed ? capacity_ * 2 : needed;
+        size_t newCapacity;
+        auto grown = PacketBufferPool::acquire(target, newCapacity);
+        if (block_) std::memcpy(grown.get(), block_.get(), size_);
+        else size_ = begin_ = HEADROOM;
+        releaseBlock();
+        block_ = std::move(grown);
+        capacity_ = newCapacity;
+    }
+
+    // ─── Framing ───
+
+    /**
+     * Write the VarInt body length into the headroom. Idempotent.
+     * Java: MessageSerializer2 — throws if the length needs more than 3 bytes.
+     */
+    void finishFrame() {
+        if (framed_) return;
+        if (!block_) reserveBody(0);
+        size_t length = bodySize();
+        if (length > MAX_BODY_LENGTH) {
+            throw std::length_error("Packet too large: " + std::to_string(length) + " bytes");
+        }
+        uint8_t prefix[HEADROOM];
+        size_t prefixLen = 0;
+        do {
+            uint8_t byte = static_cast<uint8_t>(length & 0x7F);
+            length >>= 7;
+            if (length != 0) byte |= 0x80;
+            prefix[prefixLen++] = byte;
+        } while (length != 0);
+        begin_ = HEADROOM - prefixLen;
+        std::memcpy(block_.get() + begin_, prefix, prefixLen);
+        framed_ = true;
+    }
+
+    /**
+     * For a body made of complete frames appended back to back (a per-player
+     * batch): send it as it is, without a length prefix of its own.
+     * Idempotent. The connection counts each frame in PacketStats and queues
+     * the buffer in the priority class of its most urgent frame.
+     */
+    void finishFrames() {
+        if (framed_) return;
+        if (!block_) reserveBody(0);
+        begin_ = HEADROOM;
+        framed_ = true;
+    }
+
+    bool isFramed() const { return framed_; }
+
+    // The complete frame ([VarInt length][packetId][payload]); valid after finishFrame().
+    const uint8_t* data() const { return block_.get() + begin_; }
+    size_t size() const { return size_ - begin_; }
+
+private:
+    void releaseBlock() {
+        if (block_) PacketBufferPool::release(std::move(block_), capacity_);
+    }
+
+    std::unique_ptr<uint8_t[]> block_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;      // end of the body
+    size_t begin_ = 0;     // start of the frame once framed
+    bool framed_ = false;
+};
+
+/**
+ * SharedPacket — an immutable, reference-counted frame for broadcasts.
+ *
+ * Java reference: ServerConfigurationManager.sendPacketToAllPlayers() hands
+ * one Packet object to every NetHandlerPlayServer.
+ *
+ * Serialized once and queued on any number of connections without copying;
+ * the block returns to the pool when the last connection has written it.
+ */
+using SharedPacket = std::shared_ptr<const PacketBuffer>;
+
+inline SharedPacket sharePacket(PacketBuffer packet) {
+    packet.finishFrame();
+    return std::make_shared<const PacketBuffer>(std::move(packet));
+}
+
+} // namespace mccpp
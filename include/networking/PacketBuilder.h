@@ -19,14 +19,22 @@
  *   - net.minecraft.network.play.server.S09PacketHeldItemChange
  *
  * All methods write big-endian, VarInt-prefixed packets matching the
- * exact wire format of 1.7.10 protocol version 5.
+ * exact wire format of 1.7.10 protocol version 5, into pooled PacketBuffers
+ * that are framed in place and can be passed straight to Connection::sendPacket().
+ * Fixed-layout builders are generated from their field list (PacketEncoder),
+ * so the exact size is known before the buffer is taken; PacketWriter stays
+ * for packets assembled piecewise (chunk data, plugin payloads).
  *
  * Thread safety: Stateless builders — each returns an independent buffer.
  */
 #pragma once
 
+#include "PacketBuffer.h"
+#include "PacketSchema.h"
 #include "PlayPackets.h"
+#include "types/ByteOrder.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
@@ -37,365 +45,358 @@ namespace mccpp {
 
 // ═══════════════════════════════════════════════════════════════════════════
 // PacketWriter — Low-level binary writer for building packet payloads.
-// Writes big-endian, matching Java's DataOutputStream.
+// Writes big-endian, matching Java's DataOutputStream, directly into a
+// pooled PacketBuffer behind the space reserved for the length prefix.
 // ═══════════════════════════════════════════════════════════════════════════
 
 class PacketWriter {
 public:
-    PacketWriter() { buf_.reserve(128); }
-    explicit PacketWriter(int32_t packetId) { buf_.reserve(128); writeVarInt(packetId); }
+    PacketWriter() : buf_(PacketBuffer::acquire()) {}
 
-    // ─── Primitive writes ───
-
-    void writeByte(int8_t v) { buf_.push_back(static_cast<uint8_t>(v)); }
-    void writeUByte(uint8_t v) { buf_.push_back(v); }
+    /**
+     * @param sizeHint  Expected body size; picks the pooled block up front so
+     *                  large packets (chunks) are not regrown while writing.
+     */
+    explicit PacketWriter(int32_t packetId, size_t sizeHint = 128)
+        : buf_(PacketBuffer::acquire(sizeHint)) { writeVarInt(packetId); }
 
-    void writeBool(bool v) { buf_.push_back(v ? 1 : 0); }
-
-    void writeShort(int16_t v) {
-        buf_.push_back(static_cast<uint8_t>((v >> 8) & 0xFF));
-        buf_.push_back(static_cast<uint8_t>(v & 0xFF));
-    }
-
-    void writeInt(int32_t v) {
-        buf_.push_back(static_cast<uint8_t>((v >> 24) & 0xFF));
-        buf_.push_back(static_cast<uint8_t>((v >> 16) & 0xFF));
-        buf_.push_back(static_cast<uint8_t>((v >> 8) & 0xFF));
-        buf_.push_back(static_cast<uint8_t>(v & 0xFF));
-    }
+    // ─── Primitive writes ───
 
-    void writeLong(int64_t v) {
-        for (int i = 56; i >= 0; i -= 8) {
-            buf_.push_back(static_cast<uint8_t>((v >> i) & 0xFF));
-        }
-    }
+    void writeByte(int8_t v) { buf_.put(static_cast<uint8_t>(v)); }
+    void writeUByte(uint8_t v) { buf_.put(v); }
 
-    void writeFloat(float v) {
-        uint32_t bits;
-        std::memcpy(&bits, &v, sizeof(bits));
-        writeInt(static_cast<int32_t>(bits));
-    }
+    void writeBool(bool v) { buf_.put(v ? 1 : 0); }
 
-    void writeDouble(double v) {
-        uint64_t bits;
-        std::memcpy(&bits, &v, sizeof(bits));
-        writeLong(static_cast<int64_t>(bits));
-    }
+    void writeShort(int16_t v) { writeBigEndian(v); }
+    void writeInt(int32_t v) { writeBigEndian(v); }
+    void writeLong(int64_t v) { writeBigEndian(v); }
+    void writeFloat(float v) { writeBigEndian(v); }
+    void writeDouble(double v) { writeBigEndian(v); }
 
     void writeVarInt(int32_t value) {
         uint32_t uv = static_cast<uint32_t>(value);
         while (uv >= 0x80) {
-            buf_.push_back(static_cast<uint8_t>(uv & 0x7F) | 0x80);
+            buf_.put(static_cast<uint8_t>(uv & 0x7F) | 0x80);
             uv >>= 7;
         }
-        buf_.push_back(static_cast<uint8_t>(uv));
+        buf_.put(static_cast<uint8_t>(uv));
     }
 
     void writeString(const std::string& s) {
         writeVarInt(static_cast<int32_t>(s.size()));
-        buf_.insert(buf_.end(), s.begin(), s.end());
+        buf_.append(reinterpret_cast<const uint8_t*>(s.data()), s.size());
     }
 
     void writeBytes(const uint8_t* data, size_t len) {
-        buf_.insert(buf_.end(), data, data + len);
+        buf_.append(data, len);
     }
 
     void writeBytes(const std::vector<uint8_t>& data) {
-        buf_.insert(buf_.end(), data.begin(), data.end());
+        buf_.append(data.data(), data.size());
     }
 
     // ─── Angle (rotation in 256ths of a circle) ───
     void writeAngle(float degrees) {
-        buf_.push_back(static_cast<uint8_t>(static_cast<int32_t>(degrees * 256.0f / 360.0f) & 0xFF));
+        wire::Angle::store(buf_.prepareWrite(1), degrees);
+        buf_.commitWrite(1);
     }
 
     // ─── Fixed-point position (1/32 of a block = multiply by 32) ───
     void writeFixedPoint(double v) {
-        writeInt(static_cast<int32_t>(std::floor(v * 32.0)));
+        wire::FixedPoint::store(buf_.prepareWrite(4), v);
+        buf_.commitWrite(4);
     }
 
+    // ─── In-place writes ───
+
+    // Reserve `maxBytes` at the end of the body for an encoder (e.g. deflate)
+    // to fill, then keep the `n` bytes it produced with commitWrite(n).
+    uint8_t* prepareWrite(size_t maxBytes) { return buf_.prepareWrite(maxBytes); }
+    void commitWrite(size_t n) { buf_.commitWrite(n); }
+
+    // Overwrite an int written earlier (a length known only afterwards).
+    void writeIntAt(size_t offset, int32_t v) { storeBigEndian(buf_.body() + offset, v); }
+
     // ─── Access ───
-    const std::vector<uint8_t>& data() const { return buf_; }
-    std::vector<uint8_t>& data() { return buf_; }
-    size_t size() const { return buf_.size(); }
+    const uint8_t* data() { return buf_.body(); }
+    size_t size() const { return buf_.bodySize(); }
 
     // ─── Frame with VarInt length prefix ───
-    // Returns the complete framed packet: [VarInt length][payload]
-    std::vector<uint8_t> toFramed() const {
-        std::vector<uint8_t> framed;
-        framed.reserve(buf_.size() + 5);
-        // Write length as VarInt
-        uint32_t len = static_cast<uint32_t>(buf_.size());
-        while (len >= 0x80) {
-            framed.push_back(static_cast<uint8_t>(len & 0x7F) | 0x80);
-            len >>= 7;
-        }
-        framed.push_back(static_cast<uint8_t>(len));
-        framed.insert(framed.end(), buf_.begin(), buf_.end());
-        return framed;
+    // Writes the length into the buffer's headroom and hands the buffer over:
+    // [VarInt length][packetId][payload], no copy. The writer is empty afterwards.
+    PacketBuffer finish() {
+        buf_.finishFrame();
+        return std::move(buf_);
     }
 
 private:
-    std::vector<uint8_t> buf_;
+    template <typename T>
+    void writeBigEndian(T v) {
+        storeBigEndian(buf_.prepareWrite(sizeof(T)), v);
+        buf_.commitWrite(sizeof(T));
+    }
+
+    PacketBuffer buf_;
 };
 
 // ═══════════════════════════════════════════════════════════════════════════
 // Clientbound Packet Builders — Static factory methods.
-// Each returns a fully serialized, length-prefixed packet ready to send.
+// Each returns a fully serialized, length-prefixed PacketBuffer ready to send.
 // ═══════════════════════════════════════════════════════════════════════════
 
 namespace PacketBuilder {
 
     // ─── 0x00 Keep Alive ───
-    // Java: S00PacketKeepAlive — VarInt keepAliveId
-    inline std::vector<uint8_t> keepAlive(int32_t keepAliveId) {
-        PacketWriter w(ClientboundPacket::KeepAlive);
-        w.writeVarInt(keepAliveId);
-        return w.toFramed();
+    // Java: S00PacketKeepAlive — Int keepAliveId (VarInt only from 1.8)
+    inline PacketBuffer keepAlive(int32_t keepAliveId) {
+        return PacketEncoder<ClientboundPacket::KeepAlive, wire::Int>::encode(keepAliveId);
     }
 
     // ─── 0x01 Join Game ───
     // Java: S01PacketJoinGame
-    inline std::vector<uint8_t> joinGame(int32_t entityId, uint8_t gamemode, int8_t dimension,
+    // Entity ID, gamemode (0=survival, 1=creative, 2=adventure, bit 3=hardcore),
+    // dimension (-1=nether, 0=overworld, 1=end), difficulty (0-3), max players
+    // (tab list), level type ("default", "flat", "largeBiomes", "amplified")
+    inline PacketBuffer joinGame(int32_t entityId, uint8_t gamemode, int8_t dimension,
                                           uint8_t difficulty, uint8_t maxPlayers,
                                           const std::string& levelType) {
-        PacketWriter w(ClientboundPacket::JoinGame);
-        w.writeInt(entityId);       // Entity ID
-        w.writeUByte(gamemode);     // Gamemode (0=survival, 1=creative, 2=adventure, bit 3=hardcore)
-        w.writeByte(dimension);     // Dimension (-1=nether, 0=overworld, 1=end)
-        w.writeUByte(difficulty);   // Difficulty (0-3)
-        w.writeUByte(maxPlayers);   // Max players (used for tab list)
-        w.writeString(levelType);   // Level type ("default", "flat", "largeBiomes", "amplified")
-        return w.toFramed();
+        return PacketEncoder<ClientboundPacket::JoinGame,
+            wire::Int, wire::UByte, wire::Byte, wire::UByte, wire::UByte, wire::String<>>
+            ::encode(entityId, gamemode, dimension, difficulty, maxPlayers, levelType);
     }
 
     // ─── 0x02 Chat Message ───
     // Java: S02PacketChat — JSON chat component
-    inline std::vector<uint8_t> chatMessage(const std::string& jsonText) {
-        PacketWriter w(ClientboundPacket::ChatMessage);
-        w.writeString(jsonText);
-        return w.toFramed();
+    inline PacketBuffer chatMessage(const std::string& jsonText) {
+        return PacketEncoder<ClientboundPacket::ChatMessage, wire::String<>>::encode(jsonText);
     }
 
     // ─── 0x03 Time Update ───
     // Java: S03PacketTimeUpdate
-    inline std::vector<uint8_t> timeUpdate(int64_t worldAge, int64_t timeOfDay) {
-        PacketWriter w(ClientboundPacket::TimeUpdate);
-        w.writeLong(worldAge);
-        w.writeLong(timeOfDay);
-        return w.toFramed();
+    inline PacketBuffer timeUpdate(int64_t worldAge, int64_t timeOfDay) {
+        return PacketEncoder<ClientboundPacket::TimeUpdate, wire::Long, wire::Long>
+            ::encode(worldAge, timeOfDay);
     }
 
     // ─── 0x05 Spawn Position ───
     // Java: S05PacketSpawnPosition
-    inline std::vector<uint8_t> spawnPosition(int32_t x, int32_t y, int32_t z) {
-        PacketWriter w(ClientboundPacket::SpawnPosition);
-        w.writeInt(x);
-        w.writeInt(y);
-        w.writeInt(z);
-        return w.toFramed();
+    inline PacketBuffer spawnPosition(int32_t x, int32_t y, int32_t z) {
+        return PacketEncoder<ClientboundPacket::SpawnPosition, wire::Int, wire::Int, wire::Int>
+            ::encode(x, y, z);
     }
 
     // ─── 0x06 Update Health ───
-    // Java: S06PacketUpdateHealth
-    inline std::vector<uint8_t> updateHealth(float health, int32_t food, float saturation) {
-        PacketWriter w(ClientboundPacket::UpdateHealth);
-        w.writeFloat(health);
-        w.writeVarInt(food);
-        w.writeFloat(saturation);
-        return w.toFramed();
+    // Java: S06PacketUpdateHealth — Float health, Short food, Float saturation
+    inline PacketBuffer updateHealth(float health, int32_t food, float saturation) {
+        return PacketEncoder<ClientboundPacket::UpdateHealth, wire::Float, wire::Short, wire::Float>
+            ::encode(health, static_cast<int16_t>(food), saturation);
     }
 
     // ─── 0x07 Respawn ───
     // Java: S07PacketRespawn
-    inline std::vector<uint8_t> respawn(int32_t dimension, uint8_t difficulty,
+    inline PacketBuffer respawn(int32_t dimension, uint8_t difficulty,
                                          uint8_t gamemode, const std::string& levelType) {
-        PacketWriter w(ClientboundPacket::Respawn);
-        w.writeInt(dimension);
-        w.writeUByte(difficulty);
-        w.writeUByte(gamemode);
-        w.writeString(levelType);
-        return w.toFramed();
+        return PacketEncoder<ClientboundPacket::Respawn,
+            wire::Int, wire::UByte, wire::UByte, wire::String<>>
+            ::encode(dimension, difficulty, gamemode, levelType);
     }
 
     // ─── 0x08 Player Position And Look ───
     // Java: S08PacketPlayerPosLook
-    inline std::vector<uint8_t> playerPosAndLook(double x, double y, double z,
+    inline PacketBuffer playerPosAndLook(double x, double y, double z,
                                                    float yaw, float pitch, bool onGround) {
-        PacketWriter w(ClientboundPacket::PlayerPosAndLook);
-        w.writeDouble(x);
-        w.writeDouble(y);
-        w.writeDouble(z);
-        w.writeFloat(yaw);
-        w.writeFloat(pitch);
-        w.writeBool(onGround);
-        return w.toFramed();
+        return PacketEncoder<ClientboundPacket::PlayerPosAndLook,
+            wire::Double, wire::Double, wire::Double, wire::Float, wire::Float, wire::Bool>
+            ::encode(x, y, z, yaw, pitch, onGround);
     }
 
     // ─── 0x09 Held Item Change ───
     // Java: S09PacketHeldItemChange
-    inline std::vector<uint8_t> heldItemChange(int8_t slot) {
-        PacketWriter w(ClientboundPacket::HeldItemChange);
-        w.writeByte(slot);
-        return w.toFramed();
+    inline PacketBuffer heldItemChange(int8_t slot) {
+        return PacketEncoder<ClientboundPacket::HeldItemChange, wire::Byte>::encode(slot);
     }
 
     // ─── 0x1F Set Experience ───
-    // Java: S1FPacketSetExperience
-    inline std::vector<uint8_t> setExperience(float experienceBar, int32_t level,
+    // Java: S1FPacketSetExperience — Float bar, Short level, Short total
+    inline PacketBuffer setExperience(float experienceBar, int32_t level,
                                                 int32_t totalExperience) {
-        PacketWriter w(ClientboundPacket::SetExperience);
-        w.writeFloat(experienceBar);
-        w.writeVarInt(level);
-        w.writeVarInt(totalExperience);
-        return w.toFramed();
+        return PacketEncoder<ClientboundPacket::SetExperience, wire::Float, wire::Short, wire::Short>
+            ::encode(experienceBar, static_cast<int16_t>(level), static_cast<int16_t>(totalExperience));
     }
 
     // ─── 0x2B Change Game State ───
     // Java: S2BPacketChangeGameState
     // reason: 1=rain_start, 2=rain_end, 3=gamemode, 4=enter_credits, etc
-    inline std::vector<uint8_t> changeGameState(uint8_t reason, float value) {
-        PacketWriter w(ClientboundPacket::ChangeGameState);
-        w.writeUByte(reason);
-        w.writeFloat(value);
-        return w.toFramed();
+    inline PacketBuffer changeGameState(uint8_t reason, float value) {
+        return PacketEncoder<ClientboundPacket::ChangeGameState, wire::UByte, wire::Float>
+            ::encode(reason, value);
     }
 
     // ─── 0x38 Player List Item ───
     // Java: S38PacketPlayerListItem
     // 1.7.10: string playerName, bool online, short ping
-    inline std::vector<uint8_t> playerListItem(const std::string& playerName,
+    inline PacketBuffer playerListItem(const std::string& playerName,
                                                  bool online, int16_t ping) {
-        PacketWriter w(ClientboundPacket::PlayerListItem);
-        w.writeString(playerName);
-        w.writeBool(online);
-        w.writeShort(ping);
-        return w.toFramed();
+        return PacketEncoder<ClientboundPacket::PlayerListItem, wire::String<>, wire::Bool, wire::Short>
+            ::encode(playerName, online, ping);
     }
 
     // ─── 0x39 Player Abilities ───
     // Java: S39PacketPlayerAbilities
     // flags: bit 0=invulnerable, 1=flying, 2=allowFlying, 3=creativeMode
-    inline std::vector<uint8_t> playerAbilities(uint8_t flags, float flySpeed,
+    inline PacketBuffer playerAbilities(uint8_t flags, float flySpeed,
                                                   float walkSpeed) {
-        PacketWriter w(ClientboundPacket::PlayerAbilities);
-        w.writeUByte(flags);
-        w.writeFloat(flySpeed);
-        w.writeFloat(walkSpeed);
-        return w.toFramed();
+        return PacketEncoder<ClientboundPacket::PlayerAbilities, wire::UByte, wire::Float, wire::Float>
+            ::encode(flags, flySpeed, walkSpeed);
+    }
+
+    // ─── 0x3F Plugin Message ───
+    // Java: S3FPacketCustomPayload — String channel, Short length, Byte[] data
+    inline PacketBuffer pluginMessage(const std::string& channel, const uint8_t* data, size_t length) {
+        PacketWriter w(ClientboundPacket::PluginMessage, channel.size() + length + 8);
+        w.writeString(channel);
+        w.writeShort(static_cast<int16_t>(length));
+        w.writeBytes(data, length);
+        return w.finish();
     }
 
     // ─── 0x40 Disconnect ───
     // Java: S40PacketDisconnect — JSON reason
-    inline std::vector<uint8_t> disconnect(const std::string& jsonReason) {
-        PacketWriter w(ClientboundPacket::Disconnect);
-        w.writeString(jsonReason);
-        return w.toFramed();
+    inline PacketBuffer disconnect(const std::string& jsonReason) {
+        return PacketEncoder<ClientboundPacket::Disconnect, wire::String<>>::encode(jsonReason);
     }
 
     // ─── 0x13 Destroy Entities ───
-    // Java: S13PacketDestroyEntities
-    inline std::vector<uint8_t> destroyEntities(const std::vector<int32_t>& entityIds) {
-        PacketWriter w(ClientboundPacket::DestroyEntities);
-        w.writeVarInt(static_cast<int32_t>(entityIds.size()));
-        for (int32_t id : entityIds) {
-            w.writeVarInt(id);
-        }
-        return w.toFramed();
+    // Java: S13PacketDestroyEntities — Byte count, Int[] entity IDs
+    inline PacketBuffer destroyEntities(const std::vector<int32_t>& entityIds) {
+        return PacketEncoder<ClientboundPacket::DestroyEntities, wire::Array<wire::Byte, wire::Int>>
+            ::encode(entityIds);
     }
 
     // ─── 0x12 Entity Velocity ───
     // Java: S12PacketEntityVelocity
     // velocity = clamped to [-3.9, 3.9], sent as short = (int)(v * 8000)
-    inline std::vector<uint8_t> entityVelocity(int32_t entityId, double vx, double vy, double vz) {
-        PacketWriter w(ClientboundPacket::EntityVelocity);
-        w.writeInt(entityId);
+    inline PacketBuffer entityVelocity(int32_t entityId, double vx, double vy, double vz) {
         auto clamp = [](double v) -> int16_t {
             double c = std::max(-3.9, std::min(3.9, v));
             return static_cast<int16_t>(c * 8000.0);
         };
-        w.writeShort(clamp(vx));
-        w.writeShort(clamp(vy));
-        w.writeShort(clamp(vz));
-        return w.toFramed();
+        return PacketEncoder<ClientboundPacket::EntityVelocity,
+            wire::Int, wire::Short, wire::Short, wire::Short>
+            ::encode(entityId, clamp(vx), clamp(vy), clamp(vz));
+    }
+
+    // ─── 0x15 Entity Relative Move ───
+    // Java: S15PacketEntityRelMove — Int entity ID, Byte dx/dy/dz in 32nds
+    inline PacketBuffer entityRelMove(int32_t entityId, int8_t dx, int8_t dy, int8_t dz) {
+        return PacketEncoder<ClientboundPacket::EntityRelMove,
+            wire::Int, wire::Byte, wire::Byte, wire::Byte>
+            ::encode(entityId, dx, dy, dz);
+    }
+
+    // ─── 0x16 Entity Look ───
+    // Java: S16PacketEntityLook — Int entity ID, Byte yaw/pitch in 256ths of a turn
+    inline PacketBuffer entityLook(int32_t entityId, int8_t yaw, int8_t pitch) {
+        return PacketEncoder<ClientboundPacket::EntityLook, wire::Int, wire::Byte, wire::Byte>
+            ::encode(entityId, yaw, pitch);
+    }
+
+    // ─── 0x17 Entity Look And Relative Move ───
+    // Java: S17PacketEntityLookMove
+    inline PacketBuffer entityLookRelMove(int32_t entityId, int8_t dx, int8_t dy, int8_t dz,
+                                          int8_t yaw, int8_t pitch) {
+        return PacketEncoder<ClientboundPacket::EntityLookAndRelMove,
+            wire::Int, wire::Byte, wire::Byte, wire::Byte, wire::Byte, wire::Byte>
+            ::encode(entityId, dx, dy, dz, yaw, pitch);
     }
 
     // ─── 0x18 Entity Teleport ───
-    // Java: S18PacketEntityTeleport
-    inline std::vector<uint8_t> entityTeleport(int32_t entityId, double x, double y, double z,
+    // Java: S18PacketEntityTeleport — Int entity ID, fixed-point x/y/z, angles
+    inline PacketBuffer entityTeleport(int32_t entityId, double x, double y, double z,
                                                  float yaw, float pitch) {
-        PacketWriter w(ClientboundPacket::EntityTeleport);
-        w.writeVarInt(entityId);
-        w.writeFixedPoint(x);
-        w.writeFixedPoint(y);
-        w.writeFixedPoint(z);
-        w.writeAngle(yaw);
-        w.writeAngle(pitch);
-        return w.toFramed();
+        return PacketEncoder<ClientboundPacket::EntityTeleport,
+            wire::Int, wire::FixedPoint, wire::FixedPoint, wire::FixedPoint, wire::Angle, wire::Angle>
+            ::encode(entityId, x, y, z, yaw, pitch);
+    }
+
+    // Same, from values already in 32nds and 256ths (EntityTrackerEntry)
+    inline PacketBuffer entityTeleportScaled(int32_t entityId, int32_t x, int32_t y, int32_t z,
+                                             int8_t yaw, int8_t pitch) {
+        return PacketEncoder<ClientboundPacket::EntityTeleport,
+            wire::Int, wire::Int, wire::Int, wire::Int, wire::Byte, wire::Byte>
+            ::encode(entityId, x, y, z, yaw, pitch);
     }
 
     // ─── 0x19 Entity Head Look ───
-    // Java: S19PacketEntityHeadLook
-    inline std::vector<uint8_t> entityHeadLook(int32_t entityId, float yaw) {
-        PacketWriter w(ClientboundPacket::EntityHeadLook);
-        w.writeVarInt(entityId);
-        w.writeAngle(yaw);
-        return w.toFramed();
+    // Java: S19PacketEntityHeadLook — Int entity ID, angle
+    inline PacketBuffer entityHeadLook(int32_t entityId, float yaw) {
+        return PacketEncoder<ClientboundPacket::EntityHeadLook, wire::Int, wire::Angle>
+            ::encode(entityId, yaw);
     }
 
     // ─── 0x1A Entity Status ───
     // Java: S19PacketEntityStatus
-    inline std::vector<uint8_t> entityStatus(int32_t entityId, int8_t status) {
-        PacketWriter w(ClientboundPacket::EntityStatus);
-        w.writeInt(entityId);
-        w.writeByte(status);
-        return w.toFramed();
+    inline PacketBuffer entityStatus(int32_t entityId, int8_t status) {
+        return PacketEncoder<ClientboundPacket::EntityStatus, wire::Int, wire::Byte>
+            ::encode(entityId, status);
     }
 
     // ─── 0x23 Block Change ───
     // Java: S23PacketBlockChange
-    inline std::vector<uint8_t> blockChange(int32_t x, uint8_t y, int32_t z,
+    inline PacketBuffer blockChange(int32_t x, uint8_t y, int32_t z,
                                               int32_t blockId, uint8_t metadata) {
-        PacketWriter w(ClientboundPacket::BlockChange);
-        w.writeInt(x);
-        w.writeUByte(y);
-        w.writeInt(z);
-        w.writeVarInt(blockId);
-        w.writeUByte(metadata);
-        return w.toFramed();
+        return PacketEncoder<ClientboundPacket::BlockChange,
+            wire::Int, wire::UByte, wire::Int, wire::VarInt, wire::UByte>
+            ::encode(x, y, z, blockId, metadata);
+    }
+
+    // ─── 0x22 Multi Block Change ───
+    // Java: S22PacketMultiBlockChange — Int chunkX, Int chunkZ, Short count,
+    // Int dataSize, then per block Short (x << 12 | z << 8 | y) and
+    // Short (blockId << 4 | metadata), here packed as one Int per record
+    inline PacketBuffer multiBlockChange(int32_t chunkX, int32_t chunkZ,
+                                         const int32_t* records, size_t count) {
+        PacketWriter w(ClientboundPacket::MultiBlockChange, 14 + count * 4);
+        w.writeInt(chunkX);
+        w.writeInt(chunkZ);
+        w.writeShort(static_cast<int16_t>(count));
+        w.writeInt(static_cast<int32_t>(count * 4));
+        for (size_t i = 0; i < count; ++i) w.writeInt(records[i]);
+        return w.finish();
     }
 
     // ─── 0x28 Effect (world event) ───
     // Java: S28PacketEffect
-    inline std::vector<uint8_t> effect(int32_t effectId, int32_t x, uint8_t y, int32_t z,
+    inline PacketBuffer effect(int32_t effectId, int32_t x, uint8_t y, int32_t z,
                                         int32_t data, bool disableRelativeVolume) {
-        PacketWriter w(ClientboundPacket::Effect);
-        w.writeInt(effectId);
-        w.writeInt(x);
-        w.writeUByte(y);
-        w.writeInt(z);
-        w.writeInt(data);
-        w.writeBool(disableRelativeVolume);
-        return w.toFramed();
+        return PacketEncoder<ClientboundPacket::Effect,
+            wire::Int, wire::Int, wire::UByte, wire::Int, wire::Int, wire::Bool>
+            ::encode(effectId, x, y, z, data, disableRelativeVolume);
     }
 
     // ─── 0x29 Sound Effect ───
-    // Java: S29PacketSoundEffect
-    // position = fixed-point * 8
-    inline std::vector<uint8_t> soundEffect(const std::string& soundName,
+    // Java: S29PacketSoundEffect — position * 8 as Int, Float volume,
+    // pitch * 63 as an unsigned byte (0.5-2.0 → 31-126, clamped to 0-255)
+    inline PacketBuffer soundEffect(const std::string& soundName,
                                               double x, double y, double z,
                                               float volume, float pitch) {
-        PacketWriter w(ClientboundPacket::SoundEffect);
-        w.writeString(soundName);
-        w.writeInt(static_cast<int32_t>(x * 8.0));
-        w.writeInt(static_cast<int32_t>(y * 8.0));
-        w.writeInt(static_cast<int32_t>(z * 8.0));
-        w.writeFloat(volume);
-        // Pitch is sent as unsigned byte * 63 in some implementations,
-        // but 1.7.10 uses float. Clamped to 0.5-2.0, sent as ubyte = pitch*63
-        // Actually in 1.7.10 protocol, pitch is sent as float for sound effect
-        w.writeFloat(pitch);
-        return w.toFramed();
+        int32_t pitchByte = std::max(0, std::min(255, static_cast<int32_t>(pitch * 63.0f)));
+        return PacketEncoder<ClientboundPacket::SoundEffect,
+            wire::String<>, wire::Int, wire::Int, wire::Int, wire::Float, wire::UByte>
+            ::encode(soundName, static_cast<int32_t>(x * 8.0), static_cast<int32_t>(y * 8.0),
+                     static_cast<int32_t>(z * 8.0), volume, static_cast<uint8_t>(pitchByte));
+    }
+
+    // ─── 0x2A Particle ───
+    // Java: S2APacketParticles — String name, Float x/y/z, Float offset
+    // x/y/z (spread), Float speed, Int count
+    inline PacketBuffer particle(const std::string& name, float x, float y, float z,
+                                 float offsetX, float offsetY, float offsetZ,
+                                 float speed, int32_t count) {
+        return PacketEncoder<ClientboundPacket::Particle,
+            wire::String<>, wire::Float, wire::Float, wire::Float,
+            wire::Float, wire::Float, wire::Float, wire::Float, wire::Int>
+            ::encode(name, x, y, z, offsetX, offsetY, offsetZ, speed, count);
     }
 
 } // namespace PacketBuilder
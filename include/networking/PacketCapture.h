@@ -0,0 +1,113 @@
+/**
+ * PacketCapture.h — Binary log of inbound client traffic, for replay.
+ *
+ * Java reference: none in vanilla. Records every inbound frame of every
+ * connection, so that a production session can be replayed against another
+ * build (see PacketReplay) to reproduce lag spikes and bisect regressions.
+ *
+ * Frames are logged after decryption and before dispatch, exactly as the
+ * PacketHandler sees them. C01PacketEncryptionResponse is never written (it
+ * carries the encrypted shared secret); replays run in offline mode, where
+ * LoginStart alone completes the login.
+ *
+ * File format: the magic "MCCPCAP1", then records of
+ *   [u8 type][VarInt session][VarLong µs since the previous record][body]
+ * with bodies
+ *   Open  — String remote address
+ *   Frame — VarInt length, then the frame (VarInt packetId + payload)
+ *   Close — (none)
+ *
+ * Thread-safe: connections on every event loop append to one staging buffer
+ * under a mutex; it is written out in STAGING_FLUSH_BYTES chunks and by flush().
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mccpp {
+
+enum class CaptureRecordType : uint8_t {
+    Open  = 0,
+    Frame = 1,
+    Close = 2,
+};
+
+/**
+ * One decoded record; `micros` is absolute (since the capture started).
+ */
+struct CaptureRecord {
+    CaptureRecordType    type = CaptureRecordType::Frame;
+    uint32_t             session = 0;
+    int64_t              micros = 0;
+    std::string          address;    // Open only
+    std::vector<uint8_t> frame;      // Frame only: VarInt packetId + payload
+};
+
+class PacketCapture {
+public:
+    static constexpr char MAGIC[9] = "MCCPCAP1";
+
+    /**
+     * Create (truncate) a capture file. Returns null if it cannot be opened.
+     */
+    static std::unique_ptr<PacketCapture> create(const std::string& path);
+
+    /**
+     * Read a whole capture file. Returns false (with `error` set) if the file
+     * is missing, has the wrong magic or ends in a truncated record; records
+     * decoded before the damage are kept.
+     */
+    static bool load(const std::string& path, std::vector<CaptureRecord>& records, std::string& error);
+
+    ~PacketCapture();
+
+    PacketCapture(const PacketCapture&) = delete;
+    PacketCapture& operator=(const PacketCapture&) = delete;
+
+    /**
+     * Start a session for a newly accepted connection; returns its tag.
+     */
+    uint32_t openSession(const std::string& remoteAddress);
+
+    /**
+     * Append one inbound frame (VarInt packetId + payload).
+     */
+    void recordFrame(uint32_t session, const uint8_t* frame, size_t length);
+
+    void closeSession(uint32_t session);
+
+    /**
+     * Write everything staged so far to the file.
+     */
+    void flush();
+
+    uint64_t getRecordedFrames() const;
+    uint64_t getRecordedBytes() const;
+
+private:
+    explicit PacketCapture(std::FILE* file);
+
+    // Caller holds mutex_
+    void beginRecord(CaptureRecordType type, uint32_t session);
+    void writeStaged();
+
+    mutable std::mutex    mutex_;
+    std::FILE*            file_;
+    std::vector<uint8_t>  staging_;
+    std::chrono::steady_clock::time_point start_;
+    int64_t               lastMicros_ = 0;
+    uint32_t              nextSession_ = 1;
+    uint64_t              frames_ = 0;
+    uint64_t              bytes_ = 0;   // file bytes, header included
+
+    static constexpr size_t STAGING_FLUSH_BYTES = 256 * 1024;
+};
+
+} // namespace mccpp
@@ -12,6 +12,9 @@
  */
 #pragma once
 
+#include "server/PlayerManager.h"
+
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -49,6 +52,21 @@ public:
      */
     virtual void onDisconnect(const std::string& reason) = 0;
 
+    /**
+     * Called on the tick thread once per tick in Play state, after the
+     * connection's queued packets were handled.
+     * Java reference: INetHandler.onNetworkTick()
+     */
+    virtual void onNetworkTick(Connection& /*conn*/) {}
+
+    /**
+     * Called once on the tick thread when the server drops a closed
+     * connection. onDisconnect() may run on any thread; world state the
+     * handler registered is released here.
+     * Java reference: NetworkSystem.networkTick() — onDisconnect on the main thread
+     */
+    virtual void onConnectionRemoved(Connection& /*conn*/) {}
+
     /**
      * Human-readable name for logging.
      */
@@ -108,7 +126,9 @@ private:
  * Login state machine (from NetHandlerLoginServer$LoginState):
  *   HELLO → KEY → AUTHENTICATING → READY_TO_ACCEPT → ACCEPTED
  *
- * Currently implements offline-mode login only (HELLO → READY_TO_ACCEPT → ACCEPTED).
+ * Offline mode: HELLO → ACCEPTED. Online mode: HELLO → KEY (encryption
+ * request sent) → AUTHENTICATING (encryption on, session check running on an
+ * authenticator thread) → ACCEPTED.
  * 600-tick (30 second) timeout matches Java: connectionTimer++ == 600.
  */
 class LoginHandler : public PacketHandler {
@@ -124,6 +144,27 @@ public:
     std::string handlerName() const override { return "LoginHandler"; }
 
 private:
+    // Java reference: NetHandlerLoginServer$LoginState
+    enum class LoginState : uint8_t { Hello, Key, Authenticating, Accepted };
+
+    // Java: NetHandlerLoginServer.field_147334_j — always "" since 1.7
+    static constexpr const char* SERVER_ID = "";
+
+    void sendEncryptionRequest(Connection& conn);
+    void handleEncryptionResponse(const uint8_t* data, size_t length, Connection& conn);
+
+    /**
+     * Send Login Success and hand the connection to a PlayHandler.
+     * Java reference: NetHandlerLoginServer.func_147326_c()
+     */
+    void acceptPlayer(Connection& conn, const std::string& uuid, const std::string& name);
+
+    /**
+     * Send a Login-state disconnect with `reason`, then close.
+     * Java reference: NetHandlerLoginServer.func_147322_a()
+     */
+    void kick(Connection& conn, const std::string& reason);
+
     /**
      * Generate an offline-mode UUID from a player name.
      * Java reference: NetHandlerLoginServer.getOfflineProfile()
@@ -133,6 +174,8 @@ private:
 
     MinecraftServer& server_;
     std::string playerName_;
+    std::atomic<LoginState> state_{LoginState::Hello};
+    uint8_t verifyToken_[4] = {};
 };
 
 /**
@@ -150,6 +193,13 @@ private:
  */
 class PlayHandler : public PacketHandler {
 public:
+    /**
+     * Plugin channel answering with the server's tick times (used by the
+     * bot-swarm load generator). Request: empty payload.
+     * Response: Int tickCount, Double mean MSPT, Double max MSPT.
+     */
+    static constexpr const char* TICK_TIME_CHANNEL = "MCCPP|TickTime";
+
     PlayHandler(MinecraftServer& server, const std::string& playerName,
                 const std::string& uuid, Connection& conn);
 
@@ -161,6 +211,19 @@ public:
     void onDisconnect(const std::string& reason) override;
     std::string handlerName() const override { return "PlayHandler"; }
 
+    /**
+     * Join the world on the first call, then follow the player's movement
+     * with the PlayerManager and submit queued chunks to the ChunkSendPipeline.
+     * Java reference: EntityPlayerMP.onUpdate() + PlayerManager.updateMountedMovingPlayer()
+     */
+    void onNetworkTick(Connection& conn) override;
+
+    /**
+     * Java reference: ServerConfigurationManager.playerLoggedOut() — leave the
+     * PlayerManager and stop sending chunks.
+     */
+    void onConnectionRemoved(Connection& conn) override;
+
     /**
      * Send the initial login sequence: Join Game, Spawn Position, 
      * Player Abilities, Player Position And Look.
@@ -181,6 +244,7 @@ public:
     void sendChatMessage(Connection& conn, const std::string& message);
 
     const std::string& getPlayerName() const { return playerName_; }
+    int32_t getEntityId() const { return entityId_; }
     int getKeepAliveId() const { return lastKeepAliveId_; }
 
 private:
@@ -191,10 +255,18 @@ private:
     void handlePlayerPosAndLook(const uint8_t* data, size_t length, Connection& conn);
     void handlePlayerGround(const uint8_t* data, size_t length, Connection& conn);
     void handleClientSettings(const uint8_t* data, size_t length, Connection& conn);
+    void handlePlayerDigging(const uint8_t* data, size_t length, Connection& conn);
+    void handlePlayerBlockPlace(const uint8_t* data, size_t length, Connection& conn);
+    void handlePluginMessage(const uint8_t* data, size_t length, Connection& conn);
 
     MinecraftServer& server_;
     std::string playerName_;
     std::string uuid_;
+    int32_t entityId_;
+
+    // Chunk tracking (tick thread only); Java: EntityPlayerMP.loadedChunks
+    PlayerChunkState chunkState_{};
+    bool inWorld_ = false;
 
     // Keep Alive tracking
     // Java: NetHandlerPlayServer.field_147378_h (keepAlive ID)
@@ -0,0 +1,103 @@
+/**
+ * PacketInbox.h — Lock-free single-producer/single-consumer packet queue.
+ *
+ * Java reference: NetworkManager.receivedPacketsQueue — Play packets are
+ * queued by the Netty thread and processed on the server thread by
+ * NetworkManager.processReceivedPackets().
+ *
+ * The producer is the connection's event loop (one thread), the consumer is
+ * the server tick thread. Slots are reused in place: a slot's payload vector
+ * keeps its capacity, so after warm-up queuing a packet costs one memcpy and
+ * two atomic operations, no allocation.
+ *
+ * Header-only.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mccpp {
+
+/**
+ * One queued serverbound packet (ID already decoded).
+ */
+struct InboundPacket {
+    int32_t packetId = 0;
+    std::vector<uint8_t> payload;
+};
+
+class PacketInbox {
+public:
+    /**
+     * @param capacity  Slot count; rounded up to a power of two.
+     */
+    explicit PacketInbox(size_t capacity = 4096) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        slots_.reset(new InboundPacket[cap]);
+        mask_ = cap - 1;
+    }
+
+    PacketInbox(const PacketInbox&) = delete;
+    PacketInbox& operator=(const PacketInbox&) = delete;
+
+    // ─── Producer side (event loop thread) ───
+
+    /**
+     * Copy a packet into the next free slot. Returns false if the inbox is full.
+     */
+    bool tryPush(int32_t packetId, const uint8_t* data, size_t length) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ > mask_) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ > mask_) return false;
+        }
+        InboundPacket& slot = slots_[tail & mask_];
+        slot.packetId = packetId;
+        slot.payload.assign(data, data + length);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // ─── Consumer side (tick thread) ───
+
+    /**
+     * The oldest queued packet, or nullptr if empty. Stays valid until pop().
+     */
+    const InboundPacket* front() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) return nullptr;
+        }
+        return &slots_[head & mask_];
+    }
+
+    /**
+     * Release the slot returned by front() back to the producer.
+     */
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    size_t sizeApprox() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<InboundPacket[]> slots_;
+    size_t mask_ = 0;
+
+    // Producer and consumer indices on separate cache lines, each with a
+    // private cached copy of the other side's index.
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t headCache_ = 0;
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t tailCache_ = 0;
+};
+
+} // namespace mccpp
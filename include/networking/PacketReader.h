@@ -8,14 +8,16 @@
  *
  * PacketReader wraps a raw byte buffer and provides big-endian read methods
  * matching Java's DataInputStream. All serverbound play packets are parsed
- * into typed structs.
+ * into typed structs, with decoders generated from their PacketSchema.
  *
  * Thread safety: PacketReader is not thread-safe (single-reader per instance).
  * Each connection's read thread creates its own reader.
  */
 #pragma once
 
+#include "PacketSchema.h"
 #include "PlayPackets.h"
+#include "types/ByteOrder.h"
 
 #include <cstdint>
 #include <cstring>
@@ -54,12 +56,7 @@ public:
     }
 
     int16_t readShort() {
-        checkRemaining(2);
-        int16_t v = static_cast<int16_t>(
-            (static_cast<uint16_t>(data_[pos_]) << 8) |
-            static_cast<uint16_t>(data_[pos_ + 1]));
-        pos_ += 2;
-        return v;
+        return loadBigEndian<int16_t>(take(2));
     }
 
     uint16_t readUShort() {
@@ -67,36 +64,19 @@ public:
     }
 
     int32_t readInt() {
-        checkRemaining(4);
-        int32_t v = (static_cast<int32_t>(data_[pos_]) << 24) |
-                    (static_cast<int32_t>(data_[pos_ + 1]) << 16) |
-                    (static_cast<int32_t>(data_[pos_ + 2]) << 8) |
-                    static_cast<int32_t>(data_[pos_ + 3]);
-        pos_ += 4;
-        return v;
+        return loadBigEndian<int32_t>(take(4));
     }
 
     int64_t readLong() {
-        checkRemaining(8);
-        int64_t v = 0;
-        for (int i = 0; i < 8; ++i) {
-            v = (v << 8) | static_cast<int64_t>(data_[pos_++]);
-        }
-        return v;
+        return loadBigEndian<int64_t>(take(8));
     }
 
     float readFloat() {
-        int32_t bits = readInt();
-        float v;
-        std::memcpy(&v, &bits, sizeof(v));
-        return v;
+        return loadBigEndian<float>(take(4));
     }
 
     double readDouble() {
-        int64_t bits = readLong();
-        double v;
-        std::memcpy(&v, &bits, sizeof(v));
-        return v;
+        return loadBigEndian<double>(take(8));
     }
 
     int32_t readVarInt() {
@@ -143,6 +123,17 @@ public:
         return s;
     }
 
+    /**
+     * Bounds-check `n` bytes once and consume them; returns where they start.
+     * Schema decoders load whole runs of fixed-size fields through this.
+     */
+    const uint8_t* take(size_t n) {
+        checkRemaining(n);
+        const uint8_t* p = data_ + pos_;
+        pos_ += n;
+        return p;
+    }
+
     // Read raw bytes
     std::vector<uint8_t> readBytes(size_t count) {
         checkRemaining(count);
@@ -159,7 +150,7 @@ public:
 
 private:
     void checkRemaining(size_t n) const {
-        if (pos_ + n > size_) {
+        if (n > size_ - pos_) {
             throw std::runtime_error("PacketReader: buffer underflow");
         }
     }
@@ -171,66 +162,73 @@ private:
 
 // ═══════════════════════════════════════════════════════════════════════════
 // Serverbound Packet Structures — Parsed from PacketReader.
-// All 24 serverbound play packets for Protocol v5.
+// All 24 serverbound play packets for Protocol v5. Each declares its wire
+// layout as a PacketSchema; read() and write() are generated from it.
 // ═══════════════════════════════════════════════════════════════════════════
 
 // 0x00 Keep Alive
+// Java: C00PacketKeepAlive — Int (VarInt only from 1.8)
 struct SB_KeepAlive {
     int32_t keepAliveId;
-    static SB_KeepAlive read(PacketReader& r) {
-        return { r.readVarInt() };
-    }
+    using Schema = PacketSchema<ServerboundPacket::KeepAlive, SB_KeepAlive,
+        Field<&SB_KeepAlive::keepAliveId, wire::Int>>;
+    static SB_KeepAlive read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x01 Chat Message
 struct SB_ChatMessage {
     std::string message; // max 100 chars
-    static SB_ChatMessage read(PacketReader& r) {
-        return { r.readString(100) };
-    }
+    using Schema = PacketSchema<ServerboundPacket::ChatMessage, SB_ChatMessage,
+        Field<&SB_ChatMessage::message, wire::String<100>>>;
+    static SB_ChatMessage read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x02 Use Entity
 struct SB_UseEntity {
     int32_t targetId;
     int8_t type; // 0=interact, 1=attack
-    static SB_UseEntity read(PacketReader& r) {
-        return { r.readInt(), r.readByte() };
-    }
+    using Schema = PacketSchema<ServerboundPacket::UseEntity, SB_UseEntity,
+        Field<&SB_UseEntity::targetId, wire::Int>,
+        Field<&SB_UseEntity::type,     wire::Byte>>;
+    static SB_UseEntity read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x03 Player (on ground only)
 struct SB_Player {
     bool onGround;
-    static SB_Player read(PacketReader& r) {
-        return { r.readBool() };
-    }
+    using Schema = PacketSchema<ServerboundPacket::Player, SB_Player,
+        Field<&SB_Player::onGround, wire::Bool>>;
+    static SB_Player read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x04 Player Position
 struct SB_PlayerPosition {
     double x, feetY, headY, z;
     bool onGround;
-    static SB_PlayerPosition read(PacketReader& r) {
-        double x = r.readDouble();
-        double feetY = r.readDouble();
-        double headY = r.readDouble();
-        double z = r.readDouble();
-        bool onGround = r.readBool();
-        return { x, feetY, headY, z, onGround };
-    }
+    using Schema = PacketSchema<ServerboundPacket::PlayerPosition, SB_PlayerPosition,
+        Field<&SB_PlayerPosition::x,        wire::Double>,
+        Field<&SB_PlayerPosition::feetY,    wire::Double>,
+        Field<&SB_PlayerPosition::headY,    wire::Double>,
+        Field<&SB_PlayerPosition::z,        wire::Double>,
+        Field<&SB_PlayerPosition::onGround, wire::Bool>>;
+    static SB_PlayerPosition read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x05 Player Look
 struct SB_PlayerLook {
     float yaw, pitch;
     bool onGround;
-    static SB_PlayerLook read(PacketReader& r) {
-        float yaw = r.readFloat();
-        float pitch = r.readFloat();
-        bool onGround = r.readBool();
-        return { yaw, pitch, onGround };
-    }
+    using Schema = PacketSchema<ServerboundPacket::PlayerLook, SB_PlayerLook,
+        Field<&SB_PlayerLook::yaw,      wire::Float>,
+        Field<&SB_PlayerLook::pitch,    wire::Float>,
+        Field<&SB_PlayerLook::onGround, wire::Bool>>;
+    static SB_PlayerLook read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x06 Player Position And Look
@@ -238,16 +236,16 @@ struct SB_PlayerPosAndLook {
     double x, feetY, headY, z;
     float yaw, pitch;
     bool onGround;
-    static SB_PlayerPosAndLook read(PacketReader& r) {
-        double x = r.readDouble();
-        double feetY = r.readDouble();
-        double headY = r.readDouble();
-        double z = r.readDouble();
-        float yaw = r.readFloat();
-        float pitch = r.readFloat();
-        bool onGround = r.readBool();
-        return { x, feetY, headY, z, yaw, pitch, onGround };
-    }
+    using Schema = PacketSchema<ServerboundPacket::PlayerPosAndLook, SB_PlayerPosAndLook,
+        Field<&SB_PlayerPosAndLook::x,        wire::Double>,
+        Field<&SB_PlayerPosAndLook::feetY,    wire::Double>,
+        Field<&SB_PlayerPosAndLook::headY,    wire::Double>,
+        Field<&SB_PlayerPosAndLook::z,        wire::Double>,
+        Field<&SB_PlayerPosAndLook::yaw,      wire::Float>,
+        Field<&SB_PlayerPosAndLook::pitch,    wire::Float>,
+        Field<&SB_PlayerPosAndLook::onGround, wire::Bool>>;
+    static SB_PlayerPosAndLook read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x07 Player Digging
@@ -257,14 +255,14 @@ struct SB_PlayerDigging {
     uint8_t y;
     int32_t z;
     int8_t face; // 0-5
-    static SB_PlayerDigging read(PacketReader& r) {
-        int8_t status = r.readByte();
-        int32_t x = r.readInt();
-        uint8_t y = r.readUByte();
-        int32_t z = r.readInt();
-        int8_t face = r.readByte();
-        return { status, x, y, z, face };
-    }
+    using Schema = PacketSchema<ServerboundPacket::PlayerDigging, SB_PlayerDigging,
+        Field<&SB_PlayerDigging::status, wire::Byte>,
+        Field<&SB_PlayerDigging::x,      wire::Int>,
+        Field<&SB_PlayerDigging::y,      wire::UByte>,
+        Field<&SB_PlayerDigging::z,      wire::Int>,
+        Field<&SB_PlayerDigging::face,   wire::Byte>>;
+    static SB_PlayerDigging read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x08 Player Block Placement
@@ -273,47 +271,39 @@ struct SB_PlayerBlockPlace {
     uint8_t y;
     int32_t z;
     int8_t direction; // 0-5, or -1 for use item
-    // Held item slot data follows (simplified: item id)
-    int16_t heldItemId;
+    SlotData heldItem;
     int8_t cursorX, cursorY, cursorZ; // 0-16 within block face
-    static SB_PlayerBlockPlace read(PacketReader& r) {
-        int32_t x = r.readInt();
-        uint8_t y = r.readUByte();
-        int32_t z = r.readInt();
-        int8_t dir = r.readByte();
-        int16_t itemId = r.readShort();
-        int8_t cx = 0, cy = 0, cz = 0;
-        if (itemId >= 0) {
-            r.readByte();   // count
-            r.readShort();  // damage
-            int8_t nbtTag = r.readByte(); // 0 = no NBT
-            if (nbtTag != 0) {
-                // Skip NBT — for now just consume remaining
-                // Full NBT parsing will be done in a dedicated reader
-            }
-        }
-        cx = r.readByte();
-        cy = r.readByte();
-        cz = r.readByte();
-        return { x, y, z, dir, itemId, cx, cy, cz };
-    }
+    using Schema = PacketSchema<ServerboundPacket::PlayerBlockPlace, SB_PlayerBlockPlace,
+        Field<&SB_PlayerBlockPlace::x,         wire::Int>,
+        Field<&SB_PlayerBlockPlace::y,         wire::UByte>,
+        Field<&SB_PlayerBlockPlace::z,         wire::Int>,
+        Field<&SB_PlayerBlockPlace::direction, wire::Byte>,
+        Field<&SB_PlayerBlockPlace::heldItem,  wire::Slot>,
+        Field<&SB_PlayerBlockPlace::cursorX,   wire::Byte>,
+        Field<&SB_PlayerBlockPlace::cursorY,   wire::Byte>,
+        Field<&SB_PlayerBlockPlace::cursorZ,   wire::Byte>>;
+    static SB_PlayerBlockPlace read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x09 Held Item Change
 struct SB_HeldItemChange {
     int16_t slotId; // 0-8
-    static SB_HeldItemChange read(PacketReader& r) {
-        return { r.readShort() };
-    }
+    using Schema = PacketSchema<ServerboundPacket::HeldItemChange, SB_HeldItemChange,
+        Field<&SB_HeldItemChange::slotId, wire::Short>>;
+    static SB_HeldItemChange read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x0A Animation
 struct SB_Animation {
     int32_t entityId;
     int8_t animation; // 1=swing arm
-    static SB_Animation read(PacketReader& r) {
-        return { r.readInt(), r.readByte() };
-    }
+    using Schema = PacketSchema<ServerboundPacket::Animation, SB_Animation,
+        Field<&SB_Animation::entityId,  wire::Int>,
+        Field<&SB_Animation::animation, wire::Byte>>;
+    static SB_Animation read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x0B Entity Action
@@ -321,33 +311,34 @@ struct SB_EntityAction {
     int32_t entityId;
     int8_t actionId; // 1=sneak, 2=unsneak, 3=bed, 4=sprint, 5=unsprint, 6=horseJump, 7=openInv
     int32_t jumpBoost;
-    static SB_EntityAction read(PacketReader& r) {
-        int32_t eid = r.readInt();
-        int8_t action = r.readByte();
-        int32_t boost = r.readInt();
-        return { eid, action, boost };
-    }
+    using Schema = PacketSchema<ServerboundPacket::EntityAction, SB_EntityAction,
+        Field<&SB_EntityAction::entityId,  wire::Int>,
+        Field<&SB_EntityAction::actionId,  wire::Byte>,
+        Field<&SB_EntityAction::jumpBoost, wire::Int>>;
+    static SB_EntityAction read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x0C Steer Vehicle
 struct SB_SteerVehicle {
     float sideways, forward;
     bool jump, unmount;
-    static SB_SteerVehicle read(PacketReader& r) {
-        float sw = r.readFloat();
-        float fw = r.readFloat();
-        bool j = r.readBool();
-        bool u = r.readBool();
-        return { sw, fw, j, u };
-    }
+    using Schema = PacketSchema<ServerboundPacket::SteerVehicle, SB_SteerVehicle,
+        Field<&SB_SteerVehicle::sideways, wire::Float>,
+        Field<&SB_SteerVehicle::forward,  wire::Float>,
+        Field<&SB_SteerVehicle::jump,     wire::Bool>,
+        Field<&SB_SteerVehicle::unmount,  wire::Bool>>;
+    static SB_SteerVehicle read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x0D Close Window
 struct SB_CloseWindow {
     uint8_t windowId;
-    static SB_CloseWindow read(PacketReader& r) {
-        return { r.readUByte() };
-    }
+    using Schema = PacketSchema<ServerboundPacket::CloseWindow, SB_CloseWindow,
+        Field<&SB_CloseWindow::windowId, wire::UByte>>;
+    static SB_CloseWindow read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x0E Click Window
@@ -357,23 +348,16 @@ struct SB_ClickWindow {
     int8_t button;
     int16_t actionNumber;
     int8_t mode;
-    // Clicked item follows (simplified)
-    int16_t itemId;
-    static SB_ClickWindow read(PacketReader& r) {
-        uint8_t wid = r.readUByte();
-        int16_t slot = r.readShort();
-        int8_t btn = r.readByte();
-        int16_t action = r.readShort();
-        int8_t mode = r.readByte();
-        int16_t itemId = r.readShort();
-        if (itemId >= 0) {
-            r.readByte();   // count
-            r.readShort();  // damage
-            int8_t nbt = r.readByte();
-            // Skip NBT if present
-        }
-        return { wid, slot, btn, action, mode, itemId };
-    }
+    SlotData clickedItem;
+    using Schema = PacketSchema<ServerboundPacket::ClickWindow, SB_ClickWindow,
+        Field<&SB_ClickWindow::windowId,     wire::UByte>,
+        Field<&SB_ClickWindow::slot,         wire::Short>,
+        Field<&SB_ClickWindow::button,       wire::Byte>,
+        Field<&SB_ClickWindow::actionNumber, wire::Short>,
+        Field<&SB_ClickWindow::mode,         wire::Byte>,
+        Field<&SB_ClickWindow::clickedItem,  wire::Slot>>;
+    static SB_ClickWindow read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x0F Confirm Transaction
@@ -381,34 +365,34 @@ struct SB_ConfirmTransaction {
     uint8_t windowId;
     int16_t actionNumber;
     bool accepted;
-    static SB_ConfirmTransaction read(PacketReader& r) {
-        return { r.readUByte(), r.readShort(), r.readBool() };
-    }
+    using Schema = PacketSchema<ServerboundPacket::ConfirmTransaction, SB_ConfirmTransaction,
+        Field<&SB_ConfirmTransaction::windowId,     wire::UByte>,
+        Field<&SB_ConfirmTransaction::actionNumber, wire::Short>,
+        Field<&SB_ConfirmTransaction::accepted,     wire::Bool>>;
+    static SB_ConfirmTransaction read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x10 Creative Inventory Action
 struct SB_CreativeInventory {
     int16_t slot;
-    int16_t itemId;
-    static SB_CreativeInventory read(PacketReader& r) {
-        int16_t slot = r.readShort();
-        int16_t itemId = r.readShort();
-        if (itemId >= 0) {
-            r.readByte();   // count
-            r.readShort();  // damage
-            r.readByte();   // NBT tag (0=none)
-        }
-        return { slot, itemId };
-    }
+    SlotData item;
+    using Schema = PacketSchema<ServerboundPacket::CreativeInventory, SB_CreativeInventory,
+        Field<&SB_CreativeInventory::slot, wire::Short>,
+        Field<&SB_CreativeInventory::item, wire::Slot>>;
+    static SB_CreativeInventory read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x11 Enchant Item
 struct SB_EnchantItem {
     uint8_t windowId;
     int8_t enchantment; // 0-2, slot in enchanting table
-    static SB_EnchantItem read(PacketReader& r) {
-        return { r.readUByte(), r.readByte() };
-    }
+    using Schema = PacketSchema<ServerboundPacket::EnchantItem, SB_EnchantItem,
+        Field<&SB_EnchantItem::windowId,    wire::UByte>,
+        Field<&SB_EnchantItem::enchantment, wire::Byte>>;
+    static SB_EnchantItem read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x12 Update Sign
@@ -417,75 +401,78 @@ struct SB_UpdateSign {
     int16_t y;
     int32_t z;
     std::string line1, line2, line3, line4;
-    static SB_UpdateSign read(PacketReader& r) {
-        int32_t x = r.readInt();
-        int16_t y = r.readShort();
-        int32_t z = r.readInt();
-        std::string l1 = r.readString(15);
-        std::string l2 = r.readString(15);
-        std::string l3 = r.readString(15);
-        std::string l4 = r.readString(15);
-        return { x, y, z, std::move(l1), std::move(l2), std::move(l3), std::move(l4) };
-    }
+    using Schema = PacketSchema<ServerboundPacket::UpdateSign, SB_UpdateSign,
+        Field<&SB_UpdateSign::x,     wire::Int>,
+        Field<&SB_UpdateSign::y,     wire::Short>,
+        Field<&SB_UpdateSign::z,     wire::Int>,
+        Field<&SB_UpdateSign::line1, wire::String<15>>,
+        Field<&SB_UpdateSign::line2, wire::String<15>>,
+        Field<&SB_UpdateSign::line3, wire::String<15>>,
+        Field<&SB_UpdateSign::line4, wire::String<15>>>;
+    static SB_UpdateSign read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x13 Player Abilities
 struct SB_PlayerAbilities {
     uint8_t flags; // bit 0=invuln, 1=flying, 2=allowFly, 3=creative
     float flySpeed, walkSpeed;
-    static SB_PlayerAbilities read(PacketReader& r) {
-        uint8_t flags = r.readUByte();
-        float fly = r.readFloat();
-        float walk = r.readFloat();
-        return { flags, fly, walk };
-    }
+    using Schema = PacketSchema<ServerboundPacket::PlayerAbilities, SB_PlayerAbilities,
+        Field<&SB_PlayerAbilities::flags,     wire::UByte>,
+        Field<&SB_PlayerAbilities::flySpeed,  wire::Float>,
+        Field<&SB_PlayerAbilities::walkSpeed, wire::Float>>;
+    static SB_PlayerAbilities read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x14 Tab Complete
 struct SB_TabComplete {
     std::string text;
-    static SB_TabComplete read(PacketReader& r) {
-        return { r.readString(32767) };
-    }
+    using Schema = PacketSchema<ServerboundPacket::TabComplete, SB_TabComplete,
+        Field<&SB_TabComplete::text, wire::String<32767>>>;
+    static SB_TabComplete read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x15 Client Settings
+// Java: C15PacketClientSettings — locale, view distance, chat visibility,
+// chat colours, difficulty (unused by the server), show cape
 struct SB_ClientSettings {
     std::string locale;
     int8_t viewDistance;
     int8_t chatFlags;
     bool chatColors;
-    uint8_t skinParts; // displayed skin parts bitmask
-    static SB_ClientSettings read(PacketReader& r) {
-        std::string locale = r.readString(7);
-        int8_t vd = r.readByte();
-        int8_t cf = r.readByte();
-        bool cc = r.readBool();
-        // In 1.7.10, difficulty is sent here too but not used
-        r.readByte(); // unused difficulty
-        uint8_t sp = r.readUByte();
-        return { std::move(locale), vd, cf, cc, sp };
-    }
+    int8_t difficulty;
+    bool showCape;
+    using Schema = PacketSchema<ServerboundPacket::ClientSettings, SB_ClientSettings,
+        Field<&SB_ClientSettings::locale,       wire::String<7>>,
+        Field<&SB_ClientSettings::viewDistance, wire::Byte>,
+        Field<&SB_ClientSettings::chatFlags,    wire::Byte>,
+        Field<&SB_ClientSettings::chatColors,   wire::Bool>,
+        Field<&SB_ClientSettings::difficulty,   wire::Byte>,
+        Field<&SB_ClientSettings::showCape,     wire::Bool>>;
+    static SB_ClientSettings read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x16 Client Status
 struct SB_ClientStatus {
     int8_t actionId; // 0=respawn, 1=request stats, 2=open inventory achievement
-    static SB_ClientStatus read(PacketReader& r) {
-        return { r.readByte() };
-    }
+    using Schema = PacketSchema<ServerboundPacket::ClientStatus, SB_ClientStatus,
+        Field<&SB_ClientStatus::actionId, wire::Byte>>;
+    static SB_ClientStatus read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // 0x17 Plugin Message
 struct SB_PluginMessage {
     std::string channel;
     std::vector<uint8_t> data;
-    static SB_PluginMessage read(PacketReader& r) {
-        std::string channel = r.readString(20);
-        int16_t len = r.readShort();
-        std::vector<uint8_t> data = r.readBytes(static_cast<size_t>(len));
-        return { std::move(channel), std::move(data) };
-    }
+    using Schema = PacketSchema<ServerboundPacket::PluginMessage, SB_PluginMessage,
+        Field<&SB_PluginMessage::channel, wire::String<20>>,
+        Field<&SB_PluginMessage::data,    wire::ShortBytes>>;
+    static SB_PluginMessage read(PacketReader& r) { return Schema::decode(r); }
+    PacketBuffer write() const { return Schema::encode(*this); }
 };
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -0,0 +1,386 @@
+/**
+ * PacketSchema.h — Compile-time packet descriptions that generate encoders
+ * and decoders.
+ *
+ * Java reference: every Packet subclass hand-writes a readPacketData() /
+ * writePacketData() pair over PacketBuffer. Here a packet is described once,
+ * as a type whose template arguments are its fields in wire order:
+ *
+ *   using Schema = PacketSchema<ServerboundPacket::PlayerLook, SB_PlayerLook,
+ *       Field<&SB_PlayerLook::yaw,      wire::Float>,
+ *       Field<&SB_PlayerLook::pitch,    wire::Float>,
+ *       Field<&SB_PlayerLook::onGround, wire::Bool>>;
+ *
+ * and both directions are generated from that list:
+ *   - encode(): the exact body size is computed up front (the fixed-size part
+ *     is a compile-time constant), the pooled block is taken once, and every
+ *     field is written with an unchecked big-endian store.
+ *   - decode(): each run of consecutive fixed-size fields costs one bounds
+ *     check, then loads unchecked; variable fields (VarInt, String, Slot,
+ *     arrays) check themselves.
+ *
+ * Builders that have no struct use PacketEncoder<Id, Codecs...>::encode(values...).
+ */
+#pragma once
+
+#include "networking/PacketBuffer.h"
+#include "types/ByteOrder.h"
+#include "types/VarInt.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace mccpp {
+
+/**
+ * An item stack as sent on the wire (held item, window clicks).
+ * Java reference: PacketBuffer.readItemStackFromBuffer() — Short id (-1 = empty),
+ * then Byte count, Short damage, Short NBT length (-1 = none) + gzipped NBT.
+ */
+struct SlotData {
+    int16_t              itemId = -1;
+    int8_t               count = 0;
+    int16_t              damage = 0;
+    std::vector<uint8_t> nbt;           // compressed compound, empty = none
+
+    bool empty() const { return itemId < 0; }
+};
+
+namespace detail {
+
+// Encoded size of one value: a constant for fixed-size codecs
+template <typename Codec>
+inline size_t encodedSize(const typename Codec::Value& v) {
+    if constexpr (Codec::FIXED > 0) {
+        (void)v;
+        return Codec::FIXED;
+    } else {
+        return Codec::size(v);
+    }
+}
+
+} // namespace detail
+
+// ═══════════════════════════════════════════════════════════════════════════
+// Wire codecs. Each describes one protocol data type:
+//   Value                       the C++ type it maps to
+//   FIXED                       encoded size in bytes, 0 if it varies
+//   size(v)                     encoded size (variable codecs only)
+//   store(p, v) -> p + size     unchecked write; the caller sized the buffer
+//   load(p)                     unchecked read (fixed codecs; run pre-checked)
+//   read(reader)                checked read (variable codecs)
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace wire {
+
+template <typename T>
+struct BigEndian {
+    using Value = T;
+    static constexpr size_t FIXED = sizeof(T);
+    static uint8_t* store(uint8_t* p, T v) { storeBigEndian(p, v); return p + sizeof(T); }
+    static T load(const uint8_t* p) { return loadBigEndian<T>(p); }
+};
+
+using Byte   = BigEndian<int8_t>;
+using UByte  = BigEndian<uint8_t>;
+using Short  = BigEndian<int16_t>;
+using UShort = BigEndian<uint16_t>;
+using Int    = BigEndian<int32_t>;
+using Long   = BigEndian<int64_t>;
+using Float  = BigEndian<float>;
+using Double = BigEndian<double>;
+
+struct Bool {
+    using Value = bool;
+    static constexpr size_t FIXED = 1;
+    static uint8_t* store(uint8_t* p, bool v) { *p = v ? 1 : 0; return p + 1; }
+    static bool load(const uint8_t* p) { return *p != 0; }
+};
+
+// Rotation in 256ths of a turn. Java: (byte)(int)(yaw * 256.0F / 360.0F)
+struct Angle {
+    using Value = float;
+    static constexpr size_t FIXED = 1;
+    static uint8_t* store(uint8_t* p, float degrees) {
+        *p = static_cast<uint8_t>(static_cast<int32_t>(degrees * 256.0f / 360.0f) & 0xFF);
+        return p + 1;
+    }
+    static float load(const uint8_t* p) { return static_cast<int8_t>(*p) * 360.0f / 256.0f; }
+};
+
+// Absolute position in 32nds of a block. Java: MathHelper.floor_double(x * 32.0D)
+struct FixedPoint {
+    using Value = double;
+    static constexpr size_t FIXED = 4;
+    static uint8_t* store(uint8_t* p, double v) {
+        return Int::store(p, static_cast<int32_t>(std::floor(v * 32.0)));
+    }
+    static double load(const uint8_t* p) { return Int::load(p) / 32.0; }
+};
+
+struct VarInt {
+    using Value = int32_t;
+    static constexpr size_t FIXED = 0;
+    static size_t size(int32_t v) { return static_cast<size_t>(varIntSize(v)); }
+    static uint8_t* store(uint8_t* p, int32_t v) { return p + writeVarInt(p, v); }
+    template <typename Reader>
+    static int32_t read(Reader& r) { return r.readVarInt(); }
+};
+
+/**
+ * UTF-8 string with a VarInt byte length.
+ * Java: readStringFromBuffer(max) — at most 4 * max bytes and max UTF-16 units.
+ */
+template <int32_t MaxChars = 32767>
+struct String {
+    using Value = std::string;
+    static constexpr size_t FIXED = 0;
+    static size_t size(const std::string& s) { return VarInt::size(static_cast<int32_t>(s.size())) + s.size(); }
+    static uint8_t* store(uint8_t* p, const std::string& s) {
+        p = VarInt::store(p, static_cast<int32_t>(s.size()));
+        std::memcpy(p, s.data(), s.size());
+        return p + s.size();
+    }
+    template <typename Reader>
+    static std::string read(Reader& r) {
+        int32_t len = r.readVarInt();
+        if (len < 0 || len > MaxChars * 4) {
+            throw std::runtime_error("String too long: " + std::to_string(len) + " bytes");
+        }
+        const uint8_t* p = r.take(static_cast<size_t>(len));
+        int32_t units = 0;
+        for (int32_t i = 0; i < len; ++i) {
+            units += (p[i] & 0xC0) != 0x80;   // one per code point ...
+            units += p[i] >= 0xF0;            // ... two for a surrogate pair
+        }
+        if (units > MaxChars) {
+            throw std::runtime_error("String too long: " + std::to_string(units) + " > " +
+                                     std::to_string(MaxChars));
+        }
+        return std::string(reinterpret_cast<const char*>(p), static_cast<size_t>(len));
+    }
+};
+
+// Short length + raw bytes (C17/S3F custom payload). Java: readShort() + readBytes()
+struct ShortBytes {
+    using Value = std::vector<uint8_t>;
+    static constexpr size_t FIXED = 0;
+    static size_t size(const Value& v) { return 2 + v.size(); }
+    static uint8_t* store(uint8_t* p, const Value& v) {
+        p = Short::store(p, static_cast<int16_t>(v.size()));
+        if (!v.empty()) std::memcpy(p, v.data(), v.size());
+        return p + v.size();
+    }
+    template <typename Reader>
+    static Value read(Reader& r) {
+        int16_t len = Short::load(r.take(2));
+        if (len < 0) throw std::runtime_error("Negative payload length");
+        const uint8_t* p = r.take(static_cast<size_t>(len));
+        return Value(p, p + len);
+    }
+};
+
+struct Slot {
+    using Value = SlotData;
+    static constexpr size_t FIXED = 0;
+    static size_t size(const SlotData& s) {
+        return s.empty() ? 2 : 2 + 1 + 2 + 2 + s.nbt.size();
+    }
+    static uint8_t* store(uint8_t* p, const SlotData& s) {
+        p = Short::store(p, s.itemId);
+        if (s.empty()) return p;
+        p = Byte::store(p, s.count);
+        p = Short::store(p, s.damage);
+        p = Short::store(p, s.nbt.empty() ? int16_t{-1} : static_cast<int16_t>(s.nbt.size()));
+        if (!s.nbt.empty()) std::memcpy(p, s.nbt.data(), s.nbt.size());
+        return p + s.nbt.size();
+    }
+    template <typename Reader>
+    static SlotData read(Reader& r) {
+        SlotData s;
+        s.itemId = Short::load(r.take(2));
+        if (s.empty()) return s;
+        const uint8_t* p = r.take(5);
+        s.count = Byte::load(p);
+        s.damage = Short::load(p + 1);
+        int16_t nbtLength = Short::load(p + 3);
+        if (nbtLength > 0) {
+            const uint8_t* nbt = r.take(static_cast<size_t>(nbtLength));
+            s.nbt.assign(nbt, nbt + nbtLength);
+        }
+        return s;
+    }
+};
+
+/**
+ * Count-prefixed array, e.g. Array<Byte, Int> for S13's entity IDs.
+ * Fixed-size elements are sized, stored and bounds-checked as one block.
+ */
+template <typename Count, typename Elem>
+struct Array {
+    using Value = std::vector<typename Elem::Value>;
+    static constexpr size_t FIXED = 0;
+    static size_t size(const Value& v) {
+        size_t n = detail::encodedSize<Count>(static_cast<typename Count::Value>(v.size()));
+        if constexpr (Elem::FIXED > 0) {
+            n += v.size() * Elem::FIXED;
+        } else {
+            for (const auto& e : v) n += Elem::size(e);
+        }
+        return n;
+    }
+    static uint8_t* store(uint8_t* p, const Value& v) {
+        p = Count::store(p, static_cast<typename Count::Value>(v.size()));
+        for (const auto& e : v) p = Elem::store(p, e);
+        return p;
+    }
+    template <typename Reader>
+    static Value read(Reader& r) {
+        int64_t count;
+        if constexpr (Count::FIXED > 0) count = Count::load(r.take(Count::FIXED));
+        else count = Count::read(r);
+        if (count < 0) throw std::runtime_error("Negative array length");
+
+        Value v;
+        if constexpr (Elem::FIXED > 0) {
+            const uint8_t* p = r.take(static_cast<size_t>(count) * Elem::FIXED);
+            v.reserve(static_cast<size_t>(count));
+            for (int64_t i = 0; i < count; ++i, p += Elem::FIXED) v.push_back(Elem::load(p));
+        } else {
+            for (int64_t i = 0; i < count; ++i) v.push_back(Elem::read(r));
+        }
+        return v;
+    }
+};
+
+} // namespace wire
+
+// ═══════════════════════════════════════════════════════════════════════════
+// Schema machinery
+// ═══════════════════════════════════════════════════════════════════════════
+
+/**
+ * One struct member and the codec it is sent with.
+ */
+template <auto Member, typename Codec>
+struct Field {
+    using codec = Codec;
+
+    template <typename S>
+    static const auto& get(const S& s) { return s.*Member; }
+    template <typename S>
+    static auto& get(S& s) { return s.*Member; }
+};
+
+namespace detail {
+
+// Bytes in the run of fixed-size fields at the front of the list
+template <typename... Fs>
+struct LeadingFixedBytes { static constexpr size_t value = 0; };
+
+template <typename F, typename... Rest>
+struct LeadingFixedBytes<F, Rest...> {
+    static constexpr size_t value =
+        F::codec::FIXED == 0 ? 0 : F::codec::FIXED + LeadingFixedBytes<Rest...>::value;
+};
+
+/**
+ * Decodes Fs in order. `Checked` bytes at `p` were bounds-checked (and
+ * consumed from the reader) by the first field of the current fixed run.
+ */
+template <size_t Checked, typename... Fs>
+struct FieldDecoder {
+    template <typename S, typename Reader>
+    static void decode(S&, Reader&, const uint8_t*) {}
+};
+
+template <size_t Checked, typename F, typename... Rest>
+struct FieldDecoder<Checked, F, Rest...> {
+    template <typename S, typename Reader>
+    static void decode(S& s, Reader& r, const uint8_t* p) {
+        using C = typename F::codec;
+        if constexpr (C::FIXED == 0) {
+            F::get(s) = C::read(r);
+            FieldDecoder<0, Rest...>::decode(s, r, nullptr);
+        } else if constexpr (Checked >= C::FIXED) {
+            F::get(s) = C::load(p);
+            FieldDecoder<Checked - C::FIXED, Rest...>::decode(s, r, p + C::FIXED);
+        } else {
+            constexpr size_t run = LeadingFixedBytes<F, Rest...>::value;
+            const uint8_t* q = r.take(run);
+            F::get(s) = C::load(q);
+            FieldDecoder<run - C::FIXED, Rest...>::decode(s, r, q + C::FIXED);
+        }
+    }
+};
+
+/**
+ * Take one pooled block of exactly `bodySize` bytes, write the packet ID and
+ * let `writeFields` fill the rest, then frame it.
+ */
+template <typename WriteFields>
+inline PacketBuffer encodeFrame(int32_t packetId, size_t bodySize, WriteFields&& writeFields) {
+    PacketBuffer buf = PacketBuffer::acquire(bodySize);
+    uint8_t* start = buf.prepareWrite(bodySize);
+    uint8_t* p = wire::VarInt::store(start, packetId);
+    p = writeFields(p);
+    buf.commitWrite(static_cast<size_t>(p - start));
+    buf.finishFrame();
+    return buf;
+}
+
+} // namespace detail
+
+/**
+ * A packet struct and its fields in wire order.
+ */
+template <int32_t Id, typename Struct, typename... Fields>
+struct PacketSchema {
+    static constexpr int32_t ID = Id;
+
+    // Bytes taken by the fixed-size fields (all of the body if nothing varies)
+    static constexpr size_t FIXED_PAYLOAD = (Fields::codec::FIXED + ... + 0);
+
+    static size_t bodySize(const Struct& s) {
+        return static_cast<size_t>(varIntSize(Id)) +
+               (detail::encodedSize<typename Fields::codec>(Fields::get(s)) + ... + 0);
+    }
+
+    static PacketBuffer encode(const Struct& s) {
+        return detail::encodeFrame(Id, bodySize(s), [&s](uint8_t* p) {
+            ((p = Fields::codec::store(p, Fields::get(s))), ...);
+            return p;
+        });
+    }
+
+    template <typename Reader>
+    static Struct decode(Reader& r) {
+        Struct s{};
+        detail::FieldDecoder<0, Fields...>::decode(s, r, nullptr);
+        return s;
+    }
+};
+
+/**
+ * Encoder for a packet built straight from values (no struct).
+ */
+template <int32_t Id, typename... Codecs>
+struct PacketEncoder {
+    static constexpr int32_t ID = Id;
+
+    static PacketBuffer encode(const typename Codecs::Value&... values) {
+        size_t body = static_cast<size_t>(varIntSize(Id)) +
+                      (detail::encodedSize<Codecs>(values) + ... + 0);
+        return detail::encodeFrame(Id, body, [&](uint8_t* p) {
+            ((p = Codecs::store(p, values)), ...);
+            return p;
+        });
+    }
+};
+
+} // namespace mccpp
@@ -0,0 +1,113 @@
+/**
+ * PacketStats.h — Per-packet-type traffic counters and handler-time histograms.
+ *
+ * Java reference: none in vanilla (the closest is the sampling Profiler behind
+ * /debug start). Answers "which packets dominate bandwidth and handler time".
+ *
+ * Keys are direction × Play packet ID; Handshake/Status/Login packets share
+ * the PRE_PLAY slot. For every key: packet count, wire bytes (length prefix
+ * included) and, inbound only, a histogram of handler time.
+ *
+ * Recording is lock-free: every thread that moves packets (event loops, the
+ * tick thread, authenticator threads) writes its own counter block with
+ * relaxed single-writer stores. snapshot() sums all blocks on demand; blocks
+ * of exited threads are folded into a retired total.
+ *
+ * Histograms are HDR-style log-linear: 4 sub-buckets per power of two (at
+ * most 25% relative error) from 1 ns to ~137 s.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace mccpp {
+
+enum class PacketDirection : uint8_t {
+    Inbound  = 0,   // client → server
+    Outbound = 1,   // server → client
+};
+
+/**
+ * Log-linear latency histogram (values in nanoseconds).
+ */
+struct LatencyHistogram {
+    static constexpr size_t SUB_BUCKET_BITS = 2;
+    static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKETS = 36 * SUB_BUCKETS;
+
+    uint64_t counts[BUCKETS] = {};
+
+    static size_t bucketFor(uint64_t value);
+    static uint64_t bucketLowerBound(size_t bucket);
+    static uint64_t bucketUpperBound(size_t bucket);
+
+    uint64_t total() const;
+
+    /**
+     * Upper bound of the bucket holding the q-quantile (0 < q <= 1); 0 if empty.
+     */
+    uint64_t percentile(double q) const;
+};
+
+struct PacketTrafficStats {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * Aggregated counters since the last PacketStats::reset().
+ */
+struct PacketStatsSnapshot {
+    static constexpr size_t SLOTS = 129;   // Play IDs 0x00–0x7F + PRE_PLAY
+
+    double             elapsedSeconds = 0.0;
+    PacketTrafficStats traffic[2][SLOTS];  // [PacketDirection][slot]
+    LatencyHistogram   handlerTime[SLOTS]; // inbound handler time, ns
+};
+
+class PacketStats {
+public:
+    static constexpr size_t PRE_PLAY = 128;
+
+    /**
+     * Count one packet of `wireBytes` bytes. `play` selects the Play packet
+     * ID slot; anything else is recorded under PRE_PLAY.
+     */
+    static void recordPacket(PacketDirection direction, int32_t packetId, bool play, size_t wireBytes);
+
+    /**
+     * Record the time a handler spent on one inbound packet.
+     */
+    static void recordHandlerTime(int32_t packetId, bool play, uint64_t nanos);
+
+    /**
+     * Sum of all threads' counters since the last reset().
+     */
+    static std::unique_ptr<PacketStatsSnapshot> snapshot();
+
+    /**
+     * Start a new measurement window (counters are never cleared in place;
+     * later snapshots subtract the totals taken here).
+     */
+    static void reset();
+
+    /**
+     * Packet name for a slot, e.g. "MapChunkBulk"; "0x4A" for unknown IDs.
+     */
+    static std::string packetName(PacketDirection direction, size_t slot);
+
+    /**
+     * Machine-readable dump (JSON object, one entry per non-empty slot).
+     */
+    static std::string toJson(const PacketStatsSnapshot& snapshot);
+
+    /**
+     * Human-readable summary: the top `maxRows` slots per direction by bytes.
+     */
+    static std::string formatTable(const PacketStatsSnapshot& snapshot, size_t maxRows);
+};
+
+} // namespace mccpp
@@ -0,0 +1,86 @@
+/**
+ * SessionAuthenticator.h — Online-mode session verification.
+ *
+ * Java reference: com.mojang.authlib.minecraft.MinecraftSessionService
+ *   (YggdrasilMinecraftSessionService.hasJoinedServer), called from
+ *   NetHandlerLoginServer's "User Authenticator #n" thread.
+ *
+ * The login handler only sees the SessionAuthenticator interface, so the
+ * Mojang session server can be swapped for a local stub (a different base
+ * URL, or an in-process implementation) for testing.
+ */
+#pragma once
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace mccpp {
+
+/**
+ * Verified player identity.
+ * Java reference: com.mojang.authlib.GameProfile
+ */
+struct GameProfile {
+    std::string uuid;   // dashed form: xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
+    std::string name;
+};
+
+/**
+ * Thrown when the session service cannot be reached.
+ * Java reference: com.mojang.authlib.exceptions.AuthenticationUnavailableException
+ */
+class AuthenticationUnavailable : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * SessionAuthenticator — verifies that a client joined this server.
+ *
+ * Thread safety: hasJoinedServer() is called concurrently from the
+ * authenticator threads; implementations must be thread-safe.
+ */
+class SessionAuthenticator {
+public:
+    virtual ~SessionAuthenticator() = default;
+
+    /**
+     * Blocking. Returns the profile if the session service confirms the join,
+     * nullopt if it does not; throws AuthenticationUnavailable on I/O errors.
+     * Java reference: MinecraftSessionService.hasJoinedServer(GameProfile, String)
+     */
+    virtual std::optional<GameProfile> hasJoinedServer(const std::string& username,
+                                                       const std::string& serverHash) = 0;
+};
+
+/**
+ * HttpSessionAuthenticator — queries a Yggdrasil-compatible session server:
+ *   GET <baseUrl>/session/minecraft/hasJoined?username=<name>&serverId=<hash>
+ * 200 with a profile JSON means verified; 204 means not joined.
+ *
+ * Supports https:// (OpenSSL, certificate and host name verified) and
+ * plain http:// for local stubs.
+ */
+class HttpSessionAuthenticator : public SessionAuthenticator {
+public:
+    static constexpr const char* MOJANG_SESSION_SERVER = "https://sessionserver.mojang.com";
+
+    explicit HttpSessionAuthenticator(const std::string& baseUrl = MOJANG_SESSION_SERVER,
+                                      int timeoutMs = 5000);
+
+    std::optional<GameProfile> hasJoinedServer(const std::string& username,
+                                               const std::string& serverHash) override;
+
+    const std::string& getBaseUrl() const { return baseUrl_; }
+
+private:
+    std::string baseUrl_;
+    bool        tls_ = true;
+    std::string host_;
+    std::string port_;
+    std::string pathPrefix_;
+    int         timeoutMs_;
+};
+
+} // namespace mccpp
@@ -4,6 +4,11 @@
  * Reference: nc.java (obfuscated ServerConnection) — uses Netty ServerBootstrap.
  * C++ adaptation: POSIX sockets + dedicated accept thread, dispatching new
  * connections to the server's connection manager.
+ *
+ * Admission control runs on the accept thread before the callback: each
+ * remote IPv4 address has a token bucket, and connections over its rate are
+ * reset immediately, so a flood never reaches Connection or an event loop.
+ * (Bukkit's connection-throttle does the same at login time.)
  */
 #pragma once
 
@@ -12,6 +17,7 @@
 #include <functional>
 #include <string>
 #include <thread>
+#include <unordered_map>
 
 namespace mccpp {
 
@@ -19,7 +25,7 @@ class MinecraftServer; // forward decl
 
 /**
  * Callback invoked when a new client socket is accepted.
- * Parameters: socket file descriptor, remote address string, remote port.
+ * Parameters: socket file descriptor (non-blocking), remote address string, remote port.
  */
 using AcceptCallback = std::function<void(int fd, const std::string& address, uint16_t port)>;
 
@@ -61,15 +67,51 @@ public:
 
     uint16_t getPort() const { return port_; }
 
+    /**
+     * Per-IP connection rate limit: `perSecond` sustained, bursts of up to
+     * `burst`. perSecond <= 0 disables the limit. Must be set before start().
+     */
+    void setConnectionRateLimit(double perSecond, int burst);
+
+    /**
+     * Connections accepted and handed to the callback / reset by the rate limit.
+     */
+    uint64_t getAcceptedCount() const { return acceptedCount_.load(std::memory_order_relaxed); }
+    uint64_t getRejectedCount() const { return rejectedCount_.load(std::memory_order_relaxed); }
+
 private:
     void acceptLoop();
 
+    /**
+     * Take one token from the bucket of `ipv4` (network byte order).
+     * Accept thread only.
+     */
+    bool admit(uint32_t ipv4, const std::string& address);
+
+    struct RateBucket {
+        double  tokens;
+        int64_t lastRefillMs;
+        bool    throttled;   // a rejection was already logged for this burst
+    };
+
     std::string    bindAddress_;
     uint16_t       port_;
     int            serverFd_ = -1;
     std::atomic<bool> running_{false};
     std::thread    acceptThread_;
     AcceptCallback onAccept_;
+
+    // Admission control (accept thread only, except the counters)
+    double ratePerSecond_ = 2.0;
+    int    rateBurst_     = 8;
+    std::unordered_map<uint32_t, RateBucket> buckets_;
+    std::atomic<uint64_t> acceptedCount_{0};
+    std::atomic<uint64_t> rejectedCount_{0};
+
+    // Idle buckets are dropped once the table reaches this size, at most
+    // once per refill period (burst / rate seconds)
+    static constexpr size_t BUCKET_PRUNE_THRESHOLD = 4096;
+    int64_t nextPruneMs_ = 0;
 };
 
 } // namespace mccpp
@@ -0,0 +1,200 @@
+/**
+ * ChunkSendPipeline.h — Builds players' chunk packets off the tick thread.
+ *
+ * Java reference: EntityPlayerMP.onUpdate() — the loadedChunks block, which
+ * takes up to S26PacketMapChunkBulk.func_149258_c() (5) chunks per tick and
+ * builds and deflates the S26 packet on the main thread.
+ *
+ * Here the tick thread only takes the next chunks from the player's
+ * spiral-ordered PlayerChunkState::loadedChunks (nearest first) and copies
+ * them out in wire order (ChunkSerializer::appendToBulk, a few memcpys per
+ * section), which is also the consistent snapshot of chunks it owns. A pool
+ * of worker threads deflates and frames the S26 and hands the buffer straight
+ * to the player's Connection, so no compression runs on the tick thread.
+ * Chunks whose deflated payload is cached and current are not copied at all;
+ * the worker splices the cached segment (ChunkPayloadCache.h).
+ *
+ * Compression follows a DeflatePolicy (backend, level); with the AUTO level
+ * each packet's level is picked from the current pressure — the smoothed
+ * share of the tick budget the server uses, or the worker backlog if that is
+ * higher — so a busy server spends less CPU per chunk and more bandwidth.
+ *
+ * Flow control, per player:
+ *   - at most MAX_PACKETS_IN_FLIGHT bulk packets queued or being built;
+ *   - nothing new while the connection is bulk-throttled.
+ *
+ * Block changes (PlayerManager::onChunkUpdate) are built once per chunk on
+ * the tick thread — S23 for one block, S22 for up to 63, the touched sections
+ * as an S21 beyond that — and the same buffer goes to every watcher.
+ *
+ * Ordering: a chunk the player stops watching while its packet is still
+ * being built is unloaded (empty S21) right after that packet was queued, so
+ * the unload cannot arrive first; block changes to such a chunk wait the same
+ * way, and go ahead of the unload. Chunk packets, block changes and unloads
+ * share the FIFO Bulk queue. Jobs run in submission order; with several workers two packets
+ * of the same player may be queued out of order, which the client accepts.
+ *
+ * Thread safety: addPlayer/removePlayer/sendChunks/unwatchChunk,
+ * sendChunkUpdate and setServerLoad are tick thread only; setPolicy before start(). getStats()
+ * may be called from any thread.
+ */
+#pragma once
+
+#include "networking/ChunkSerializer.h"
+#include "networking/DeflateEngine.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mccpp {
+
+class Connection;        // forward decl
+class WorldServer;       // forward decl
+struct PlayerChunkState; // forward decl
+struct PlayerInstance;   // forward decl
+
+/**
+ * Cumulative pipeline counters.
+ */
+struct ChunkSendStats {
+    uint64_t chunks          = 0;   // chunks sent
+    uint64_t packets         = 0;   // S26 packets sent
+    uint64_t rawBytes        = 0;   // chunk data bytes before deflate
+    uint64_t packetBytes     = 0;   // framed S26 bytes handed to connections
+    uint64_t workerNanos     = 0;   // worker time spent building packets
+    size_t   queuedPackets   = 0;   // packets waiting for a worker
+    int      deflateLevel    = 0;   // level of the last packet built
+    uint64_t blockChanges    = 0;   // S23 built (one changed block)
+    uint64_t multiBlockChanges = 0; // S22 built (2-63 changed blocks)
+    uint64_t sectionResends  = 0;   // partial S21 built (64 or more)
+};
+
+class ChunkSendPipeline {
+public:
+    // Java: S26PacketMapChunkBulk.func_149258_c()
+    static constexpr size_t CHUNKS_PER_PACKET = 5;
+    static constexpr int    MAX_PACKETS_IN_FLIGHT = 4;
+
+    /**
+     * A quarter of the hardware threads, 1 to 4.
+     */
+    static int defaultThreadCount();
+
+    explicit ChunkSendPipeline(int threadCount);
+    ~ChunkSendPipeline();
+
+    ChunkSendPipeline(const ChunkSendPipeline&) = delete;
+    ChunkSendPipeline& operator=(const ChunkSendPipeline&) = delete;
+
+    void setPolicy(const DeflatePolicy& policy) { policy_ = policy; }
+    const DeflatePolicy& getPolicy() const { return policy_; }
+
+    /**
+     * Report the last tick's duration as a share of the 50 ms budget.
+     */
+    void setServerLoad(double tickLoad);
+
+    /**
+     * Spawn the worker threads.
+     */
+    void start();
+
+    /**
+     * Drop queued packets and join the workers.
+     */
+    void stop();
+
+    /**
+     * Start sending chunks to `playerId` over `conn`.
+     */
+    void addPlayer(int32_t playerId, std::shared_ptr<Connection> conn);
+
+    /**
+     * Forget the player; packets already being built are discarded.
+     */
+    void removePlayer(int32_t playerId);
+
+    /**
+     * Submit the player's next queued chunks, nearest first, as far as the
+     * flow-control limits allow. Chunks that are not loaded stay queued.
+     * Java reference: EntityPlayerMP.onUpdate() — loadedChunks → S26
+     */
+    void sendChunks(PlayerChunkState& player, WorldServer& world);
+
+    /**
+     * Unload a chunk on the player's client (PlayerManager::onUnwatchChunk),
+     * after any packet still carrying it.
+     */
+    void unwatchChunk(int32_t playerId, int32_t chunkX, int32_t chunkZ);
+
+    /**
+     * Send the changed blocks of `instance` to `recipients`
+     * (PlayerManager::onChunkUpdate), after any packet still carrying the chunk.
+     * Java reference: PlayerManager.PlayerInstance.sendChunkUpdate()
+     */
+    void sendChunkUpdate(WorldServer& world, const PlayerInstance& instance,
+                         const std::vector<int32_t>& recipients);
+
+    ChunkSendStats getStats() const;
+    int getThreadCount() const { return threadCount_; }
+
+private:
+    // Per-player state shared by the tick thread and the workers
+    struct Session {
+        std::shared_ptr<Connection> conn;
+        std::atomic<int>  packetsInFlight{0};
+        std::atomic<bool> closed{false};
+
+        std::mutex mutex;   // guards the containers below and ordering on conn
+        std::unordered_map<int64_t, int> inFlight;   // chunk key → packets carrying it
+        std::vector<std::pair<int64_t, SharedPacket>> pendingUpdates;  // send once out of flight
+        std::vector<int64_t> pendingUnloads;         // unload once out of flight
+    };
+
+    struct Job {
+        std::shared_ptr<Session> session;
+        ChunkBulkData bulk;
+    };
+
+    void workerLoop();
+    void runJob(Job& job, size_t backlog);
+
+    static int64_t chunkKey(int32_t chunkX, int32_t chunkZ) {
+        return (static_cast<int64_t>(chunkX) & 0xFFFFFFFFL) |
+               ((static_cast<int64_t>(chunkZ) & 0xFFFFFFFFL) << 32);
+    }
+
+    int threadCount_;
+    std::vector<std::thread> workers_;
+
+    DeflatePolicy       policy_;
+    double              smoothedLoad_ = 0.0;   // tick thread only
+    std::atomic<double> serverLoad_{0.0};
+
+    mutable std::mutex      queueMutex_;
+    std::condition_variable queueCv_;
+    std::deque<Job>         queue_;
+    bool                    stopping_ = false;
+
+    // Tick thread only
+    std::unordered_map<int32_t, std::shared_ptr<Session>> sessions_;
+
+    std::atomic<uint64_t> chunks_{0};
+    std::atomic<uint64_t> packets_{0};
+    std::atomic<uint64_t> rawBytes_{0};
+    std::atomic<uint64_t> packetBytes_{0};
+    std::atomic<uint64_t> workerNanos_{0};
+    std::atomic<int>      deflateLevel_{0};
+    std::atomic<uint64_t> blockChanges_{0};
+    std::atomic<uint64_t> multiBlockChanges_{0};
+    std::atomic<uint64_t> sectionResends_{0};
+};
+
+} // namespace mccpp
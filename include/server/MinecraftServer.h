@@ -10,13 +10,21 @@
  */
 #pragma once
 
+#include "networking/DeflateEngine.h"
+#include "networking/NetworkReactor.h"
+#include "networking/PacketBuffer.h"
+#include "world/AnvilChunkLoader.h"
+
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <functional>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace mccpp {
@@ -24,6 +32,11 @@ namespace mccpp {
 class TcpListener;   // forward decl
 class Connection;    // forward decl
 class WorldServer;   // forward decl
+class ServerKeyPair; // forward decl
+class SessionAuthenticator; // forward decl
+class CommandHandler;        // forward decl
+class PacketCapture;         // forward decl
+class ChunkSendPipeline;     // forward decl
 
 /**
  * MinecraftServer — the central server object.
@@ -41,6 +54,18 @@ public:
     static constexpr const char* GAME_VERSION = "1.7.10";
     static constexpr int TICKS_PER_SECOND = 20;
     static constexpr int MS_PER_TICK = 1000 / TICKS_PER_SECOND; // 50ms
+    // Java: NetworkManager.processReceivedPackets() — max packets handled per tick
+    static constexpr int MAX_PACKETS_PER_TICK = 1000;
+    // Connections that have not reached Play are closed after these.
+    // Java reference: NetHandlerLoginServer.onNetworkTick() — 600 ticks to log in
+    static constexpr int HANDSHAKE_TIMEOUT_MS = 5000;    // Handshake / Status
+    static constexpr int LOGIN_TIMEOUT_MS     = 30000;   // Login
+    static constexpr int TICK_TIME_SAMPLES = 100;
+    // Java: WorldSettings.GameType IDs
+    static constexpr int GAME_TYPE_SURVIVAL = 0;
+    static constexpr int GAME_TYPE_CREATIVE = 1;
+    // Java: MinecraftServer.tick() — saveAllWorlds every 900 ticks (45 s)
+    static constexpr int AUTOSAVE_TICKS = 900;
 
     MinecraftServer();
     ~MinecraftServer();
@@ -86,21 +111,176 @@ public:
     int getMaxPlayers() const { return maxPlayers_; }
     void setMaxPlayers(int max) { maxPlayers_ = max; }
 
-    int getOnlinePlayerCount() const;
+    bool isOnlineMode() const { return onlineMode_; }
+    void setOnlineMode(bool online) { onlineMode_ = online; }
+
+    /**
+     * Game mode of every player: GAME_TYPE_SURVIVAL or GAME_TYPE_CREATIVE.
+     * Until there is an inventory and dig-time validation, only creative
+     * players may place blocks or break blocks that take time to dig.
+     * Java reference: server.properties "gamemode" (WorldSettings.GameType)
+     */
+    int getGameType() const { return gameType_; }
+    void setGameType(int gameType) { gameType_ = gameType; }
+    bool isCreative() const { return gameType_ == GAME_TYPE_CREATIVE; }
+
+    /**
+     * RSA key pair for the online-mode handshake (null in offline mode).
+     * Java reference: MinecraftServer.getKeyPair()
+     */
+    const ServerKeyPair* getKeyPair() const { return keyPair_.get(); }
+
+    /**
+     * Session verification backend. Defaults to the Mojang session server;
+     * replace before init() to use a local stub.
+     * Java reference: MinecraftServer.func_147130_as() (MinecraftSessionService)
+     */
+    std::shared_ptr<SessionAuthenticator> getSessionAuthenticator() const { return authenticator_; }
+    void setSessionAuthenticator(std::shared_ptr<SessionAuthenticator> authenticator) {
+        authenticator_ = std::move(authenticator);
+    }
+
+    /**
+     * Run `task` on its own authenticator thread. The server owns the thread
+     * and joins it during shutdown, before connections and worlds are torn
+     * down; once shutdown has begun the task is not started and false is
+     * returned. Tasks should check isRunning() before acting on their result.
+     * Java reference: NetHandlerLoginServer — new Thread("User Authenticator #" + n)
+     */
+    bool startAuthenticator(std::function<void()> task);
+
+    /**
+     * Log all inbound traffic to `path` (see PacketCapture). Set before init().
+     */
+    void setCaptureFile(const std::string& path) { captureFile_ = path; }
+
+    int getNetworkThreads() const { return networkThreads_; }
+    void setNetworkThreads(int threads) { networkThreads_ = threads; }
+
+    int getChunkSendThreads() const { return chunkSendThreads_; }
+    void setChunkSendThreads(int threads) { chunkSendThreads_ = threads; }
+
+    /**
+     * Deflate backend and level for chunk packets. Set before init().
+     */
+    const DeflatePolicy& getChunkCompression() const { return chunkCompression_; }
+    void setChunkCompression(const DeflatePolicy& policy) { chunkCompression_ = policy; }
+
+    /**
+     * Load and save chunks under `dir` (Anvil region files); empty (the
+     * default) keeps no world on disk. Set before init().
+     * Java reference: MinecraftServer.getFolderName() / ISaveHandler
+     */
+    const std::string& getWorldDirectory() const { return worldDirectory_; }
+    void setWorldDirectory(const std::string& dir) { worldDirectory_ = dir; }
+
+    /**
+     * Chunk I/O threads and durability policy. Set before init().
+     */
+    const ChunkIoConfig& getChunkIoConfig() const { return chunkIo_; }
+    void setChunkIoConfig(const ChunkIoConfig& config) { chunkIo_ = config; }
+
+    /**
+     * World for a dimension ID, or null. Tick thread only.
+     * Java reference: MinecraftServer.worldServerForDimension(int)
+     */
+    WorldServer* worldServerForDimension(int dimension);
+
+    /**
+     * Worker pool that builds chunk packets for players (null before init()).
+     */
+    ChunkSendPipeline* getChunkSendPipeline() { return chunkSender_.get(); }
+
+    /**
+     * Connections in Play state, as counted at the start of the last tick.
+     */
+    int getOnlinePlayerCount() const { return onlinePlayers_.load(std::memory_order_relaxed); }
+
+    /**
+     * Serialized S00PacketServerInfo for the server list, rebuilt on the tick
+     * thread whenever the player count changes. Thread-safe.
+     * Java reference: MinecraftServer.func_147134_at() (cached ServerStatusResponse)
+     */
+    SharedPacket getStatusResponse() const { return std::atomic_load(&statusResponse_); }
+
+    /**
+     * Queue a console command for the next tick.
+     * Java reference: DedicatedServer.addPendingCommand()
+     * Thread-safe.
+     */
+    void addPendingCommand(const std::string& command);
+
+    /**
+     * Per-IP accept rate limit passed to the TcpListener (see
+     * TcpListener::setConnectionRateLimit). Set before init().
+     */
+    void setConnectionRateLimit(double perSecond, int burst) {
+        connectionRate_ = perSecond;
+        connectionBurst_ = burst;
+    }
 
     int getTickCount() const { return tickCount_.load(std::memory_order_relaxed); }
 
+    /**
+     * Mean and worst tick duration over the last TICK_TIME_SAMPLES ticks, in ms.
+     * Java reference: MinecraftServer.tickTimeArray (read by /debug and the GUI)
+     * Tick thread only.
+     */
+    double getAverageTickMillis() const;
+    double getMaxTickMillis() const;
+
+    /**
+     * Cumulative outbound write counters across all network threads.
+     */
+    NetworkWriteStats getNetworkWriteStats() const;
+
     /**
      * Register a new client connection (called from TcpListener callback).
      * Thread-safe.
      */
     void addConnection(std::shared_ptr<Connection> conn);
 
+    /**
+     * Take over a connected, non-blocking socket as if the listener had
+     * accepted it (used by PacketReplay with one end of a socketpair).
+     * Thread-safe; the server must have been initialized.
+     */
+    void adoptConnection(int fd, const std::string& address, uint16_t port) {
+        onClientAccepted(fd, address, port);
+    }
+
     /**
      * Remove a disconnected connection. Thread-safe.
      */
     void removeConnection(Connection* conn);
 
+    /**
+     * Queue one serialized frame on every connection in Play state.
+     * Java reference: ServerConfigurationManager.sendPacketToAllPlayers()
+     * Thread-safe. Written by the end-of-tick flush.
+     */
+    void broadcastPacket(SharedPacket packet);
+    void broadcastPacket(PacketBuffer packet) { broadcastPacket(sharePacket(std::move(packet))); }
+
+    /**
+     * Players in the world, by entity ID (PlayHandler joins and leaves).
+     * Java reference: ServerConfigurationManager.playerEntityList
+     * Tick thread only.
+     */
+    void addPlayer(int32_t entityId, std::shared_ptr<Connection> conn);
+    void removePlayer(int32_t entityId);
+
+    /**
+     * Queue `packet` (a sound, particle or world effect) for every player
+     * within `distance` of (x, y, z) in `world` except `excludeEntityId`.
+     * Recipients come from PlayerManager::getPlayersNear, the watchers of the
+     * chunks around the point; all of them share the one frame.
+     * Java reference: ServerConfigurationManager.sendToAllNearExcept()
+     * Tick thread only.
+     */
+    void sendToAllNearExcept(WorldServer& world, double x, double y, double z, double distance,
+                             const SharedPacket& packet, int32_t excludeEntityId = -1);
+
 private:
     /**
      * Execute a single server tick.
@@ -108,6 +288,44 @@ private:
      */
     void tick();
 
+    /**
+     * Network phase: handle queued Play packets for every connection on the
+     * tick thread, up to MAX_PACKETS_PER_TICK each.
+     * Java reference: NetworkSystem.networkTick() → NetworkManager.processReceivedPackets()
+     */
+    void processReceivedPackets();
+
+    /**
+     * Flush every connection's outbound queue once, at the end of the tick.
+     * Java reference: NetworkSystem.networkTick() → NetworkManager.flush()
+     */
+    void flushConnections();
+
+    /**
+     * Run queued console commands on the tick thread.
+     * Java reference: DedicatedServer.executePendingCommands()
+     */
+    void executePendingCommands();
+
+    /**
+     * Queue every changed chunk of every world for saving; with `flush`, wait
+     * until all of it is written. Returns false if a write failed.
+     * Java reference: MinecraftServer.saveAllWorlds(boolean)
+     * Tick thread only.
+     */
+    bool saveAllWorlds(bool flush);
+
+    /**
+     * Start the thread that reads commands from stdin.
+     * Java reference: DedicatedServer — "Server console handler" thread
+     */
+    void startConsoleReader();
+
+    /**
+     * Rebuild the cached status packet for `online` players.
+     */
+    void refreshStatusResponse(int online);
+
     /**
      * Called when a new client is accepted by the TCP listener.
      */
@@ -119,19 +337,75 @@ private:
     std::string motd_        = "A MineCPPaft Server";
     int         maxPlayers_  = 20;
     bool        onlineMode_  = true;
+    int         gameType_    = GAME_TYPE_SURVIVAL;
+    int         networkThreads_ = 0; // 0 = NetworkReactor::defaultThreadCount()
+    int         chunkSendThreads_ = 0; // 0 = ChunkSendPipeline::defaultThreadCount()
+    DeflatePolicy chunkCompression_;
+    std::string   worldDirectory_;     // empty = chunks are not saved
+    ChunkIoConfig chunkIo_;
+    double      connectionRate_  = 2.0;  // accepts per second per IP (0 = unlimited)
+    int         connectionBurst_ = 8;
+
+    // ─── Online mode ────────────────────────────────────────────────────
+    std::unique_ptr<ServerKeyPair>        keyPair_;
+    std::shared_ptr<SessionAuthenticator> authenticator_;
+
+    // Authenticator threads; finished ones are joined by the next
+    // startAuthenticator(), the rest at shutdown
+    struct AuthThread {
+        std::thread       thread;
+        std::atomic<bool> done{false};
+    };
+    std::mutex            authMutex_;
+    std::list<AuthThread> authThreads_;      // guarded by authMutex_
+    bool                  authStopped_ = false;  // guarded by authMutex_
+
+    void joinAuthenticators();
+
+    // ─── Traffic capture ────────────────────────────────────────────────
+    std::string                    captureFile_;
+    std::shared_ptr<PacketCapture> capture_;
 
     // ─── Runtime state ──────────────────────────────────────────────────
     std::atomic<bool> running_{false};
     std::atomic<int>  tickCount_{0};
+    std::atomic<int>  onlinePlayers_{0};
+    int64_t           tickTimesNs_[TICK_TIME_SAMPLES] = {};   // tick thread only
+    int64_t           tickTimeTotalNs_ = 0;                   // whole run, tick thread only
+    int64_t           tickTimeMaxNs_ = 0;
+    bool              autosaving_ = false;   // autosave still has chunks to queue
+
+    // Cached status response (std::atomic_load/atomic_store) and the player
+    // count it was built for (tick thread only)
+    SharedPacket statusResponse_;
+    int          statusPlayers_ = -1;
 
     // ─── Networking ─────────────────────────────────────────────────────
+    std::unique_ptr<NetworkReactor> reactor_;
     std::unique_ptr<TcpListener> listener_;
 
     mutable std::mutex connectionsMutex_;
     std::vector<std::shared_ptr<Connection>> connections_;
 
+    // Tick thread only
+    std::unordered_map<int32_t, std::shared_ptr<Connection>> players_;
+    std::vector<int32_t> nearbyPlayers_;   // scratch for sendToAllNearExcept
+
+    // Write counters at the previous status report (tick thread only)
+    NetworkWriteStats reportedWriteStats_;
+
+    // ─── Console ─────────────────────────────────────────────────────────
+    std::unique_ptr<CommandHandler> commandHandler_;
+    // Shared with the detached console reader, which may outlive the server
+    struct PendingCommands {
+        std::mutex               mutex;
+        std::vector<std::string> commands;
+    };
+    std::shared_ptr<PendingCommands> pendingCommands_ = std::make_shared<PendingCommands>();
+
     // ─── Worlds ──────────────────────────────────────────────────────────
     std::vector<std::unique_ptr<WorldServer>> worlds_;
+    std::unique_ptr<ChunkSendPipeline>        chunkSender_;
 
     // ─── Timing (Java reference: MinecraftServer.run() tick timing) ─────
     using Clock = std::chrono::steady_clock;
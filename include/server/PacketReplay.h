@@ -0,0 +1,79 @@
+/**
+ * PacketReplay.h — Feeds a PacketCapture file back into a running server.
+ *
+ * Java reference: none in vanilla.
+ *
+ * Every captured session becomes a local connection: one end of an AF_UNIX
+ * socketpair is handed to MinecraftServer::adoptConnection(), so the replayed
+ * bytes take the same path as network traffic (framing, the Play inbox, the
+ * tick-thread handlers) without a TCP socket. Frames are written in capture
+ * order at the recorded pace divided by `speed` (0 = as fast as possible);
+ * everything the server sends back is read and discarded. At full speed,
+ * sessions are only closed once the replay has settled. A session that sends
+ * more than a Play inbox's worth of packets within one tick is kicked for
+ * flooding, as it would be over the network.
+ *
+ * The server must run in offline mode (captures contain no encryption
+ * response). When the last record has been played the driver waits for the
+ * sessions to settle, logs a summary and, if asked to, stops the server.
+ */
+#pragma once
+
+#include "networking/PacketCapture.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mccpp {
+
+class MinecraftServer;   // forward decl
+
+class PacketReplay {
+public:
+    PacketReplay(MinecraftServer& server, std::vector<CaptureRecord> records, double speed);
+    ~PacketReplay();
+
+    PacketReplay(const PacketReplay&) = delete;
+    PacketReplay& operator=(const PacketReplay&) = delete;
+
+    /**
+     * Start the driver thread; it waits until the server is running.
+     * With `stopServerWhenDone` the server is stopped after the replay.
+     */
+    void start(bool stopServerWhenDone);
+
+    /**
+     * Abort (if still playing) and join the driver thread.
+     */
+    void stop();
+
+    bool isFinished() const { return finished_.load(std::memory_order_acquire); }
+
+private:
+    void run();
+    bool writeFrame(int fd, const std::vector<uint8_t>& frame);
+    void drainResponses();
+    void closeSession(uint32_t session);
+
+    MinecraftServer&           server_;
+    std::vector<CaptureRecord> records_;
+    double                     speed_;
+    bool                       stopServer_ = false;
+
+    std::thread       thread_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> finished_{false};
+
+    // Driver-side socket of each open session (driver thread only)
+    std::unordered_map<uint32_t, int> sessions_;
+    uint64_t framesSent_ = 0;
+    uint64_t bytesSent_ = 0;
+    uint64_t bytesReceived_ = 0;
+
+    static constexpr int SETTLE_MS = 1000;   // after the last record
+};
+
+} // namespace mccpp
@@ -7,13 +7,22 @@
  *   - PlayerInstance: per-chunk watcher list, tracks which players see each chunk
  *   - playerInstances: LongHashMap keyed by (chunkX+MAX_INT) | ((chunkZ+MAX_INT) << 32)
  *   - playerViewRadius: clamped [3, 20], controls chunk loading square around player
- *   - addPlayer: creates ±viewRadius square of PlayerInstances
+ *   - addPlayer: creates ±viewRadius square of PlayerInstances, queues each
+ *     chunk on the player's loadedChunks
  *   - removePlayer: removes player from existing ±viewRadius instances
+ *   - A chunk a player stops watching is dropped from loadedChunks if still
+ *     queued, otherwise reported through onUnwatchChunk (client must unload
+ *     it); an instance without watchers is removed and its chunk unloaded
  *   - updateMountedMovingPlayer: 64.0 distance² threshold (8 blocks), diff old/new grids
  *   - filterChunkLoadQueue: spiral outward from center for optimal send order
- *   - updatePlayerInstances: full update every 8000 ticks, else only dirty instances
- *   - markBlockForUpdate: route to PlayerInstance via block→chunk coords
+ *   - markBlockForUpdate: route to PlayerInstance via block→chunk coords; the
+ *     first change of a tick puts the instance on the dirty list
+ *   - updatePlayerInstances: flush only the dirty instances (idle chunks cost
+ *     nothing per tick) through onChunkUpdate, which builds one packet per
+ *     instance for all its watchers (S23 / S22 / S21 by change count)
  *   - View distance change: add new / remove old instances for all players
+ *   - getPlayersNear: recipients of a positional effect from the watchers of
+ *     the chunks around it, instead of a distance check of every player
  *
  * Thread safety: Called from main server thread.
  * JNI readiness: Predictable fields, clear player→chunk association.
@@ -21,6 +30,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <functional>
 #include <string>
@@ -36,13 +46,18 @@ namespace mccpp {
 // ═══════════════════════════════════════════════════════════════════════════
 
 struct PlayerInstance {
+    // Java: 64 — at this many changes the touched sections are resent whole
+    static constexpr int32_t MAX_TRACKED_CHANGES = 64;
+
     int32_t chunkX, chunkZ;
     std::unordered_set<int32_t> watchingPlayers; // Player entity IDs
-    bool dirty = false;
 
-    // Pending block updates within this chunk
+    // Changed blocks since the last update, each once.
+    // Java: locationOfBlockChange — localX << 12 | localZ << 8 | y
     int32_t numBlocksToUpdate = 0;
-    int16_t pendingUpdates[64] = {};  // Encoded block positions
+    int16_t pendingUpdates[MAX_TRACKED_CHANGES] = {};
+    // Java: flagsYAreasToUpdate — bit per 16-block section touched
+    uint16_t sectionsToUpdate = 0;
 
     PlayerInstance() : chunkX(0), chunkZ(0) {}
     PlayerInstance(int32_t cx, int32_t cz) : chunkX(cx), chunkZ(cz) {}
@@ -56,22 +71,29 @@ struct PlayerInstance {
     }
 
     bool hasPlayers() const { return !watchingPlayers.empty(); }
-
-    // Java: flagChunkForUpdate(localX, y, localZ)
-    void flagBlockForUpdate(int32_t localX, int32_t y, int32_t localZ) {
-        if (numBlocksToUpdate < 64) {
-            // Encode: localX | (localZ << 4) | (y << 8)
-            pendingUpdates[numBlocksToUpdate] =
-                static_cast<int16_t>(localX | (localZ << 4) | (y << 8));
+    bool isDirty() const { return numBlocksToUpdate != 0; }
+
+    /**
+     * Java: flagChunkForUpdate(localX, y, localZ). Returns true for the first
+     * change since the last update (the instance just became dirty).
+     */
+    bool flagBlockForUpdate(int32_t localX, int32_t y, int32_t localZ) {
+        bool first = numBlocksToUpdate == 0;
+        sectionsToUpdate |= static_cast<uint16_t>(1u << (y >> 4));
+        if (numBlocksToUpdate < MAX_TRACKED_CHANGES) {
+            auto location = static_cast<int16_t>(localX << 12 | localZ << 8 | y);
+            for (int32_t i = 0; i < numBlocksToUpdate; ++i) {
+                if (pendingUpdates[i] == location) return first;
+            }
+            pendingUpdates[numBlocksToUpdate++] = location;
         }
-        ++numBlocksToUpdate;
-        dirty = true;
+        return first;
     }
 
-    // Java: onUpdate — called when dirty, sends block changes to watching players
-    void onUpdate() {
+    // Java: sendChunkUpdate — the tail that resets the change list
+    void clearUpdates() {
         numBlocksToUpdate = 0;
-        dirty = false;
+        sectionsToUpdate = 0;
     }
 };
 
@@ -99,9 +121,9 @@ struct ChunkCoordPairHash {
 
 struct PlayerChunkState {
     int32_t entityId;
-    double posX, posZ;
+    double posX, posY, posZ;
     double managedPosX, managedPosZ;  // Last known position for chunk tracking
-    std::vector<ChunkCoordPair> loadedChunks;  // Chunks queued to send
+    std::vector<ChunkCoordPair> loadedChunks;  // Chunks queued to send, nearest first
 };
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -115,10 +137,17 @@ public:
     using LoadChunkFn = std::function<void(int32_t chunkX, int32_t chunkZ)>;
     using UnloadChunkFn = std::function<void(int32_t chunkX, int32_t chunkZ)>;
     using SendChunkFn = std::function<void(int32_t playerId, int32_t chunkX, int32_t chunkZ)>;
-    using SendBlockUpdateFn = std::function<void(int32_t playerId, int32_t x, int32_t y, int32_t z)>;
+    // Java: PlayerInstance.removePlayer — S21PacketChunkData(chunk, true, 0)
+    using UnwatchChunkFn = std::function<void(int32_t playerId, int32_t chunkX, int32_t chunkZ)>;
+    // Java: PlayerInstance.sendChunkUpdate — the instance's changes, for the
+    // watchers that already have (or are being sent) the chunk
+    using ChunkUpdateFn = std::function<void(const PlayerInstance& instance,
+                                             const std::vector<int32_t>& recipients)>;
 
     LoadChunkFn onLoadChunk;
     UnloadChunkFn onUnloadChunk;
+    UnwatchChunkFn onUnwatchChunk;
+    ChunkUpdateFn onChunkUpdate;
 
     // ─── Configuration ───
     int32_t playerViewRadius = 10;  // Java default, clamped [3, 20]
@@ -169,11 +198,11 @@ public:
 
         for (int32_t x = cx - playerViewRadius; x <= cx + playerViewRadius; ++x) {
             for (int32_t z = cz - playerViewRadius; z <= cz + playerViewRadius; ++z) {
-                getPlayerInstance(x, z, true)->addPlayer(player.entityId);
+                watchChunk(player, x, z);
             }
         }
 
-        players_.push_back(player.entityId);
+        players_[player.entityId] = &player;
         filterChunkLoadQueue(player);
     }
 
@@ -186,21 +215,15 @@ public:
         int32_t cx = static_cast<int32_t>(player.managedPosX) >> 4;
         int32_t cz = static_cast<int32_t>(player.managedPosZ) >> 4;
 
+        // The player is leaving: nothing needs to be unloaded on its client
         for (int32_t x = cx - playerViewRadius; x <= cx + playerViewRadius; ++x) {
             for (int32_t z = cz - playerViewRadius; z <= cz + playerViewRadius; ++z) {
-                auto* inst = getPlayerInstance(x, z, false);
-                if (inst) {
-                    inst->removePlayer(player.entityId);
-                    // Unload chunk if no watchers
-                    if (!inst->hasPlayers() && onUnloadChunk) {
-                        onUnloadChunk(x, z);
-                    }
-                }
+                unwatchChunk(player, x, z, false);
             }
         }
+        player.loadedChunks.clear();
 
-        players_.erase(std::remove(players_.begin(), players_.end(), player.entityId),
-                         players_.end());
+        players_.erase(player.entityId);
     }
 
     // ═══════════════════════════════════════════════════════════════════════
@@ -228,17 +251,11 @@ public:
             for (int32_t z = newCZ - r; z <= newCZ + r; ++z) {
                 // Add to new chunks the player wasn't watching
                 if (!overlaps(x, z, oldCX, oldCZ, r)) {
-                    getPlayerInstance(x, z, true)->addPlayer(player.entityId);
+                    watchChunk(player, x, z);
                 }
                 // Remove from old chunks the player no longer watches
                 if (!overlaps(x - diffX, z - diffZ, newCX, newCZ, r)) {
-                    auto* inst = getPlayerInstance(x - diffX, z - diffZ, false);
-                    if (inst) {
-                        inst->removePlayer(player.entityId);
-                        if (!inst->hasPlayers() && onUnloadChunk) {
-                            onUnloadChunk(x - diffX, z - diffZ);
-                        }
-                    }
+                    unwatchChunk(player, x - diffX, z - diffZ, true);
                 }
             }
         }
@@ -307,21 +324,20 @@ public:
     }
 
     // ═══════════════════════════════════════════════════════════════════════
-    // updatePlayerInstances — Tick update for chunk watchers.
-    // Java: Every 8000 ticks = full update, otherwise only dirty instances.
+    // updatePlayerInstances — Send the tick's block changes.
+    // Java: updatePlayerInstances — walks playerInstancesToUpdate only. Its
+    // full pass every 8000 ticks just adds Chunk.inhabitedTime, which nothing
+    // here reads yet.
     // ═══════════════════════════════════════════════════════════════════════
 
-    void updatePlayerInstances(int64_t totalWorldTime, bool canRespawnHere) {
-        if (totalWorldTime - previousTotalWorldTime_ > 8000L) {
-            previousTotalWorldTime_ = totalWorldTime;
-            for (auto& [key, inst] : playerInstances_) {
-                inst.onUpdate();
-            }
-        } else {
-            for (auto& [key, inst] : playerInstances_) {
-                if (inst.dirty) inst.onUpdate();
-            }
+    void updatePlayerInstances(int64_t /*totalWorldTime*/, bool canRespawnHere) {
+        for (int64_t key : dirtyInstances_) {
+            // Instances dropped since they were flagged have no watchers left
+            auto it = playerInstances_.find(key);
+            if (it == playerInstances_.end() || !it->second.isDirty()) continue;
+            sendChunkUpdate(it->second);
         }
+        dirtyInstances_.clear();
 
         // If no players and dimension can't respawn, unload all
         if (players_.empty() && !canRespawnHere) {
@@ -340,8 +356,48 @@ public:
         int32_t chunkX = blockX >> 4;
         int32_t chunkZ = blockZ >> 4;
         auto* inst = getPlayerInstance(chunkX, chunkZ, false);
-        if (inst) {
-            inst->flagBlockForUpdate(blockX & 0xF, blockY, blockZ & 0xF);
+        if (inst && inst->flagBlockForUpdate(blockX & 0xF, blockY, blockZ & 0xF)) {
+            dirtyInstances_.push_back(instanceKey(chunkX, chunkZ));
+        }
+    }
+
+    size_t getDirtyInstanceCount() const { return dirtyInstances_.size(); }
+
+    // ═══════════════════════════════════════════════════════════════════════
+    // getPlayersNear — Players within `distance` of a point, for effects.
+    // Java: ServerConfigurationManager.sendToAllNearExcept checks every
+    // player in the dimension; a player in range watches the chunks around
+    // the point, so only their watchers are checked here. Within the view
+    // distance that is the point's own chunk.
+    // ═══════════════════════════════════════════════════════════════════════
+
+    void getPlayersNear(double x, double y, double z, double distance, int32_t excludeId,
+                        std::vector<int32_t>& out) const {
+        out.clear();
+        int32_t cx = static_cast<int32_t>(std::floor(x)) >> 4;
+        int32_t cz = static_cast<int32_t>(std::floor(z)) >> 4;
+        int32_t r = distance <= getFurthestViewableBlock(playerViewRadius)
+                        ? 0 : (static_cast<int32_t>(distance) >> 4) + 1;
+        double dist2 = distance * distance;
+
+        for (int32_t x0 = cx - r; x0 <= cx + r; ++x0) {
+            for (int32_t z0 = cz - r; z0 <= cz + r; ++z0) {
+                auto it = playerInstances_.find(instanceKey(x0, z0));
+                if (it == playerInstances_.end()) continue;
+                for (int32_t playerId : it->second.watchingPlayers) {
+                    if (playerId == excludeId) continue;
+                    auto player = players_.find(playerId);
+                    if (player == players_.end()) continue;
+                    const PlayerChunkState& p = *player->second;
+                    double dx = x - p.posX, dy = y - p.posY, dz = z - p.posZ;
+                    if (dx * dx + dy * dy + dz * dz < dist2) out.push_back(playerId);
+                }
+            }
+        }
+        if (r > 0) {
+            // A player watches every chunk of its view square
+            std::sort(out.begin(), out.end());
+            out.erase(std::unique(out.begin(), out.end()), out.end());
         }
     }
 
@@ -380,6 +436,55 @@ public:
     }
 
 private:
+    // Java: PlayerInstance.addPlayer — watch and queue the chunk for sending
+    void watchChunk(PlayerChunkState& player, int32_t chunkX, int32_t chunkZ) {
+        getPlayerInstance(chunkX, chunkZ, true)->addPlayer(player.entityId);
+        player.loadedChunks.push_back({chunkX, chunkZ});
+    }
+
+    // Java: PlayerInstance.removePlayer — a chunk that was still queued was
+    // never sent; anything else has to be unloaded on the client (`notify`)
+    void unwatchChunk(PlayerChunkState& player, int32_t chunkX, int32_t chunkZ, bool notify) {
+        int64_t key = instanceKey(chunkX, chunkZ);
+        auto it = playerInstances_.find(key);
+        if (it == playerInstances_.end()) return;
+        PlayerInstance& inst = it->second;
+        if (inst.watchingPlayers.erase(player.entityId) == 0) return;
+
+        auto queued = std::find(player.loadedChunks.begin(), player.loadedChunks.end(),
+                                ChunkCoordPair{chunkX, chunkZ});
+        if (queued != player.loadedChunks.end()) {
+            player.loadedChunks.erase(queued);
+        } else if (notify && onUnwatchChunk) {
+            onUnwatchChunk(player.entityId, chunkX, chunkZ);
+        }
+
+        // Java: the instance is dropped with its last watcher, so a later
+        // getPlayerInstance(create) loads the chunk again
+        if (!inst.hasPlayers()) {
+            playerInstances_.erase(it);
+            instanceList_.erase(std::remove(instanceList_.begin(), instanceList_.end(), key),
+                                instanceList_.end());
+            if (onUnloadChunk) onUnloadChunk(chunkX, chunkZ);
+        }
+    }
+
+    // Java: PlayerInstance.sendChunkUpdate. Watchers that still have the
+    // chunk queued get the current data with it and are skipped.
+    void sendChunkUpdate(PlayerInstance& inst) {
+        recipients_.clear();
+        ChunkCoordPair coords{inst.chunkX, inst.chunkZ};
+        for (int32_t playerId : inst.watchingPlayers) {
+            auto player = players_.find(playerId);
+            if (player == players_.end()) continue;
+            const auto& queued = player->second->loadedChunks;
+            if (std::find(queued.begin(), queued.end(), coords) != queued.end()) continue;
+            recipients_.push_back(playerId);
+        }
+        if (!recipients_.empty() && onChunkUpdate) onChunkUpdate(inst, recipients_);
+        inst.clearUpdates();
+    }
+
     // Java: overlaps(x, z, cx, cz, radius)
     static bool overlaps(int32_t x, int32_t z, int32_t cx, int32_t cz, int32_t r) {
         int32_t dx = x - cx;
@@ -389,8 +494,10 @@ private:
 
     std::unordered_map<int64_t, PlayerInstance> playerInstances_;
     std::vector<int64_t> instanceList_;
-    std::vector<int32_t> players_;
-    int64_t previousTotalWorldTime_ = 0;
+    std::unordered_map<int32_t, PlayerChunkState*> players_;   // by entity ID
+    // Java: playerInstancesToUpdate — keys of instances with pending changes
+    std::vector<int64_t> dirtyInstances_;
+    std::vector<int32_t> recipients_;   // scratch for sendChunkUpdate
 };
 
 } // namespace mccpp
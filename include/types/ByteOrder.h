@@ -0,0 +1,81 @@
+/**
+ * ByteOrder.h — Big-endian loads and stores for protocol and NBT data.
+ *
+ * Java reference: java.io.DataInputStream / DataOutputStream (network order).
+ *
+ * Header-only. Each access is one unaligned memcpy plus a byte swap, which
+ * compiles to a single load/store + bswap (or movbe) instead of a shift per byte.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace mccpp {
+
+namespace detail {
+
+template <typename U>
+inline U byteSwap(U v) {
+    static_assert(std::is_unsigned_v<U>, "byteSwap takes an unsigned integer");
+    if constexpr (sizeof(U) == 1) {
+        return v;
+    } else {
+#if defined(__GNUC__) || defined(__clang__)
+        if constexpr (sizeof(U) == 2) return __builtin_bswap16(v);
+        else if constexpr (sizeof(U) == 4) return __builtin_bswap32(v);
+        else return __builtin_bswap64(v);
+#else
+        U r = 0;
+        for (size_t i = 0; i < sizeof(U); ++i) {
+            r = static_cast<U>((r << 8) | ((v >> (8 * i)) & 0xFF));
+        }
+        return r;
+#endif
+    }
+}
+
+template <size_t N> struct UnsignedOfSize;
+template <> struct UnsignedOfSize<1> { using type = uint8_t; };
+template <> struct UnsignedOfSize<2> { using type = uint16_t; };
+template <> struct UnsignedOfSize<4> { using type = uint32_t; };
+template <> struct UnsignedOfSize<8> { using type = uint64_t; };
+
+inline constexpr bool HOST_IS_BIG_ENDIAN =
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    true;
+#else
+    false;
+#endif
+
+} // namespace detail
+
+/**
+ * Store an integer or floating-point value big-endian at `p` (unaligned).
+ */
+template <typename T>
+inline void storeBigEndian(uint8_t* p, T value) {
+    using U = typename detail::UnsignedOfSize<sizeof(T)>::type;
+    U bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    if constexpr (!detail::HOST_IS_BIG_ENDIAN) bits = detail::byteSwap(bits);
+    std::memcpy(p, &bits, sizeof(T));
+}
+
+/**
+ * Load a big-endian integer or floating-point value from `p` (unaligned).
+ */
+template <typename T>
+inline T loadBigEndian(const uint8_t* p) {
+    using U = typename detail::UnsignedOfSize<sizeof(T)>::type;
+    U bits;
+    std::memcpy(&bits, p, sizeof(T));
+    if constexpr (!detail::HOST_IS_BIG_ENDIAN) bits = detail::byteSwap(bits);
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+} // namespace mccpp
@@ -11,6 +11,14 @@
 
 namespace mccpp {
 
+/**
+ * Escape `str` for use inside a JSON string literal: quotes, backslashes
+ * and control characters. Anything a player typed must go through this
+ * before it is put into a chat component, or one `"` breaks the JSON and
+ * every client that receives it disconnects.
+ */
+std::string jsonEscape(const std::string& str);
+
 /**
  * Minimal chat component — enough for server messages, kick reasons,
  * and MOTD. Full implementation (click events, hover events, selectors)
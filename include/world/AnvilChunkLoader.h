@@ -1,7 +1,9 @@
 /**
- * AnvilChunkLoader.h — Anvil region file chunk serialization/deserialization.
+ * AnvilChunkLoader.h — Anvil region file chunk serialization/deserialization
+ * and the chunk I/O worker pool.
  *
  * Java reference: net.minecraft.world.chunk.storage.AnvilChunkLoader (318 lines)
+ *                 net.minecraft.world.storage.ThreadedFileIOBase
  *
  * Architecture:
  *   - Chunk NBT format: Level{V:1, xPos, zPos, LastUpdate, HeightMap int[256],
@@ -9,24 +11,58 @@
  *     Blocks byte[4096], Add nibble[2048]?, Data nibble[2048],
  *     BlockLight nibble[2048], SkyLight nibble[2048]}, Biomes byte[256],
  *     Entities[], TileEntities[], TileTicks[]{i,x,y,z,t,p}}
- *   - Threaded I/O: pending queue with coordinate set, writeNextIO pops first
- *   - Load: check pending queue first, else read from RegionFile
- *   - Save: serialize to NBT, queue for async write
+ *   - Save: the caller serializes the chunk ({Level: ...}), which is its
+ *     snapshot; the bytes wait in a pending map keyed by chunk coordinates.
+ *   - Load: the pending map first (read-your-writes), else the RegionFile.
  *
- * Thread safety:
- *   - mutex on pending chunks queue and coordinate set
- *   - Writes happen on dedicated I/O thread
+ * Java keeps pending chunks in a list and a set, and scans the list on every
+ * save and load of a chunk; its single ThreadedFileIOBase thread writes one
+ * chunk at a time. Here the pending map is the only index (O(1) either way),
+ * and a pool of I/O threads takes batches in save order, groups them by
+ * region and hands each group to RegionFile::writeChunks(). Saving a chunk
+ * that is still pending only replaces its bytes (coalescing), so a chunk
+ * saved on every autosave while the disk is behind is written once. A chunk
+ * is never written by two threads at once: a save that arrives while its
+ * chunk is being written is requeued once that write is done, so the newest
+ * bytes always land last.
+ *
+ * Durability (ChunkSyncPolicy) decides when region files are fdatasync'ed:
+ *   - None:      never; headers reach the file when RegionFile flushes them,
+ *                and the sectors of rewritten chunks are reused as soon as
+ *                a header no longer points at them (nothing is crash-safe).
+ *   - PerRegion: after every batch written to a region — a chunk is durable
+ *                once it left the pending map.
+ *   - Periodic:  regions written to are synced every syncIntervalMs.
+ * flushAllPending() (shutdown, save-all) blocks until every save queued
+ * before it is written, then flushes all region headers, synced unless the
+ * policy is None.
+ *
+ * Open region files are an LRU cache of ChunkIoConfig::maxOpenRegions. When
+ * a new one would exceed it, the least recently used region no thread is
+ * using is synced (unless the policy is None) and closed. Java's
+ * RegionFileCache instead closes every file once 256 are open.
+ *
+ * Thread safety: everything may be called from any thread, except that
+ * start() and stop() must not race with other calls.
  *
  * JNI readiness: Predictable NBT key names, standard byte/nibble arrays.
  */
 #pragma once
 
+#include "world/Chunk.h"
+
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstring>
 #include <deque>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -134,13 +170,47 @@ struct AnvilChunkData {
 };
 
 // ═══════════════════════════════════════════════════════════════════════════
-// PendingChunk — Queued chunk write.
-// Java reference: AnvilChunkLoader$PendingChunk
+// Chunk I/O configuration and counters.
+// Not in Java: ThreadedFileIOBase has one thread and never syncs.
 // ═══════════════════════════════════════════════════════════════════════════
 
-struct PendingChunk {
-    int32_t chunkX, chunkZ;
-    AnvilChunkData data;
+enum class ChunkSyncPolicy : uint8_t {
+    None,        // no fdatasync
+    PerRegion,   // after every batch written to a region
+    Periodic     // regions written to, every syncIntervalMs
+};
+
+/**
+ * Parse "none", "region" or "periodic"; false if unknown.
+ */
+bool parseChunkSyncPolicy(const std::string& name, ChunkSyncPolicy& out);
+const char* chunkSyncPolicyName(ChunkSyncPolicy policy);
+
+/**
+ * Parse "sync" or "io_uring"; false if unknown.
+ */
+bool parseRegionIoMode(const std::string& name, RegionIoMode& out);
+const char* regionIoModeName(RegionIoMode mode);
+
+struct ChunkIoConfig {
+    int             threads = 0;                        // 0 = AnvilChunkLoader::defaultThreadCount()
+    ChunkSyncPolicy sync = ChunkSyncPolicy::Periodic;
+    int             syncIntervalMs = 5000;
+    RegionIoMode    ioMode = RegionIoMode::Sync;       // batched chunk writes via io_uring
+    size_t          maxOpenRegions = 256;               // Java: RegionFileCache limit
+};
+
+struct ChunkIoStats {
+    uint64_t savesQueued     = 0;   // queueChunkSave calls
+    uint64_t savesCoalesced  = 0;   // saves that replaced a pending one
+    uint64_t chunksWritten   = 0;   // chunk writes handed to region files
+    uint64_t writeFailures   = 0;
+    uint64_t batches         = 0;   // RegionFile::writeChunks calls
+    uint64_t bytesWritten    = 0;   // uncompressed NBT bytes
+    uint64_t loadsPending    = 0;   // loads answered from the pending map
+    uint64_t loadsDisk       = 0;   // loads read from a region file
+    uint64_t syncs           = 0;   // region flushes with fdatasync
+    size_t   pending         = 0;   // chunks waiting or being written
 };
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -150,9 +220,38 @@ struct PendingChunk {
 
 class AnvilChunkLoader {
 public:
+    // Chunks taken per batch; below RegionFile::HEADER_FLUSH_UPDATES so a
+    // batch on its own never makes a region write its header unsynced
+    static constexpr size_t MAX_BATCH = 32;
+    static_assert(MAX_BATCH < RegionFile::HEADER_FLUSH_UPDATES, "batch triggers a header write");
+
     std::string saveDirectory;
 
-    explicit AnvilChunkLoader(const std::string& dir) : saveDirectory(dir) {}
+    /**
+     * A quarter of the hardware threads, 1 to 4.
+     */
+    static int defaultThreadCount();
+
+    /**
+     * Chunks are stored in `dir`/region/r.X.Z.mca. Nothing is written until
+     * a save is queued.
+     */
+    explicit AnvilChunkLoader(const std::string& dir, const ChunkIoConfig& config = {});
+    ~AnvilChunkLoader();
+
+    AnvilChunkLoader(const AnvilChunkLoader&) = delete;
+    AnvilChunkLoader& operator=(const AnvilChunkLoader&) = delete;
+
+    /**
+     * Spawn the I/O threads. Without them, saves wait for flushAllPending().
+     */
+    void start();
+
+    /**
+     * Join the I/O threads, write everything still pending and close the
+     * region files.
+     */
+    void stop();
 
     // ═══════════════════════════════════════════════════════════════════════
     // Serialize chunk to NBT-compatible byte stream.
@@ -280,71 +379,47 @@ public:
     }
 
     // ═══════════════════════════════════════════════════════════════════════
-    // Threaded I/O — Pending write queue
-    // Java: addChunkToPending, writeNextIO, saveExtraData
-    // Thread safety: mutex on pending queue
+    // Threaded I/O — pending saves and the I/O threads
+    // Java: saveChunk, addChunkToPending, loadChunk, writeNextIO, saveExtraData
     // ═══════════════════════════════════════════════════════════════════════
 
-    void queueChunkSave(const AnvilChunkData& chunk) {
-        std::lock_guard lock(pendingMutex_);
-        int64_t key = chunkKey(chunk.xPos, chunk.zPos);
-
-        // Update existing pending entry if present
-        if (pendingCoords_.count(key)) {
-            for (auto& pending : pendingChunks_) {
-                if (pending.chunkX == chunk.xPos && pending.chunkZ == chunk.zPos) {
-                    pending.data = chunk;
-                    return;
-                }
-            }
-        }
-
-        pendingChunks_.push_back({chunk.xPos, chunk.zPos, chunk});
-        pendingCoords_.insert(key);
-    }
-
-    // Pop and return next chunk to write. Returns true if there was one.
-    // Java: writeNextIO
-    bool writeNextIO(PendingChunk& out) {
-        std::lock_guard lock(pendingMutex_);
-        if (pendingChunks_.empty()) return false;
-
-        out = std::move(pendingChunks_.front());
-        pendingChunks_.pop_front();
-        pendingCoords_.erase(chunkKey(out.chunkX, out.chunkZ));
-        return true;
-    }
-
-    // Flush all pending writes
-    // Java: saveExtraData
-    void flushAllPending() {
-        PendingChunk chunk;
-        while (writeNextIO(chunk)) {
-            // Write chunk to disk (via RegionFile)
-        }
-    }
+    /**
+     * Serialize `chunk` as {Level: ...} on the calling thread and queue it.
+     * Java reference: AnvilChunkLoader.saveChunk()
+     */
+    void queueChunkSave(const Chunk& chunk);
+
+    /**
+     * Queue uncompressed chunk NBT (root compound with a Level tag). A save
+     * of a chunk that is still pending replaces it.
+     * Java reference: AnvilChunkLoader.addChunkToPending()
+     */
+    void queueChunkSave(int32_t x, int32_t z, std::vector<uint8_t> nbt);
+
+    /**
+     * The chunk's NBT: the latest pending save, else what its region file
+     * holds; nullptr if it was never saved.
+     */
+    std::shared_ptr<const std::vector<uint8_t>> loadChunkData(int32_t x, int32_t z);
+
+    /**
+     * Load and deserialize a chunk; nullptr if it was never saved or its
+     * data is unreadable.
+     * Java reference: AnvilChunkLoader.loadChunk() → checkedReadChunkFromNBT()
+     */
+    std::unique_ptr<Chunk> loadChunk(int32_t x, int32_t z);
+
+    /**
+     * Write every save queued so far, helping the I/O threads, and wait for
+     * the ones they are writing; then flush all region headers (synced unless
+     * the policy is None). Returns false if a write or flush failed.
+     * Java reference: AnvilChunkLoader.saveExtraData() — waits for
+     * ThreadedFileIOBase.waitForFinish()
+     */
+    bool flushAllPending();
 
     // Check if chunk has pending save
-    bool hasPendingSave(int32_t x, int32_t z) const {
-        std::lock_guard lock(pendingMutex_);
-        return pendingCoords_.count(chunkKey(x, z)) > 0;
-    }
-
-    // Load pending chunk data (for reads during async write)
-    // Java: loadChunk — checks pending queue first before disk
-    bool loadFromPending(int32_t x, int32_t z, AnvilChunkData& out) {
-        std::lock_guard lock(pendingMutex_);
-        int64_t key = chunkKey(x, z);
-        if (!pendingCoords_.count(key)) return false;
-
-        for (const auto& pending : pendingChunks_) {
-            if (pending.chunkX == x && pending.chunkZ == z) {
-                out = pending.data;
-                return true;
-            }
-        }
-        return false;
-    }
+    bool hasPendingSave(int32_t x, int32_t z) const;
 
     // ═══════════════════════════════════════════════════════════════════════
     // Validation
@@ -359,10 +434,12 @@ public:
     // Accessors
     // ═══════════════════════════════════════════════════════════════════════
 
-    int32_t getPendingCount() const {
-        std::lock_guard lock(pendingMutex_);
-        return static_cast<int32_t>(pendingChunks_.size());
-    }
+    // Chunks waiting or being written
+    int32_t getPendingCount() const;
+
+    ChunkIoStats getStats() const;
+    const ChunkIoConfig& getConfig() const { return config_; }
+    int getThreadCount() const { return threadCount_; }
 
 private:
     static int64_t chunkKey(int32_t x, int32_t z) {
@@ -370,9 +447,79 @@ private:
                (static_cast<int64_t>(z) & 0xFFFFFFFFL) << 32;
     }
 
-    mutable std::mutex pendingMutex_;
-    std::deque<PendingChunk> pendingChunks_;
-    std::unordered_set<int64_t> pendingCoords_;
+    // Latest bytes of a chunk not yet written
+    struct PendingSave {
+        std::shared_ptr<const std::vector<uint8_t>> data;
+        uint64_t version = 0;    // bumped by every save
+        bool     queued  = false;   // key is in queue_
+        bool     writing = false;   // an I/O thread is writing some version
+    };
+
+    // A write taken from the queue
+    struct SaveJob {
+        int64_t  key;
+        int32_t  x, z;
+        uint64_t version;
+        std::shared_ptr<const std::vector<uint8_t>> data;
+    };
+
+    void workerLoop();
+
+    // Under mutex_: move up to MAX_BATCH queued saves into `batch`
+    void takeBatchLocked(std::vector<SaveJob>& batch);
+
+    // Write a batch region by region and settle its pending entries
+    bool writeBatch(std::vector<SaveJob>& batch);
+
+    // Sync the regions written to since their last sync (Periodic)
+    void syncDirtyRegions();
+
+    // Region file of region (rx, rz); with !create, nullptr if there is none.
+    // Holding the pointer keeps the region from being evicted.
+    std::shared_ptr<RegionFile> getRegion(int32_t rx, int32_t rz, bool create);
+
+    // A region taken out of the cache; synced and closed outside regionMutex_
+    struct EvictedRegion {
+        int64_t key = 0;
+        std::shared_ptr<RegionFile> file;
+        bool sync = false;   // written to since its last sync
+    };
+
+    // Under regionMutex_: take out the least recently used region nobody
+    // holds and mark it closing; empty if every region is held
+    EvictedRegion evictRegionLocked();
+
+    // Sync and close an evicted region, then let getRegion() reopen it
+    void closeEvictedRegion(EvictedRegion evicted);
+
+    ChunkIoConfig config_;
+    int           threadCount_;
+    std::string   regionDirectory_;
+
+    // ─── Pending saves (mutex_) ─────────────────────────────────────────
+    mutable std::mutex      mutex_;
+    std::condition_variable workCv_;   // queue_ filled or stopping_
+    std::condition_variable idleCv_;   // a batch finished
+    std::unordered_map<int64_t, PendingSave> pending_;
+    std::deque<int64_t>     queue_;     // keys to write, in save order
+    size_t                  inFlight_ = 0;   // saves being written
+    bool                    stopping_ = false;
+    std::unordered_set<int64_t> dirtyRegions_;   // region keys written to but not synced
+    std::chrono::steady_clock::time_point nextSync_;
+    ChunkIoStats            stats_;
+
+    std::vector<std::thread> workers_;
+
+    // ─── Region files (regionMutex_), an LRU cache until stop() ────────
+    struct OpenRegion {
+        std::shared_ptr<RegionFile> file;
+        std::list<int64_t>::iterator lru;
+    };
+    std::mutex regionMutex_;
+    std::condition_variable regionClosedCv_;   // an evicted region was closed
+    std::unordered_map<int64_t, OpenRegion> regions_;
+    std::list<int64_t> regionLru_;   // region keys, most recently used first
+    std::unordered_set<int64_t> closingRegions_;   // evicted, not yet closed
 };
 
 } // namespace mccpp
@@ -4,25 +4,29 @@
  * Java references:
  *   - net.minecraft.world.chunk.NibbleArray
  *   - net.minecraft.world.chunk.storage.ExtendedBlockStorage
+ *   - net.minecraft.world.chunk.BlockStateContainer (1.9+; palette storage)
  *   - net.minecraft.world.chunk.Chunk (data portion)
  *   - net.minecraft.world.chunk.storage.RegionFile
  *
  * This implements the Anvil chunk format for block storage, serialization,
- * and region file I/O (reading/writing .mca files).
+ * and region file I/O (reading/writing .mca files). In memory, block IDs and
+ * metadata are palette-compressed (BlockStateStorage); the Anvil arrays are
+ * only produced when a chunk is saved or sent.
  *
  * Thread safety: ChunkSection and Chunk are intended for single-owner access
  * (one thread owns a chunk at a time, via the chunk provider). RegionFile
- * uses a mutex for concurrent read/write access.
+ * reads are lock-free; writes serialize only sector allocation.
  */
 #pragma once
 
 #include "block/Block.h"
 #include "nbt/NBT.h"
+#include "world/SectorBitmap.h"
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
-#include <fstream>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -31,32 +35,47 @@
 
 namespace mccpp {
 
+struct ChunkPayloadCache;   // forward decl (networking/ChunkPayloadCache.h)
+
 // ═══════════════════════════════════════════════════════════════════════════
 // NibbleArray — 4-bit-per-element packed array (half-byte storage).
 // Java reference: net.minecraft.world.chunk.NibbleArray
+//
+// An array whose nibbles all hold one value (sky light above the terrain,
+// block light almost everywhere) keeps just that value; the buffer is
+// allocated on the first write of a different value.
 // ═══════════════════════════════════════════════════════════════════════════
 
 class NibbleArray {
 public:
-    std::vector<uint8_t> data;
+    // Largest array (in bytes) whose uniform form can be read via bytes()
+    static constexpr size_t MAX_SHARED_BYTES = 2048;
 
     /**
-     * Create a NibbleArray for `length` elements.
+     * Create a NibbleArray for `length` elements, all `value`. It holds no
+     * buffer until a set() writes a different value.
      * Java: NibbleArray(int n, int n2) — n = element count, n2 = depthBits (always 4 for blocks)
      */
-    explicit NibbleArray(int elementCount, int depthBits = 4)
-        : data(elementCount >> 1, 0)
+    explicit NibbleArray(int elementCount, int depthBits = 4, int value = 0)
+        : length_(static_cast<size_t>(elementCount) >> 1)
+        , uniform_(static_cast<uint8_t>(value & 0x0F))
         , depthBits_(depthBits)
-        , depthBitsPlusFour_(depthBits + 4) {}
+        , depthBitsPlusFour_(depthBits + 4) {
+        if (length_ > MAX_SHARED_BYTES) materialize();
+    }
 
     /**
-     * Create from existing data buffer.
+     * Create from existing data buffer; kept in uniform form if every
+     * nibble has the same value.
      * Java: NibbleArray(byte[], int)
      */
     NibbleArray(std::vector<uint8_t> buf, int depthBits = 4)
-        : data(std::move(buf))
+        : data_(std::move(buf))
+        , length_(data_.size())
         , depthBits_(depthBits)
-        , depthBitsPlusFour_(depthBits + 4) {}
+        , depthBitsPlusFour_(depthBits + 4) {
+        compact();
+    }
 
     /**
      * Get nibble value at (x, y, z).
@@ -64,13 +83,14 @@ public:
      * Index: y << (depthBits+4) | z << depthBits | x
      */
     int get(int x, int y, int z) const {
+        if (data_.empty()) return uniform_;
         int idx = (y << depthBitsPlusFour_) | (z << depthBits_) | x;
         int half = idx >> 1;
         int odd = idx & 1;
         if (odd == 0) {
-            return data[half] & 0x0F;
+            return data_[half] & 0x0F;
         }
-        return (data[half] >> 4) & 0x0F;
+        return (data_[half] >> 4) & 0x0F;
     }
 
     /**
@@ -78,21 +98,153 @@ public:
      * Java: NibbleArray.set(x, y, z, val)
      */
     void set(int x, int y, int z, int val) {
+        if (data_.empty()) {
+            if ((val & 0x0F) == uniform_) return;
+            materialize();
+        }
         int idx = (y << depthBitsPlusFour_) | (z << depthBits_) | x;
         int half = idx >> 1;
         int odd = idx & 1;
         if (odd == 0) {
-            data[half] = static_cast<uint8_t>((data[half] & 0xF0) | (val & 0x0F));
+            data_[half] = static_cast<uint8_t>((data_[half] & 0xF0) | (val & 0x0F));
         } else {
-            data[half] = static_cast<uint8_t>((data[half] & 0x0F) | ((val & 0x0F) << 4));
+            data_[half] = static_cast<uint8_t>((data_[half] & 0x0F) | ((val & 0x0F) << 4));
         }
     }
 
+    // ─── Uniform form ───
+
+    bool isUniform() const { return data_.empty(); }
+    int getUniformValue() const { return uniform_; }
+
+    /**
+     * Drop the buffer if every nibble has the same value again.
+     * Returns true if the array is uniform afterwards.
+     */
+    bool compact();
+
+    // ─── Raw bytes (Java layout: even index in the low nibble) ───
+
+    size_t size() const { return length_; }
+
+    /**
+     * The packed bytes. A uniform array points into a shared, read-only
+     * buffer of that value (sizes up to MAX_SHARED_BYTES).
+     */
+    const uint8_t* bytes() const { return data_.empty() ? sharedBytes(uniform_) : data_.data(); }
+
+    // Heap bytes held.
+    size_t getHeapBytes() const { return data_.capacity(); }
+
+    // MAX_SHARED_BYTES bytes of nibble `value` in both halves.
+    static const uint8_t* sharedBytes(int value);
+
 private:
+    void materialize() { data_.assign(length_, static_cast<uint8_t>(uniform_ * 0x11)); }
+
+    std::vector<uint8_t> data_;   // empty while uniform
+    size_t length_;               // bytes
+    uint8_t uniform_ = 0;         // the value of every nibble while uniform
     int depthBits_;
     int depthBitsPlusFour_;
 };
 
+// ═══════════════════════════════════════════════════════════════════════════
+// BlockStateStorage — Palette-compressed block ID + metadata for one section.
+// Not in Java 1.7.10 (flat arrays); modelled on 1.9's BlockStateContainer.
+//
+// A state is (blockId << 4 | metadata), 16 bits. Storage modes:
+//   - single value: one state for all 4096 blocks, no index array;
+//   - palette: 1, 2, 4 or 8-bit indices into a palette of up to 256 states;
+//   - direct: 16-bit states, once a section holds more than 256 states.
+// Index widths are powers of two, so an index never straddles a word and
+// locating it is shifts only. Adding a state to a full palette first drops
+// the states no longer used, then widens the indices if it is still full.
+// Element order matches NibbleArray: y << 8 | z << 4 | x.
+// ═══════════════════════════════════════════════════════════════════════════
+
+class BlockStateStorage {
+public:
+    static constexpr int SIZE = 4096;
+    static constexpr int MAX_PALETTE_BITS = 8;
+    static constexpr int DIRECT_BITS = 16;
+
+    uint16_t get(int index) const {
+        if (bits_ == 0) return single_;
+        uint32_t value = static_cast<uint32_t>(
+            words_[index >> wordShift_] >> ((index & slotMask_) << bitsLog2_)) & valueMask_;
+        return bits_ == DIRECT_BITS ? static_cast<uint16_t>(value) : palette_[value];
+    }
+
+    void set(int index, uint16_t state);
+
+    /**
+     * Replace all 4096 states, choosing the smallest mode that holds them.
+     */
+    void assign(const uint16_t* states) { rebuild(states, 0); }
+
+    // All 4096 states in index order.
+    void decode(uint16_t* out) const;
+
+    /**
+     * Call fn(state, count) for the stored states: once per palette entry in
+     * use, or once per block in direct mode.
+     */
+    template <typename Fn>
+    void forEachStateCount(Fn&& fn) const {
+        if (bits_ == 0) {
+            fn(single_, SIZE);
+            return;
+        }
+        if (bits_ == DIRECT_BITS) {
+            for (uint64_t word : words_) {
+                for (int i = 0; i < 4; ++i, word >>= 16) fn(static_cast<uint16_t>(word), 1);
+            }
+            return;
+        }
+        int counts[size_t{1} << MAX_PALETTE_BITS] = {};
+        const int bits = bits_, perWord = 64 >> bitsLog2_;
+        const uint64_t mask = valueMask_;
+        for (uint64_t word : words_) {
+            for (int i = 0; i < perWord; ++i, word >>= bits) ++counts[word & mask];
+        }
+        for (size_t slot = 0; slot < palette_.size(); ++slot) {
+            if (counts[slot]) fn(palette_[slot], counts[slot]);
+        }
+    }
+
+    bool isSingleValue() const { return bits_ == 0; }
+    int getBits() const { return bits_; }
+    size_t getPaletteSize() const { return bits_ == 0 ? 1 : palette_.size(); }
+
+    // True if a palette entry (or, in direct mode, any block) has an ID > 255.
+    bool hasHighIds() const;
+
+    // Heap bytes held (palette + indices).
+    size_t getHeapBytes() const {
+        return palette_.capacity() * sizeof(uint16_t) + words_.capacity() * sizeof(uint64_t);
+    }
+
+private:
+    void setBits(int bits);
+    void write(int index, uint32_t value) {
+        uint64_t& word = words_[index >> wordShift_];
+        int shift = (index & slotMask_) << bitsLog2_;
+        word = (word & ~(static_cast<uint64_t>(valueMask_) << shift)) | (static_cast<uint64_t>(value) << shift);
+    }
+    // Re-encode `states` with room for `reserve` more palette entries.
+    void rebuild(const uint16_t* states, size_t reserve);
+
+    std::vector<uint16_t> palette_;   // empty in single-value and direct mode
+    std::vector<uint64_t> words_;     // SIZE * bits_ / 64 words
+    uint16_t single_ = 0;             // the state, in single-value mode
+    uint8_t bits_ = 0;
+    uint8_t bitsLog2_ = 0;
+    uint8_t wordShift_ = 0;           // index >> wordShift_ = word
+    uint8_t slotMask_ = 0;            // index & slotMask_ = slot within the word
+    uint32_t valueMask_ = 0;
+};
+
 // ═══════════════════════════════════════════════════════════════════════════
 // ChunkSection — 16x16x16 block storage (ExtendedBlockStorage in Java).
 // Java reference: net.minecraft.world.chunk.storage.ExtendedBlockStorage
@@ -105,9 +257,10 @@ public:
      */
     explicit ChunkSection(int yBase, bool hasSkylight = true);
 
-    // Block access
+    // Block access (x, y, z are 0-15)
     Block* getBlock(int x, int y, int z) const;
     void setBlock(int x, int y, int z, Block* block);
+    int getBlockId(int x, int y, int z) const;   // index into BlockProperties
     int getBlockMetadata(int x, int y, int z) const;
     void setBlockMetadata(int x, int y, int z, int meta);
 
@@ -122,34 +275,63 @@ public:
     bool needsRandomTick() const { return tickRefCount_ > 0; }
     int getYBase() const { return yBase_; }
 
+    /**
+     * Bumped by every write through the setters below; see
+     * Chunk::getModificationCount(). Writes through the non-const array
+     * accessors must call markModified() themselves.
+     */
+    uint32_t getModificationCount() const { return modCount_; }
+    void markModified() { ++modCount_; }
+
     /**
      * Recalculates blockRefCount and tickRefCount by scanning all blocks.
      * Java: ExtendedBlockStorage.removeInvalidBlocks()
      */
     void recalcRefCounts();
 
-    // Raw data access (for NBT serialization)
-    const std::array<uint8_t, 4096>& getBlockLSBArray() const { return blockLSB_; }
-    void setBlockLSBArray(const std::vector<uint8_t>& arr);
-    NibbleArray* getBlockMSBArray() { return blockMSB_.get(); }
-    void setBlockMSBArray(std::unique_ptr<NibbleArray> arr) { blockMSB_ = std::move(arr); }
-    NibbleArray& getMetadataArray() { return metadata_; }
-    void setMetadataArray(NibbleArray arr) { metadata_ = std::move(arr); }
+    // ─── Anvil layout (NBT "Blocks"/"Add"/"Data", S21 chunk data) ───
+
+    /**
+     * Whether the expanded data includes an MSB ("Add") array. Like Java's
+     * blockMSBArray this may stay set after the last ID > 255 is gone.
+     */
+    bool hasBlockMSB() const { return blocks_.hasHighIds(); }
+
+    /**
+     * Expand to the Anvil arrays: 4096 LSB bytes, 2048 metadata nibble bytes
+     * and, if `msb` is not null, 2048 MSB nibble bytes.
+     */
+    void getBlockArrays(uint8_t* lsb, uint8_t* msb, uint8_t* meta) const;
+
+    /**
+     * Load from the Anvil arrays (`msb` may be null). Call recalcRefCounts() after.
+     */
+    void setBlockArrays(const uint8_t* lsb, const uint8_t* msb, const uint8_t* meta);
+
+    const BlockStateStorage& getBlockStorage() const { return blocks_; }
+
+    /**
+     * Bytes this section holds, heap included.
+     */
+    size_t getMemoryUsage() const;
+
+    // Light arrays
     NibbleArray& getBlocklightArray() { return blocklight_; }
-    void setBlocklightArray(NibbleArray arr) { blocklight_ = std::move(arr); }
+    const NibbleArray& getBlocklightArray() const { return blocklight_; }
+    void setBlocklightArray(NibbleArray arr) { blocklight_ = std::move(arr); ++modCount_; }
     NibbleArray* getSkylightArray() { return skylight_.get(); }
-    void setSkylightArray(std::unique_ptr<NibbleArray> arr) { skylight_ = std::move(arr); }
+    const NibbleArray* getSkylightArray() const { return skylight_.get(); }
+    void setSkylightArray(std::unique_ptr<NibbleArray> arr) { skylight_ = std::move(arr); ++modCount_; }
 
 private:
     int yBase_;
     int blockRefCount_ = 0;
     int tickRefCount_ = 0;
+    uint32_t modCount_ = 0;
 
-    // Block IDs: LSB is mandatory, MSB is optional (only for IDs > 255)
-    std::array<uint8_t, 4096> blockLSB_;
-    std::unique_ptr<NibbleArray> blockMSB_;  // nullable, like Java
+    // Block IDs and metadata (Java: blockLSBArray, blockMSBArray, blockMetadataArray)
+    BlockStateStorage blocks_;
 
-    NibbleArray metadata_;     // 4096 elements
     NibbleArray blocklight_;   // 4096 elements
     std::unique_ptr<NibbleArray> skylight_;  // nullable (nether has no skylight)
 };
@@ -182,6 +364,11 @@ public:
     bool hasEntities = false;
     int64_t inhabitedTime = 0;
 
+    // Deflated packet payload of this chunk, created and used by
+    // ChunkSerializer. Shared so that a chunk-send worker can still store into
+    // it after the chunk was unloaded.
+    mutable std::shared_ptr<ChunkPayloadCache> payloadCache;
+
     Chunk() = default;
     Chunk(int x, int z) : xPosition(x), zPosition(z) {
         biomes.fill(0);
@@ -193,9 +380,42 @@ public:
      */
     Block* getBlock(int x, int y, int z) const;
     void setBlock(int x, int y, int z, Block* block);
+    int getBlockId(int x, int y, int z) const;
     int getBlockMetadata(int x, int y, int z) const;
     void setBlockMetadata(int x, int y, int z, int meta);
 
+    /**
+     * Changes whenever the chunk's block, light or biome data may have changed:
+     * the chunk's own counter plus those of its sections. Direct writes to
+     * `biomes` or `sections` must call markModified().
+     * Not in Java — keys the deflated payload cache (ChunkPayloadCache).
+     */
+    uint64_t getModificationCount() const {
+        uint64_t count = modCount_;
+        for (const auto& section : sections) {
+            if (section) count += section->getModificationCount();
+        }
+        return count;
+    }
+    void markModified() { ++modCount_; }
+
+    // getModificationCount() when the chunk was last loaded from or queued
+    // for saving to disk (ChunkProviderServer); NOT_SAVED if it was generated.
+    static constexpr uint64_t NOT_SAVED = ~0ULL;
+    uint64_t savedModificationCount = NOT_SAVED;
+
+    /**
+     * Java reference: Chunk.needsSaving(boolean) — here any change since the
+     * last load or save.
+     */
+    bool needsSaving() const { return getModificationCount() != savedModificationCount; }
+
+    /**
+     * Bytes this chunk holds in memory: the object and its sections, not the
+     * cached packet payload.
+     */
+    size_t getMemoryUsage() const;
+
     /**
      * Serialize chunk data to NBT (Level compound).
      * Java reference: AnvilChunkLoader.writeChunkToNBT()
@@ -208,6 +428,9 @@ public:
      * Java reference: AnvilChunkLoader.readChunkFromNBT()
      */
     static std::unique_ptr<Chunk> readFromNBT(const nbt::NBTTagCompound& levelTag);
+
+private:
+    uint64_t modCount_ = 0;
 };
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -218,12 +441,59 @@ public:
 // Header: 4096 bytes of chunk offsets + 4096 bytes of timestamps.
 // Each chunk is zlib-compressed NBT data.
 //
-// Thread safety: mutex-protected for concurrent access.
+// I/O is positional (pread/pwrite on a raw fd), so nothing seeks a shared
+// file position. Writes are copy-on-write: a chunk always goes to newly
+// allocated sectors and its header slot is switched afterwards, so the old
+// copy stays intact until the new one is complete. Sectors given up by a
+// rewrite only become reusable once a header that no longer references them
+// has been written and synced (flush(true)), so a crash always finds the
+// chunks of the last synced header intact. Without sync nothing is
+// crash-safe; a region opened with crashSafe = false (never synced) reuses
+// them after any header write.
+//
+// Header updates are deferred: the offset and timestamp tables are written
+// in one 8 KiB pwrite by flush(), by close(), or once HEADER_FLUSH_UPDATES
+// chunk writes have accumulated. A header write that releases sectors also
+// cuts the file back to its last used sector.
+//
+// Free space is a SectorBitmap with best-fit allocation. compact() moves
+// chunks from the end of the file into holes while the region stays in use;
+// compactFile() rewrites an unused region with its chunks back to back.
+//
+// RegionIoMode::IoUring adds a batched path (readChunks/writeChunks) that
+// keeps a whole batch in flight on the calling thread's io_uring.
+//
+// Thread safety: reads take no lock. Each header slot carries a generation
+// that every write bumps; a read re-checks it after its pread and retries if
+// the chunk moved meanwhile. Sector allocation and header updates take the
+// mutex; compression, decompression and the data I/O run outside it.
+// close() must not race with other calls.
 // ═══════════════════════════════════════════════════════════════════════════
 
+enum class RegionIoMode : uint8_t {
+    Sync,      // pread/pwrite, one chunk at a time
+    IoUring    // batches submitted through io_uring (falls back to Sync)
+};
+
+struct RegionCompactStats {
+    int chunksMoved = 0;
+    int sectorsBefore = 0;   // file length in sectors
+    int sectorsAfter = 0;
+};
+
 class RegionFile {
 public:
-    explicit RegionFile(const std::string& path);
+    static constexpr int32_t SECTOR_BYTES = 4096;
+    static constexpr int32_t HEADER_SECTORS = 2;
+    static constexpr int32_t MAX_CHUNK_SECTORS = 255;
+    static constexpr int HEADER_FLUSH_UPDATES = 64;
+
+    /**
+     * With !crashSafe the caller never syncs: sectors given up by rewrites
+     * are reused after any header write instead of only a synced one.
+     */
+    explicit RegionFile(const std::string& path, RegionIoMode mode = RegionIoMode::Sync,
+                        bool crashSafe = true);
     ~RegionFile();
 
     // Non-copyable
@@ -243,28 +513,105 @@ public:
      */
     bool writeChunkData(int localX, int localZ, const std::vector<uint8_t>& data);
 
+    /**
+     * Batched reads: result[i] is the chunk at coords[i] (nullopt if not
+     * saved or unreadable). In IoUring mode all sector reads are in flight
+     * at once; otherwise this is a loop over readChunkData().
+     */
+    std::vector<std::optional<std::vector<uint8_t>>> readChunks(
+        const std::vector<std::pair<int, int>>& coords);
+
+    struct ChunkWrite {
+        int localX;
+        int localZ;
+        const std::vector<uint8_t>* data;   // uncompressed NBT
+    };
+
+    /**
+     * Batched writes; returns how many succeeded. Every chunk is compressed
+     * and given its sectors first, then all data writes are issued together
+     * and the header slots are switched once they have completed.
+     */
+    size_t writeChunks(const std::vector<ChunkWrite>& writes);
+
     /**
      * Check if a chunk exists in this region.
      * Java reference: RegionFile.isChunkSaved()
      */
     bool isChunkSaved(int localX, int localZ) const;
 
+    /**
+     * Write the header if chunk writes changed it. With `sync`, chunk data
+     * is fdatasync'ed before the header is written and the header after it,
+     * so a crash leaves either the old or the new copy of each chunk
+     * reachable; only then are the sectors it no longer references released
+     * (without crashSafe, after any header write).
+     */
+    bool flush(bool sync = false);
+
+    /**
+     * Online compaction: repeatedly move the chunk that ends last in the
+     * file into the best-fitting hole before it, then cut the file. Moves
+     * copy the raw sectors and go through the same copy-on-write slot switch
+     * as writes, so readers and writers may keep running; a chunk rewritten
+     * during its move keeps the new copy. Each round of moves ends with a
+     * synced header write, which frees the sectors moved out of. Stops after
+     * `maxMoves` moves (negative = until nothing can move). Best run while
+     * the region is idle.
+     */
+    RegionCompactStats compact(int maxMoves = -1);
+
+    /**
+     * Offline compaction: rewrite the region at `path` with its chunks back to
+     * back in index order (x + z * 32) from sector 2, then replace the file.
+     * If any chunk cannot be read, the original is kept and false returned.
+     * Nothing else may have the file open.
+     */
+    static bool compactFile(const std::string& path, RegionCompactStats* stats = nullptr);
+
     void close();
 
+    bool isOpen() const { return fd_ >= 0; }
+    RegionIoMode getIoMode() const { return mode_; }
+    int getSectorCount() const;
+    int getFreeSectorCount() const;
+
 private:
+    // Header slot: generation (high 32 bits) | Anvil offset (sectorStart << 8 | sectorCount)
+    static int32_t slotOffset(uint64_t slot) { return static_cast<int32_t>(slot & 0xFFFFFFFFu); }
+    static int slotIndex(int x, int z) { return x + z * 32; }
     static bool outOfBounds(int x, int z) { return x < 0 || x >= 32 || z < 0 || z >= 32; }
-    int getOffset(int x, int z) const { return offsets_[x + z * 32]; }
-    void setOffset(int x, int z, int val);
-    void setTimestamp(int x, int z, int val);
 
-    void writeSector(int sectorNum, const uint8_t* data, int length);
+    // A compressed chunk laid out as its sectors: [length][type][zlib data][zero pad]
+    struct SectorImage {
+        std::unique_ptr<uint8_t[]> bytes;
+        int sectors = 0;
+    };
+
+    static bool compressChunk(const std::vector<uint8_t>& data, SectorImage& image);
+    static std::optional<std::vector<uint8_t>> decodeChunk(const uint8_t* sectors, size_t length);
+
+    bool readSectors(uint8_t* dest, int sectorStart, int sectorCount) const;
+    bool writeSectors(const uint8_t* src, int sectorStart, int sectorCount) const;
+
+    // Under mutex_
+    int allocateSectors(int count);
+    void releaseSectors(int start, int count);
+    void publish(int index, int sectorStart, int sectorCount, bool touch = true);
+    bool writeHeaderLocked(bool sync);
 
     std::string path_;
-    std::fstream file_;
+    int fd_ = -1;
+    RegionIoMode mode_;
+    bool crashSafe_;
+    std::array<std::atomic<uint64_t>, 1024> slots_{};
+
     mutable std::mutex mutex_;
-    std::array<int32_t, 1024> offsets_{};
     std::array<int32_t, 1024> timestamps_{};
-    std::vector<bool> sectorFree_;
+    SectorBitmap sectors_;
+    std::vector<std::pair<int, int>> pendingFree_;   // runs freed, not yet released
+    int headerUpdates_ = 0;                          // slot changes not yet written
+    bool unsynced_ = false;                          // header written without fdatasync
 };
 
 } // namespace mccpp
@@ -0,0 +1,96 @@
+/**
+ * IoUring.h — Minimal Linux io_uring submission ring for file I/O.
+ *
+ * No Java equivalent: RegionFile uses RandomAccessFile, one blocking call at
+ * a time. This is the batched path used by RegionFile::readChunks() and
+ * writeChunks(): every read or write of a batch is queued as one SQE, all of
+ * them are submitted with a single io_uring_enter(), and the batch completes
+ * when the last CQE has arrived.
+ *
+ * Built on the raw syscalls (no liburing dependency). Only IORING_OP_READ and
+ * IORING_OP_WRITE are used (Linux 5.6+). On kernels without io_uring, or when
+ * it is disabled (seccomp, io_uring_disabled sysctl), forThisThread() returns
+ * nullptr and callers fall back to pread/pwrite.
+ *
+ * Thread safety: none. A ring belongs to the thread that created it;
+ * forThisThread() hands every thread its own.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace mccpp {
+
+class IoUring {
+public:
+    // Queue depth of the per-thread rings; larger batches are split.
+    static constexpr unsigned THREAD_RING_ENTRIES = 64;
+
+    explicit IoUring(unsigned entries);
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    /**
+     * The calling thread's ring, created on first use; nullptr if io_uring
+     * cannot be set up here or the ring has failed (remembered per thread).
+     */
+    static IoUring* forThisThread();
+
+    bool isOpen() const { return ringFd_ >= 0; }
+    int getError() const { return error_; }      // errno of a failed setup
+    unsigned getCapacity() const { return sqEntries_; }
+    unsigned getQueued() const { return queued_; }
+
+    /**
+     * Queue a read/write of `length` bytes at `offset`. Returns false when the
+     * submission queue is full; submit and wait first.
+     */
+    bool queueRead(int fd, void* buffer, uint32_t length, uint64_t offset, uint64_t tag);
+    bool queueWrite(int fd, const void* buffer, uint32_t length, uint64_t offset, uint64_t tag);
+
+    /**
+     * Submit everything queued and wait for all of it. onComplete(tag, result)
+     * runs once per request; result is the byte count or -errno, as for
+     * pread/pwrite. Returns false if the ring itself failed: requests the
+     * kernel had already taken are still waited for, the rest are not
+     * reported (the caller redoes them), and the ring is closed, so
+     * forThisThread() returns nullptr on this thread afterwards.
+     */
+    bool submitAndWait(const std::function<void(uint64_t tag, int32_t result)>& onComplete);
+
+private:
+    io_uring_sqe* nextSqe();
+    void release();
+
+    int ringFd_ = -1;
+    int error_ = 0;
+    unsigned sqEntries_ = 0;
+    unsigned queued_ = 0;
+
+    // Mapped rings
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    size_t sqRingBytes_ = 0;
+    size_t cqRingBytes_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqesBytes_ = 0;
+
+    // Pointers into the rings (kernel-shared indices)
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqMask_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned* cqMask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+};
+
+} // namespace mccpp
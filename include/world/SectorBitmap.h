@@ -0,0 +1,145 @@
+/**
+ * SectorBitmap.h — Free-sector map of a region file, one bit per sector.
+ *
+ * Java reference: RegionFile.sectorFree (ArrayList<Boolean>), scanned
+ * first-fit one sector at a time on every write that changes a chunk's size.
+ *
+ * Here a set bit marks a free sector. Runs are found a 64-bit word at a time:
+ * words that are all used or all free are skipped whole, and run edges are
+ * located with count-trailing-zeros. Allocation is best fit (the smallest
+ * free run that holds the chunk, lowest address on ties), so small holes are
+ * filled before large ones are split.
+ *
+ * Thread safety: none; RegionFile guards it with its mutex.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mccpp {
+
+class SectorBitmap {
+public:
+    int size() const { return size_; }
+
+    /**
+     * Grow or shrink to `sectors`; new sectors start out used.
+     */
+    void resize(int sectors) {
+        words_.resize(static_cast<size_t>((sectors + 63) / 64), 0);
+        size_ = sectors;
+        clearTail();
+    }
+
+    bool isFree(int sector) const {
+        return (words_[static_cast<size_t>(sector >> 6)] >> (sector & 63)) & 1;
+    }
+
+    void markUsed(int start, int count) { setRange(start, count, false); }
+    void markFree(int start, int count) { setRange(start, count, true); }
+
+    /**
+     * Start of the best-fitting free run of `count` sectors that ends at or
+     * before `limit` (default: anywhere), or -1 if none.
+     */
+    int findBestFit(int count, int limit = -1) const {
+        if (limit < 0 || limit > size_) limit = size_;
+        int best = -1;
+        int bestLength = 0;
+        int pos = nextFree(0, limit);
+        while (pos < limit) {
+            int end = nextUsed(pos, limit);
+            int length = end - pos;
+            if (length >= count && (best < 0 || length < bestLength)) {
+                best = pos;
+                bestLength = length;
+                if (length == count) break;
+            }
+            pos = nextFree(end, limit);
+        }
+        return best;
+    }
+
+    /**
+     * Number of free sectors at the end (an allocation that does not fit
+     * anywhere starts there and extends the file).
+     */
+    int trailingFree() const {
+        int end = usedEnd();
+        return size_ - end;
+    }
+
+    /**
+     * One past the last used sector: the length the file can be cut to.
+     */
+    int usedEnd() const {
+        for (size_t w = words_.size(); w-- > 0;) {
+            uint64_t used = ~words_[w] & validMask(w);
+            if (used != 0) return static_cast<int>(w * 64) + 64 - __builtin_clzll(used);
+        }
+        return 0;
+    }
+
+    int freeCount() const {
+        int n = 0;
+        for (uint64_t word : words_) n += __builtin_popcountll(word);
+        return n;
+    }
+
+private:
+    // Bits of word `w` that correspond to real sectors
+    uint64_t validMask(size_t w) const {
+        int bits = size_ - static_cast<int>(w * 64);
+        return bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+    }
+
+    void clearTail() {
+        if (!words_.empty()) words_.back() &= validMask(words_.size() - 1);
+    }
+
+    void setRange(int start, int count, bool free) {
+        int end = start + count;
+        if (end > size_) end = size_;
+        while (start < end) {
+            int bit = start & 63;
+            int n = end - start < 64 - bit ? end - start : 64 - bit;
+            uint64_t mask = (n == 64 ? ~0ULL : ((1ULL << n) - 1)) << bit;
+            uint64_t& word = words_[static_cast<size_t>(start >> 6)];
+            word = free ? (word | mask) : (word & ~mask);
+            start += n;
+        }
+    }
+
+    // First free sector at or after `from`, or `limit`
+    int nextFree(int from, int limit) const {
+        while (from < limit) {
+            uint64_t word = words_[static_cast<size_t>(from >> 6)] >> (from & 63);
+            if (word != 0) {
+                int pos = from + __builtin_ctzll(word);
+                return pos < limit ? pos : limit;
+            }
+            from = (from | 63) + 1;
+        }
+        return limit;
+    }
+
+    // First used sector at or after `from`, or `limit`
+    int nextUsed(int from, int limit) const {
+        while (from < limit) {
+            uint64_t word = ~words_[static_cast<size_t>(from >> 6)] >> (from & 63);
+            if (word != 0) {
+                int pos = from + __builtin_ctzll(word);
+                return pos < limit ? pos : limit;
+            }
+            from = (from | 63) + 1;
+        }
+        return limit;
+    }
+
+    std::vector<uint64_t> words_;
+    int size_ = 0;
+};
+
+} // namespace mccpp
@@ -23,6 +23,8 @@
  */
 #pragma once
 
+#include "server/PlayerManager.h"
+#include "world/AnvilChunkLoader.h"
 #include "world/Chunk.h"
 
 #include <atomic>
@@ -121,6 +123,14 @@ class ChunkProviderServer {
 public:
     ChunkProviderServer(WorldServer* world, std::unique_ptr<IChunkGenerator> generator);
 
+    /**
+     * Keep chunks on disk through `loader` (started by the caller). Without
+     * one, chunks are generated on every load and dropped on unload.
+     * Java reference: ChunkProviderServer.currentChunkLoader
+     */
+    void setChunkLoader(std::unique_ptr<AnvilChunkLoader> loader) { chunkLoader_ = std::move(loader); }
+    AnvilChunkLoader* getChunkLoader() { return chunkLoader_.get(); }
+
     /**
      * Get or load/generate a chunk.
      * Java reference: ChunkProviderServer.loadChunk(int, int)
@@ -148,11 +158,19 @@ public:
     void dropChunk(int chunkX, int chunkZ);
 
     /**
-     * Process unload queue (called from tick loop).
+     * Process unload queue (called from tick loop). Changed chunks are
+     * queued for saving first.
      * Java reference: ChunkProviderServer.unloadQueuedChunks()
      */
     bool unloadQueuedChunks();
 
+    /**
+     * Queue changed chunks for saving: all of them, or with !saveAll at most
+     * SAVE_BATCH. Returns how many were queued. Tick thread only.
+     * Java reference: ChunkProviderServer.saveChunks(boolean, IProgressUpdate)
+     */
+    int saveChunks(bool saveAll);
+
     /**
      * Get number of loaded chunks.
      */
@@ -163,9 +181,16 @@ public:
      */
     std::vector<Chunk*> getLoadedChunks() const;
 
+    // Java: ChunkProviderServer.saveChunks() — 24 chunks unless saving all
+    static constexpr int SAVE_BATCH = 24;
+
 private:
+    // Queue `chunk` on the chunk loader if it changed since its last save
+    bool saveChunk(Chunk& chunk);
+
     WorldServer* world_;
     std::unique_ptr<IChunkGenerator> generator_;
+    std::unique_ptr<AnvilChunkLoader> chunkLoader_;
 
     // Chunk storage: key = ChunkCoordIntPair hash, value = owned Chunk
     mutable std::shared_mutex chunkMapMutex_;
@@ -218,6 +243,12 @@ public:
     Chunk* getChunkFromBlockCoords(int blockX, int blockZ);
     ChunkProviderServer* getChunkProvider() { return chunkProvider_.get(); }
 
+    /**
+     * Which players watch which chunks. Tick thread only.
+     * Java reference: WorldServer.getPlayerManager()
+     */
+    PlayerManager& getPlayerManager() { return playerManager_; }
+
     // ─── World properties ──────────────────────────────────────────────
     int getDimensionId() const { return dimensionId_; }
     const std::string& getWorldName() const { return worldName_; }
@@ -243,6 +274,7 @@ private:
     std::string worldName_;
 
     std::unique_ptr<ChunkProviderServer> chunkProvider_;
+    PlayerManager playerManager_;
 
     // World time (in ticks)
     int64_t totalWorldTime_ = 0;
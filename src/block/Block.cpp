@@ -101,6 +101,52 @@ void Block::setBlockBounds(float x1, float y1, float z1, float x2, float y2, flo
     maxX_ = x2; maxY_ = y2; maxZ_ = z2;
 }
 
+// ─── Material flags ─────────────────────────────────────────────────────────
+// Java reference: Material.blocksMovement(), Material.isOpaque()
+// (MaterialLogic, MaterialTransparent, MaterialLiquid, MaterialPortal and the
+// web override block no movement; glass, ice and TNT are translucent)
+
+static bool materialBlocksMovement(Material m) {
+    switch (m) {
+        case Material::Air:   case Material::Water:    case Material::Lava:
+        case Material::Plants: case Material::Vine:    case Material::Circuits:
+        case Material::Fire:  case Material::Portal:   case Material::Web:
+        case Material::Snow:  case Material::Carpet:
+            return false;
+        default:
+            return true;
+    }
+}
+
+static bool materialIsOpaque(Material m) {
+    // Java: isTranslucent ? false : blocksMovement()
+    if (m == Material::Glass || m == Material::Ice || m == Material::TNT) return false;
+    return materialBlocksMovement(m);
+}
+
+bool Block::isNormalCube() const {
+    return materialIsOpaque(material_) && opaqueCube_ && fullBlock_;
+}
+
+CollisionClass Block::getCollisionClass() const {
+    if (!materialBlocksMovement(material_)) return CollisionClass::None;
+    bool unitCube = minX_ == 0.0 && minY_ == 0.0 && minZ_ == 0.0 &&
+                    maxX_ == 1.0 && maxY_ == 1.0 && maxZ_ == 1.0;
+    return unitCube ? CollisionClass::Cube : CollisionClass::Shaped;
+}
+
+void Block::fillPropertyTables() {
+    for (int32_t id = 0; id < BlockProperties::ID_COUNT; ++id) {
+        const Block* b = getBlockById(id);
+        BlockProperties::lightOpacity[id] = b ? static_cast<uint8_t>(b->lightOpacity_) : 0;
+        BlockProperties::lightValue[id] = b ? static_cast<uint8_t>(b->lightValue_) : 0;
+        BlockProperties::material[id] = b ? b->material_ : Material::Air;
+        BlockProperties::ticksRandomly[id] = b && b->needsRandomTick_;
+        BlockProperties::normalCube[id] = b && b->isNormalCube();
+        BlockProperties::collision[id] = b ? b->getCollisionClass() : CollisionClass::None;
+    }
+}
+
 // ─── Static lookup ──────────────────────────────────────────────────────────
 
 Block* Block::getBlockFromName(const std::string& name) {
@@ -127,7 +173,7 @@ void Block::registerBlocks() {
         { Block& b = alloc(mat); b
 
     #define END(id, name) \
-        ; blockRegistry.addObject(id, name, &b); }
+        ; b.id_ = id; blockRegistry.addObject(id, name, &b); }
 
     // 0: air
     REG(0, "air", Material::Air).setUnlocalizedName("air") END(0, "air")
@@ -809,6 +855,8 @@ void Block::registerBlocks() {
     #undef REG
     #undef END
 
+    fillPropertyTables();
+
     std::cout << "[Block] Registered " << blockRegistry.size() << " blocks\n";
 }
 
@@ -5,12 +5,14 @@
  *   net.minecraft.command.CommandHandler — command dispatch and registration
  *   net.minecraft.command.server.CommandStop — /stop
  *   net.minecraft.command.server.CommandSay — /say
+ *   net.minecraft.command.server.CommandSaveAll — /save-all
  *   net.minecraft.command.CommandHelp — /help
  *   net.minecraft.command.CommandGameMode — /gamemode
  *   net.minecraft.command.CommandTime — /time
  *   net.minecraft.command.CommandGive — /give
  *   net.minecraft.command.CommandTeleport — /tp
  *   net.minecraft.command.CommandGameRule — /gamerule
+ *   net.minecraft.command.CommandDebug — analog for /netstats
  *
  * Key behaviors preserved from Java:
  *   - executeCommand: strips leading '/', splits by space, looks up command
@@ -20,7 +22,10 @@
  */
 
 #include "command/CommandSystem.h"
+#include "networking/PacketStats.h"
 #include <algorithm>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 
@@ -45,6 +50,7 @@ CommandHandler::CommandHandler() {
     registerCommand(std::make_shared<CommandSeed>());
     registerCommand(std::make_shared<CommandList>());
     registerCommand(std::make_shared<CommandKill>());
+    registerCommand(std::make_shared<CommandNetStats>());
 
     std::cout << "[Commands] Registered " << getCommandCount() << " commands\n";
 }
@@ -212,6 +218,17 @@ void CommandStop::processCommand(ICommandSender& sender, const std::vector<std::
     // In full implementation, would set MinecraftServer.serverRunning = false
 }
 
+// /save-all — Java: CommandSaveAll.processCommand
+void CommandSaveAll::processCommand(ICommandSender& sender, const std::vector<std::string>& /*args*/) {
+    // Java: "commands.save.start" / "commands.save.success" / "commands.save.failed"
+    sender.addChatMessage("Saving...");
+    if (saveAll_ && saveAll_()) {
+        sender.addChatMessage("Saved the world");
+    } else {
+        sender.addChatMessage("§cSaving failed");
+    }
+}
+
 // /say — Java: CommandSay.processCommand
 void CommandSay::processCommand(ICommandSender& sender, const std::vector<std::string>& args) {
     if (args.empty()) {
@@ -440,4 +457,41 @@ void CommandKill::processCommand(ICommandSender& sender, const std::vector<std::
     std::cout << "[Server] " << sender.getCommandSenderName() << " killed " << target << "\n";
 }
 
+// /netstats — Java analog: CommandDebug writes profiler results to debug/
+void CommandNetStats::processCommand(ICommandSender& sender, const std::vector<std::string>& args) {
+    if (!args.empty() && args[0] == "reset") {
+        PacketStats::reset();
+        sender.addChatMessage("Packet statistics reset");
+        return;
+    }
+
+    auto snapshot = PacketStats::snapshot();
+
+    if (!args.empty() && args[0] == "dump") {
+        std::string path = args.size() > 1 ? args[1] : "netstats.json";
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            sender.addChatMessage("§cCould not write " + path);
+            return;
+        }
+        out << PacketStats::toJson(*snapshot);
+        sender.addChatMessage("Wrote packet statistics to " + path);
+        return;
+    }
+
+    size_t rows = 10;
+    if (args.size() > 1 && args[0] == "top") {
+        rows = static_cast<size_t>(std::max(1, std::atoi(args[1].c_str())));
+    } else if (!args.empty()) {
+        sender.addChatMessage("§cUsage: " + getCommandUsage());
+        return;
+    }
+
+    std::istringstream table(PacketStats::formatTable(*snapshot, rows));
+    std::string line;
+    while (std::getline(table, line)) {
+        sender.addChatMessage(line);
+    }
+}
+
 } // namespace mccpp
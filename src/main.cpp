@@ -8,13 +8,49 @@
  */
 
 #include "server/MinecraftServer.h"
+#include "server/PacketReplay.h"
+#include "networking/PacketCapture.h"
+#include "networking/SessionAuthenticator.h"
+#include "world/Chunk.h"
 
+#include <algorithm>
 #include <csignal>
 #include <cstdlib>
+#include <filesystem>
 #include <iostream>
 
 static mccpp::MinecraftServer* g_server = nullptr;
 
+/**
+ * Offline region compaction (--compact-regions): rewrite every .mca file in
+ * `dir` with its chunks back to back. The world must not be in use.
+ */
+static int compactRegions(const std::string& dir) {
+    std::error_code ec;
+    std::filesystem::directory_iterator it(dir, ec);
+    if (ec) {
+        std::cerr << "[Main] Cannot read " << dir << ": " << ec.message() << "\n";
+        return 1;
+    }
+    int failed = 0;
+    int64_t sectorsBefore = 0, sectorsAfter = 0;
+    for (const auto& entry : it) {
+        if (entry.path().extension() != ".mca") continue;
+        mccpp::RegionCompactStats stats;
+        if (!mccpp::RegionFile::compactFile(entry.path().string(), &stats)) {
+            ++failed;
+            continue;
+        }
+        sectorsBefore += stats.sectorsBefore;
+        sectorsAfter += stats.sectorsAfter;
+        std::cout << "[Main] " << entry.path().filename().string() << ": " << stats.chunksMoved
+                  << " chunks, " << stats.sectorsBefore << " -> " << stats.sectorsAfter << " sectors\n";
+    }
+    std::cout << "[Main] Compacted " << dir << ": " << (sectorsBefore * 4) << " KiB -> "
+              << (sectorsAfter * 4) << " KiB" << (failed ? ", some files failed" : "") << "\n";
+    return failed ? 1 : 0;
+}
+
 /**
  * Signal handler for clean shutdown (Ctrl+C / SIGTERM).
  * Mirrors Java's Runtime.addShutdownHook() in MinecraftServer.main().
@@ -36,6 +72,9 @@ int main(int argc, char* argv[]) {
     mccpp::MinecraftServer server;
     g_server = &server;
 
+    std::string replayFile;
+    double replaySpeed = 1.0;
+
     // Parse command-line arguments (mirrors Java main() argument parsing)
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -53,17 +92,129 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--max-players" && !next.empty()) {
             server.setMaxPlayers(std::atoi(next.c_str()));
             ++i;
+        } else if (arg == "--network-threads" && !next.empty()) {
+            server.setNetworkThreads(std::atoi(next.c_str()));
+            ++i;
+        } else if (arg == "--chunk-threads" && !next.empty()) {
+            server.setChunkSendThreads(std::atoi(next.c_str()));
+            ++i;
+        } else if (arg == "--chunk-compression" && !next.empty()) {
+            mccpp::DeflatePolicy policy = server.getChunkCompression();
+            if (!mccpp::parseDeflateBackend(next, policy.backend)) {
+                std::cerr << "[Main] Unknown --chunk-compression '" << next << "' (zlib or fast)\n";
+                return 1;
+            }
+            server.setChunkCompression(policy);
+            ++i;
+        } else if (arg == "--chunk-compression-level" && !next.empty()) {
+            mccpp::DeflatePolicy policy = server.getChunkCompression();
+            policy.level = next == "auto" ? mccpp::DeflatePolicy::AUTO
+                                          : std::clamp(std::atoi(next.c_str()), mccpp::DeflateEngine::MIN_LEVEL,
+                                                       mccpp::DeflateEngine::MAX_LEVEL);
+            server.setChunkCompression(policy);
+            ++i;
+        } else if (arg == "--world-dir" && !next.empty()) {
+            server.setWorldDirectory(next);
+            ++i;
+        } else if (arg == "--chunk-io-threads" && !next.empty()) {
+            mccpp::ChunkIoConfig config = server.getChunkIoConfig();
+            config.threads = std::atoi(next.c_str());
+            server.setChunkIoConfig(config);
+            ++i;
+        } else if (arg == "--chunk-io-sync" && !next.empty()) {
+            mccpp::ChunkIoConfig config = server.getChunkIoConfig();
+            if (!mccpp::parseChunkSyncPolicy(next, config.sync)) {
+                std::cerr << "[Main] Unknown --chunk-io-sync '" << next << "' (none, region or periodic)\n";
+                return 1;
+            }
+            server.setChunkIoConfig(config);
+            ++i;
+        } else if (arg == "--chunk-io-mode" && !next.empty()) {
+            mccpp::ChunkIoConfig config = server.getChunkIoConfig();
+            if (!mccpp::parseRegionIoMode(next, config.ioMode)) {
+                std::cerr << "[Main] Unknown --chunk-io-mode '" << next << "' (sync or io_uring)\n";
+                return 1;
+            }
+            server.setChunkIoConfig(config);
+            ++i;
+        } else if (arg == "--chunk-io-sync-interval" && !next.empty()) {
+            mccpp::ChunkIoConfig config = server.getChunkIoConfig();
+            config.syncIntervalMs = std::max(1, std::atoi(next.c_str()));
+            server.setChunkIoConfig(config);
+            ++i;
+        } else if (arg == "--gamemode" && !next.empty()) {
+            if (next == "survival" || next == "0") {
+                server.setGameType(mccpp::MinecraftServer::GAME_TYPE_SURVIVAL);
+            } else if (next == "creative" || next == "1") {
+                server.setGameType(mccpp::MinecraftServer::GAME_TYPE_CREATIVE);
+            } else {
+                std::cerr << "[Main] Unknown --gamemode '" << next << "' (survival or creative)\n";
+                return 1;
+            }
+            ++i;
+        } else if (arg == "--offline-mode") {
+            server.setOnlineMode(false);
+        } else if (arg == "--session-server" && !next.empty()) {
+            server.setSessionAuthenticator(std::make_shared<mccpp::HttpSessionAuthenticator>(next));
+            ++i;
+        } else if (arg == "--connection-throttle" && !next.empty()) {
+            // Sustained accepts per second per IP; bursts of four seconds' worth
+            double rate = std::atof(next.c_str());
+            server.setConnectionRateLimit(rate, std::max(8, static_cast<int>(rate * 4)));
+            ++i;
+        } else if (arg == "--capture" && !next.empty()) {
+            server.setCaptureFile(next);
+            ++i;
+        } else if (arg == "--replay" && !next.empty()) {
+            replayFile = next;
+            ++i;
+        } else if (arg == "--replay-speed" && !next.empty()) {
+            replaySpeed = std::max(0.0, std::atof(next.c_str()));
+            ++i;
+        } else if (arg == "--compact-regions" && !next.empty()) {
+            return compactRegions(next);
         } else if (arg == "--help") {
             std::cout << "Usage: minecppaft-server [options]\n"
                       << "  --port <port>         Server port (default: 25565)\n"
                       << "  --bind <address>      Bind address (default: 0.0.0.0)\n"
                       << "  --motd <message>      Server MOTD\n"
                       << "  --max-players <count> Max player count (default: 20)\n"
+                      << "  --network-threads <n> Network I/O threads (default: cores/4, 1-4)\n"
+                      << "  --chunk-threads <n>   Chunk packet compression threads (default: cores/4, 1-4)\n"
+                      << "  --chunk-compression <zlib|fast> Chunk packet deflate backend (default: zlib)\n"
+                      << "  --chunk-compression-level <1-9|auto> Deflate level (default: auto, 6 down to 1 under load)\n"
+                      << "  --world-dir <dir>     Load and save chunks in <dir>/region (default: not saved)\n"
+                      << "  --chunk-io-threads <n> Chunk save threads (default: cores/4, 1-4)\n"
+                      << "  --chunk-io-sync <none|region|periodic> When region files are fsync'ed (default: periodic)\n"
+                      << "  --chunk-io-sync-interval <ms> Periodic sync interval (default: 5000)\n"
+                      << "  --chunk-io-mode <sync|io_uring> Region file writes (default: sync)\n"
+                      << "  --gamemode <survival|creative> Game mode of all players (default: survival)\n"
+                      << "  --offline-mode        Skip encryption and session verification\n"
+                      << "  --session-server <url> Session server base URL (default: Mojang)\n"
+                      << "  --connection-throttle <n> Connections per second per IP (default: 2, 0 = off)\n"
+                      << "  --capture <file>      Record all inbound packets to <file>\n"
+                      << "  --replay <file>       Replay a capture against this server, then stop\n"
+                      << "  --replay-speed <x>    Replay pace multiplier (default: 1, 0 = no delays)\n"
+                      << "  --compact-regions <dir> Rewrite the region files in <dir> without gaps, then exit\n"
                       << "  --help                Show this help\n";
             return 0;
         }
     }
 
+    // Replays carry no encryption response, so logins must not ask for one
+    std::unique_ptr<mccpp::PacketReplay> replay;
+    if (!replayFile.empty()) {
+        std::vector<mccpp::CaptureRecord> records;
+        std::string error;
+        if (!mccpp::PacketCapture::load(replayFile, records, error)) {
+            std::cerr << "[Main] " << error << "\n";
+            if (records.empty()) return 1;
+            std::cerr << "[Main] Replaying the " << records.size() << " records before the damage\n";
+        }
+        server.setOnlineMode(false);
+        replay = std::make_unique<mccpp::PacketReplay>(server, std::move(records), replaySpeed);
+    }
+
     // Install signal handlers for graceful shutdown
     std::signal(SIGINT, signalHandler);
     std::signal(SIGTERM, signalHandler);
@@ -75,9 +226,13 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (replay) replay->start(true);
+
     // Run the main tick loop (blocking)
     server.run();
 
+    if (replay) replay->stop();
+
     g_server = nullptr;
     return 0;
 }
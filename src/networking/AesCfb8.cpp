@@ -0,0 +1,273 @@
+/**
+ * AesCfb8.cpp — AES-128/CFB8 stream cipher with AES-NI and portable backends.
+ *
+ * Java reference: net.minecraft.util.CryptManager ("AES/CFB8/NoPadding")
+ */
+
+#include "networking/AesCfb8.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MCCPP_HAVE_AESNI 1
+#include <immintrin.h>
+#endif
+
+namespace mccpp {
+
+namespace {
+
+// ─── Portable AES-128 (FIPS-197) ────────────────────────────────────────────
+
+constexpr uint8_t SBOX[256] = {
+    0x63,0x7c,0x77,0x7b,0xf2,0x6b,0x6f,0xc5,0x30,0x01,0x67,0x2b,0xfe,0xd7,0xab,0x76,
+    0xca,0x82,0xc9,0x7d,0xfa,0x59,0x47,0xf0,0xad,0xd4,0xa2,0xaf,0x9c,0xa4,0x72,0xc0,
+    0xb7,0xfd,0x93,0x26,0x36,0x3f,0xf7,0xcc,0x34,0xa5,0xe5,0xf1,0x71,0xd8,0x31,0x15,
+    0x04,0xc7,0x23,0xc3,0x18,0x96,0x05,0x9a,0x07,0x12,0x80,0xe2,0xeb,0x27,0xb2,0x75,
+    0x09,0x83,0x2c,0x1a,0x1b,0x6e,0x5a,0xa0,0x52,0x3b,0xd6,0xb3,0x29,0xe3,0x2f,0x84,
+    0x53,0xd1,0x00,0xed,0x20,0xfc,0xb1,0x5b,0x6a,0xcb,0xbe,0x39,0x4a,0x4c,0x58,0xcf,
+    0xd0,0xef,0xaa,0xfb,0x43,0x4d,0x33,0x85,0x45,0xf9,0x02,0x7f,0x50,0x3c,0x9f,0xa8,
+    0x51,0xa3,0x40,0x8f,0x92,0x9d,0x38,0xf5,0xbc,0xb6,0xda,0x21,0x10,0xff,0xf3,0xd2,
+    0xcd,0x0c,0x13,0xec,0x5f,0x97,0x44,0x17,0xc4,0xa7,0x7e,0x3d,0x64,0x5d,0x19,0x73,
+    0x60,0x81,0x4f,0xdc,0x22,0x2a,0x90,0x88,0x46,0xee,0xb8,0x14,0xde,0x5e,0x0b,0xdb,
+    0xe0,0x32,0x3a,0x0a,0x49,0x06,0x24,0x5c,0xc2,0xd3,0xac,0x62,0x91,0x95,0xe4,0x79,
+    0xe7,0xc8,0x37,0x6d,0x8d,0xd5,0x4e,0xa9,0x6c,0x56,0xf4,0xea,0x65,0x7a,0xae,0x08,
+    0xba,0x78,0x25,0x2e,0x1c,0xa6,0xb4,0xc6,0xe8,0xdd,0x74,0x1f,0x4b,0xbd,0x8b,0x8a,
+    0x70,0x3e,0xb5,0x66,0x48,0x03,0xf6,0x0e,0x61,0x35,0x57,0xb9,0x86,0xc1,0x1d,0x9e,
+    0xe1,0xf8,0x98,0x11,0x69,0xd9,0x8e,0x94,0x9b,0x1e,0x87,0xe9,0xce,0x55,0x28,0xdf,
+    0x8c,0xa1,0x89,0x0d,0xbf,0xe6,0x42,0x68,0x41,0x99,0x2d,0x0f,0xb0,0x54,0xbb,0x16,
+};
+
+constexpr uint8_t RCON[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+
+inline uint32_t rotr(uint32_t v, int n) { return (v >> n) | (v << (32 - n)); }
+
+inline uint32_t loadBE(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8)  |  static_cast<uint32_t>(p[3]);
+}
+
+inline void storeBE(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+// Combined SubBytes + ShiftRows + MixColumns lookup tables
+struct EncTables {
+    uint32_t te[4][256];
+
+    EncTables() {
+        for (int i = 0; i < 256; ++i) {
+            uint32_t s = SBOX[i];
+            uint32_t s2 = ((s << 1) ^ ((s & 0x80) ? 0x1b : 0)) & 0xFF;
+            uint32_t s3 = s2 ^ s;
+            uint32_t w = (s2 << 24) | (s << 16) | (s << 8) | s3;
+            te[0][i] = w;
+            te[1][i] = rotr(w, 8);
+            te[2][i] = rotr(w, 16);
+            te[3][i] = rotr(w, 24);
+        }
+    }
+};
+
+const EncTables& encTables() {
+    static const EncTables tables;
+    return tables;
+}
+
+// ─── AES-NI ─────────────────────────────────────────────────────────────────
+
+#ifdef MCCPP_HAVE_AESNI
+
+#define MCCPP_AESNI_TARGET __attribute__((target("aes,ssse3")))
+
+MCCPP_AESNI_TARGET
+inline __m128i aesniEncrypt(__m128i x, const __m128i* k) {
+    x = _mm_xor_si128(x, k[0]);
+    for (int r = 1; r < 10; ++r) x = _mm_aesenc_si128(x, k[r]);
+    return _mm_aesenclast_si128(x, k[10]);
+}
+
+MCCPP_AESNI_TARGET
+inline __m128i shiftIn(__m128i r, uint8_t c) {
+    return _mm_or_si128(_mm_srli_si128(r, 1), _mm_slli_si128(_mm_cvtsi32_si128(c), 15));
+}
+
+MCCPP_AESNI_TARGET
+void encryptAesNi(const uint8_t* roundKeys, uint8_t* shift,
+                  const uint8_t* in, uint8_t* out, size_t length) {
+    __m128i k[11];
+    for (int r = 0; r < 11; ++r) k[r] = _mm_load_si128(reinterpret_cast<const __m128i*>(roundKeys + 16 * r));
+    __m128i reg = _mm_load_si128(reinterpret_cast<const __m128i*>(shift));
+
+    for (size_t i = 0; i < length; ++i) {
+        __m128i o = aesniEncrypt(reg, k);
+        uint8_t c = static_cast<uint8_t>(in[i] ^ static_cast<uint8_t>(_mm_cvtsi128_si32(o)));
+        out[i] = c;
+        reg = shiftIn(reg, c);
+    }
+    _mm_store_si128(reinterpret_cast<__m128i*>(shift), reg);
+}
+
+// Decrypt eight bytes per iteration: the eight shift register values are
+// windows over (register || next 8 ciphertext bytes), so the eight AES
+// encryptions are independent and fill the AES unit's pipeline.
+MCCPP_AESNI_TARGET
+void decryptAesNi(const uint8_t* roundKeys, uint8_t* shift,
+                  const uint8_t* in, uint8_t* out, size_t length) {
+    __m128i k[11];
+    for (int r = 0; r < 11; ++r) k[r] = _mm_load_si128(reinterpret_cast<const __m128i*>(roundKeys + 16 * r));
+    __m128i reg = _mm_load_si128(reinterpret_cast<const __m128i*>(shift));
+
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t cipher;
+        std::memcpy(&cipher, in + i, 8);   // read before `out` (maybe == in) is written
+        __m128i c = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i));
+
+        __m128i b[8];
+        b[0] = reg;
+        b[1] = _mm_alignr_epi8(c, reg, 1);
+        b[2] = _mm_alignr_epi8(c, reg, 2);
+        b[3] = _mm_alignr_epi8(c, reg, 3);
+        b[4] = _mm_alignr_epi8(c, reg, 4);
+        b[5] = _mm_alignr_epi8(c, reg, 5);
+        b[6] = _mm_alignr_epi8(c, reg, 6);
+        b[7] = _mm_alignr_epi8(c, reg, 7);
+
+        for (int j = 0; j < 8; ++j) b[j] = _mm_xor_si128(b[j], k[0]);
+        for (int r = 1; r < 10; ++r) {
+            for (int j = 0; j < 8; ++j) b[j] = _mm_aesenc_si128(b[j], k[r]);
+        }
+        uint64_t keystream = 0;
+        for (int j = 0; j < 8; ++j) {
+            b[j] = _mm_aesenclast_si128(b[j], k[10]);
+            keystream |= static_cast<uint64_t>(static_cast<uint8_t>(_mm_cvtsi128_si32(b[j]))) << (8 * j);
+        }
+
+        uint64_t plain = cipher ^ keystream;   // little-endian byte order on x86
+        std::memcpy(out + i, &plain, 8);
+        reg = _mm_alignr_epi8(c, reg, 8);
+    }
+
+    for (; i < length; ++i) {
+        uint8_t c = in[i];
+        __m128i o = aesniEncrypt(reg, k);
+        out[i] = static_cast<uint8_t>(c ^ static_cast<uint8_t>(_mm_cvtsi128_si32(o)));
+        reg = shiftIn(reg, c);
+    }
+    _mm_store_si128(reinterpret_cast<__m128i*>(shift), reg);
+}
+
+#endif // MCCPP_HAVE_AESNI
+
+} // anonymous namespace
+
+// ─── AesCfb8 ────────────────────────────────────────────────────────────────
+
+bool AesCfb8::aesNiSupported() {
+#ifdef MCCPP_HAVE_AESNI
+    static const bool supported = __builtin_cpu_supports("aes") && __builtin_cpu_supports("ssse3");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+AesCfb8::Backend AesCfb8::defaultBackend() {
+    return aesNiSupported() ? Backend::AesNi : Backend::Portable;
+}
+
+const char* AesCfb8::backendName(Backend backend) {
+    return backend == Backend::AesNi ? "AES-NI" : "portable";
+}
+
+AesCfb8::AesCfb8(const uint8_t* key, const uint8_t* iv, Backend backend)
+    : backend_(backend == Backend::AesNi && !aesNiSupported() ? Backend::Portable : backend) {
+    // FIPS-197 §5.2 key expansion; both backends use the same schedule.
+    for (int i = 0; i < 4; ++i) encKeys_[i] = loadBE(key + 4 * i);
+    for (int i = 4; i < 44; ++i) {
+        uint32_t t = encKeys_[i - 1];
+        if (i % 4 == 0) {
+            t = (static_cast<uint32_t>(SBOX[(t >> 16) & 0xFF]) << 24) |
+                (static_cast<uint32_t>(SBOX[(t >> 8) & 0xFF]) << 16) |
+                (static_cast<uint32_t>(SBOX[t & 0xFF]) << 8) |
+                 static_cast<uint32_t>(SBOX[t >> 24]);
+            t ^= static_cast<uint32_t>(RCON[i / 4 - 1]) << 24;
+        }
+        encKeys_[i] = encKeys_[i - 4] ^ t;
+    }
+    for (int i = 0; i < 44; ++i) storeBE(roundKeys_ + 4 * i, encKeys_[i]);
+    std::memcpy(shift_, iv, 16);
+}
+
+void AesCfb8::encryptBlock(const uint8_t* in, uint8_t* out) const {
+    const auto& t = encTables().te;
+    const uint32_t* rk = encKeys_;
+
+    uint32_t s0 = loadBE(in)      ^ rk[0];
+    uint32_t s1 = loadBE(in + 4)  ^ rk[1];
+    uint32_t s2 = loadBE(in + 8)  ^ rk[2];
+    uint32_t s3 = loadBE(in + 12) ^ rk[3];
+
+    for (int r = 1; r < 10; ++r) {
+        rk += 4;
+        uint32_t t0 = t[0][s0 >> 24] ^ t[1][(s1 >> 16) & 0xFF] ^ t[2][(s2 >> 8) & 0xFF] ^ t[3][s3 & 0xFF] ^ rk[0];
+        uint32_t t1 = t[0][s1 >> 24] ^ t[1][(s2 >> 16) & 0xFF] ^ t[2][(s3 >> 8) & 0xFF] ^ t[3][s0 & 0xFF] ^ rk[1];
+        uint32_t t2 = t[0][s2 >> 24] ^ t[1][(s3 >> 16) & 0xFF] ^ t[2][(s0 >> 8) & 0xFF] ^ t[3][s1 & 0xFF] ^ rk[2];
+        uint32_t t3 = t[0][s3 >> 24] ^ t[1][(s0 >> 16) & 0xFF] ^ t[2][(s1 >> 8) & 0xFF] ^ t[3][s2 & 0xFF] ^ rk[3];
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+    }
+
+    // Final round: SubBytes + ShiftRows + AddRoundKey (no MixColumns).
+    // CFB8 only consumes the first output byte, but the block is produced whole.
+    rk += 4;
+    auto last = [](uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t k) {
+        return ((static_cast<uint32_t>(SBOX[a >> 24]) << 24) |
+                (static_cast<uint32_t>(SBOX[(b >> 16) & 0xFF]) << 16) |
+                (static_cast<uint32_t>(SBOX[(c >> 8) & 0xFF]) << 8) |
+                 static_cast<uint32_t>(SBOX[d & 0xFF])) ^ k;
+    };
+    storeBE(out,      last(s0, s1, s2, s3, rk[0]));
+    storeBE(out + 4,  last(s1, s2, s3, s0, rk[1]));
+    storeBE(out + 8,  last(s2, s3, s0, s1, rk[2]));
+    storeBE(out + 12, last(s3, s0, s1, s2, rk[3]));
+}
+
+void AesCfb8::encrypt(const uint8_t* in, uint8_t* out, size_t length) {
+#ifdef MCCPP_HAVE_AESNI
+    if (backend_ == Backend::AesNi) {
+        encryptAesNi(roundKeys_, shift_, in, out, length);
+        return;
+    }
+#endif
+    uint8_t block[16];
+    for (size_t i = 0; i < length; ++i) {
+        encryptBlock(shift_, block);
+        uint8_t c = static_cast<uint8_t>(in[i] ^ block[0]);
+        out[i] = c;
+        std::memmove(shift_, shift_ + 1, 15);
+        shift_[15] = c;
+    }
+}
+
+void AesCfb8::decrypt(const uint8_t* in, uint8_t* out, size_t length) {
+#ifdef MCCPP_HAVE_AESNI
+    if (backend_ == Backend::AesNi) {
+        decryptAesNi(roundKeys_, shift_, in, out, length);
+        return;
+    }
+#endif
+    uint8_t block[16];
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t c = in[i];
+        encryptBlock(shift_, block);
+        out[i] = static_cast<uint8_t>(c ^ block[0]);
+        std::memmove(shift_, shift_ + 1, 15);
+        shift_[15] = c;
+    }
+}
+
+} // namespace mccpp
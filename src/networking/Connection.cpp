@@ -2,38 +2,50 @@
  * Connection.cpp — Per-client connection implementation.
  *
  * Reference: net.minecraft.network.NetworkManager
- * Implements VarInt-framed packet reading/writing with dedicated threads.
+ * Implements VarInt-framed packet reading/writing on a non-blocking socket
+ * driven by the connection's EventLoop.
  */
 
 #include "networking/Connection.h"
+#include "networking/NetworkReactor.h"
+#include "networking/PacketCapture.h"
 #include "networking/PacketHandler.h"
+#include "networking/PacketStats.h"
+#include "networking/PlayPackets.h"
 #include "types/VarInt.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
+#include <exception>
 #include <iostream>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace mccpp {
 
 Connection::Connection(int socketFd, const std::string& remoteAddress, uint16_t remotePort)
-    : socketFd_(socketFd), remoteAddress_(remoteAddress), remotePort_(remotePort) {}
+    : socketFd_(socketFd), remoteAddress_(remoteAddress), remotePort_(remotePort),
+      connectedAt_(std::chrono::steady_clock::now()), budgetRefill_(connectedAt_) {}
 
 Connection::~Connection() {
-    disconnect();
-    if (readThread_.joinable()) readThread_.join();
-    if (writeThread_.joinable()) writeThread_.join();
+    connected_.store(false, std::memory_order_relaxed);
     closeSocket();
 }
 
-void Connection::start(std::shared_ptr<PacketHandler> handler) {
+void Connection::start(std::shared_ptr<PacketHandler> handler, EventLoop& loop) {
     {
         std::lock_guard<std::mutex> lock(handlerMutex_);
         handler_ = std::move(handler);
     }
-    readThread_ = std::thread(&Connection::readLoop, this);
-    writeThread_ = std::thread(&Connection::writeLoop, this);
+    loop_ = &loop;
+    loop.attach(shared_from_this());
+}
+
+void Connection::setCapture(std::shared_ptr<PacketCapture> capture) {
+    capture_ = std::move(capture);
+    if (capture_) captureSession_ = capture_->openSession(remoteAddress_ + ":" + std::to_string(remotePort_));
 }
 
 void Connection::setHandler(std::shared_ptr<PacketHandler> handler) {
@@ -42,18 +54,196 @@ void Connection::setHandler(std::shared_ptr<PacketHandler> handler) {
     handler_ = std::move(handler);
 }
 
-void Connection::sendPacket(std::vector<uint8_t> data) {
+namespace {
+
+// Packet ID of a complete frame ([VarInt length][VarInt packetId]...), or -1.
+int32_t framePacketId(const uint8_t* frame, size_t size) {
+    size_t pos = 0;
+    while (pos < size && (frame[pos] & 0x80)) ++pos;
+    if (++pos >= size) return -1;
+    // Every packet ID of this protocol fits in one byte
+    return (frame[pos] & 0x80) ? -1 : frame[pos];
+}
+
+// Call fn(packetId, frameBytes) for each frame of a buffer of complete
+// frames: one for finishFrame(), several for a finishFrames() batch.
+template <typename Fn>
+void forEachFrame(const uint8_t* data, size_t size, Fn&& fn) {
+    size_t pos = 0;
+    while (pos < size) {
+        size_t start = pos, length = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            if (pos >= size || shift > 14) return;   // length prefix is at most 3 bytes
+            byte = data[pos++];
+            length |= static_cast<size_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        if (length > size - pos) return;
+        pos += length;
+        fn(framePacketId(data + start, pos - start), pos - start);
+    }
+}
+
+// Java reference: EnumConnectionState.PLAY — clientbound packet IDs
+PacketPriority priorityOf(ConnectionState state, int32_t packetId) {
+    if (state != ConnectionState::Play) return PacketPriority::Control;
+
+    switch (packetId) {
+        case ClientboundPacket::KeepAlive:
+        case ClientboundPacket::JoinGame:
+        case ClientboundPacket::UpdateHealth:
+        case ClientboundPacket::Respawn:
+        case ClientboundPacket::ChatMessage:
+        case ClientboundPacket::ChangeGameState:
+        case ClientboundPacket::PlayerAbilities:
+        case ClientboundPacket::Disconnect:
+            return PacketPriority::Control;
+        case ClientboundPacket::ChunkData:
+        case ClientboundPacket::MultiBlockChange:
+        case ClientboundPacket::BlockChange:
+        case ClientboundPacket::BlockAction:
+        case ClientboundPacket::BlockBreakAnim:
+        case ClientboundPacket::MapChunkBulk:
+        case ClientboundPacket::Explosion:
+        case ClientboundPacket::UpdateSign:
+        case ClientboundPacket::UpdateBlockEntity:
+            return PacketPriority::Bulk;
+        default:
+            return PacketPriority::Gameplay;
+    }
+}
+
+// A batch goes out in the class of its most urgent frame, so none of its
+// frames waits behind traffic it would otherwise overtake
+PacketPriority priorityOfFrames(ConnectionState state, const uint8_t* data, size_t size) {
+    PacketPriority priority = PacketPriority::Bulk;
+    bool any = false;
+    forEachFrame(data, size, [&](int32_t packetId, size_t) {
+        priority = std::min(priority, priorityOf(state, packetId));
+        any = true;
+    });
+    return any ? priority : priorityOf(state, -1);
+}
+
+void recordOutboundFrames(const uint8_t* data, size_t size, bool play) {
+    forEachFrame(data, size, [&](int32_t packetId, size_t bytes) {
+        PacketStats::recordPacket(PacketDirection::Outbound, packetId, play, bytes);
+    });
+}
+
+int64_t steadyMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // anonymous namespace
+
+void Connection::sendPacket(PacketBuffer packet) {
+    // The length prefix goes into the buffer's headroom; nothing is copied.
+    packet.finishFrame();
+    PacketPriority priority = priorityOfFrames(getState(), packet.data(), packet.size());
+    sendPacket(std::move(packet), priority);
+}
+
+void Connection::sendPacket(PacketBuffer packet, PacketPriority priority) {
     // Java reference: NetworkManager.scheduleOutboundPacket()
     if (!connected_.load(std::memory_order_relaxed)) return;
 
-    // Frame the packet: VarInt(total length) + data
-    // data already contains VarInt(packetId) + payload
-    std::vector<uint8_t> framed;
-    writeVarInt(framed, static_cast<int32_t>(data.size()));
-    framed.insert(framed.end(), data.begin(), data.end());
+    packet.finishFrame();
+    size_t bytes = packet.size();
+    size_t c = static_cast<size_t>(priority);
+    recordOutboundFrames(packet.data(), bytes, getState() == ConnectionState::Play);
+    size_t total;
+    {
+        std::lock_guard<std::mutex> lock(outMutex_);
+        outQueues_[c].push_back(OutboundFrame{std::move(packet), nullptr});
+        queuedBytes_[c] += bytes;
+        total = queuedTotal_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    }
+    if (total > MAX_QUEUED_BYTES) {
+        disconnect("Outbound queue overflow");
+    }
+}
+
+void Connection::sendPacket(SharedPacket packet) {
+    if (!packet) return;
+    PacketPriority priority = priorityOfFrames(getState(), packet->data(), packet->size());
+    sendPacket(std::move(packet), priority);
+}
+
+void Connection::sendPacket(SharedPacket packet, PacketPriority priority) {
+    if (!connected_.load(std::memory_order_relaxed) || !packet) return;
+
+    size_t bytes = packet->size();
+    size_t c = static_cast<size_t>(priority);
+    recordOutboundFrames(packet->data(), bytes, getState() == ConnectionState::Play);
+    size_t total;
+    {
+        std::lock_guard<std::mutex> lock(outMutex_);
+        outQueues_[c].push_back(OutboundFrame{PacketBuffer(), std::move(packet)});
+        queuedBytes_[c] += bytes;
+        total = queuedTotal_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    }
+    if (total > MAX_QUEUED_BYTES) {
+        disconnect("Outbound queue overflow");
+    }
+}
+
+void Connection::flush() {
+    // Java: NetworkManager.flush() hands the write to the channel's event loop
+    if (!loop_ || !connected_.load(std::memory_order_relaxed)) return;
+    if (!checkBacklog()) return;
+    // While blocked on EAGAIN the next EPOLLOUT edge resumes the write anyway.
+    if (writeBlocked_.load(std::memory_order_acquire)) return;
+    if (!flushScheduled_.exchange(true, std::memory_order_acq_rel)) {
+        loop_->scheduleFlush(shared_from_this());
+    }
+}
+
+bool Connection::checkBacklog() {
+    size_t backlog = queuedTotal_.load(std::memory_order_relaxed) +
+                     inFlightBytes_.load(std::memory_order_relaxed);
+    if (backlog <= BACKLOG_SOFT_LIMIT) {
+        bulkThrottled_.store(false, std::memory_order_relaxed);
+        overBudgetSinceMs_.store(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Over budget: throttle chunk producers first, disconnect if it persists.
+    bulkThrottled_.store(true, std::memory_order_relaxed);
+    int64_t now = steadyMs();
+    int64_t since = 0;
+    if (overBudgetSinceMs_.compare_exchange_strong(since, now, std::memory_order_relaxed)) {
+        return true;
+    }
+    if (now - since > OVER_BUDGET_TIMEOUT_MS) {
+        disconnect("Client is not keeping up (" + std::to_string(backlog / 1024) +
+                   " KiB outbound backlog)");
+        return false;
+    }
+    return true;
+}
 
-    std::lock_guard<std::mutex> lock(outMutex_);
-    outQueue_.push_back(std::move(framed));
+void Connection::setByteBudget(size_t bytesPerSecond, size_t burstBytes) {
+    budgetRate_ = bytesPerSecond;
+    budgetBurst_ = burstBytes;
+    budgetTokens_ = static_cast<double>(burstBytes);
+}
+
+OutboundQueueStats Connection::getOutboundStats() const {
+    OutboundQueueStats stats;
+    {
+        std::lock_guard<std::mutex> lock(outMutex_);
+        for (size_t c = 0; c < PRIORITY_CLASSES; ++c) {
+            stats.queuedFrames[c] = outQueues_[c].size();
+            stats.queuedBytes[c] = queuedBytes_[c];
+        }
+    }
+    stats.bytesInFlight = inFlightBytes_.load(std::memory_order_relaxed);
+    stats.bulkThrottled = isBulkThrottled();
+    return stats;
 }
 
 void Connection::disconnect(const std::string& reason) {
@@ -74,133 +264,447 @@ void Connection::disconnect(const std::string& reason) {
     if (h) {
         h->onDisconnect(reason);
     }
+
+    // The loop flushes queued packets (e.g. the kick reason) and closes the socket.
+    if (loop_) {
+        loop_->scheduleClose(shared_from_this());
+    }
 }
 
 void Connection::setState(ConnectionState state) {
     // Java reference: NetworkManager.setConnectionState()
+    // The release store publishes inbox_ to the tick thread.
+    if (state == ConnectionState::Play && !inbox_) {
+        inbox_ = std::make_unique<PacketInbox>(INBOX_CAPACITY);
+    }
     state_.store(state, std::memory_order_release);
 }
 
+void Connection::enableEncryption(const uint8_t* sharedSecret) {
+    // Java reference: NetworkManager.enableEncryption() — adds the
+    // NettyEncryptingDecoder/Encoder pair; the secret is both key and IV.
+    decryptor_ = std::make_unique<AesCfb8>(sharedSecret, sharedSecret);
+    encryptor_ = std::make_unique<AesCfb8>(sharedSecret, sharedSecret);
+
+    // Anything received after the EncryptionResponse frame is already ciphertext.
+    if (size_t pending = inBuffer_.readableBytes()) {
+        decryptor_->decrypt(inBuffer_.readableData(), inBuffer_.readableData(), pending);
+    }
+    encrypted_.store(true, std::memory_order_release);
+}
+
 bool Connection::hasOutboundData() const {
-    std::lock_guard<std::mutex> lock(outMutex_);
-    return !outQueue_.empty();
+    if (writeBlocked_.load(std::memory_order_acquire)) return true;
+    return queuedTotal_.load(std::memory_order_relaxed) != 0;
 }
 
-void Connection::readLoop() {
-    std::vector<uint8_t> buffer;
-    uint8_t readBuf[READ_BUF_SIZE];
+void Connection::onReadable() {
+    // Edge-triggered: drain the socket until EAGAIN or the peer goes away.
+    while (connected_.load(std::memory_order_relaxed)) {
+        uint8_t* tail = inBuffer_.prepareWrite(READ_BUF_SIZE);
+        ssize_t bytesRead = ::recv(socketFd_, tail, inBuffer_.writableBytes(), 0);
+        if (bytesRead < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            disconnect(std::string("Read error: ") + std::strerror(errno));
+            break;
+        }
+        if (bytesRead == 0) {
+            // Java reference: NetworkManager.channelInactive() → "disconnect.endOfStream"
+            disconnect("End of stream");
+            break;
+        }
+
+        if (decryptor_) decryptor_->decrypt(tail, tail, static_cast<size_t>(bytesRead));
+        inBuffer_.commitWrite(static_cast<size_t>(bytesRead));
+        processInbound();
+    }
+
+    // Handshake/Status/Login replies go out with the read batch, not the next tick.
+    flushOutbound();
+}
 
+void Connection::processInbound() {
+    // Java reference: MessageDeserializer2.decode() — split on VarInt length prefixes.
+    // Each complete frame is dispatched in place; nothing is copied or erased.
+    FrameView frame;
     while (connected_.load(std::memory_order_relaxed)) {
-        ssize_t bytesRead = ::recv(socketFd_, readBuf, READ_BUF_SIZE, 0);
-        if (bytesRead <= 0) {
-            if (bytesRead == 0) {
-                // Java reference: NetworkManager.channelInactive() → "disconnect.endOfStream"
-                disconnect("End of stream");
-            } else if (errno != EINTR) {
-                disconnect(std::string("Read error: ") + std::strerror(errno));
-            }
+        FrameStatus status = inBuffer_.nextFrame(frame);
+        if (status == FrameStatus::NeedMore) break;
+
+        if (status == FrameStatus::BadLength) {
+            disconnect("Bad packet length");
+            break;
+        }
+        if (status == FrameStatus::TooLarge) {
+            disconnect("Packet too large");
+            break;
+        }
+        if (status == FrameStatus::Empty) {
+            disconnect("Empty packet");
             break;
         }
 
-        buffer.insert(buffer.end(), readBuf, readBuf + bytesRead);
-
-        // Process complete packets from the buffer
-        // Java reference: NetworkManager.processReceivedPackets() processes up to 1000 packets/tick
-        while (buffer.size() > 0 && connected_.load(std::memory_order_relaxed)) {
-            // Try to read packet length (VarInt)
-            size_t available = buffer.size();
-            int offset = 0;
-            int32_t packetLength = 0;
-            bool lengthComplete = false;
-
-            for (size_t i = 0; i < available && i < 5; ++i) {
-                uint8_t byte = buffer[i];
-                packetLength |= static_cast<int32_t>(byte & 0x7F) << (7 * i);
-                ++offset;
-                if ((byte & 0x80) == 0) {
-                    lengthComplete = true;
-                    break;
-                }
-            }
+        dispatchPacket(frame);
+    }
 
-            if (!lengthComplete) {
-                break; // Need more data for the length prefix
-            }
+    inBuffer_.compactIfDrained();
+}
+
+void Connection::dispatchPacket(const FrameView& frame) {
+    int32_t packetId;
+    const uint8_t* payload;
+    size_t payloadLen;
+    try {
+        auto idResult = readVarInt(frame.data, frame.length);
+        packetId = idResult.value;
+        payload = frame.data + idResult.bytesRead;
+        payloadLen = frame.length - static_cast<size_t>(idResult.bytesRead);
+    } catch (const std::exception& e) {
+        disconnect(std::string("Internal Exception: ") + e.what());
+        return;
+    }
+
+    bool play = getState() == ConnectionState::Play;
+    PacketStats::recordPacket(PacketDirection::Inbound, packetId, play,
+                              frame.length + static_cast<size_t>(varIntSize(static_cast<int32_t>(frame.length))));
+
+    // The encryption response (the client's shared secret) is never captured
+    if (capture_ && !(getState() == ConnectionState::Login && packetId == LoginPacket::EncryptionResponse)) {
+        capture_->recordFrame(captureSession_, frame.data, frame.length);
+    }
 
-            if (packetLength < 0 || packetLength > 2097152) { // 2 MB max
-                disconnect("Packet too large");
+    // Java reference: NetworkManager.channelRead0() — Play packets are queued
+    // for the server thread; everything else is handled on the I/O thread.
+    if (play) {
+        if (!inbox_->tryPush(packetId, payload, payloadLen)) {
+            disconnect("Too many packets");
+        }
+        return;
+    }
+
+    std::shared_ptr<PacketHandler> h;
+    {
+        std::lock_guard<std::mutex> lock(handlerMutex_);
+        h = handler_;
+    }
+    if (h) {
+        handleSafely(*h, packetId, payload, payloadLen);
+    }
+}
+
+void Connection::handleSafely(PacketHandler& handler, int32_t packetId,
+                              const uint8_t* data, size_t length) {
+    // Java reference: NetworkManager.exceptionCaught() — a malformed packet
+    // kicks the client instead of taking down the calling thread.
+    bool play = getState() == ConnectionState::Play;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        handler.handlePacket(packetId, data, length, *this);
+    } catch (const std::exception& e) {
+        disconnect(std::string("Internal Exception: ") + e.what());
+    }
+    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    PacketStats::recordHandlerTime(packetId, play, static_cast<uint64_t>(nanos));
+}
+
+namespace {
+
+bool isMovementPacket(int32_t packetId) {
+    return packetId >= ServerboundPacket::Player &&
+           packetId <= ServerboundPacket::PlayerPosAndLook;
+}
+
+/**
+ * Folds a run of C03/C04/C05/C06 packets into the one packet that carries
+ * the final state: C06 if both position and look changed, else C04 or C05,
+ * else C03.
+ */
+class MovementCoalescer {
+public:
+    // Returns false if the payload is too short to fold (handled on its own).
+    bool add(int32_t packetId, const std::vector<uint8_t>& p) {
+        switch (packetId) {
+            case ServerboundPacket::Player:             // onGround
+                if (p.size() < 1) return false;
                 break;
-            }
+            case ServerboundPacket::PlayerPosition:     // x, y, stance, z, onGround
+                if (p.size() < 33) return false;
+                std::memcpy(position_, p.data(), 32);
+                hasPosition_ = true;
+                break;
+            case ServerboundPacket::PlayerLook:         // yaw, pitch, onGround
+                if (p.size() < 9) return false;
+                std::memcpy(look_, p.data(), 8);
+                hasLook_ = true;
+                break;
+            default:                                    // x, y, stance, z, yaw, pitch, onGround
+                if (p.size() < 41) return false;
+                std::memcpy(position_, p.data(), 32);
+                std::memcpy(look_, p.data() + 32, 8);
+                hasPosition_ = hasLook_ = true;
+                break;
+        }
+        onGround_ = p.back();
+        ++count_;
+        return true;
+    }
+
+    bool empty() const { return count_ == 0; }
+
+    // Build the coalesced packet into `out`; returns its packet ID.
+    int32_t build(std::vector<uint8_t>& out) const {
+        out.clear();
+        int32_t packetId = ServerboundPacket::Player;
+        if (hasPosition_) {
+            out.insert(out.end(), position_, position_ + 32);
+            packetId = ServerboundPacket::PlayerPosition;
+        }
+        if (hasLook_) {
+            out.insert(out.end(), look_, look_ + 8);
+            packetId = hasPosition_ ? ServerboundPacket::PlayerPosAndLook
+                                    : ServerboundPacket::PlayerLook;
+        }
+        out.push_back(onGround_);
+        return packetId;
+    }
+
+private:
+    uint8_t position_[32] = {};
+    uint8_t look_[8] = {};
+    uint8_t onGround_ = 0;
+    bool hasPosition_ = false;
+    bool hasLook_ = false;
+    int count_ = 0;
+};
+
+} // anonymous namespace
+
+int Connection::processReceivedPackets(int budget) {
+    // Java reference: NetworkManager.processReceivedPackets()
+    if (getState() != ConnectionState::Play) return 0;
+
+    std::shared_ptr<PacketHandler> h;
+    {
+        std::lock_guard<std::mutex> lock(handlerMutex_);
+        h = handler_;
+    }
+    if (!h) return 0;
+
+    int processed = 0;
+    std::vector<uint8_t> coalesced;
+    const InboundPacket* packet;
+
+    while (processed < budget && connected_.load(std::memory_order_relaxed)
+           && (packet = inbox_->front()) != nullptr) {
+        if (!isMovementPacket(packet->packetId)) {
+            handleSafely(*h, packet->packetId, packet->payload.data(), packet->payload.size());
+            inbox_->pop();
+            ++processed;
+            continue;
+        }
+
+        MovementCoalescer run;
+        while (packet && processed < budget && isMovementPacket(packet->packetId)
+               && run.add(packet->packetId, packet->payload)) {
+            inbox_->pop();
+            ++processed;
+            packet = inbox_->front();
+        }
+
+        if (run.empty()) {
+            // Malformed movement packet: let the handler see it as-is.
+            handleSafely(*h, packet->packetId, packet->payload.data(), packet->payload.size());
+            inbox_->pop();
+            ++processed;
+            continue;
+        }
+
+        int32_t packetId = run.build(coalesced);
+        handleSafely(*h, packetId, coalesced.data(), coalesced.size());
+    }
+
+    // Java: NetworkManager.processReceivedPackets() → netHandler.onNetworkTick()
+    if (connected_.load(std::memory_order_relaxed)) {
+        h->onNetworkTick(*this);
+    }
+    return processed;
+}
+
+void Connection::notifyRemoved() {
+    std::shared_ptr<PacketHandler> h;
+    {
+        std::lock_guard<std::mutex> lock(handlerMutex_);
+        h = handler_;
+    }
+    if (h) h->onConnectionRemoved(*this);
+}
+
+void Connection::onWritable() {
+    flushOutbound();
+}
 
-            size_t totalNeeded = static_cast<size_t>(offset) + static_cast<size_t>(packetLength);
-            if (buffer.size() < totalNeeded) {
-                break; // Need more data for the packet body
+void Connection::flushOutbound() {
+    // Cleared first so that a flush() requested from now on schedules another pass.
+    flushScheduled_.store(false, std::memory_order_release);
+
+    if (encryptor_) {
+        flushEncrypted();
+        return;
+    }
+
+    for (;;) {
+        if (writeQueue_.empty()) {
+            writeOffset_ = 0;
+            if (!takeOutbound()) {
+                writeBlocked_.store(false, std::memory_order_release);
+                return;
             }
+        }
 
-            // Extract the packet body
-            const uint8_t* packetData = buffer.data() + offset;
-            size_t packetDataLen = static_cast<size_t>(packetLength);
+        // Gather up to MAX_IOV frames into one sendmsg(). MSG_MORE (the per-call
+        // form of TCP_CORK) holds back a partial segment while more frames follow.
+        iovec iov[MAX_IOV];
+        size_t count = 0;
+        for (auto it = writeQueue_.begin(); it != writeQueue_.end() && count < MAX_IOV; ++it) {
+            size_t skip = (count == 0) ? writeOffset_ : 0;
+            iov[count].iov_base = const_cast<uint8_t*>(it->data()) + skip;
+            iov[count].iov_len = it->size() - skip;
+            ++count;
+        }
 
-            if (packetDataLen == 0) {
-                disconnect("Empty packet");
-                break;
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        int flags = MSG_NOSIGNAL;
+        if (count < writeQueue_.size()) flags |= MSG_MORE;
+
+        ssize_t sent = ::sendmsg(socketFd_, &msg, flags);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Resumed by the next EPOLLOUT edge
+                writeBlocked_.store(true, std::memory_order_release);
+                publishInFlight();
+                return;
             }
+            disconnect(std::string("Write error: ") + std::strerror(errno));
+            return;
+        }
 
-            // Read packet ID from the body
-            auto idResult = readVarInt(packetData, packetDataLen);
-            int32_t packetId = idResult.value;
-            const uint8_t* payload = packetData + idResult.bytesRead;
-            size_t payloadLen = packetDataLen - static_cast<size_t>(idResult.bytesRead);
-
-            // Dispatch to handler (thread-safe access)
-            {
-                std::shared_ptr<PacketHandler> h;
-                {
-                    std::lock_guard<std::mutex> lock(handlerMutex_);
-                    h = handler_;
-                }
-                if (h) {
-                    h->handlePacket(packetId, payload, payloadLen, *this);
-                }
+        // Retire fully written frames (their blocks go back to this thread's
+        // pool); keep the offset into a partial one.
+        size_t remaining = static_cast<size_t>(sent);
+        size_t frames = 0;
+        while (remaining > 0) {
+            size_t left = writeQueue_.front().size() - writeOffset_;
+            if (remaining < left) {
+                writeOffset_ += remaining;
+                break;
             }
+            remaining -= left;
+            writeQueueBytes_ -= writeQueue_.front().size();
+            writeQueue_.pop_front();
+            writeOffset_ = 0;
+            ++frames;
+        }
+        loop_->recordWrite(static_cast<uint64_t>(sent), frames);
+    }
+}
 
-            // Remove processed bytes from buffer
-            buffer.erase(buffer.begin(), buffer.begin() + static_cast<long>(totalNeeded));
+bool Connection::takeOutbound() {
+    // Refill the byte budget for the time since the last pass.
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - budgetRefill_).count();
+    budgetRefill_ = now;
+    budgetTokens_ = std::min(static_cast<double>(budgetBurst_), budgetTokens_ + elapsed * budgetRate_);
+
+    // Control, then Gameplay, then Bulk. Bulk waits for a positive budget and
+    // is capped per pass so newly queued Control frames are not stuck behind it.
+    size_t moved = 0;
+    size_t bulkTaken = 0;
+    {
+        std::lock_guard<std::mutex> lock(outMutex_);
+        for (size_t c = 0; c < PRIORITY_CLASSES; ++c) {
+            bool bulk = c == static_cast<size_t>(PacketPriority::Bulk);
+            auto& queue = outQueues_[c];
+            while (!queue.empty()) {
+                if (bulk && (budgetTokens_ <= 0.0 || bulkTaken >= BULK_WRITE_WINDOW)) break;
+                size_t bytes = queue.front().size();
+                writeQueue_.push_back(std::move(queue.front()));
+                queue.pop_front();
+                queuedBytes_[c] -= bytes;
+                queuedTotal_.fetch_sub(bytes, std::memory_order_relaxed);
+                writeQueueBytes_ += bytes;
+                budgetTokens_ -= static_cast<double>(bytes);
+                if (bulk) bulkTaken += bytes;
+                ++moved;
+            }
         }
     }
+    publishInFlight();
+    return moved != 0;
 }
 
-void Connection::writeLoop() {
-    while (connected_.load(std::memory_order_relaxed)) {
-        std::vector<uint8_t> packet;
+void Connection::publishInFlight() {
+    size_t inFlight = writeQueueBytes_ - writeOffset_ + (cipherOut_.size() - cipherOffset_);
+    inFlightBytes_.store(inFlight, std::memory_order_relaxed);
+}
+
+void Connection::flushEncrypted() {
+    // Java reference: NettyEncryptingEncoder — the cipher is a byte stream,
+    // so frames are encrypted exactly once, in queue order, into cipherOut_;
+    // partial writes resume from cipherOffset_ without touching the cipher.
+    for (;;) {
+        if (cipherOffset_ == cipherOut_.size()) {
+            if (cipherOut_.capacity() > CIPHER_SHRINK_THRESHOLD) {
+                std::vector<uint8_t>().swap(cipherOut_);   // after a chunk burst
+            }
+            cipherOut_.clear();
+            cipherOffset_ = 0;
+            cipherFrames_ = 0;
+
+            if (writeQueue_.empty() && !takeOutbound()) {
+                writeBlocked_.store(false, std::memory_order_release);
+                return;
+            }
 
-        {
-            std::lock_guard<std::mutex> lock(outMutex_);
-            if (outQueue_.empty()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                continue;
+            size_t total = 0;
+            for (const auto& frame : writeQueue_) total += frame.size();
+            cipherOut_.resize(total);
+            uint8_t* out = cipherOut_.data();
+            for (const auto& frame : writeQueue_) {
+                encryptor_->encrypt(frame.data(), out, frame.size());
+                out += frame.size();
             }
-            packet = std::move(outQueue_.front());
-            outQueue_.pop_front();
-        }
-
-        // Write the full packet to socket
-        size_t totalSent = 0;
-        while (totalSent < packet.size()) {
-            ssize_t sent = ::send(socketFd_, packet.data() + totalSent,
-                                  packet.size() - totalSent, MSG_NOSIGNAL);
-            if (sent <= 0) {
-                if (errno == EINTR) continue;
-                disconnect(std::string("Write error: ") + std::strerror(errno));
+            cipherFrames_ = writeQueue_.size();
+            writeQueue_.clear();   // plaintext blocks go back to the pool
+            writeQueueBytes_ = 0;
+        }
+
+        ssize_t sent = ::send(socketFd_, cipherOut_.data() + cipherOffset_,
+                              cipherOut_.size() - cipherOffset_, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                writeBlocked_.store(true, std::memory_order_release);
+                publishInFlight();
                 return;
             }
-            totalSent += static_cast<size_t>(sent);
+            disconnect(std::string("Write error: ") + std::strerror(errno));
+            return;
         }
+
+        cipherOffset_ += static_cast<size_t>(sent);
+        loop_->recordWrite(static_cast<uint64_t>(sent),
+                           cipherOffset_ == cipherOut_.size() ? cipherFrames_ : 0);
     }
 }
 
 void Connection::closeSocket() {
     if (socketFd_ >= 0) {
+        if (capture_) capture_->closeSession(captureSession_);
         ::shutdown(socketFd_, SHUT_RDWR);
         ::close(socketFd_);
         socketFd_ = -1;
@@ -0,0 +1,115 @@
+/**
+ * CryptManager.cpp — RSA and SHA-1 helpers for the online-mode handshake.
+ *
+ * Java reference: net.minecraft.util.CryptManager
+ */
+
+#include "networking/CryptManager.h"
+
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+namespace mccpp {
+
+// ─── ServerKeyPair ──────────────────────────────────────────────────────────
+
+std::unique_ptr<ServerKeyPair> ServerKeyPair::generate() {
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+    if (!ctx) return nullptr;
+
+    EVP_PKEY* key = nullptr;
+    if (EVP_PKEY_keygen_init(ctx) <= 0 ||
+        EVP_PKEY_CTX_set_rsa_keygen_bits(ctx, KEY_BITS) <= 0 ||
+        EVP_PKEY_keygen(ctx, &key) <= 0) {
+        EVP_PKEY_CTX_free(ctx);
+        return nullptr;
+    }
+    EVP_PKEY_CTX_free(ctx);
+
+    std::unique_ptr<ServerKeyPair> pair(new ServerKeyPair(key));
+    if (pair->publicKeyDer_.empty()) return nullptr;
+    return pair;
+}
+
+ServerKeyPair::ServerKeyPair(evp_pkey_st* key) : key_(key) {
+    // Java: PublicKey.getEncoded() — X.509 SubjectPublicKeyInfo
+    int length = i2d_PUBKEY(key_, nullptr);
+    if (length <= 0) return;
+    publicKeyDer_.resize(static_cast<size_t>(length));
+    uint8_t* p = publicKeyDer_.data();
+    i2d_PUBKEY(key_, &p);
+}
+
+ServerKeyPair::~ServerKeyPair() {
+    EVP_PKEY_free(key_);
+}
+
+bool ServerKeyPair::decrypt(const uint8_t* data, size_t length, std::vector<uint8_t>& out) const {
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new(key_, nullptr);
+    if (!ctx) return false;
+
+    bool ok = false;
+    size_t outLength = 0;
+    if (EVP_PKEY_decrypt_init(ctx) > 0 &&
+        EVP_PKEY_CTX_set_rsa_padding(ctx, RSA_PKCS1_PADDING) > 0 &&
+        EVP_PKEY_decrypt(ctx, nullptr, &outLength, data, length) > 0) {
+        out.resize(outLength);
+        if (EVP_PKEY_decrypt(ctx, out.data(), &outLength, data, length) > 0) {
+            out.resize(outLength);
+            ok = true;
+        }
+    }
+    EVP_PKEY_CTX_free(ctx);
+    return ok;
+}
+
+// ─── CryptManager ───────────────────────────────────────────────────────────
+
+namespace CryptManager {
+
+bool randomBytes(uint8_t* out, size_t length) {
+    return RAND_bytes(out, static_cast<int>(length)) == 1;
+}
+
+std::string serverIdHash(const std::string& serverId,
+                         const uint8_t* sharedSecret, size_t secretLength,
+                         const std::vector<uint8_t>& publicKeyDer) {
+    // Java: CryptManager.getServerIdHash() — SHA-1 over the ISO-8859-1 server
+    // ID, the shared secret and the encoded public key.
+    uint8_t digest[20];
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(ctx, EVP_sha1(), nullptr);
+    EVP_DigestUpdate(ctx, serverId.data(), serverId.size());
+    EVP_DigestUpdate(ctx, sharedSecret, secretLength);
+    EVP_DigestUpdate(ctx, publicKeyDer.data(), publicKeyDer.size());
+    EVP_DigestFinal_ex(ctx, digest, nullptr);
+    EVP_MD_CTX_free(ctx);
+
+    // Java: new BigInteger(digest).toString(16) — signed, no leading zeros
+    bool negative = (digest[0] & 0x80) != 0;
+    if (negative) {
+        // Two's complement negate: invert, then add one.
+        bool carry = true;
+        for (int i = 19; i >= 0; --i) {
+            digest[i] = static_cast<uint8_t>(~digest[i]);
+            if (carry) carry = (++digest[i] == 0);
+        }
+    }
+
+    static const char HEX[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(41);
+    for (uint8_t byte : digest) {
+        hex.push_back(HEX[byte >> 4]);
+        hex.push_back(HEX[byte & 0x0F]);
+    }
+    size_t firstDigit = hex.find_first_not_of('0');
+    hex = (firstDigit == std::string::npos) ? "0" : hex.substr(firstDigit);
+    return negative ? "-" + hex : hex;
+}
+
+} // namespace CryptManager
+
+} // namespace mccpp
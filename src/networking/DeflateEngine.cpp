@@ -0,0 +1,344 @@
+/**
+ * DeflateEngine.cpp — zlib and in-tree deflate backends.
+ *
+ * Java reference: java.util.zip.Deflater
+ *
+ * The Fast backend writes RFC 1951 directly: one fixed-Huffman block
+ * (BTYPE 01) of greedy LZ77 matches found through a hash chain over the
+ * 32K window, then either the final-block end or a sync flush.
+ */
+
+#include "networking/DeflateEngine.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <zlib.h>
+
+namespace mccpp {
+
+const char* deflateBackendName(DeflateBackend backend) {
+    switch (backend) {
+        case DeflateBackend::Zlib: return "zlib";
+        case DeflateBackend::Fast: return "fast";
+    }
+    return "?";
+}
+
+bool parseDeflateBackend(const std::string& name, DeflateBackend& out) {
+    if (name == "zlib") { out = DeflateBackend::Zlib; return true; }
+    if (name == "fast") { out = DeflateBackend::Fast; return true; }
+    return false;
+}
+
+namespace {
+
+// Empty stored block of a sync flush, plus the bits before it
+constexpr size_t SYNC_FLUSH_BYTES = 6;
+
+// ═══════════════════════════════════════════════════════════════════════════
+// ZlibDeflateEngine — zlib with one long-lived raw deflate stream.
+// ═══════════════════════════════════════════════════════════════════════════
+
+class ZlibDeflateEngine final : public DeflateEngine {
+public:
+    ZlibDeflateEngine() {
+        deflateInit2(&strm_, level_, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    }
+
+    ~ZlibDeflateEngine() override {
+        deflateEnd(&strm_);
+    }
+
+    DeflateBackend getBackend() const override { return DeflateBackend::Zlib; }
+
+    size_t bound(size_t rawLen) override {
+        return deflateBound(&strm_, static_cast<uLong>(rawLen)) + SYNC_FLUSH_BYTES;
+    }
+
+    size_t compress(const uint8_t* raw, size_t rawLen, uint8_t* out,
+                    int level, bool finish) override {
+        level = std::clamp(level, MIN_LEVEL, MAX_LEVEL);
+        size_t capacity = bound(rawLen);
+        deflateReset(&strm_);
+        if (level != level_) {
+            // Nothing buffered after a reset, so this only swaps the parameters
+            deflateParams(&strm_, level, Z_DEFAULT_STRATEGY);
+            level_ = level;
+        }
+        strm_.next_in = const_cast<Bytef*>(raw);
+        strm_.avail_in = static_cast<uInt>(rawLen);
+        strm_.next_out = out;
+        strm_.avail_out = static_cast<uInt>(capacity);
+        deflate(&strm_, finish ? Z_FINISH : Z_SYNC_FLUSH);
+        return capacity - strm_.avail_out;
+    }
+
+private:
+    z_stream strm_ = {};
+    int      level_ = DEFAULT_LEVEL;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+// Fixed Huffman codes (RFC 1951 §3.2.6), bit-reversed for LSB-first output
+// ═══════════════════════════════════════════════════════════════════════════
+
+struct FixedHuffman {
+    // Literal/length symbols 0-287
+    uint16_t litCode[288];
+    uint8_t  litBits[288];
+
+    // Match length 3-258: length symbol and extra bits, pre-joined
+    uint32_t lenCode[259];
+    uint8_t  lenBits[259];
+
+    // Distance 1-32768: distance symbol (5 bits) and extra bits, pre-joined
+    uint32_t distCode[32769];
+    uint8_t  distBits[32769];
+
+    FixedHuffman() {
+        for (int v = 0; v < 288; ++v) {
+            int code, bits;
+            if (v < 144)      { code = 0x30 + v;          bits = 8; }
+            else if (v < 256) { code = 0x190 + (v - 144); bits = 9; }
+            else if (v < 280) { code = v - 256;           bits = 7; }
+            else              { code = 0xC0 + (v - 280);  bits = 8; }
+            litCode[v] = static_cast<uint16_t>(reverse(code, bits));
+            litBits[v] = static_cast<uint8_t>(bits);
+        }
+
+        static constexpr int LEN_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                             35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static constexpr int LEN_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                              3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        // Symbol 285 last: 258 must not be coded as 284 + 31
+        for (int c = 0; c < 29; ++c) {
+            for (int e = 0; e < (1 << LEN_EXTRA[c]); ++e) {
+                int len = LEN_BASE[c] + e;
+                if (len > 258) break;
+                int sym = 257 + c;
+                lenCode[len] = litCode[sym] | (static_cast<uint32_t>(e) << litBits[sym]);
+                lenBits[len] = static_cast<uint8_t>(litBits[sym] + LEN_EXTRA[c]);
+            }
+        }
+
+        static constexpr int DIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                              257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                              8193, 12289, 16385, 24577};
+        static constexpr int DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                               7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        for (int c = 0; c < 30; ++c) {
+            uint32_t sym = reverse(c, 5);
+            for (int e = 0; e < (1 << DIST_EXTRA[c]); ++e) {
+                int dist = DIST_BASE[c] + e;
+                distCode[dist] = sym | (static_cast<uint32_t>(e) << 5);
+                distBits[dist] = static_cast<uint8_t>(5 + DIST_EXTRA[c]);
+            }
+        }
+    }
+
+    static uint32_t reverse(int code, int bits) {
+        uint32_t r = 0;
+        for (int i = 0; i < bits; ++i) r |= ((code >> i) & 1u) << (bits - 1 - i);
+        return r;
+    }
+
+    static const FixedHuffman& get() {
+        static const FixedHuffman table;
+        return table;
+    }
+};
+
+// LSB-first bit output; at most 31 bits per put()
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t* out) : out_(out), start_(out) {}
+
+    void put(uint32_t bits, unsigned count) {
+        buf_ |= static_cast<uint64_t>(bits) << count_;
+        count_ += count;
+        if (count_ >= 32) {
+            for (int i = 0; i < 4; ++i) *out_++ = static_cast<uint8_t>(buf_ >> (8 * i));
+            buf_ >>= 32;
+            count_ -= 32;
+        }
+    }
+
+    // Pad to a byte boundary and write out everything pending
+    void alignAndFlush() {
+        while (count_ > 0) {
+            *out_++ = static_cast<uint8_t>(buf_);
+            buf_ >>= 8;
+            count_ = count_ > 8 ? count_ - 8 : 0;
+        }
+    }
+
+    void putAlignedBytes(const uint8_t* bytes, size_t n) {
+        std::memcpy(out_, bytes, n);
+        out_ += n;
+    }
+
+    size_t size() const { return static_cast<size_t>(out_ - start_); }
+
+private:
+    uint8_t* out_;
+    uint8_t* start_;
+    uint64_t buf_ = 0;
+    unsigned count_ = 0;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+// FastDeflateEngine — greedy LZ77 + fixed Huffman.
+// ═══════════════════════════════════════════════════════════════════════════
+
+class FastDeflateEngine final : public DeflateEngine {
+public:
+    FastDeflateEngine() : head_(HASH_SIZE, 0), prev_(WINDOW, 0) {}
+
+    DeflateBackend getBackend() const override { return DeflateBackend::Fast; }
+
+    size_t bound(size_t rawLen) override {
+        // 9 bits per literal at worst, block header, end of block, flush
+        return rawLen + rawLen / 8 + 8 + SYNC_FLUSH_BYTES;
+    }
+
+    size_t compress(const uint8_t* raw, size_t rawLen, uint8_t* out,
+                    int level, bool finish) override {
+        const FixedHuffman& fh = FixedHuffman::get();
+        const LevelParams params = LEVELS[std::clamp(level, MIN_LEVEL, MAX_LEVEL) - 1];
+
+        // Positions are stored as base_ + offset so that entries left over
+        // from earlier calls read as out of range without clearing the tables
+        if (base_ > UINT32_MAX - rawLen - WINDOW - 1) {
+            std::fill(head_.begin(), head_.end(), 0);
+            std::fill(prev_.begin(), prev_.end(), 0);
+            base_ = 1;
+        }
+        const uint32_t base = base_;
+        base_ += static_cast<uint32_t>(rawLen) + WINDOW + 1;
+
+        BitWriter bw(out);
+        bw.put(finish ? 1 : 0, 1);   // BFINAL
+        bw.put(1, 2);                // BTYPE 01: fixed Huffman
+
+        size_t i = 0;
+        while (i + MIN_MATCH <= rawLen) {
+            uint32_t pos = base + static_cast<uint32_t>(i);
+            uint32_t h = hash(raw + i);
+            uint32_t cand = head_[h];
+            head_[h] = pos;
+            prev_[pos & WINDOW_MASK] = cand;
+
+            size_t maxLen = std::min<size_t>(MAX_MATCH, rawLen - i);
+            size_t bestLen = 0;
+            uint32_t bestDist = 0;
+            for (int chain = params.chain; chain > 0 && cand >= base && pos - cand <= WINDOW; --chain) {
+                const uint8_t* c = raw + (cand - base);
+                if (load32(c) == load32(raw + i)) {
+                    size_t len = matchLength(c, raw + i, maxLen);
+                    if (len > bestLen) {
+                        bestLen = len;
+                        bestDist = pos - cand;
+                        if (len >= params.niceLength) break;
+                    }
+                }
+                uint32_t next = prev_[cand & WINDOW_MASK];
+                if (next >= cand) break;   // slot reused by a newer position
+                cand = next;
+            }
+
+            if (bestLen >= MIN_MATCH) {
+                bw.put(fh.lenCode[bestLen], fh.lenBits[bestLen]);
+                bw.put(fh.distCode[bestDist], fh.distBits[bestDist]);
+                // Index the positions inside the match (all of them only at
+                // the higher levels; long runs are cheap to skip)
+                size_t insertEnd = std::min(i + (params.insertAll ? bestLen : std::min<size_t>(bestLen, 4)),
+                                            rawLen - MIN_MATCH + 1);
+                for (size_t k = i + 1; k < insertEnd; ++k) {
+                    uint32_t p = base + static_cast<uint32_t>(k);
+                    uint32_t hk = hash(raw + k);
+                    prev_[p & WINDOW_MASK] = head_[hk];
+                    head_[hk] = p;
+                }
+                i += bestLen;
+            } else {
+                bw.put(fh.litCode[raw[i]], fh.litBits[raw[i]]);
+                ++i;
+            }
+        }
+        for (; i < rawLen; ++i) bw.put(fh.litCode[raw[i]], fh.litBits[raw[i]]);
+        bw.put(fh.litCode[256], fh.litBits[256]);   // end of block
+
+        if (!finish) {
+            // Sync flush: empty non-final stored block, byte-aligned
+            static constexpr uint8_t EMPTY_STORED[4] = {0x00, 0x00, 0xFF, 0xFF};
+            bw.put(0, 3);
+            bw.alignAndFlush();
+            bw.putAlignedBytes(EMPTY_STORED, sizeof(EMPTY_STORED));
+        } else {
+            bw.alignAndFlush();
+        }
+        return bw.size();
+    }
+
+private:
+    static constexpr uint32_t WINDOW = 32768;
+    static constexpr uint32_t WINDOW_MASK = WINDOW - 1;
+    static constexpr int      HASH_BITS = 15;
+    static constexpr size_t   HASH_SIZE = size_t{1} << HASH_BITS;
+    static constexpr size_t   MIN_MATCH = 4;   // deflate allows 3; 4 hashes in one load
+    static constexpr size_t   MAX_MATCH = 258;
+
+    struct LevelParams {
+        int    chain;        // candidates tried per position
+        size_t niceLength;   // stop searching at a match this long
+        bool   insertAll;    // index every position inside matches
+    };
+    static constexpr LevelParams LEVELS[MAX_LEVEL] = {
+        {1, 32, false}, {2, 32, false}, {4, 64, false},
+        {8, 64, true},  {16, 128, true}, {32, 258, true},
+        {64, 258, true}, {128, 258, true}, {256, 258, true},
+    };
+
+    static uint32_t load32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint32_t hash(const uint8_t* p) {
+        return (load32(p) * 0x9E3779B1u) >> (32 - HASH_BITS);
+    }
+
+    static size_t matchLength(const uint8_t* a, const uint8_t* b, size_t maxLen) {
+        size_t len = 0;
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        while (len + 8 <= maxLen) {
+            uint64_t x, y;
+            std::memcpy(&x, a + len, 8);
+            std::memcpy(&y, b + len, 8);
+            if (uint64_t diff = x ^ y) return len + static_cast<size_t>(__builtin_ctzll(diff) >> 3);
+            len += 8;
+        }
+#endif
+        while (len < maxLen && a[len] == b[len]) ++len;
+        return len;
+    }
+
+    std::vector<uint32_t> head_;   // hash → newest position
+    std::vector<uint32_t> prev_;   // position → previous one with the same hash
+    uint32_t              base_ = 1;
+};
+
+} // namespace
+
+DeflateEngine& DeflateEngine::forThread(DeflateBackend backend) {
+    if (backend == DeflateBackend::Fast) {
+        thread_local FastDeflateEngine fast;
+        return fast;
+    }
+    thread_local ZlibDeflateEngine zlib;
+    return zlib;
+}
+
+} // namespace mccpp
@@ -0,0 +1,288 @@
+/**
+ * NetworkReactor.cpp — epoll event loop implementation.
+ *
+ * Reference: net.minecraft.network.NetworkSystem (Netty NioEventLoopGroup)
+ * Edge-triggered epoll: every readiness notification is drained until the
+ * socket reports EAGAIN, so a notification is never lost.
+ */
+
+#include "networking/NetworkReactor.h"
+#include "networking/Connection.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace mccpp {
+
+namespace {
+constexpr int MAX_EVENTS = 256;
+} // anonymous namespace
+
+// ─── EventLoop ──────────────────────────────────────────────────────────────
+
+EventLoop::EventLoop(int index) : index_(index) {}
+
+EventLoop::~EventLoop() {
+    stop();
+}
+
+bool EventLoop::start() {
+    epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) {
+        std::cerr << "[Network] epoll_create1 failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        std::cerr << "[Network] eventfd failed: " << std::strerror(errno) << "\n";
+        ::close(epollFd_);
+        epollFd_ = -1;
+        return false;
+    }
+
+    // The wakeup fd is level-triggered: it is drained explicitly on every wake.
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&EventLoop::run, this);
+    return true;
+}
+
+void EventLoop::stop() {
+    if (!running_.exchange(false)) return;
+
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd_, &one, sizeof(one));
+    (void)ignored;
+
+    if (thread_.joinable()) thread_.join();
+
+    ::close(wakeFd_);
+    ::close(epollFd_);
+    wakeFd_ = -1;
+    epollFd_ = -1;
+}
+
+void EventLoop::attach(std::shared_ptr<Connection> conn) {
+    // Counted immediately so a burst of accepts is spread across loops.
+    connectionCount_.fetch_add(1, std::memory_order_relaxed);
+    post(TaskType::Attach, std::move(conn));
+}
+
+void EventLoop::scheduleFlush(std::shared_ptr<Connection> conn) {
+    post(TaskType::Flush, std::move(conn));
+}
+
+void EventLoop::scheduleClose(std::shared_ptr<Connection> conn) {
+    post(TaskType::Close, std::move(conn));
+}
+
+void EventLoop::post(TaskType type, std::shared_ptr<Connection> conn) {
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex_);
+        tasks_.push_back({type, std::move(conn)});
+    }
+    // Only the first poster after a drain pays for the eventfd write.
+    if (!wakePending_.exchange(true, std::memory_order_acq_rel)) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void EventLoop::run() {
+    threadId_.store(std::this_thread::get_id());
+    epoll_event events[MAX_EVENTS];
+
+    while (running_.load(std::memory_order_acquire)) {
+        int n = ::epoll_wait(epollFd_, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[Network] epoll_wait failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            auto* conn = static_cast<Connection*>(events[i].data.ptr);
+            if (!conn) {
+                uint64_t counter;
+                ssize_t ignored = ::read(wakeFd_, &counter, sizeof(counter));
+                (void)ignored;
+                continue;
+            }
+
+            uint32_t mask = events[i].events;
+            if (mask & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                conn->onReadable();
+            }
+            if ((mask & EPOLLOUT) && conn->isConnected()) {
+                flushes_.fetch_add(1, std::memory_order_relaxed);
+                conn->onWritable();
+            }
+            if (!conn->isConnected()) {
+                closing_.push_back(conn);
+            }
+        }
+
+        runPendingTasks();
+
+        // Deferred so that no later event in this batch sees a freed Connection.
+        for (Connection* conn : closing_) {
+            closeConnection(conn);
+        }
+        closing_.clear();
+    }
+
+    // Shutdown: close everything still registered
+    runPendingTasks();
+    for (auto& [ptr, conn] : connections_) {
+        conn->flushOutbound();
+        conn->closeSocket();
+    }
+    connections_.clear();
+    connectionCount_.store(0, std::memory_order_relaxed);
+}
+
+void EventLoop::runPendingTasks() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex_);
+        tasks.swap(tasks_);
+        wakePending_.store(false, std::memory_order_release);
+    }
+
+    for (auto& task : tasks) {
+        switch (task.type) {
+            case TaskType::Attach:
+                registerConnection(task.conn);
+                break;
+            case TaskType::Flush:
+                if (connections_.count(task.conn.get())) {
+                    flushes_.fetch_add(1, std::memory_order_relaxed);
+                    task.conn->flushOutbound();
+                    if (!task.conn->isConnected()) closing_.push_back(task.conn.get());
+                }
+                break;
+            case TaskType::Close:
+                if (connections_.count(task.conn.get())) {
+                    closing_.push_back(task.conn.get());
+                }
+                break;
+        }
+    }
+}
+
+void EventLoop::registerConnection(const std::shared_ptr<Connection>& conn) {
+    if (!conn->isConnected()) {
+        conn->closeSocket();
+        connectionCount_.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = conn.get();
+    if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, conn->socketFd_, &ev) < 0) {
+        std::cerr << "[Network] epoll_ctl(ADD) failed: " << std::strerror(errno) << "\n";
+        conn->disconnect("Failed to register socket");
+        conn->closeSocket();
+        connectionCount_.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+
+    connections_.emplace(conn.get(), conn);
+
+    // Data may have arrived (and packets may have been queued) before registration.
+    conn->onReadable();
+    if (conn->isConnected()) conn->flushOutbound();
+    if (!conn->isConnected()) closing_.push_back(conn.get());
+}
+
+void EventLoop::closeConnection(Connection* conn) {
+    auto it = connections_.find(conn);
+    if (it == connections_.end()) return;
+
+    // Best effort: push out anything queued before the close (e.g. a kick reason)
+    conn->flushOutbound();
+    ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn->socketFd_, nullptr);
+    conn->closeSocket();
+
+    connections_.erase(it);
+    connectionCount_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+NetworkWriteStats EventLoop::getWriteStats() const {
+    NetworkWriteStats stats;
+    stats.syscalls = writeSyscalls_.load(std::memory_order_relaxed);
+    stats.bytes    = bytesWritten_.load(std::memory_order_relaxed);
+    stats.frames   = framesWritten_.load(std::memory_order_relaxed);
+    stats.flushes  = flushes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// ─── NetworkReactor ─────────────────────────────────────────────────────────
+
+int NetworkReactor::defaultThreadCount() {
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    return std::clamp(hw / 4, 1, 4);
+}
+
+NetworkReactor::NetworkReactor(int threadCount) {
+    threadCount = std::max(1, threadCount);
+    loops_.reserve(static_cast<size_t>(threadCount));
+    for (int i = 0; i < threadCount; ++i) {
+        loops_.push_back(std::make_unique<EventLoop>(i));
+    }
+}
+
+NetworkReactor::~NetworkReactor() {
+    stop();
+}
+
+bool NetworkReactor::start() {
+    for (auto& loop : loops_) {
+        if (!loop->start()) {
+            stop();
+            return false;
+        }
+    }
+    std::cout << "[Network] Started " << loops_.size() << " network I/O thread(s)\n";
+    return true;
+}
+
+void NetworkReactor::stop() {
+    for (auto& loop : loops_) {
+        loop->stop();
+    }
+}
+
+EventLoop& NetworkReactor::nextLoop() {
+    auto it = std::min_element(loops_.begin(), loops_.end(),
+        [](const auto& a, const auto& b) {
+            return a->connectionCount() < b->connectionCount();
+        });
+    return **it;
+}
+
+NetworkWriteStats NetworkReactor::getWriteStats() const {
+    NetworkWriteStats total;
+    for (const auto& loop : loops_) {
+        auto stats = loop->getWriteStats();
+        total.syscalls += stats.syscalls;
+        total.bytes    += stats.bytes;
+        total.frames   += stats.frames;
+        total.flushes  += stats.flushes;
+    }
+    return total;
+}
+
+} // namespace mccpp
@@ -0,0 +1,126 @@
+/**
+ * PacketBuffer.cpp — Per-thread packet block pool.
+ *
+ * Java reference: io.netty.buffer.PooledByteBufAllocator (thread-local caches
+ * in front of shared arenas), which backs every vanilla packet ByteBuf.
+ */
+
+#include "networking/PacketBuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace mccpp {
+
+namespace {
+
+using Block = std::unique_ptr<uint8_t[]>;
+
+// Free blocks kept per thread and in the shared depot, per size class.
+// Small packets dominate; 1 MiB blocks only back chunk bulk packets.
+constexpr size_t LOCAL_LIMIT[PacketBufferPool::SIZE_CLASSES] = { 512, 128, 16, 2 };
+constexpr size_t DEPOT_LIMIT[PacketBufferPool::SIZE_CLASSES] = { 4096, 1024, 64, 8 };
+
+std::atomic<uint64_t> statAcquired{0};
+std::atomic<uint64_t> statReused{0};
+std::atomic<uint64_t> statReleased{0};
+std::atomic<uint64_t> statDiscarded{0};
+
+struct Depot {
+    std::mutex mutex;
+    std::vector<Block> blocks;
+};
+
+Depot& depot(size_t sizeClass) {
+    static Depot depots[PacketBufferPool::SIZE_CLASSES];
+    return depots[sizeClass];
+}
+
+struct LocalCache {
+    std::vector<Block> blocks[PacketBufferPool::SIZE_CLASSES];
+};
+
+LocalCache& localCache() {
+    thread_local LocalCache cache;
+    return cache;
+}
+
+// Smallest class that holds `capacity` bytes, or SIZE_CLASSES if none does.
+size_t classFor(size_t capacity) {
+    size_t c = 0;
+    while (c < PacketBufferPool::SIZE_CLASSES && PacketBufferPool::CLASS_SIZES[c] < capacity) ++c;
+    return c;
+}
+
+} // anonymous namespace
+
+std::unique_ptr<uint8_t[]> PacketBufferPool::acquire(size_t minCapacity, size_t& capacity) {
+    statAcquired.fetch_add(1, std::memory_order_relaxed);
+
+    size_t c = classFor(minCapacity);
+    if (c == SIZE_CLASSES) {
+        capacity = minCapacity;
+        return Block(new uint8_t[minCapacity]);
+    }
+    capacity = CLASS_SIZES[c];
+
+    auto& local = localCache().blocks[c];
+    if (local.empty()) {
+        // Refill half a local list from the depot in one lock.
+        Depot& d = depot(c);
+        std::lock_guard<std::mutex> lock(d.mutex);
+        size_t take = std::min(d.blocks.size(), LOCAL_LIMIT[c] / 2);
+        for (size_t i = 0; i < take; ++i) {
+            local.push_back(std::move(d.blocks.back()));
+            d.blocks.pop_back();
+        }
+    }
+    if (local.empty()) {
+        return Block(new uint8_t[capacity]);
+    }
+
+    statReused.fetch_add(1, std::memory_order_relaxed);
+    Block block = std::move(local.back());
+    local.pop_back();
+    return block;
+}
+
+void PacketBufferPool::release(std::unique_ptr<uint8_t[]> block, size_t capacity) {
+    size_t c = classFor(capacity);
+    if (c == SIZE_CLASSES || CLASS_SIZES[c] != capacity) {
+        statDiscarded.fetch_add(1, std::memory_order_relaxed);
+        return;   // unpooled size: `block` is freed here
+    }
+
+    auto& local = localCache().blocks[c];
+    if (local.size() >= LOCAL_LIMIT[c]) {
+        // Hand half to the depot so the producing thread can pick it up.
+        Depot& d = depot(c);
+        std::lock_guard<std::mutex> lock(d.mutex);
+        size_t give = local.size() / 2;
+        for (size_t i = 0; i < give && d.blocks.size() < DEPOT_LIMIT[c]; ++i) {
+            d.blocks.push_back(std::move(local.back()));
+            local.pop_back();
+        }
+    }
+    if (local.size() >= LOCAL_LIMIT[c]) {
+        statDiscarded.fetch_add(1, std::memory_order_relaxed);
+        return;   // depot full as well
+    }
+
+    statReleased.fetch_add(1, std::memory_order_relaxed);
+    local.push_back(std::move(block));
+}
+
+PacketPoolStats PacketBufferPool::getStats() {
+    PacketPoolStats stats;
+    stats.acquired  = statAcquired.load(std::memory_order_relaxed);
+    stats.reused    = statReused.load(std::memory_order_relaxed);
+    stats.released  = statReleased.load(std::memory_order_relaxed);
+    stats.discarded = statDiscarded.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace mccpp
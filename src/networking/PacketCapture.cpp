@@ -0,0 +1,157 @@
+/**
+ * PacketCapture.cpp — Inbound traffic capture file writer and reader.
+ */
+
+#include "networking/PacketCapture.h"
+#include "types/VarInt.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace mccpp {
+
+std::unique_ptr<PacketCapture> PacketCapture::create(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return nullptr;
+    return std::unique_ptr<PacketCapture>(new PacketCapture(file));
+}
+
+PacketCapture::PacketCapture(std::FILE* file)
+    : file_(file), start_(std::chrono::steady_clock::now()) {
+    staging_.reserve(STAGING_FLUSH_BYTES + 4096);
+    staging_.insert(staging_.end(), MAGIC, MAGIC + 8);
+    bytes_ = 8;
+}
+
+PacketCapture::~PacketCapture() {
+    flush();
+    std::fclose(file_);
+}
+
+void PacketCapture::beginRecord(CaptureRecordType type, uint32_t session) {
+    int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+    // Taken under the lock, so records are in time order and deltas are >= 0
+    int64_t delta = std::max<int64_t>(0, now - lastMicros_);
+    lastMicros_ += delta;
+
+    staging_.push_back(static_cast<uint8_t>(type));
+    writeVarInt(staging_, static_cast<int32_t>(session));
+    writeVarLong(staging_, delta);
+}
+
+uint32_t PacketCapture::openSession(const std::string& remoteAddress) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t session = nextSession_++;
+    size_t before = staging_.size();
+    beginRecord(CaptureRecordType::Open, session);
+    writeString(staging_, remoteAddress);
+    bytes_ += staging_.size() - before;
+    return session;
+}
+
+void PacketCapture::recordFrame(uint32_t session, const uint8_t* frame, size_t length) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t before = staging_.size();
+    beginRecord(CaptureRecordType::Frame, session);
+    writeVarInt(staging_, static_cast<int32_t>(length));
+    staging_.insert(staging_.end(), frame, frame + length);
+    bytes_ += staging_.size() - before;
+    ++frames_;
+    if (staging_.size() >= STAGING_FLUSH_BYTES) writeStaged();
+}
+
+void PacketCapture::closeSession(uint32_t session) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t before = staging_.size();
+    beginRecord(CaptureRecordType::Close, session);
+    bytes_ += staging_.size() - before;
+}
+
+void PacketCapture::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    writeStaged();
+    std::fflush(file_);
+}
+
+void PacketCapture::writeStaged() {
+    if (staging_.empty()) return;
+    std::fwrite(staging_.data(), 1, staging_.size(), file_);
+    staging_.clear();
+}
+
+uint64_t PacketCapture::getRecordedFrames() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frames_;
+}
+
+uint64_t PacketCapture::getRecordedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+// ─── Reader ─────────────────────────────────────────────────────────────────
+
+bool PacketCapture::load(const std::string& path, std::vector<CaptureRecord>& records, std::string& error) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    std::fclose(file);
+
+    if (data.size() < 8 || std::memcmp(data.data(), MAGIC, 8) != 0) {
+        error = path + " is not a packet capture";
+        return false;
+    }
+
+    size_t pos = 8;
+    int64_t micros = 0;
+    try {
+        while (pos < data.size()) {
+            CaptureRecord record;
+            uint8_t type = data[pos++];
+            if (type > static_cast<uint8_t>(CaptureRecordType::Close)) {
+                throw std::runtime_error("unknown record type " + std::to_string(type));
+            }
+            record.type = static_cast<CaptureRecordType>(type);
+
+            auto session = readVarInt(data.data() + pos, data.size() - pos);
+            pos += static_cast<size_t>(session.bytesRead);
+            auto delta = readVarLong(data.data() + pos, data.size() - pos);
+            pos += static_cast<size_t>(delta.bytesRead);
+            micros += delta.value;
+            record.session = static_cast<uint32_t>(session.value);
+            record.micros = micros;
+
+            if (record.type == CaptureRecordType::Open) {
+                auto address = readString(data.data() + pos, data.size() - pos);
+                pos += static_cast<size_t>(address.bytesRead);
+                record.address = std::move(address.value);
+            } else if (record.type == CaptureRecordType::Frame) {
+                auto length = readVarInt(data.data() + pos, data.size() - pos);
+                pos += static_cast<size_t>(length.bytesRead);
+                if (length.value <= 0 || static_cast<size_t>(length.value) > data.size() - pos) {
+                    throw std::runtime_error("truncated frame");
+                }
+                record.frame.assign(data.data() + pos, data.data() + pos + length.value);
+                pos += static_cast<size_t>(length.value);
+            }
+            records.push_back(std::move(record));
+        }
+    } catch (const std::exception& e) {
+        error = path + ": " + e.what() + " at offset " + std::to_string(pos);
+        return false;
+    }
+    return true;
+}
+
+} // namespace mccpp
@@ -8,10 +8,18 @@
  */
 
 #include "networking/PacketHandler.h"
+#include "entity/Entity.h"
 #include "networking/Connection.h"
+#include "networking/CryptManager.h"
+#include "networking/PacketBuilder.h"
+#include "networking/PacketReader.h"
 #include "networking/PlayPackets.h"
+#include "networking/SessionAuthenticator.h"
+#include "server/ChunkSendPipeline.h"
 #include "server/MinecraftServer.h"
+#include "types/Chat.h"
 #include "types/VarInt.h"
+#include "world/World.h"
 
 #include <array>
 #include <cstring>
@@ -212,20 +220,18 @@ void HandshakeHandler::handlePacket(int32_t packetId,
         if (protocolVersion > MinecraftServer::PROTOCOL_VERSION) {
             // "Outdated server! I'm still on 1.7.10"
             std::string msg = R"({"text":"Outdated server! I'm still on 1.7.10"})";
-            std::vector<uint8_t> pkt;
-            writeVarInt(pkt, LoginPacket::Disconnect); // S00PacketDisconnect
-            writeString(pkt, msg);
-            conn.sendPacket(std::move(pkt));
+            PacketWriter w(LoginPacket::Disconnect); // S00PacketDisconnect
+            w.writeString(msg);
+            conn.sendPacket(w.finish());
             conn.disconnect("Outdated server");
             return;
         }
         if (protocolVersion < MinecraftServer::PROTOCOL_VERSION) {
             // "Outdated client! Please use 1.7.10"
             std::string msg = R"({"text":"Outdated client! Please use 1.7.10"})";
-            std::vector<uint8_t> pkt;
-            writeVarInt(pkt, LoginPacket::Disconnect);
-            writeString(pkt, msg);
-            conn.sendPacket(std::move(pkt));
+            PacketWriter w(LoginPacket::Disconnect);
+            w.writeString(msg);
+            conn.sendPacket(w.finish());
             conn.disconnect("Outdated client");
             return;
         }
@@ -261,18 +267,9 @@ void StatusHandler::handlePacket(int32_t packetId,
                                   Connection& conn) {
     if (packetId == StatusPacket::Request) {
         // Java reference: NetHandlerStatusServer.processServerQuery()
-        // Responds with S00PacketServerInfo containing server status JSON
-        std::string json = R"({"version":{"name":")" +
-            std::string(MinecraftServer::GAME_VERSION) +
-            R"(","protocol":)" + std::to_string(MinecraftServer::PROTOCOL_VERSION) +
-            R"(},"players":{"max":)" + std::to_string(server_.getMaxPlayers()) +
-            R"(,"online":)" + std::to_string(server_.getOnlinePlayerCount()) +
-            R"(},"description":{"text":")" + server_.getMotd() + R"("}})";
-
-        std::vector<uint8_t> response;
-        writeVarInt(response, StatusPacket::Response);
-        writeString(response, json);
-        conn.sendPacket(std::move(response));
+        // Responds with S00PacketServerInfo containing server status JSON.
+        // The frame is cached by the server and refreshed on the tick thread.
+        conn.sendPacket(server_.getStatusResponse());
 
     } else if (packetId == StatusPacket::Ping) {
         // Java reference: NetHandlerStatusServer.processPing()
@@ -282,10 +279,9 @@ void StatusHandler::handlePacket(int32_t packetId,
             return;
         }
 
-        std::vector<uint8_t> pong;
-        writeVarInt(pong, StatusPacket::Pong);
-        pong.insert(pong.end(), data, data + 8);
-        conn.sendPacket(std::move(pong));
+        PacketWriter w(StatusPacket::Pong);
+        w.writeBytes(data, 8);
+        conn.sendPacket(w.finish());
 
     } else {
         conn.disconnect("Unexpected packet in Status state");
@@ -307,7 +303,7 @@ void LoginHandler::handlePacket(int32_t packetId,
                                  const uint8_t* data,
                                  size_t length,
                                  Connection& conn) {
-    if (packetId == LoginPacket::LoginStart) {
+    if (packetId == LoginPacket::LoginStart && state_ == LoginState::Hello) {
         // Java reference: NetHandlerLoginServer.processLoginStart()
         auto nameResult = readString(data, length);
         playerName_ = nameResult.value;
@@ -318,141 +314,180 @@ void LoginHandler::handlePacket(int32_t packetId,
         // Java reference: if (server.isServerInOnlineMode() && !networkManager.isLocalChannel())
         //   → send S01PacketEncryptionRequest, state = KEY
         // else → state = READY_TO_ACCEPT
-        // Currently: offline mode only (no encryption)
+        if (server_.isOnlineMode()) {
+            sendEncryptionRequest(conn);
+            return;
+        }
 
         // Generate offline UUID
         // Java reference: NetHandlerLoginServer.getOfflineProfile()
         // UUID.nameUUIDFromBytes(("OfflinePlayer:" + name).getBytes(UTF_8))
         std::string uuid = generateOfflineUUID(playerName_);
-
-        // Send S02PacketLoginSuccess
-        // Java reference: NetHandlerLoginServer.func_147326_c()
-        std::vector<uint8_t> success;
-        writeVarInt(success, LoginPacket::LoginSuccess);
-        writeString(success, uuid);
-        writeString(success, playerName_);
-        conn.sendPacket(std::move(success));
-
-        conn.setState(ConnectionState::Play);
         std::cout << "[Login] Player '" << playerName_ << "' logged in (offline mode)"
                   << " UUID=" << uuid << "\n";
+        acceptPlayer(conn, uuid, playerName_);
 
-        // Transition to PlayHandler
-        // Java: server.getConfigurationManager().initializeConnectionToPlayer(networkManager, player)
-        auto playHandler = std::make_shared<PlayHandler>(server_, playerName_, uuid, conn);
-        conn.setHandler(playHandler);
-
-        // Send initial login sequence (Join Game, Spawn Position, Abilities, Position)
-        playHandler->sendLoginSequence(conn);
-
-    } else if (packetId == LoginPacket::EncryptionResponse) {
-        // Java reference: NetHandlerLoginServer.processEncryptionResponse()
-        // TODO: Implement when OpenSSL encryption is added
-        std::cout << "[Login] Encryption response received (not yet implemented)\n";
-        conn.disconnect("Encryption not yet supported");
+    } else if (packetId == LoginPacket::EncryptionResponse && state_ == LoginState::Key) {
+        handleEncryptionResponse(data, length, conn);
 
     } else {
         conn.disconnect("Unexpected packet in Login state");
     }
 }
 
-void LoginHandler::onDisconnect(const std::string& reason) {
-    // Java reference: NetHandlerLoginServer.onDisconnect()
-    if (!playerName_.empty()) {
-        std::cout << "[Login] " << playerName_ << " lost connection: " << reason << "\n";
+void LoginHandler::sendEncryptionRequest(Connection& conn) {
+    // Java reference: S01PacketEncryptionRequest(serverId = "", publicKey, verifyToken)
+    // 1.7.10 wire format: String serverId, Short keyLength, Bytes key,
+    //                     Short tokenLength, Bytes token
+    const ServerKeyPair* keyPair = server_.getKeyPair();
+    if (!keyPair || !CryptManager::randomBytes(verifyToken_, sizeof(verifyToken_))) {
+        kick(conn, "Internal server error");
+        return;
     }
-}
-
-std::string LoginHandler::generateOfflineUUID(const std::string& playerName) {
-    // Java reference: NetHandlerLoginServer.getOfflineProfile()
-    // UUID = UUID.nameUUIDFromBytes(("OfflinePlayer:" + name).getBytes(Charsets.UTF_8))
-    return nameUUIDFromBytes("OfflinePlayer:" + playerName);
-}
+    const auto& publicKey = keyPair->getPublicKeyDer();
+
+    PacketWriter w(LoginPacket::EncryptionRequest, publicKey.size() + 16);
+    w.writeString(SERVER_ID);
+    w.writeShort(static_cast<int16_t>(publicKey.size()));
+    w.writeBytes(publicKey);
+    w.writeShort(static_cast<int16_t>(sizeof(verifyToken_)));
+    w.writeBytes(verifyToken_, sizeof(verifyToken_));
+    conn.sendPacket(w.finish());
+
+    state_ = LoginState::Key;
+}
+
+void LoginHandler::handleEncryptionResponse(const uint8_t* data, size_t length, Connection& conn) {
+    // Java reference: NetHandlerLoginServer.processEncryptionResponse()
+    // C01PacketEncryptionResponse: Short secretLength, Bytes secret,
+    //                              Short tokenLength, Bytes token (both RSA-encrypted)
+    auto readBlob = [&](size_t& offset, const uint8_t*& blob, size_t& blobLength) {
+        if (offset + 2 > length) return false;
+        blobLength = (static_cast<size_t>(data[offset]) << 8) | data[offset + 1];
+        offset += 2;
+        if (offset + blobLength > length) return false;
+        blob = data + offset;
+        offset += blobLength;
+        return true;
+    };
 
-// ─── PlayHandler ────────────────────────────────────────────────────────────
-// Java reference: net.minecraft.network.play.server.NetHandlerPlayServer
-// Handles all Play-state packets after login success.
-
-namespace {
-
-// Big-endian write helpers for protocol data types
-inline void writeInt(std::vector<uint8_t>& out, int32_t v) {
-    out.push_back(static_cast<uint8_t>((v >> 24) & 0xFF));
-    out.push_back(static_cast<uint8_t>((v >> 16) & 0xFF));
-    out.push_back(static_cast<uint8_t>((v >>  8) & 0xFF));
-    out.push_back(static_cast<uint8_t>( v        & 0xFF));
-}
+    size_t offset = 0;
+    const uint8_t* secretBlob = nullptr;
+    const uint8_t* tokenBlob = nullptr;
+    size_t secretLength = 0, tokenLength = 0;
+    if (!readBlob(offset, secretBlob, secretLength) || !readBlob(offset, tokenBlob, tokenLength)) {
+        conn.disconnect("Malformed encryption response");
+        return;
+    }
 
-inline void writeLong(std::vector<uint8_t>& out, int64_t v) {
-    for (int i = 56; i >= 0; i -= 8) {
-        out.push_back(static_cast<uint8_t>((v >> i) & 0xFF));
+    const ServerKeyPair* keyPair = server_.getKeyPair();
+    std::vector<uint8_t> token, secret;
+    if (!keyPair->decrypt(tokenBlob, tokenLength, token) || token.size() != sizeof(verifyToken_) ||
+        std::memcmp(token.data(), verifyToken_, sizeof(verifyToken_)) != 0) {
+        // Java: throw new IllegalStateException("Invalid nonce!")
+        conn.disconnect("Invalid nonce!");
+        return;
+    }
+    if (!keyPair->decrypt(secretBlob, secretLength, secret) || secret.size() != AesCfb8::KEY_SIZE) {
+        conn.disconnect("Invalid shared secret");
+        return;
     }
-}
 
-inline void writeFloat(std::vector<uint8_t>& out, float v) {
-    uint32_t bits;
-    std::memcpy(&bits, &v, 4);
-    writeInt(out, static_cast<int32_t>(bits));
-}
+    // Everything from here on, both ways, goes through AES-128/CFB8.
+    conn.enableEncryption(secret.data());
+    state_ = LoginState::Authenticating;
+
+    std::string serverHash = CryptManager::serverIdHash(SERVER_ID, secret.data(), secret.size(),
+                                                        keyPair->getPublicKeyDer());
+
+    // Java: new Thread("User Authenticator #" + n) — the session server call
+    // blocks, so it never runs on an event loop. The server owns the thread
+    // and joins it on shutdown; a result that arrives after shutdown began is
+    // dropped.
+    auto authenticator = server_.getSessionAuthenticator();
+    auto connRef = conn.shared_from_this();
+    auto self = std::static_pointer_cast<LoginHandler>(shared_from_this());
+    std::string name = playerName_;
+
+    bool started = server_.startAuthenticator([authenticator, connRef, self, name, serverHash]() {
+        std::optional<GameProfile> profile;
+        try {
+            profile = authenticator->hasJoinedServer(name, serverHash);
+        } catch (const AuthenticationUnavailable& e) {
+            std::cerr << "[Login] Couldn't verify username because servers are unavailable: "
+                      << e.what() << "\n";
+            if (connRef->isConnected() && self->server_.isRunning()) {
+                self->kick(*connRef, "Authentication servers are down. Please try again later, sorry!");
+            }
+            return;
+        }
 
-inline void writeDouble(std::vector<uint8_t>& out, double v) {
-    uint64_t bits;
-    std::memcpy(&bits, &v, 8);
-    writeLong(out, static_cast<int64_t>(bits));
-}
+        if (!connRef->isConnected() || !self->server_.isRunning()) return;
+        if (!profile) {
+            std::cout << "[Login] Username '" << name << "' tried to join with an invalid session\n";
+            self->kick(*connRef, "Failed to verify username!");
+            return;
+        }
 
-inline void writeByte(std::vector<uint8_t>& out, uint8_t v) {
-    out.push_back(v);
+        std::cout << "[Login] UUID of player " << profile->name << " is " << profile->uuid << "\n";
+        self->acceptPlayer(*connRef, profile->uuid, profile->name);
+        connRef->flush();
+    });
+    if (!started) conn.disconnect("Server shutting down");
 }
 
-inline void writeUByte(std::vector<uint8_t>& out, uint8_t v) {
-    out.push_back(v);
-}
+void LoginHandler::acceptPlayer(Connection& conn, const std::string& uuid, const std::string& name) {
+    // Send S02PacketLoginSuccess
+    // Java reference: NetHandlerLoginServer.func_147326_c()
+    state_ = LoginState::Accepted;
+    PacketWriter w(LoginPacket::LoginSuccess);
+    w.writeString(uuid);
+    w.writeString(name);
+    conn.sendPacket(w.finish());
 
-inline void writeBool(std::vector<uint8_t>& out, bool v) {
-    out.push_back(v ? 1 : 0);
-}
+    // Transition to PlayHandler
+    // Java: server.getConfigurationManager().initializeConnectionToPlayer(networkManager, player)
+    // The handler is installed before the state flips to Play: from then on the
+    // tick thread may start draining the inbox and must find the PlayHandler.
+    auto playHandler = std::make_shared<PlayHandler>(server_, name, uuid, conn);
+    conn.setHandler(playHandler);
+    conn.setState(ConnectionState::Play);
 
-inline void writeShort(std::vector<uint8_t>& out, int16_t v) {
-    out.push_back(static_cast<uint8_t>((v >> 8) & 0xFF));
-    out.push_back(static_cast<uint8_t>( v       & 0xFF));
+    // Send initial login sequence (Join Game, Spawn Position, Abilities, Position)
+    playHandler->sendLoginSequence(conn);
 }
 
-// Big-endian read helpers
-inline int32_t readInt(const uint8_t* data) {
-    return (static_cast<int32_t>(data[0]) << 24) |
-           (static_cast<int32_t>(data[1]) << 16) |
-           (static_cast<int32_t>(data[2]) <<  8) |
-            static_cast<int32_t>(data[3]);
+void LoginHandler::kick(Connection& conn, const std::string& reason) {
+    // Java reference: NetHandlerLoginServer.func_147322_a() — S00PacketDisconnect
+    PacketWriter w(LoginPacket::Disconnect);
+    w.writeString(ChatComponent::of(reason).toJson());
+    conn.sendPacket(w.finish());
+    conn.disconnect(reason);
 }
 
-inline double readDouble(const uint8_t* data) {
-    uint64_t bits = 0;
-    for (int i = 0; i < 8; ++i) {
-        bits = (bits << 8) | data[i];
+void LoginHandler::onDisconnect(const std::string& reason) {
+    // Java reference: NetHandlerLoginServer.onDisconnect()
+    if (!playerName_.empty()) {
+        std::cout << "[Login] " << playerName_ << " lost connection: " << reason << "\n";
     }
-    double v;
-    std::memcpy(&v, &bits, 8);
-    return v;
 }
 
-inline float readFloat(const uint8_t* data) {
-    uint32_t bits = (static_cast<uint32_t>(data[0]) << 24) |
-                     (static_cast<uint32_t>(data[1]) << 16) |
-                     (static_cast<uint32_t>(data[2]) <<  8) |
-                      static_cast<uint32_t>(data[3]);
-    float v;
-    std::memcpy(&v, &bits, 4);
-    return v;
+std::string LoginHandler::generateOfflineUUID(const std::string& playerName) {
+    // Java reference: NetHandlerLoginServer.getOfflineProfile()
+    // UUID = UUID.nameUUIDFromBytes(("OfflinePlayer:" + name).getBytes(Charsets.UTF_8))
+    return nameUUIDFromBytes("OfflinePlayer:" + playerName);
 }
 
-} // anonymous namespace
+// ─── PlayHandler ────────────────────────────────────────────────────────────
+// Java reference: net.minecraft.network.play.server.NetHandlerPlayServer
+// Handles all Play-state packets after login success.
 
 PlayHandler::PlayHandler(MinecraftServer& server, const std::string& playerName,
                          const std::string& uuid, Connection& /*conn*/)
     : server_(server)
     , playerName_(playerName)
     , uuid_(uuid)
+    , entityId_(Entity::allocateEntityId())
 {
     // Default spawn position for superflat world
     playerX_ = 0.5;
@@ -469,54 +504,32 @@ void PlayHandler::sendLoginSequence(Connection& conn) {
     // 1. S01PacketJoinGame (0x01)
     // Format: Int entityID, UByte gamemode, Byte dimension, UByte difficulty,
     //         UByte maxPlayers, String levelType
-    {
-        std::vector<uint8_t> pkt;
-        writeVarInt(pkt, ClientboundPacket::JoinGame);
-        writeInt(pkt, 0);          // Entity ID (0 for first player)
-        writeUByte(pkt, 0);        // Gamemode: 0 = Survival
-        writeByte(pkt, 0);         // Dimension: 0 = Overworld
-        writeUByte(pkt, 1);        // Difficulty: 1 = Easy
-        writeUByte(pkt, static_cast<uint8_t>(server_.getMaxPlayers())); // Max players
-        writeString(pkt, "flat");  // Level type: flat (superflat)
-        conn.sendPacket(std::move(pkt));
-    }
+    conn.sendPacket(PacketBuilder::joinGame(
+        entityId_,                                      // Entity ID
+        static_cast<uint8_t>(server_.getGameType()),    // Gamemode: 0 = Survival, 1 = Creative
+        0,                                              // Dimension: 0 = Overworld
+        1,                                              // Difficulty: 1 = Easy
+        static_cast<uint8_t>(server_.getMaxPlayers()),  // Max players
+        "flat"));                                       // Level type: flat (superflat)
 
     // 2. S05PacketSpawnPosition (0x05)
     // Format: Int x, Int y, Int z
-    {
-        std::vector<uint8_t> pkt;
-        writeVarInt(pkt, ClientboundPacket::SpawnPosition);
-        writeInt(pkt, 0);   // Spawn X
-        writeInt(pkt, 4);   // Spawn Y (above surface)
-        writeInt(pkt, 0);   // Spawn Z
-        conn.sendPacket(std::move(pkt));
-    }
+    conn.sendPacket(PacketBuilder::spawnPosition(0, 4, 0));   // Spawn Y above surface
 
     // 3. S39PacketPlayerAbilities (0x39)
     // Format: Byte flags, Float flySpeed, Float walkSpeed
     // Flags: 0x01=invulnerable, 0x02=flying, 0x04=allowFlying, 0x08=creativeMode
-    {
-        std::vector<uint8_t> pkt;
-        writeVarInt(pkt, ClientboundPacket::PlayerAbilities);
-        writeByte(pkt, 0x00);          // Flags: survival, not flying
-        writeFloat(pkt, 0.05f);        // Fly speed
-        writeFloat(pkt, 0.1f);         // Walk speed (FOV modifier)
-        conn.sendPacket(std::move(pkt));
-    }
+    // Java: PlayerCapabilities from GameType.configurePlayerCapabilities()
+    conn.sendPacket(PacketBuilder::playerAbilities(
+        server_.isCreative() ? 0x0D : 0x00,   // Flags: creative (invulnerable, may fly) or survival
+        0.05f,      // Fly speed
+        0.1f));     // Walk speed (FOV modifier)
 
     // 4. S08PacketPlayerPosLook (0x08)
     // Format: Double x, Double y, Double z, Float yaw, Float pitch, Bool onGround
-    {
-        std::vector<uint8_t> pkt;
-        writeVarInt(pkt, ClientboundPacket::PlayerPosAndLook);
-        writeDouble(pkt, playerX_);     // X
-        writeDouble(pkt, playerY_);     // Y
-        writeDouble(pkt, playerZ_);     // Z
-        writeFloat(pkt, playerYaw_);    // Yaw
-        writeFloat(pkt, playerPitch_);  // Pitch
-        writeBool(pkt, false);          // On ground
-        conn.sendPacket(std::move(pkt));
-    }
+    conn.sendPacket(PacketBuilder::playerPosAndLook(
+        playerX_, playerY_, playerZ_, playerYaw_, playerPitch_,
+        false));    // On ground
 
     std::cout << "[Play] " << playerName_ << " joined the game at ("
               << playerX_ << ", " << playerY_ << ", " << playerZ_ << ")\n";
@@ -549,18 +562,21 @@ void PlayHandler::handlePacket(int32_t packetId,
             handleClientSettings(data, length, conn);
             break;
         case ServerboundPacket::PluginMessage:
-            // Java: NetHandlerPlayServer.processVanilla250Packet()
-            // Silently consume for now (Forge sends MC|Brand)
+            handlePluginMessage(data, length, conn);
             break;
         case ServerboundPacket::PlayerAbilities:
             // Java: NetHandlerPlayServer.processPlayerAbilities()
             // Client sends flying state — accept silently for now
             break;
+        case ServerboundPacket::PlayerDigging:
+            handlePlayerDigging(data, length, conn);
+            break;
+        case ServerboundPacket::PlayerBlockPlace:
+            handlePlayerBlockPlace(data, length, conn);
+            break;
         case ServerboundPacket::HeldItemChange:
         case ServerboundPacket::Animation:
         case ServerboundPacket::EntityAction:
-        case ServerboundPacket::PlayerDigging:
-        case ServerboundPacket::PlayerBlockPlace:
         case ServerboundPacket::CloseWindow:
         case ServerboundPacket::ClickWindow:
         case ServerboundPacket::ConfirmTransaction:
@@ -584,106 +600,213 @@ void PlayHandler::onDisconnect(const std::string& reason) {
     std::cout << "[Play] " << playerName_ << " disconnected: " << reason << "\n";
 }
 
+void PlayHandler::onNetworkTick(Connection& conn) {
+    WorldServer* world = server_.worldServerForDimension(0);
+    ChunkSendPipeline* chunkSender = server_.getChunkSendPipeline();
+    if (!world || !chunkSender) return;
+
+    chunkState_.posX = playerX_;
+    chunkState_.posY = playerY_;
+    chunkState_.posZ = playerZ_;
+    if (!inWorld_) {
+        // Java reference: ServerConfigurationManager.playerLoggedIn() → PlayerManager.addPlayer()
+        chunkState_.entityId = entityId_;
+        server_.addPlayer(entityId_, conn.shared_from_this());
+        chunkSender->addPlayer(entityId_, conn.shared_from_this());
+        world->getPlayerManager().addPlayer(chunkState_);
+        inWorld_ = true;
+    } else {
+        // Java reference: ServerConfigurationManager.updatePlayerPertinentChunks()
+        world->getPlayerManager().updateMountedMovingPlayer(chunkState_);
+    }
+    chunkSender->sendChunks(chunkState_, *world);
+}
+
+void PlayHandler::onConnectionRemoved(Connection& /*conn*/) {
+    if (!inWorld_) return;
+    if (WorldServer* world = server_.worldServerForDimension(0)) {
+        world->getPlayerManager().removePlayer(chunkState_);
+    }
+    if (ChunkSendPipeline* chunkSender = server_.getChunkSendPipeline()) {
+        chunkSender->removePlayer(entityId_);
+    }
+    server_.removePlayer(entityId_);
+    inWorld_ = false;
+}
+
 void PlayHandler::sendKeepAlive(Connection& conn) {
     // Java reference: NetHandlerPlayServer.update() — sends S00PacketKeepAlive
     // Format: VarInt keepAliveId
     ++lastKeepAliveId_;
-    std::vector<uint8_t> pkt;
-    writeVarInt(pkt, ClientboundPacket::KeepAlive);
-    writeVarInt(pkt, lastKeepAliveId_);
-    conn.sendPacket(std::move(pkt));
+    conn.sendPacket(PacketBuilder::keepAlive(lastKeepAliveId_));
 }
 
 void PlayHandler::sendChatMessage(Connection& conn, const std::string& message) {
     // Java reference: S02PacketChat
     // Format: String jsonData
-    std::string json = R"({"text":")" + message + R"("})";
-    std::vector<uint8_t> pkt;
-    writeVarInt(pkt, ClientboundPacket::ChatMessage);
-    writeString(pkt, json);
-    conn.sendPacket(std::move(pkt));
+    std::string json = ChatComponent::of(message).toJson();
+    conn.sendPacket(PacketBuilder::chatMessage(json));
 }
 
 void PlayHandler::handleKeepAlive(const uint8_t* data, size_t length, Connection& /*conn*/) {
     // Java reference: NetHandlerPlayServer.processKeepAlive()
     // Client echoes back the keepAlive ID we sent
-    if (length < 1) return;
-    auto result = readVarInt(data, length);
-    int id = result.value;
-    if (id == lastKeepAliveId_) {
+    PacketReader r(data, length);
+    if (SB_KeepAlive::read(r).keepAliveId == lastKeepAliveId_) {
         ticksSinceLastKeepAlive_ = 0;
     }
 }
 
-void PlayHandler::handleChatMessage(const uint8_t* data, size_t length, Connection& conn) {
+void PlayHandler::handleChatMessage(const uint8_t* data, size_t length, Connection& /*conn*/) {
     // Java reference: NetHandlerPlayServer.processChatMessage()
-    if (length < 1) return;
-    auto result = readString(data, length);
-    std::string message = result.value;
-
-    // Max chat length = 100 characters in 1.7.10
-    if (message.size() > 100) {
-        conn.disconnect("Chat message too long");
-        return;
-    }
+    // Messages over 100 characters fail to decode and kick, as in vanilla.
+    PacketReader r(data, length);
+    std::string message = SB_ChatMessage::read(r).message;
 
     std::cout << "[Chat] <" << playerName_ << "> " << message << "\n";
 
-    // Broadcast to all connections (echo format: <PlayerName> message)
-    // For now, just echo back to the sender
+    // Java: ServerConfigurationManager.sendChatMsgImpl() — broadcast to every
+    // player (format: <PlayerName> message). Serialized once for all recipients.
     std::string formatted = "<" + playerName_ + "> " + message;
-    sendChatMessage(conn, formatted);
+    server_.broadcastPacket(PacketBuilder::chatMessage(ChatComponent::of(formatted).toJson()));
 }
 
 void PlayHandler::handlePlayerPosition(const uint8_t* data, size_t length, Connection& /*conn*/) {
     // Java reference: NetHandlerPlayServer.processPlayer()
-    // C04PacketPlayerPosition: Double x, Double y, Double stance, Double z, Bool onGround
-    // Note: 1.7.10 sends BOTH y (feet) AND stance (head) — 33 bytes total
-    if (length < 33) return;
-    playerX_ = readDouble(data);
-    playerY_ = readDouble(data + 8);
-    // stance = readDouble(data + 16) — head Y, not stored separately
-    playerZ_ = readDouble(data + 24);
-    playerOnGround_ = data[32] != 0;
+    // C04PacketPlayerPosition: 1.7.10 sends BOTH y (feet) AND stance (head)
+    PacketReader r(data, length);
+    auto p = SB_PlayerPosition::read(r);
+    playerX_ = p.x;
+    playerY_ = p.feetY;
+    playerZ_ = p.z;
+    playerOnGround_ = p.onGround;
 }
 
 void PlayHandler::handlePlayerLook(const uint8_t* data, size_t length, Connection& /*conn*/) {
     // Java reference: NetHandlerPlayServer.processPlayer()
-    // C05PacketPlayerLook: Float yaw, Float pitch, Bool onGround
-    if (length < 9) return;
-    playerYaw_ = readFloat(data);
-    playerPitch_ = readFloat(data + 4);
-    playerOnGround_ = data[8] != 0;
+    PacketReader r(data, length);
+    auto p = SB_PlayerLook::read(r);
+    playerYaw_ = p.yaw;
+    playerPitch_ = p.pitch;
+    playerOnGround_ = p.onGround;
 }
 
 void PlayHandler::handlePlayerPosAndLook(const uint8_t* data, size_t length, Connection& /*conn*/) {
     // Java reference: NetHandlerPlayServer.processPlayer()
-    // C06PacketPlayerPosLook: Double x, Double y, Double stance, Double z, Float yaw, Float pitch, Bool onGround
-    if (length < 41) return;
-    playerX_ = readDouble(data);
-    playerY_ = readDouble(data + 8);
-    // stance = readDouble(data + 16)
-    playerZ_ = readDouble(data + 24);
-    playerYaw_ = readFloat(data + 32);
-    playerPitch_ = readFloat(data + 36);
-    playerOnGround_ = data[40] != 0;
+    PacketReader r(data, length);
+    auto p = SB_PlayerPosAndLook::read(r);
+    playerX_ = p.x;
+    playerY_ = p.feetY;
+    playerZ_ = p.z;
+    playerYaw_ = p.yaw;
+    playerPitch_ = p.pitch;
+    playerOnGround_ = p.onGround;
 }
 
 void PlayHandler::handlePlayerGround(const uint8_t* data, size_t length, Connection& /*conn*/) {
     // Java reference: NetHandlerPlayServer.processPlayer()
-    // C03PacketPlayer: Bool onGround
-    if (length < 1) return;
-    playerOnGround_ = data[0] != 0;
+    PacketReader r(data, length);
+    playerOnGround_ = SB_Player::read(r).onGround;
+}
+
+void PlayHandler::handlePlayerDigging(const uint8_t* data, size_t length, Connection& conn) {
+    // Java reference: NetHandlerPlayServer.processPlayerDigging()
+    PacketReader r(data, length);
+    auto p = SB_PlayerDigging::read(r);
+    // 0 = started (breaks blocks without hardness at once), 2 = finished
+    if (p.status != 0 && p.status != 2) return;
+    WorldServer* world = server_.worldServerForDimension(0);
+    if (!world || !inWorld_) return;
+
+    // Java: reach of 6 blocks from the eyes (feet + 1.5)
+    double dx = playerX_ - (p.x + 0.5);
+    double dy = playerY_ - (p.y + 0.5) + 1.5;
+    double dz = playerZ_ - (p.z + 0.5);
+    if (dx * dx + dy * dy + dz * dz > 36.0) return;
+
+    // Java: ItemInWorldManager.onBlockClicked — creative players break at
+    // once. Survival digging is not timed yet, so only blocks without
+    // hardness break; anything else is refused rather than trusted.
+    Block* block = world->getBlock(p.x, p.y, p.z);
+    float hardness = block->getHardness();
+    bool breaks = block->getMaterial() != Material::Air && hardness >= 0.0f &&
+                  (server_.isCreative() || hardness == 0.0f);
+    if (breaks) {
+        // Java: ItemInWorldManager.tryHarvestBlock → World.setBlockToAir, and
+        // playAuxSFXAtEntity(2001) for the break sound and particles, which
+        // the breaking client plays itself
+        int32_t meta = world->getBlockMetadata(p.x, p.y, p.z);
+        world->setBlock(p.x, p.y, p.z, Block::getBlockById(0));
+        world->setBlockMetadata(p.x, p.y, p.z, 0);
+        server_.sendToAllNearExcept(*world, p.x, p.y, p.z, 64.0,
+            sharePacket(PacketBuilder::effect(2001, p.x, p.y, p.z,
+                                              Block::getIdFromBlock(block) | meta << 12, false)),
+            entityId_);
+    } else if (p.status == 2 && block->getMaterial() != Material::Air) {
+        // Java: refused — put the block back on the client
+        conn.sendPacket(PacketBuilder::blockChange(p.x, p.y, p.z, Block::getIdFromBlock(block),
+            static_cast<uint8_t>(world->getBlockMetadata(p.x, p.y, p.z))));
+    }
+}
+
+void PlayHandler::handlePlayerBlockPlace(const uint8_t* data, size_t length, Connection& conn) {
+    // Java reference: NetHandlerPlayServer.processPlayerBlockPlacement()
+    PacketReader r(data, length);
+    auto p = SB_PlayerBlockPlace::read(r);
+    if (p.direction < 0 || p.direction > 5) return;   // use item in air
+    WorldServer* world = server_.worldServerForDimension(0);
+    if (!world || !inWorld_) return;
+
+    // Java: Facing offsets 0=-y 1=+y 2=-z 3=+z 4=-x 5=+x
+    static constexpr int32_t OFFSETS[6][3] = {{0,-1,0},{0,1,0},{0,0,-1},{0,0,1},{-1,0,0},{1,0,0}};
+    int32_t x = p.x + OFFSETS[p.direction][0];
+    int32_t y = p.y + OFFSETS[p.direction][1];
+    int32_t z = p.z + OFFSETS[p.direction][2];
+
+    double dx = playerX_ - (p.x + 0.5);
+    double dy = playerY_ - (p.y + 0.5);
+    double dz = playerZ_ - (p.z + 0.5);
+
+    // Java: ItemBlock.onItemUse. There is no server-side inventory yet, so the
+    // held block is taken from the packet's slot — which only creative
+    // players may do (Java trusts their C10 inventory actions the same way).
+    Block* placed = server_.isCreative() && p.heldItem.itemId > 0 && p.heldItem.itemId < 256
+                        ? Block::getBlockById(p.heldItem.itemId) : nullptr;
+    Block* target = world->getBlock(x, y, z);
+    bool fits = y >= 0 && y < 256 && dx * dx + dy * dy + dz * dz < 64.0 &&
+                placed && placed->getMaterial() != Material::Air &&
+                (target->getMaterial() == Material::Air || target->getMaterial() == Material::Water ||
+                 target->getMaterial() == Material::Lava);
+    if (fits) {
+        world->setBlock(x, y, z, placed);
+        world->setBlockMetadata(x, y, z, 0);
+    } else if (y >= 0 && y < 256) {
+        // Java: the client already drew the block — undo it
+        conn.sendPacket(PacketBuilder::blockChange(x, static_cast<uint8_t>(y), z, Block::getIdFromBlock(target),
+            static_cast<uint8_t>(world->getBlockMetadata(x, y, z))));
+    }
+}
+
+void PlayHandler::handlePluginMessage(const uint8_t* data, size_t length, Connection& conn) {
+    // Java reference: NetHandlerPlayServer.processVanilla250Packet()
+    // Other channels (MC|Brand from the client, Forge handshakes) are ignored.
+    PacketReader r(data, length);
+    if (SB_PluginMessage::read(r).channel != TICK_TIME_CHANNEL) return;
+
+    // Reply: Int tickCount, Double mean MSPT, Double max MSPT (last 100 ticks)
+    PacketWriter w;
+    w.writeInt(server_.getTickCount());
+    w.writeDouble(server_.getAverageTickMillis());
+    w.writeDouble(server_.getMaxTickMillis());
+    conn.sendPacket(PacketBuilder::pluginMessage(TICK_TIME_CHANNEL, w.data(), w.size()));
 }
 
 void PlayHandler::handleClientSettings(const uint8_t* data, size_t length, Connection& /*conn*/) {
     // Java reference: NetHandlerPlayServer.processClientSettings()
-    // C15PacketClientSettings: String locale, Byte viewDistance, Byte chatFlags,
-    //                          Bool chatColours, Byte difficulty(?), Bool showCape
-    if (length < 1) return;
-    auto locale = readString(data, length);
+    PacketReader r(data, length);
+    auto settings = SB_ClientSettings::read(r);
     // Just log for now
-    (void)locale;
+    (void)settings;
 }
 
 } // namespace mccpp
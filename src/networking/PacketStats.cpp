@@ -0,0 +1,341 @@
+/**
+ * PacketStats.cpp — Per-thread packet counters, aggregation and reports.
+ */
+
+#include "networking/PacketStats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace mccpp {
+
+// ─── LatencyHistogram ───────────────────────────────────────────────────────
+
+size_t LatencyHistogram::bucketFor(uint64_t value) {
+    if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+    // Exponent of the highest set bit, then the next SUB_BUCKET_BITS bits
+    size_t exponent = 63 - static_cast<size_t>(__builtin_clzll(value));
+    size_t bucket = (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS +
+                    static_cast<size_t>((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return std::min(bucket, BUCKETS - 1);
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    size_t exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t mantissa = SUB_BUCKETS + bucket % SUB_BUCKETS;
+    return mantissa << (exponent - SUB_BUCKET_BITS);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    size_t exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t mantissa = SUB_BUCKETS + bucket % SUB_BUCKETS + 1;
+    return (mantissa << (exponent - SUB_BUCKET_BITS)) - 1;
+}
+
+uint64_t LatencyHistogram::total() const {
+    uint64_t sum = 0;
+    for (uint64_t c : counts) sum += c;
+    return sum;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    uint64_t n = total();
+    if (n == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(n) + 0.5);
+    rank = std::clamp<uint64_t>(rank, 1, n);
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKETS; ++b) {
+        seen += counts[b];
+        if (seen >= rank) return bucketUpperBound(b);
+    }
+    return bucketUpperBound(BUCKETS - 1);
+}
+
+namespace {
+
+constexpr size_t SLOTS = PacketStatsSnapshot::SLOTS;
+constexpr size_t BUCKETS = LatencyHistogram::BUCKETS;
+
+// ─── Per-thread counters ────────────────────────────────────────────────────
+// Only the owning thread writes; load+store keeps the hot path free of
+// locked instructions while snapshot() can still read concurrently.
+
+inline void bump(std::atomic<uint64_t>& counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+struct HandlerBlock {
+    std::atomic<uint64_t> counts[SLOTS][BUCKETS] = {};
+};
+
+struct ThreadCounters {
+    std::atomic<uint64_t> count[2][SLOTS] = {};
+    std::atomic<uint64_t> bytes[2][SLOTS] = {};
+    // Allocated on the first handler timing; only handler threads pay for it.
+    std::atomic<HandlerBlock*> handler{nullptr};
+
+    ~ThreadCounters() { delete handler.load(std::memory_order_relaxed); }
+
+    void addTo(PacketStatsSnapshot& out) const {
+        for (size_t d = 0; d < 2; ++d) {
+            for (size_t s = 0; s < SLOTS; ++s) {
+                out.traffic[d][s].count += count[d][s].load(std::memory_order_relaxed);
+                out.traffic[d][s].bytes += bytes[d][s].load(std::memory_order_relaxed);
+            }
+        }
+        if (HandlerBlock* h = handler.load(std::memory_order_acquire)) {
+            for (size_t s = 0; s < SLOTS; ++s) {
+                for (size_t b = 0; b < BUCKETS; ++b) {
+                    out.handlerTime[s].counts[b] += h->counts[s][b].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+};
+
+void accumulate(PacketStatsSnapshot& into, const PacketStatsSnapshot& from, bool subtract) {
+    for (size_t d = 0; d < 2; ++d) {
+        for (size_t s = 0; s < SLOTS; ++s) {
+            auto& t = into.traffic[d][s];
+            const auto& f = from.traffic[d][s];
+            t.count = subtract ? t.count - f.count : t.count + f.count;
+            t.bytes = subtract ? t.bytes - f.bytes : t.bytes + f.bytes;
+        }
+    }
+    for (size_t s = 0; s < SLOTS; ++s) {
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            uint64_t& c = into.handlerTime[s].counts[b];
+            c = subtract ? c - from.handlerTime[s].counts[b] : c + from.handlerTime[s].counts[b];
+        }
+    }
+}
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadCounters*> live;
+    PacketStatsSnapshot retired;    // counters of threads that have exited
+    PacketStatsSnapshot baseline;   // totals at the last reset()
+    std::chrono::steady_clock::time_point since = std::chrono::steady_clock::now();
+};
+
+Registry& registry() {
+    // Never destroyed: thread_local holders may retire after static destructors run.
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+struct ThreadHolder {
+    ThreadCounters* counters = nullptr;
+
+    ~ThreadHolder() {
+        if (!counters) return;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        counters->addTo(r.retired);
+        r.live.erase(std::remove(r.live.begin(), r.live.end(), counters), r.live.end());
+        delete counters;
+    }
+};
+
+ThreadCounters& localCounters() {
+    thread_local ThreadHolder holder;
+    if (!holder.counters) {
+        holder.counters = new ThreadCounters();
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(holder.counters);
+    }
+    return *holder.counters;
+}
+
+size_t slotFor(int32_t packetId, bool play) {
+    if (!play || packetId < 0 || packetId >= static_cast<int32_t>(PacketStats::PRE_PLAY)) {
+        return PacketStats::PRE_PLAY;
+    }
+    return static_cast<size_t>(packetId);
+}
+
+std::unique_ptr<PacketStatsSnapshot> rawTotals(Registry& r) {
+    auto out = std::make_unique<PacketStatsSnapshot>();
+    *out = r.retired;
+    for (const ThreadCounters* c : r.live) c->addTo(*out);
+    return out;
+}
+
+// Java reference: EnumConnectionState.PLAY packet registrations (1.7.10)
+const char* const CLIENTBOUND_NAMES[] = {
+    "KeepAlive", "JoinGame", "ChatMessage", "TimeUpdate", "EntityEquipment",
+    "SpawnPosition", "UpdateHealth", "Respawn", "PlayerPosAndLook", "HeldItemChange",
+    "UseBed", "Animation", "SpawnPlayer", "CollectItem", "SpawnObject", "SpawnMob",
+    "SpawnPainting", "SpawnExpOrb", "EntityVelocity", "DestroyEntities", "Entity",
+    "EntityRelMove", "EntityLook", "EntityLookAndRelMove", "EntityTeleport",
+    "EntityHeadLook", "EntityStatus", "AttachEntity", "EntityMetadata", "EntityEffect",
+    "RemoveEntityEffect", "SetExperience", "EntityProperties", "ChunkData",
+    "MultiBlockChange", "BlockChange", "BlockAction", "BlockBreakAnim", "MapChunkBulk",
+    "Explosion", "Effect", "SoundEffect", "Particle", "ChangeGameState",
+    "SpawnGlobalEntity", "OpenWindow", "CloseWindow", "SetSlot", "WindowItems",
+    "WindowProperty", "ConfirmTransaction", "UpdateSign", "Maps", "UpdateBlockEntity",
+    "SignEditorOpen", "Statistics", "PlayerListItem", "PlayerAbilities", "TabComplete",
+    "ScoreboardObjective", "UpdateScore", "DisplayScoreboard", "Teams", "PluginMessage",
+    "Disconnect",
+};
+
+const char* const SERVERBOUND_NAMES[] = {
+    "KeepAlive", "ChatMessage", "UseEntity", "Player", "PlayerPosition", "PlayerLook",
+    "PlayerPosAndLook", "PlayerDigging", "PlayerBlockPlace", "HeldItemChange",
+    "Animation", "EntityAction", "SteerVehicle", "CloseWindow", "ClickWindow",
+    "ConfirmTransaction", "CreativeInventory", "EnchantItem", "UpdateSign",
+    "PlayerAbilities", "TabComplete", "ClientSettings", "ClientStatus", "PluginMessage",
+};
+
+std::string formatNanos(uint64_t ns) {
+    char buf[32];
+    if (ns < 10000) std::snprintf(buf, sizeof(buf), "%lluns", static_cast<unsigned long long>(ns));
+    else if (ns < 10000000) std::snprintf(buf, sizeof(buf), "%.1fus", ns / 1e3);
+    else std::snprintf(buf, sizeof(buf), "%.1fms", ns / 1e6);
+    return buf;
+}
+
+} // anonymous namespace
+
+// ─── PacketStats ────────────────────────────────────────────────────────────
+
+void PacketStats::recordPacket(PacketDirection direction, int32_t packetId, bool play, size_t wireBytes) {
+    ThreadCounters& c = localCounters();
+    size_t d = static_cast<size_t>(direction);
+    size_t slot = slotFor(packetId, play);
+    bump(c.count[d][slot], 1);
+    bump(c.bytes[d][slot], wireBytes);
+}
+
+void PacketStats::recordHandlerTime(int32_t packetId, bool play, uint64_t nanos) {
+    ThreadCounters& c = localCounters();
+    HandlerBlock* h = c.handler.load(std::memory_order_relaxed);
+    if (!h) {
+        h = new HandlerBlock();
+        c.handler.store(h, std::memory_order_release);
+    }
+    bump(h->counts[slotFor(packetId, play)][LatencyHistogram::bucketFor(nanos)], 1);
+}
+
+std::unique_ptr<PacketStatsSnapshot> PacketStats::snapshot() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto out = rawTotals(r);
+    accumulate(*out, r.baseline, true);
+    out->elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - r.since).count();
+    return out;
+}
+
+void PacketStats::reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.baseline = *rawTotals(r);
+    r.since = std::chrono::steady_clock::now();
+}
+
+std::string PacketStats::packetName(PacketDirection direction, size_t slot) {
+    if (slot == PRE_PLAY) return "Handshake/Status/Login";
+    if (direction == PacketDirection::Outbound) {
+        if (slot < std::size(CLIENTBOUND_NAMES)) return CLIENTBOUND_NAMES[slot];
+    } else if (slot < std::size(SERVERBOUND_NAMES)) {
+        return SERVERBOUND_NAMES[slot];
+    }
+    char buf[8];
+    std::snprintf(buf, sizeof(buf), "0x%02zX", slot);
+    return buf;
+}
+
+std::string PacketStats::toJson(const PacketStatsSnapshot& snapshot) {
+    std::ostringstream out;
+    out << "{\"elapsed_seconds\":" << snapshot.elapsedSeconds;
+    for (size_t d = 0; d < 2; ++d) {
+        auto direction = static_cast<PacketDirection>(d);
+        out << ",\"" << (direction == PacketDirection::Inbound ? "inbound" : "outbound") << "\":[";
+        bool first = true;
+        for (size_t s = 0; s < SLOTS; ++s) {
+            const auto& t = snapshot.traffic[d][s];
+            if (t.count == 0) continue;
+            if (!first) out << ",";
+            first = false;
+            out << "{\"id\":" << (s == PRE_PLAY ? -1 : static_cast<int>(s))
+                << ",\"name\":\"" << packetName(direction, s) << "\""
+                << ",\"count\":" << t.count << ",\"bytes\":" << t.bytes;
+            const LatencyHistogram& h = snapshot.handlerTime[s];
+            if (direction == PacketDirection::Inbound && h.total() != 0) {
+                out << ",\"handler_ns\":{\"count\":" << h.total()
+                    << ",\"p50\":" << h.percentile(0.50) << ",\"p90\":" << h.percentile(0.90)
+                    << ",\"p99\":" << h.percentile(0.99) << ",\"max\":" << h.percentile(1.0)
+                    << ",\"buckets\":[";
+                bool firstBucket = true;
+                for (size_t b = 0; b < BUCKETS; ++b) {
+                    if (h.counts[b] == 0) continue;
+                    if (!firstBucket) out << ",";
+                    firstBucket = false;
+                    out << "[" << LatencyHistogram::bucketLowerBound(b) << ","
+                        << LatencyHistogram::bucketUpperBound(b) << "," << h.counts[b] << "]";
+                }
+                out << "]}";
+            }
+            out << "}";
+        }
+        out << "]";
+    }
+    out << "}\n";
+    return out.str();
+}
+
+std::string PacketStats::formatTable(const PacketStatsSnapshot& snapshot, size_t maxRows) {
+    std::ostringstream out;
+    char line[160];
+    std::snprintf(line, sizeof(line), "Packet statistics over %.1fs\n", snapshot.elapsedSeconds);
+    out << line;
+
+    for (size_t d = 0; d < 2; ++d) {
+        auto direction = static_cast<PacketDirection>(d);
+        std::vector<size_t> slots;
+        uint64_t totalBytes = 0;
+        for (size_t s = 0; s < SLOTS; ++s) {
+            if (snapshot.traffic[d][s].count == 0) continue;
+            slots.push_back(s);
+            totalBytes += snapshot.traffic[d][s].bytes;
+        }
+        std::sort(slots.begin(), slots.end(), [&](size_t a, size_t b) {
+            return snapshot.traffic[d][a].bytes > snapshot.traffic[d][b].bytes;
+        });
+        if (slots.size() > maxRows) slots.resize(maxRows);
+
+        bool inbound = direction == PacketDirection::Inbound;
+        out << (inbound ? "Inbound" : "Outbound") << " (" << totalBytes / 1024 << " KiB)\n";
+        std::snprintf(line, sizeof(line), "  %-4s %-22s %10s %12s %6s%s\n", "ID", "Packet", "Count",
+                      "Bytes", "Share", inbound ? "   Handler p50 / p99 / max" : "");
+        out << line;
+        for (size_t s : slots) {
+            const auto& t = snapshot.traffic[d][s];
+            double share = totalBytes ? 100.0 * t.bytes / totalBytes : 0.0;
+            char id[8] = "--";
+            if (s != PRE_PLAY) std::snprintf(id, sizeof(id), "0x%02zX", s);
+            std::snprintf(line, sizeof(line), "  %-4s %-22s %10llu %12llu %5.1f%%", id,
+                          packetName(direction, s).c_str(), static_cast<unsigned long long>(t.count),
+                          static_cast<unsigned long long>(t.bytes), share);
+            out << line;
+            const LatencyHistogram& h = snapshot.handlerTime[s];
+            if (inbound && h.total() != 0) {
+                out << "   " << formatNanos(h.percentile(0.50)) << " / " << formatNanos(h.percentile(0.99))
+                    << " / " << formatNanos(h.percentile(1.0));
+            }
+            out << "\n";
+        }
+    }
+    return out.str();
+}
+
+} // namespace mccpp
@@ -0,0 +1,203 @@
+/**
+ * SessionAuthenticator.cpp — HTTP(S) client for the Yggdrasil session server.
+ *
+ * Java reference: com.mojang.authlib.yggdrasil.YggdrasilMinecraftSessionService
+ *
+ * One short-lived connection per login (HTTP/1.0, Connection: close), made
+ * from the authenticator thread. Blocking sockets with send/receive timeouts.
+ */
+
+#include "networking/SessionAuthenticator.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netdb.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace mccpp {
+
+namespace {
+
+std::string urlEncode(const std::string& s) {
+    static const char HEX[] = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char c : s) {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            out.push_back(static_cast<char>(c));
+        } else {
+            out.push_back('%');
+            out.push_back(HEX[c >> 4]);
+            out.push_back(HEX[c & 0x0F]);
+        }
+    }
+    return out;
+}
+
+// Value of a top-level string field in a flat JSON object ("key":"value").
+std::optional<std::string> jsonString(const std::string& json, const std::string& key) {
+    std::string needle = "\"" + key + "\"";
+    size_t pos = json.find(needle);
+    if (pos == std::string::npos) return std::nullopt;
+    pos = json.find(':', pos + needle.size());
+    if (pos == std::string::npos) return std::nullopt;
+    pos = json.find('"', pos + 1);
+    if (pos == std::string::npos) return std::nullopt;
+    size_t end = json.find('"', pos + 1);
+    if (end == std::string::npos) return std::nullopt;
+    return json.substr(pos + 1, end - pos - 1);
+}
+
+// Java: UUIDTypeAdapter.fromString() — 32 hex digits to the dashed form
+std::string dashUuid(const std::string& hex) {
+    if (hex.size() != 32) return hex;
+    return hex.substr(0, 8) + "-" + hex.substr(8, 4) + "-" + hex.substr(12, 4) + "-" +
+           hex.substr(16, 4) + "-" + hex.substr(20);
+}
+
+int connectTcp(const std::string& host, const std::string& port, int timeoutMs) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    int rc = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0) {
+        throw AuthenticationUnavailable("Cannot resolve " + host + ": " + ::gai_strerror(rc));
+    }
+
+    timeval tv{};
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+
+    int fd = -1;
+    for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        // SO_SNDTIMEO also bounds connect() on Linux
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(result);
+    if (fd < 0) {
+        throw AuthenticationUnavailable("Cannot connect to " + host + ":" + port);
+    }
+    return fd;
+}
+
+std::string httpGet(bool tls, const std::string& host, const std::string& port,
+                    const std::string& path, int timeoutMs) {
+    std::string request = "GET " + path + " HTTP/1.0\r\n"
+                          "Host: " + host + "\r\n"
+                          "User-Agent: minecppaft-server\r\n"
+                          "Connection: close\r\n\r\n";
+    std::string response;
+    char buf[4096];
+
+    int fd = connectTcp(host, port, timeoutMs);
+
+    if (!tls) {
+        bool ok = ::send(fd, request.data(), request.size(), MSG_NOSIGNAL) ==
+                  static_cast<ssize_t>(request.size());
+        ssize_t n;
+        while (ok && (n = ::recv(fd, buf, sizeof(buf), 0)) > 0) response.append(buf, static_cast<size_t>(n));
+        ::close(fd);
+        if (!ok) throw AuthenticationUnavailable("Request to " + host + " failed");
+        return response;
+    }
+
+    SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+    SSL* ssl = ctx ? SSL_new(ctx) : nullptr;
+    bool ok = ssl != nullptr;
+    if (ok) {
+        SSL_CTX_set_default_verify_paths(ctx);
+        SSL_set_verify(ssl, SSL_VERIFY_PEER, nullptr);
+        SSL_set_tlsext_host_name(ssl, host.c_str());
+        SSL_set1_host(ssl, host.c_str());
+        SSL_set_fd(ssl, fd);
+        ok = SSL_connect(ssl) == 1 &&
+             SSL_write(ssl, request.data(), static_cast<int>(request.size())) ==
+                 static_cast<int>(request.size());
+    }
+    int n;
+    while (ok && (n = SSL_read(ssl, buf, sizeof(buf))) > 0) response.append(buf, static_cast<size_t>(n));
+
+    unsigned long err = ok ? 0 : ERR_get_error();
+    if (ssl) {
+        SSL_shutdown(ssl);
+        SSL_free(ssl);
+    }
+    if (ctx) SSL_CTX_free(ctx);
+    ::close(fd);
+
+    if (!ok) {
+        char reason[256] = "TLS error";
+        if (err) ERR_error_string_n(err, reason, sizeof(reason));
+        throw AuthenticationUnavailable("Request to " + host + " failed: " + reason);
+    }
+    return response;
+}
+
+} // anonymous namespace
+
+HttpSessionAuthenticator::HttpSessionAuthenticator(const std::string& baseUrl, int timeoutMs)
+    : baseUrl_(baseUrl), timeoutMs_(timeoutMs) {
+    // scheme://host[:port][/prefix]
+    std::string rest = baseUrl;
+    if (rest.rfind("https://", 0) == 0) {
+        rest = rest.substr(8);
+        tls_ = true;
+    } else if (rest.rfind("http://", 0) == 0) {
+        rest = rest.substr(7);
+        tls_ = false;
+    }
+    size_t slash = rest.find('/');
+    std::string authority = rest.substr(0, slash);
+    pathPrefix_ = (slash == std::string::npos) ? "" : rest.substr(slash);
+    while (!pathPrefix_.empty() && pathPrefix_.back() == '/') pathPrefix_.pop_back();
+
+    size_t colon = authority.rfind(':');
+    if (colon != std::string::npos && authority.find(']') == std::string::npos) {
+        host_ = authority.substr(0, colon);
+        port_ = authority.substr(colon + 1);
+    } else {
+        host_ = authority;
+        port_ = tls_ ? "443" : "80";
+    }
+}
+
+std::optional<GameProfile> HttpSessionAuthenticator::hasJoinedServer(const std::string& username,
+                                                                      const std::string& serverHash) {
+    std::string path = pathPrefix_ + "/session/minecraft/hasJoined?username=" + urlEncode(username) +
+                       "&serverId=" + urlEncode(serverHash);
+    std::string response = httpGet(tls_, host_, port_, path, timeoutMs_);
+
+    // Status line: HTTP/1.x <code> ...
+    size_t space = response.find(' ');
+    if (space == std::string::npos) throw AuthenticationUnavailable("Malformed session server response");
+    int status = std::atoi(response.c_str() + space + 1);
+    if (status == 204) return std::nullopt;
+    if (status != 200) {
+        throw AuthenticationUnavailable("Session server returned HTTP " + std::to_string(status));
+    }
+
+    size_t bodyStart = response.find("\r\n\r\n");
+    std::string body = (bodyStart == std::string::npos) ? "" : response.substr(bodyStart + 4);
+    auto id = jsonString(body, "id");
+    auto name = jsonString(body, "name");
+    if (!id || !name) return std::nullopt;
+
+    GameProfile profile;
+    profile.uuid = dashUuid(*id);
+    profile.name = *name;
+    return profile;
+}
+
+} // namespace mccpp
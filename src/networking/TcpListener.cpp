@@ -8,10 +8,13 @@
 #include "networking/TcpListener.h"
 
 #include <arpa/inet.h>
+#include <algorithm>
 #include <cerrno>
+#include <chrono>
 #include <cstring>
 #include <fcntl.h>
 #include <iostream>
+#include <iterator>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <sys/socket.h>
@@ -19,6 +22,25 @@
 
 namespace mccpp {
 
+namespace {
+
+int64_t monotonicMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Close with an RST instead of a FIN: no TIME_WAIT entry is left behind
+// for a connection that was never served.
+void resetAndClose(int fd) {
+    linger lg{};
+    lg.l_onoff = 1;
+    lg.l_linger = 0;
+    ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+    ::close(fd);
+}
+
+} // anonymous namespace
+
 TcpListener::TcpListener(const std::string& bindAddress, uint16_t port)
     : bindAddress_(bindAddress), port_(port) {}
 
@@ -30,8 +52,13 @@ void TcpListener::setAcceptCallback(AcceptCallback callback) {
     onAccept_ = std::move(callback);
 }
 
+void TcpListener::setConnectionRateLimit(double perSecond, int burst) {
+    ratePerSecond_ = perSecond;
+    rateBurst_ = std::max(1, burst);
+}
+
 bool TcpListener::start() {
-    serverFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    serverFd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
     if (serverFd_ < 0) {
         std::cerr << "[TcpListener] Failed to create socket: " << std::strerror(errno) << "\n";
         return false;
@@ -64,7 +91,9 @@ bool TcpListener::start() {
         return false;
     }
 
-    if (::listen(serverFd_, 128) < 0) {
+    // A deep backlog keeps bursts of legitimate connects from being dropped
+    // by the kernel while the accept thread sheds a flood.
+    if (::listen(serverFd_, SOMAXCONN) < 0) {
         std::cerr << "[TcpListener] Listen failed: " << std::strerror(errno) << "\n";
         ::close(serverFd_);
         serverFd_ = -1;
@@ -100,28 +129,41 @@ void TcpListener::acceptLoop() {
         sockaddr_in clientAddr{};
         socklen_t clientLen = sizeof(clientAddr);
 
-        int clientFd = ::accept(serverFd_, reinterpret_cast<sockaddr*>(&clientAddr), &clientLen);
+        // Client sockets are handed to the NetworkReactor, which requires non-blocking I/O
+        int clientFd = ::accept4(serverFd_, reinterpret_cast<sockaddr*>(&clientAddr), &clientLen,
+                                 SOCK_NONBLOCK | SOCK_CLOEXEC);
         if (clientFd < 0) {
             if (!running_.load(std::memory_order_relaxed)) {
                 break; // We're shutting down
             }
-            if (errno == EINTR) {
+            if (errno == EINTR || errno == ECONNABORTED) {
                 continue;
             }
             std::cerr << "[TcpListener] Accept error: " << std::strerror(errno) << "\n";
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                // Out of descriptors/memory: back off instead of spinning on the error
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
             continue;
         }
 
-        // Disable Nagle's algorithm (Minecraft protocol is latency-sensitive)
-        int flag = 1;
-        ::setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
-
         // Get remote address string
         char addrBuf[INET_ADDRSTRLEN];
         ::inet_ntop(AF_INET, &clientAddr.sin_addr, addrBuf, sizeof(addrBuf));
         std::string remoteAddr(addrBuf);
         uint16_t remotePort = ntohs(clientAddr.sin_port);
 
+        if (!admit(clientAddr.sin_addr.s_addr, remoteAddr)) {
+            rejectedCount_.fetch_add(1, std::memory_order_relaxed);
+            resetAndClose(clientFd);
+            continue;
+        }
+        acceptedCount_.fetch_add(1, std::memory_order_relaxed);
+
+        // Disable Nagle's algorithm (Minecraft protocol is latency-sensitive)
+        int flag = 1;
+        ::setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
         std::cout << "[TcpListener] Accepted connection from "
                   << remoteAddr << ":" << remotePort << "\n";
 
@@ -134,4 +176,40 @@ void TcpListener::acceptLoop() {
     }
 }
 
+bool TcpListener::admit(uint32_t ipv4, const std::string& address) {
+    if (ratePerSecond_ <= 0.0) return true;
+
+    int64_t now = monotonicMs();
+
+    if (buckets_.size() >= BUCKET_PRUNE_THRESHOLD && now >= nextPruneMs_) {
+        // Drop buckets that have refilled completely; they carry no state.
+        // At most one sweep per refill period, so a table kept full by active
+        // addresses costs one scan per period instead of one per accept.
+        for (auto it = buckets_.begin(); it != buckets_.end();) {
+            double refilled = it->second.tokens + (now - it->second.lastRefillMs) * ratePerSecond_ / 1000.0;
+            it = (refilled >= rateBurst_) ? buckets_.erase(it) : std::next(it);
+        }
+        nextPruneMs_ = now + std::max<int64_t>(1, static_cast<int64_t>(rateBurst_ * 1000.0 / ratePerSecond_));
+    }
+
+    auto [it, inserted] = buckets_.try_emplace(ipv4, RateBucket{static_cast<double>(rateBurst_), now, false});
+    RateBucket& bucket = it->second;
+    if (!inserted) {
+        bucket.tokens = std::min(static_cast<double>(rateBurst_),
+                                 bucket.tokens + (now - bucket.lastRefillMs) * ratePerSecond_ / 1000.0);
+        bucket.lastRefillMs = now;
+    }
+
+    if (bucket.tokens < 1.0) {
+        if (!bucket.throttled) {
+            bucket.throttled = true;
+            std::cout << "[TcpListener] Throttling connections from " << address << "\n";
+        }
+        return false;
+    }
+    bucket.tokens -= 1.0;
+    bucket.throttled = false;
+    return true;
+}
+
 } // namespace mccpp
@@ -0,0 +1,292 @@
+/**
+ * ChunkSendPipeline.cpp — Chunk packet worker pool.
+ */
+
+#include "server/ChunkSendPipeline.h"
+#include "networking/Connection.h"
+#include "networking/PacketBuilder.h"
+#include "server/PlayerManager.h"
+#include "world/World.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace mccpp {
+
+int ChunkSendPipeline::defaultThreadCount() {
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    return std::clamp(hw / 4, 1, 4);
+}
+
+ChunkSendPipeline::ChunkSendPipeline(int threadCount)
+    : threadCount_(std::max(1, threadCount)) {}
+
+ChunkSendPipeline::~ChunkSendPipeline() {
+    stop();
+}
+
+void ChunkSendPipeline::start() {
+    workers_.reserve(static_cast<size_t>(threadCount_));
+    for (int i = 0; i < threadCount_; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+void ChunkSendPipeline::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    queueCv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    workers_.clear();
+}
+
+// ─── Tick thread ────────────────────────────────────────────────────────────
+
+void ChunkSendPipeline::setServerLoad(double tickLoad) {
+    // About a second's worth of ticks, so one slow tick doesn't swing the level
+    smoothedLoad_ += (tickLoad - smoothedLoad_) * 0.05;
+    serverLoad_.store(smoothedLoad_, std::memory_order_relaxed);
+}
+
+void ChunkSendPipeline::addPlayer(int32_t playerId, std::shared_ptr<Connection> conn) {
+    auto session = std::make_shared<Session>();
+    session->conn = std::move(conn);
+    sessions_[playerId] = std::move(session);
+}
+
+void ChunkSendPipeline::removePlayer(int32_t playerId) {
+    auto it = sessions_.find(playerId);
+    if (it == sessions_.end()) return;
+    it->second->closed.store(true, std::memory_order_release);
+    sessions_.erase(it);
+}
+
+void ChunkSendPipeline::sendChunks(PlayerChunkState& player, WorldServer& world) {
+    auto it = sessions_.find(player.entityId);
+    if (it == sessions_.end()) return;
+    Session& session = *it->second;
+    ChunkProviderServer* provider = world.getChunkProvider();
+
+    while (!player.loadedChunks.empty()
+           && session.packetsInFlight.load(std::memory_order_acquire) < MAX_PACKETS_IN_FLIGHT
+           && !session.conn->isBulkThrottled()) {
+        // Java: EntityPlayerMP.onUpdate() — the first loaded chunks of the
+        // queue; those not loaded yet keep their place
+        auto& queue = player.loadedChunks;
+        const Chunk* chunks[CHUNKS_PER_PACKET];
+        size_t count = 0;
+        size_t kept = 0;
+        size_t i = 0;
+        for (; i < queue.size() && count < CHUNKS_PER_PACKET; ++i) {
+            if (Chunk* chunk = provider->getChunkIfLoaded(queue[i].chunkX, queue[i].chunkZ)) {
+                chunks[count++] = chunk;
+            } else {
+                queue[kept++] = queue[i];
+            }
+        }
+        if (count == 0) break;
+        queue.erase(queue.begin() + static_cast<std::ptrdiff_t>(kept),
+                    queue.begin() + static_cast<std::ptrdiff_t>(i));
+
+        Job job;
+        job.session = it->second;
+        job.bulk.hasSkyLight = !world.hasNoSky();
+        // Unchanged chunks reuse their deflated payload; only the rest is copied
+        std::shared_ptr<const ChunkPayload> cached[CHUNKS_PER_PACKET];
+        size_t rawSize = 0;
+        for (size_t c = 0; c < count; ++c) {
+            cached[c] = ChunkSerializer::cachedPayload(*chunks[c], job.bulk.hasSkyLight);
+            if (!cached[c]) rawSize += ChunkSerializer::extractedSize(*chunks[c], true, job.bulk.hasSkyLight);
+        }
+        job.bulk.raw.reserve(rawSize);
+        job.bulk.entries.reserve(count);
+        for (size_t c = 0; c < count; ++c) {
+            ChunkSerializer::appendToBulk(job.bulk, *chunks[c], std::move(cached[c]));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            for (const auto& e : job.bulk.entries) {
+                int64_t key = chunkKey(e.chunkX, e.chunkZ);
+                ++session.inFlight[key];
+                // Watched again before its unload went out: the new data replaces it
+                session.pendingUnloads.erase(
+                    std::remove(session.pendingUnloads.begin(), session.pendingUnloads.end(), key),
+                    session.pendingUnloads.end());
+            }
+        }
+        session.packetsInFlight.fetch_add(1, std::memory_order_acq_rel);
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            queue_.push_back(std::move(job));
+        }
+        queueCv_.notify_one();
+    }
+}
+
+void ChunkSendPipeline::unwatchChunk(int32_t playerId, int32_t chunkX, int32_t chunkZ) {
+    auto it = sessions_.find(playerId);
+    if (it == sessions_.end()) return;
+    Session& session = *it->second;
+
+    std::lock_guard<std::mutex> lock(session.mutex);
+    int64_t key = chunkKey(chunkX, chunkZ);
+    if (session.inFlight.count(key)) {
+        session.pendingUnloads.push_back(key);
+        return;
+    }
+    session.conn->sendPacket(ChunkSerializer::buildUnloadChunkPacket(chunkX, chunkZ),
+                             PacketPriority::Bulk);
+}
+
+void ChunkSendPipeline::sendChunkUpdate(WorldServer& world, const PlayerInstance& instance,
+                                        const std::vector<int32_t>& recipients) {
+    const Chunk* chunk = world.getChunkProvider()->getChunkIfLoaded(instance.chunkX, instance.chunkZ);
+    if (!chunk || instance.numBlocksToUpdate == 0) return;
+
+    // Java: PlayerInstance.sendChunkUpdate — one packet for all watchers
+    PacketBuffer packet;
+    if (instance.numBlocksToUpdate == 1) {
+        int32_t location = instance.pendingUpdates[0];
+        int32_t x = location >> 12 & 15, z = location >> 8 & 15, y = location & 255;
+        packet = PacketBuilder::blockChange(instance.chunkX * 16 + x, static_cast<uint8_t>(y),
+                                            instance.chunkZ * 16 + z,
+                                            chunk->getBlockId(x, y, z),
+                                            static_cast<uint8_t>(chunk->getBlockMetadata(x, y, z)));
+        blockChanges_.fetch_add(1, std::memory_order_relaxed);
+    } else if (instance.numBlocksToUpdate < PlayerInstance::MAX_TRACKED_CHANGES) {
+        int32_t records[PlayerInstance::MAX_TRACKED_CHANGES];
+        for (int32_t i = 0; i < instance.numBlocksToUpdate; ++i) {
+            int32_t location = instance.pendingUpdates[i];
+            int32_t x = location >> 12 & 15, z = location >> 8 & 15, y = location & 255;
+            int32_t blockId = chunk->getBlockId(x, y, z);
+            records[i] = (location & 0xFFFF) << 16 |
+                         (blockId & 4095) << 4 | (chunk->getBlockMetadata(x, y, z) & 15);
+        }
+        packet = PacketBuilder::multiBlockChange(instance.chunkX, instance.chunkZ, records,
+                                                 static_cast<size_t>(instance.numBlocksToUpdate));
+        multiBlockChanges_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // Rare enough to deflate here, at the level the workers currently use
+        DeflateSettings settings = policy_.settingsFor(serverLoad_.load(std::memory_order_relaxed));
+        packet = ChunkSerializer::buildChunkDataPacket(*chunk, false, !world.hasNoSky(),
+                                                       instance.sectionsToUpdate, settings);
+        sectionResends_.fetch_add(1, std::memory_order_relaxed);
+    }
+    SharedPacket shared = sharePacket(std::move(packet));
+
+    int64_t key = chunkKey(instance.chunkX, instance.chunkZ);
+    for (int32_t playerId : recipients) {
+        auto it = sessions_.find(playerId);
+        if (it == sessions_.end()) continue;
+        Session& session = *it->second;
+
+        std::lock_guard<std::mutex> lock(session.mutex);
+        if (session.inFlight.count(key)) {
+            session.pendingUpdates.emplace_back(key, shared);
+            continue;
+        }
+        session.conn->sendPacket(shared, PacketPriority::Bulk);
+    }
+}
+
+// ─── Workers ────────────────────────────────────────────────────────────────
+
+void ChunkSendPipeline::workerLoop() {
+    for (;;) {
+        Job job;
+        size_t backlog;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueCv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            backlog = queue_.size();
+        }
+        runJob(job, backlog);
+    }
+}
+
+void ChunkSendPipeline::runJob(Job& job, size_t backlog) {
+    Session& session = *job.session;
+    if (session.closed.load(std::memory_order_acquire)) return;
+
+    // Two queued packets per worker count as saturated
+    double pressure = std::max(serverLoad_.load(std::memory_order_relaxed),
+                               static_cast<double>(backlog) / (2.0 * threadCount_));
+    DeflateSettings settings = policy_.settingsFor(pressure);
+    deflateLevel_.store(settings.level, std::memory_order_relaxed);
+
+    auto start = std::chrono::steady_clock::now();
+    PacketBuffer packet = ChunkSerializer::buildBulkChunkPacket(job.bulk, settings);
+    packet.finishFrame();
+    workerNanos_.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+
+    chunks_.fetch_add(job.bulk.entries.size(), std::memory_order_relaxed);
+    packets_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t rawBytes = 0;
+    for (const auto& e : job.bulk.entries) rawBytes += e.rawSize;
+    rawBytes_.fetch_add(rawBytes, std::memory_order_relaxed);
+    packetBytes_.fetch_add(packet.size(), std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(session.mutex);
+        session.conn->sendPacket(std::move(packet));
+
+        // Block changes and unloads that waited for this packet go right
+        // behind it, in that order
+        for (const auto& e : job.bulk.entries) {
+            int64_t key = chunkKey(e.chunkX, e.chunkZ);
+            auto it = session.inFlight.find(key);
+            if (it == session.inFlight.end() || --it->second > 0) continue;
+            session.inFlight.erase(it);
+
+            if (!session.pendingUpdates.empty()) {
+                auto& updates = session.pendingUpdates;
+                size_t kept = 0;
+                for (auto& update : updates) {
+                    if (update.first == key) session.conn->sendPacket(update.second, PacketPriority::Bulk);
+                    else updates[kept++] = std::move(update);
+                }
+                updates.erase(updates.begin() + static_cast<std::ptrdiff_t>(kept), updates.end());
+            }
+
+            auto pending = std::find(session.pendingUnloads.begin(), session.pendingUnloads.end(), key);
+            if (pending != session.pendingUnloads.end()) {
+                session.pendingUnloads.erase(pending);
+                session.conn->sendPacket(ChunkSerializer::buildUnloadChunkPacket(e.chunkX, e.chunkZ),
+                                         PacketPriority::Bulk);
+            }
+        }
+    }
+    session.packetsInFlight.fetch_sub(1, std::memory_order_acq_rel);
+
+    // Don't wait for the end-of-tick flush
+    session.conn->flush();
+}
+
+ChunkSendStats ChunkSendPipeline::getStats() const {
+    ChunkSendStats stats;
+    stats.chunks = chunks_.load(std::memory_order_relaxed);
+    stats.packets = packets_.load(std::memory_order_relaxed);
+    stats.rawBytes = rawBytes_.load(std::memory_order_relaxed);
+    stats.packetBytes = packetBytes_.load(std::memory_order_relaxed);
+    stats.workerNanos = workerNanos_.load(std::memory_order_relaxed);
+    stats.deflateLevel = deflateLevel_.load(std::memory_order_relaxed);
+    stats.blockChanges = blockChanges_.load(std::memory_order_relaxed);
+    stats.multiBlockChanges = multiBlockChanges_.load(std::memory_order_relaxed);
+    stats.sectionResends = sectionResends_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    stats.queuedPackets = queue_.size();
+    return stats;
+}
+
+} // namespace mccpp
@@ -12,11 +12,21 @@
 
 #include "server/MinecraftServer.h"
 #include "block/Block.h"
+#include "command/CommandSystem.h"
 #include "item/Item.h"
 #include "crafting/Crafting.h"
+#include "networking/AesCfb8.h"
+#include "networking/ChunkPayloadCache.h"
 #include "networking/Connection.h"
+#include "networking/CryptManager.h"
+#include "networking/PacketCapture.h"
+#include "networking/PacketBuffer.h"
+#include "networking/PacketBuilder.h"
 #include "networking/PacketHandler.h"
+#include "networking/SessionAuthenticator.h"
 #include "networking/TcpListener.h"
+#include "server/ChunkSendPipeline.h"
+#include "types/Chat.h"
 #include "world/World.h"
 
 #include <algorithm>
@@ -24,10 +34,34 @@
 
 namespace mccpp {
 
+namespace {
+
+/**
+ * The server console as a command sender: output goes to stdout.
+ * Java reference: DedicatedServer as ICommandSender ("Server", permission 4)
+ */
+class ConsoleCommandSender : public ICommandSender {
+public:
+    std::string getCommandSenderName() const override { return "Server"; }
+    void addChatMessage(const std::string& message) override { std::cout << message << "\n"; }
+    bool canCommandSenderUseCommand(int32_t, const std::string&) const override { return true; }
+};
+
+} // anonymous namespace
+
 MinecraftServer::MinecraftServer() = default;
 
 MinecraftServer::~MinecraftServer() {
     stop();
+    // Connections reference their event loop; drop them (and the chunk
+    // senders holding them) before the reactor.
+    chunkSender_.reset();
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        connections_.clear();
+    }
+    listener_.reset();
+    reactor_.reset();
 }
 
 bool MinecraftServer::init() {
@@ -35,14 +69,54 @@ bool MinecraftServer::init() {
     std::cout << "[Server] Game version: " << GAME_VERSION
               << " (Protocol " << PROTOCOL_VERSION << ")\n";
 
+    // Java reference: DedicatedServer.startServer() — "Generating keypair"
+    if (onlineMode_) {
+        std::cout << "[Server] Generating keypair\n";
+        keyPair_ = ServerKeyPair::generate();
+        if (!keyPair_) {
+            std::cerr << "[Server] Failed to generate RSA key pair\n";
+            return false;
+        }
+        if (!authenticator_) {
+            authenticator_ = std::make_shared<HttpSessionAuthenticator>();
+        }
+        std::cout << "[Server] Online mode: protocol encryption AES-128/CFB8 ("
+                  << AesCfb8::backendName(AesCfb8::defaultBackend()) << ")\n";
+    } else {
+        // Java: "**** SERVER IS RUNNING IN OFFLINE/INSECURE MODE!"
+        std::cout << "[Server] **** SERVER IS RUNNING IN OFFLINE/INSECURE MODE!\n";
+    }
+
+    if (!captureFile_.empty()) {
+        capture_ = PacketCapture::create(captureFile_);
+        if (!capture_) {
+            std::cerr << "[Server] Cannot open capture file " << captureFile_ << "\n";
+            return false;
+        }
+        std::cout << "[Server] Capturing inbound packets to " << captureFile_ << "\n";
+    }
+
+    // Start the network I/O threads before accepting anything
+    // Java reference: NetworkSystem.eventLoops
+    reactor_ = std::make_unique<NetworkReactor>(
+        networkThreads_ > 0 ? networkThreads_ : NetworkReactor::defaultThreadCount());
+    if (!reactor_->start()) {
+        std::cerr << "[Server] Failed to start network I/O threads\n";
+        return false;
+    }
+
     // Create and configure the TCP listener
     listener_ = std::make_unique<TcpListener>(bindAddress_, port_);
+    listener_->setConnectionRateLimit(connectionRate_, connectionBurst_);
     listener_->setAcceptCallback(
         [this](int fd, const std::string& addr, uint16_t port) {
             onClientAccepted(fd, addr, port);
         }
     );
 
+    // The server list can be queried as soon as the port is open
+    refreshStatusResponse(0);
+
     // Start listening
     if (!listener_->start()) {
         std::cerr << "[Server] Failed to start TCP listener on "
@@ -65,12 +139,46 @@ bool MinecraftServer::init() {
     CraftingManager::getInstance();
     FurnaceRecipes::instance();
 
+    // Java reference: ServerCommandManager, created with the server
+    commandHandler_ = std::make_unique<CommandHandler>();
+    commandHandler_->registerCommand(std::make_shared<CommandSaveAll>([this] { return saveAllWorlds(true); }));
+
     // Initialize worlds
     // Java reference: MinecraftServer.h() — creates WorldServer for each dimension
     auto overworld = std::make_unique<WorldServer>(0, "world");
+    if (!worldDirectory_.empty()) {
+        // Before the spawn area is prepared, so it comes from disk
+        auto loader = std::make_unique<AnvilChunkLoader>(worldDirectory_, chunkIo_);
+        loader->start();
+        std::cout << "[Server] World directory " << worldDirectory_ << ", chunk I/O threads: "
+                  << loader->getThreadCount() << ", sync " << chunkSyncPolicyName(chunkIo_.sync);
+        if (chunkIo_.sync == ChunkSyncPolicy::Periodic) std::cout << " every " << chunkIo_.syncIntervalMs << " ms";
+        std::cout << ", " << regionIoModeName(chunkIo_.ioMode) << " writes\n";
+        overworld->getChunkProvider()->setChunkLoader(std::move(loader));
+    }
     overworld->initialize();
     worlds_.push_back(std::move(overworld));
 
+    // Chunk packets for players are deflated off the tick thread
+    chunkSender_ = std::make_unique<ChunkSendPipeline>(
+        chunkSendThreads_ > 0 ? chunkSendThreads_ : ChunkSendPipeline::defaultThreadCount());
+    chunkSender_->setPolicy(chunkCompression_);
+    chunkSender_->start();
+    for (auto& world : worlds_) {
+        world->getPlayerManager().onUnwatchChunk = [this](int32_t playerId, int32_t chunkX, int32_t chunkZ) {
+            chunkSender_->unwatchChunk(playerId, chunkX, chunkZ);
+        };
+        world->getPlayerManager().onChunkUpdate = [this, w = world.get()](
+                const PlayerInstance& instance, const std::vector<int32_t>& recipients) {
+            chunkSender_->sendChunkUpdate(*w, instance, recipients);
+        };
+    }
+    std::cout << "[Server] Chunk send threads: " << chunkSender_->getThreadCount() << ", compression "
+              << deflateBackendName(chunkCompression_.backend) << " level "
+              << (chunkCompression_.level == DeflatePolicy::AUTO ? std::string("auto")
+                                                                 : std::to_string(chunkCompression_.level))
+              << "\n";
+
     return true;
 }
 
@@ -79,6 +187,7 @@ void MinecraftServer::run() {
 
     std::cout << "[Server] Starting main tick loop (" << TICKS_PER_SECOND << " TPS)\n";
     std::cout << "[Server] Done! Ready for connections.\n";
+    startConsoleReader();
 
     // Java reference: MinecraftServer.run() — main loop
     auto lastTick = Clock::now();
@@ -121,6 +230,14 @@ void MinecraftServer::run() {
         listener_->stop();
     }
 
+    // Pending session checks still hold connections and handlers that call
+    // back into the server; they see running_ == false and drop their result.
+    joinAuthenticators();
+
+    if (chunkSender_) {
+        chunkSender_->stop();
+    }
+
     // Close all connections
     {
         std::lock_guard<std::mutex> lock(connectionsMutex_);
@@ -130,6 +247,59 @@ void MinecraftServer::run() {
         connections_.clear();
     }
 
+    // Flushes and closes every socket still owned by the event loops
+    if (reactor_) {
+        reactor_->stop();
+    }
+
+    // Java reference: MinecraftServer.stopServer() — "Saving worlds"
+    for (auto& world : worlds_) {
+        AnvilChunkLoader* loader = world->getChunkProvider()->getChunkLoader();
+        if (!loader) continue;
+        std::cout << "[Server] Saving chunks for level '" << world->getWorldName() << "'\n";
+        world->getChunkProvider()->saveChunks(true);
+        loader->stop();
+        ChunkIoStats io = loader->getStats();
+        std::cout << "[Server] Chunk I/O: " << io.savesQueued << " saves (" << io.savesCoalesced
+                  << " coalesced), " << io.chunksWritten << " chunks written in " << io.batches
+                  << " batches (" << (io.bytesWritten >> 20) << " MiB), " << io.syncs << " syncs, "
+                  << io.loadsDisk << " loaded from disk";
+        if (io.writeFailures) std::cout << ", " << io.writeFailures << " failed";
+        std::cout << "\n";
+    }
+
+    if (capture_) {
+        capture_->flush();
+        std::cout << "[Server] Captured " << capture_->getRecordedFrames() << " packets ("
+                  << capture_->getRecordedBytes() / 1024 << " KiB) to " << captureFile_ << "\n";
+    }
+    if (int ticks = getTickCount()) {
+        std::cout << "[Server] Tick time over " << ticks << " ticks: mean "
+                  << tickTimeTotalNs_ / 1e6 / ticks << " ms, max " << tickTimeMaxNs_ / 1e6 << " ms\n";
+    }
+    if (chunkSender_) {
+        ChunkSendStats chunks = chunkSender_->getStats();
+        ChunkPayloadCacheStats cache = ChunkPayloadCache::getStats();
+        std::cout << "[Server] Chunks sent: " << chunks.chunks << " in " << chunks.packets << " packets, "
+                  << chunks.workerNanos / 1000000 << " ms on workers; payload cache "
+                  << static_cast<int>(cache.hitRate() * 100.0) << "% hits, ~"
+                  << cache.savedNanos() / 1000000 << " ms deflate saved\n";
+        std::cout << "[Server] Block updates sent: " << chunks.blockChanges << " single, "
+                  << chunks.multiBlockChanges << " multi-block, " << chunks.sectionResends
+                  << " section resends\n";
+    }
+    size_t loadedChunks = 0, chunkBytes = 0;
+    for (const auto& world : worlds_) {
+        for (Chunk* chunk : world->getChunkProvider()->getLoadedChunks()) {
+            chunkBytes += chunk->getMemoryUsage();
+            ++loadedChunks;
+        }
+    }
+    if (loadedChunks) {
+        std::cout << "[Server] Loaded chunks: " << loadedChunks << ", " << chunkBytes / 1024 << " KiB ("
+                  << chunkBytes / loadedChunks << " bytes each)\n";
+    }
+
     std::cout << "[Server] Server stopped.\n";
 }
 
@@ -137,10 +307,35 @@ void MinecraftServer::stop() {
     running_.store(false, std::memory_order_release);
 }
 
-int MinecraftServer::getOnlinePlayerCount() const {
-    std::lock_guard<std::mutex> lock(connectionsMutex_);
-    return static_cast<int>(std::count_if(connections_.begin(), connections_.end(),
-        [](const auto& c) { return c->getState() == ConnectionState::Play; }));
+bool MinecraftServer::startAuthenticator(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(authMutex_);
+    if (authStopped_) return false;
+
+    for (auto it = authThreads_.begin(); it != authThreads_.end();) {
+        if (it->done.load(std::memory_order_acquire)) {
+            it->thread.join();
+            it = authThreads_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    AuthThread& worker = authThreads_.emplace_back();
+    worker.thread = std::thread([task = std::move(task), &done = worker.done] {
+        task();
+        done.store(true, std::memory_order_release);
+    });
+    return true;
+}
+
+void MinecraftServer::joinAuthenticators() {
+    std::list<AuthThread> threads;
+    {
+        std::lock_guard<std::mutex> lock(authMutex_);
+        authStopped_ = true;
+        threads.swap(authThreads_);
+    }
+    for (auto& worker : threads) worker.thread.join();
 }
 
 void MinecraftServer::addConnection(std::shared_ptr<Connection> conn) {
@@ -148,6 +343,34 @@ void MinecraftServer::addConnection(std::shared_ptr<Connection> conn) {
     connections_.push_back(std::move(conn));
 }
 
+void MinecraftServer::broadcastPacket(SharedPacket packet) {
+    // Every recipient queues a reference to the same frame; nothing is copied.
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    for (auto& conn : connections_) {
+        if (conn->getState() == ConnectionState::Play) {
+            conn->sendPacket(packet);
+        }
+    }
+}
+
+void MinecraftServer::addPlayer(int32_t entityId, std::shared_ptr<Connection> conn) {
+    players_[entityId] = std::move(conn);
+}
+
+void MinecraftServer::removePlayer(int32_t entityId) {
+    players_.erase(entityId);
+}
+
+void MinecraftServer::sendToAllNearExcept(WorldServer& world, double x, double y, double z,
+                                          double distance, const SharedPacket& packet,
+                                          int32_t excludeEntityId) {
+    world.getPlayerManager().getPlayersNear(x, y, z, distance, excludeEntityId, nearbyPlayers_);
+    for (int32_t playerId : nearbyPlayers_) {
+        auto it = players_.find(playerId);
+        if (it != players_.end()) it->second->sendPacket(packet);
+    }
+}
+
 void MinecraftServer::removeConnection(Connection* conn) {
     std::lock_guard<std::mutex> lock(connectionsMutex_);
     connections_.erase(
@@ -159,18 +382,49 @@ void MinecraftServer::removeConnection(Connection* conn) {
 
 void MinecraftServer::tick() {
     int ticks = tickCount_.fetch_add(1, std::memory_order_relaxed);
+    auto tickStart = Clock::now();
 
     // Java reference: MinecraftServer.u() — per-tick processing
 
-    // Clean up dead connections
+    // Clean up dead connections, count players and find connections that
+    // are taking too long to get through the handshake or login
+    int online = 0;
+    std::vector<std::shared_ptr<Connection>> timedOut;
+    std::vector<std::shared_ptr<Connection>> removed;
     {
+        auto now = Clock::now();
         std::lock_guard<std::mutex> lock(connectionsMutex_);
-        connections_.erase(
-            std::remove_if(connections_.begin(), connections_.end(),
-                [](const auto& c) { return !c->isConnected(); }),
-            connections_.end()
-        );
+        auto dead = std::stable_partition(connections_.begin(), connections_.end(),
+            [](const auto& c) { return c->isConnected(); });
+        removed.assign(std::make_move_iterator(dead), std::make_move_iterator(connections_.end()));
+        connections_.erase(dead, connections_.end());
+        for (auto& conn : connections_) {
+            ConnectionState state = conn->getState();
+            if (state == ConnectionState::Play) {
+                ++online;
+                continue;
+            }
+            int timeoutMs = (state == ConnectionState::Login) ? LOGIN_TIMEOUT_MS : HANDSHAKE_TIMEOUT_MS;
+            if (now - conn->getConnectedAt() > std::chrono::milliseconds(timeoutMs)) {
+                timedOut.push_back(conn);
+            }
+        }
+    }
+    for (auto& conn : removed) {
+        conn->notifyRemoved();
+    }
+    for (auto& conn : timedOut) {
+        // Java: "Took too long to log in"
+        conn->disconnect(conn->getState() == ConnectionState::Login ? "Took too long to log in"
+                                                                    : "Timed out");
     }
+    onlinePlayers_.store(online, std::memory_order_relaxed);
+    if (online != statusPlayers_) {
+        refreshStatusResponse(online);
+    }
+
+    // Java reference: DedicatedServer.updateTimeLightAndEntities() → executePendingCommands()
+    executePendingCommands();
 
     // Tick all worlds
     // Java reference: MinecraftServer.u() — tickWorlds
@@ -178,18 +432,192 @@ void MinecraftServer::tick() {
         world->tick();
     }
 
+    // Java reference: MinecraftServer.tick() — autosave every 900 ticks,
+    // here spread over ticks (SAVE_BATCH chunks per world each) so no tick
+    // serializes the whole world; the chunk I/O threads do the writing
+    if (ticks > 0 && ticks % AUTOSAVE_TICKS == 0) {
+        autosaving_ = true;
+    }
+    if (autosaving_) {
+        autosaving_ = false;
+        for (auto& world : worlds_) {
+            if (world->getChunkProvider()->saveChunks(false) == ChunkProviderServer::SAVE_BATCH) {
+                autosaving_ = true;
+            }
+        }
+    }
+
+    // Java reference: MinecraftServer.updateTimeLightAndEntities() — the
+    // network tick runs after the worlds, then everything queued is flushed
+    processReceivedPackets();
+    flushConnections();
+
+    // Java reference: MinecraftServer.tick() — tickTimeArray[tickCounter % 100]
+    int64_t tickNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - tickStart).count();
+    tickTimesNs_[ticks % TICK_TIME_SAMPLES] = tickNs;
+    tickTimeTotalNs_ += tickNs;
+    tickTimeMaxNs_ = std::max(tickTimeMaxNs_, tickNs);
+    if (chunkSender_) {
+        chunkSender_->setServerLoad(static_cast<double>(tickNs) / (MS_PER_TICK * 1e6));
+    }
+
     // Periodic status logging (every 6000 ticks = 5 minutes)
     if (ticks > 0 && ticks % 6000 == 0) {
+        auto stats = getNetworkWriteStats();
+        uint64_t syscalls = stats.syscalls - reportedWriteStats_.syscalls;
+        uint64_t bytes = stats.bytes - reportedWriteStats_.bytes;
+        uint64_t frames = stats.frames - reportedWriteStats_.frames;
+        reportedWriteStats_ = stats;
+
+        auto pool = PacketBufferPool::getStats();
+        double reuse = pool.acquired ? 100.0 * pool.reused / pool.acquired : 0.0;
+
         std::lock_guard<std::mutex> lock(connectionsMutex_);
+        size_t backlog = 0, maxBacklog = 0, throttled = 0;
+        for (auto& conn : connections_) {
+            OutboundQueueStats q = conn->getOutboundStats();
+            size_t bytes = q.bytesInFlight;
+            for (size_t c = 0; c < PRIORITY_CLASSES; ++c) bytes += q.queuedBytes[c];
+            backlog += bytes;
+            maxBacklog = std::max(maxBacklog, bytes);
+            if (q.bulkThrottled) ++throttled;
+        }
         std::cout << "[Server] Tick " << ticks
-                  << " | Connections: " << connections_.size() << "\n";
+                  << " | MSPT: " << getAverageTickMillis() << " (max " << getMaxTickMillis() << ")"
+                  << " | Connections: " << connections_.size()
+                  << " | Writes/tick: " << (syscalls / 6000.0)
+                  << " | Bytes/write: " << (syscalls ? bytes / syscalls : 0)
+                  << " | Packets/write: " << (syscalls ? static_cast<double>(frames) / syscalls : 0.0)
+                  << " | Packet buffer reuse: " << reuse << "%"
+                  << " | Outbound backlog: " << (backlog / 1024) << " KiB (max "
+                  << (maxBacklog / 1024) << " KiB, " << throttled << " throttled)"
+                  << " | Rejected connections: " << (listener_ ? listener_->getRejectedCount() : 0);
+        if (chunkSender_) {
+            ChunkSendStats chunks = chunkSender_->getStats();
+            std::cout << " | Chunks sent: " << chunks.chunks << " in " << chunks.packets << " packets ("
+                      << (chunks.rawBytes >> 20) << " MiB -> " << (chunks.packetBytes >> 20) << " MiB, "
+                      << chunks.workerNanos / 1000000 << " ms on workers, "
+                      << chunks.queuedPackets << " queued, level " << chunks.deflateLevel << ")";
+            ChunkPayloadCacheStats cache = ChunkPayloadCache::getStats();
+            std::cout << " | Chunk cache: " << static_cast<int>(cache.hitRate() * 100.0) << "% hits ("
+                      << cache.hits << "/" << (cache.hits + cache.misses) << "), ~"
+                      << cache.savedNanos() / 1000000 << " ms deflate saved";
+        }
+        std::cout << "\n";
+    }
+}
+
+void MinecraftServer::processReceivedPackets() {
+    // Snapshot so handlers may add/remove connections without deadlocking
+    std::vector<std::shared_ptr<Connection>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        snapshot = connections_;
+    }
+    for (auto& conn : snapshot) {
+        conn->processReceivedPackets(MAX_PACKETS_PER_TICK);
+    }
+}
+
+void MinecraftServer::flushConnections() {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    for (auto& conn : connections_) {
+        conn->flush();
+    }
+}
+
+WorldServer* MinecraftServer::worldServerForDimension(int dimension) {
+    for (auto& world : worlds_) {
+        if (world->getDimensionId() == dimension) return world.get();
     }
+    return nullptr;
+}
+
+double MinecraftServer::getAverageTickMillis() const {
+    int samples = std::min(getTickCount(), TICK_TIME_SAMPLES);
+    if (samples == 0) return 0.0;
+    int64_t total = 0;
+    for (int i = 0; i < samples; ++i) total += tickTimesNs_[i];
+    return total / 1e6 / samples;
+}
+
+double MinecraftServer::getMaxTickMillis() const {
+    int samples = std::min(getTickCount(), TICK_TIME_SAMPLES);
+    int64_t worst = 0;
+    for (int i = 0; i < samples; ++i) worst = std::max(worst, tickTimesNs_[i]);
+    return worst / 1e6;
+}
+
+bool MinecraftServer::saveAllWorlds(bool flush) {
+    bool ok = true;
+    for (auto& world : worlds_) {
+        ChunkProviderServer* provider = world->getChunkProvider();
+        AnvilChunkLoader* loader = provider->getChunkLoader();
+        if (!loader) continue;
+        provider->saveChunks(true);
+        if (flush) ok &= loader->flushAllPending();
+    }
+    return ok;
+}
+
+void MinecraftServer::addPendingCommand(const std::string& command) {
+    std::lock_guard<std::mutex> lock(pendingCommands_->mutex);
+    pendingCommands_->commands.push_back(command);
+}
+
+void MinecraftServer::executePendingCommands() {
+    std::vector<std::string> commands;
+    {
+        std::lock_guard<std::mutex> lock(pendingCommands_->mutex);
+        commands.swap(pendingCommands_->commands);
+    }
+    if (commands.empty() || !commandHandler_) return;
+
+    ConsoleCommandSender console;
+    for (const auto& command : commands) {
+        commandHandler_->executeCommand(console, command);
+    }
+}
+
+void MinecraftServer::startConsoleReader() {
+    // Detached like vanilla's daemon console thread: it blocks in getline()
+    // and ends at EOF (e.g. stdin redirected from /dev/null).
+    std::thread([pending = pendingCommands_] {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line.empty()) continue;
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            pending->commands.push_back(line);
+        }
+    }).detach();
+}
+
+void MinecraftServer::refreshStatusResponse(int online) {
+    // Java reference: NetHandlerStatusServer.processServerQuery() serializes
+    // MinecraftServer's ServerStatusResponse; here it is serialized once per
+    // change and every Status Request queues the same frame.
+    std::string json = R"({"version":{"name":")" +
+        std::string(GAME_VERSION) +
+        R"(","protocol":)" + std::to_string(PROTOCOL_VERSION) +
+        R"(},"players":{"max":)" + std::to_string(maxPlayers_) +
+        R"(,"online":)" + std::to_string(online) +
+        R"(},"description":)" + ChatComponent::of(motd_).toJson() + "}";
+
+    PacketWriter w(StatusPacket::Response, json.size() + 8);
+    w.writeString(json);
+    std::atomic_store(&statusResponse_, sharePacket(w.finish()));
+    statusPlayers_ = online;
+}
+
+NetworkWriteStats MinecraftServer::getNetworkWriteStats() const {
+    return reactor_ ? reactor_->getWriteStats() : NetworkWriteStats{};
 }
 
 void MinecraftServer::onClientAccepted(int fd, const std::string& address, uint16_t port) {
     auto conn = std::make_shared<Connection>(fd, address, port);
     auto handler = std::make_shared<HandshakeHandler>(*this);
-    conn->start(handler);
+    if (capture_) conn->setCapture(capture_);
+    conn->start(handler, reactor_->nextLoop());
     addConnection(conn);
 }
 
@@ -0,0 +1,179 @@
+/**
+ * PacketReplay.cpp — Capture replay driver.
+ */
+
+#include "server/PacketReplay.h"
+#include "server/MinecraftServer.h"
+#include "types/VarInt.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace mccpp {
+
+PacketReplay::PacketReplay(MinecraftServer& server, std::vector<CaptureRecord> records, double speed)
+    : server_(server), records_(std::move(records)), speed_(speed) {}
+
+PacketReplay::~PacketReplay() {
+    stop();
+}
+
+void PacketReplay::start(bool stopServerWhenDone) {
+    stopServer_ = stopServerWhenDone;
+    thread_ = std::thread([this] { run(); });
+}
+
+void PacketReplay::stop() {
+    stopping_.store(true, std::memory_order_release);
+    if (thread_.joinable()) thread_.join();
+}
+
+void PacketReplay::run() {
+    using Clock = std::chrono::steady_clock;
+
+    // Connections adopted before run() would race the first tick's cleanup
+    while (!server_.isRunning() && !stopping_.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::cout << "[Replay] Playing " << records_.size() << " records at ";
+    if (speed_ > 0) std::cout << speed_ << "x speed\n";
+    else std::cout << "full speed\n";
+
+    auto start = Clock::now();
+    size_t sessionsOpened = 0;
+
+    for (const auto& record : records_) {
+        if (stopping_.load(std::memory_order_acquire)) break;
+
+        if (speed_ > 0) {
+            auto due = start + std::chrono::microseconds(static_cast<int64_t>(record.micros / speed_));
+            while (Clock::now() < due && !stopping_.load(std::memory_order_acquire)) {
+                drainResponses();
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(due - Clock::now());
+                std::this_thread::sleep_for(std::min(wait, std::chrono::milliseconds(5)));
+            }
+        }
+
+        switch (record.type) {
+            case CaptureRecordType::Open: {
+                int fds[2];
+                if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) < 0) {
+                    std::cerr << "[Replay] socketpair failed: " << std::strerror(errno) << "\n";
+                    break;
+                }
+                sessions_[record.session] = fds[0];
+                server_.adoptConnection(fds[1], "replay/" + record.address, 0);
+                ++sessionsOpened;
+                break;
+            }
+            case CaptureRecordType::Frame: {
+                auto it = sessions_.find(record.session);
+                if (it != sessions_.end() && !writeFrame(it->second, record.frame)) {
+                    closeSession(record.session);
+                }
+                break;
+            }
+            case CaptureRecordType::Close:
+                // Without delays the server could not handle the session's
+                // queued Play packets before seeing the close; close at the end
+                if (speed_ > 0) closeSession(record.session);
+                break;
+        }
+        drainResponses();
+    }
+
+    // Let the server work through what was sent before closing what is left
+    auto settleUntil = Clock::now() + std::chrono::milliseconds(SETTLE_MS);
+    while (Clock::now() < settleUntil && !stopping_.load(std::memory_order_acquire)) {
+        drainResponses();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    while (!sessions_.empty()) closeSession(sessions_.begin()->first);
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    double captured = records_.empty() ? 0.0 : records_.back().micros / 1e6;
+    std::cout << "[Replay] Done: " << sessionsOpened << " sessions, " << framesSent_ << " frames ("
+              << bytesSent_ / 1024 << " KiB) in " << seconds << " s (captured over " << captured
+              << " s); " << bytesReceived_ / 1024 << " KiB received\n";
+
+    finished_.store(true, std::memory_order_release);
+    if (stopServer_ && !stopping_.load(std::memory_order_acquire)) server_.stop();
+}
+
+bool PacketReplay::writeFrame(int fd, const std::vector<uint8_t>& frame) {
+    uint8_t prefix[5];
+    int prefixLen = writeVarInt(prefix, static_cast<int32_t>(frame.size()));
+
+    iovec iov[2] = {{prefix, static_cast<size_t>(prefixLen)},
+                    {const_cast<uint8_t*>(frame.data()), frame.size()}};
+    size_t total = static_cast<size_t>(prefixLen) + frame.size();
+    size_t written = 0;
+
+    while (written < total) {
+        // Skip what has already been written
+        iovec parts[2];
+        int count = 0;
+        size_t skip = written;
+        for (auto& part : iov) {
+            if (skip >= part.iov_len) { skip -= part.iov_len; continue; }
+            parts[count].iov_base = static_cast<uint8_t*>(part.iov_base) + skip;
+            parts[count].iov_len = part.iov_len - skip;
+            skip = 0;
+            ++count;
+        }
+        msghdr msg{};
+        msg.msg_iov = parts;
+        msg.msg_iovlen = static_cast<size_t>(count);
+        ssize_t n = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return false;   // server closed it
+            if (stopping_.load(std::memory_order_acquire)) return false;
+            // The server is not reading: keep its replies moving and wait
+            drainResponses();
+            pollfd pfd{fd, POLLOUT, 0};
+            ::poll(&pfd, 1, 10);
+            continue;
+        }
+        written += static_cast<size_t>(n);
+    }
+
+    ++framesSent_;
+    bytesSent_ += total;
+    return true;
+}
+
+void PacketReplay::drainResponses() {
+    uint8_t buf[65536];
+    std::vector<uint32_t> closed;
+    for (auto& [session, fd] : sessions_) {
+        for (;;) {
+            ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                bytesReceived_ += static_cast<uint64_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) closed.push_back(session);
+            break;
+        }
+    }
+    for (uint32_t session : closed) closeSession(session);
+}
+
+void PacketReplay::closeSession(uint32_t session) {
+    auto it = sessions_.find(session);
+    if (it == sessions_.end()) return;
+    ::close(it->second);
+    sessions_.erase(it);
+}
+
+} // namespace mccpp
@@ -10,10 +10,8 @@
 
 namespace mccpp {
 
-/**
- * Escape a string for JSON output.
- */
-static std::string jsonEscape(const std::string& str) {
+std::string jsonEscape(const std::string& str) {
+    static const char HEX[] = "0123456789abcdef";
     std::string result;
     result.reserve(str.size() + 8);
     for (char c : str) {
@@ -23,7 +21,16 @@ static std::string jsonEscape(const std::string& str) {
             case '\n': result += "\\n";  break;
             case '\r': result += "\\r";  break;
             case '\t': result += "\\t";  break;
-            default:   result += c;      break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    // Other control characters as \u00XX
+                    result += "\\u00";
+                    result += HEX[(c >> 4) & 0xF];
+                    result += HEX[c & 0xF];
+                } else {
+                    result += c;
+                }
+                break;
         }
     }
     return result;
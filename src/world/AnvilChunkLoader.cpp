@@ -0,0 +1,490 @@
+/**
+ * AnvilChunkLoader.cpp — Pending chunk saves and the chunk I/O worker pool.
+ *
+ * Java references:
+ *   net.minecraft.world.chunk.storage.AnvilChunkLoader
+ *   net.minecraft.world.storage.ThreadedFileIOBase
+ *   net.minecraft.world.chunk.storage.RegionFileCache
+ */
+
+#include "world/AnvilChunkLoader.h"
+#include "nbt/NBT.h"
+
+#include <filesystem>
+#include <iostream>
+
+namespace mccpp {
+
+// ─── Configuration ──────────────────────────────────────────────────────────
+
+bool parseChunkSyncPolicy(const std::string& name, ChunkSyncPolicy& out) {
+    if (name == "none") {
+        out = ChunkSyncPolicy::None;
+    } else if (name == "region") {
+        out = ChunkSyncPolicy::PerRegion;
+    } else if (name == "periodic") {
+        out = ChunkSyncPolicy::Periodic;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* chunkSyncPolicyName(ChunkSyncPolicy policy) {
+    switch (policy) {
+        case ChunkSyncPolicy::None:      return "none";
+        case ChunkSyncPolicy::PerRegion: return "region";
+        case ChunkSyncPolicy::Periodic:  return "periodic";
+    }
+    return "?";
+}
+
+bool parseRegionIoMode(const std::string& name, RegionIoMode& out) {
+    if (name == "sync") {
+        out = RegionIoMode::Sync;
+    } else if (name == "io_uring") {
+        out = RegionIoMode::IoUring;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* regionIoModeName(RegionIoMode mode) {
+    switch (mode) {
+        case RegionIoMode::Sync:    return "sync";
+        case RegionIoMode::IoUring: return "io_uring";
+    }
+    return "?";
+}
+
+int AnvilChunkLoader::defaultThreadCount() {
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    return std::clamp(hw / 4, 1, 4);
+}
+
+AnvilChunkLoader::AnvilChunkLoader(const std::string& dir, const ChunkIoConfig& config)
+    : saveDirectory(dir)
+    , config_(config)
+    , threadCount_(config.threads > 0 ? config.threads : defaultThreadCount())
+    , regionDirectory_(dir + "/region")
+{
+    config_.syncIntervalMs = std::max(1, config_.syncIntervalMs);
+}
+
+AnvilChunkLoader::~AnvilChunkLoader() {
+    stop();
+}
+
+void AnvilChunkLoader::start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+        nextSync_ = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(config_.syncIntervalMs);
+    }
+    workers_.reserve(static_cast<size_t>(threadCount_));
+    for (int i = 0; i < threadCount_; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+void AnvilChunkLoader::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    workCv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    workers_.clear();
+
+    // Whatever the threads left behind is written here
+    flushAllPending();
+
+    std::lock_guard<std::mutex> lock(regionMutex_);
+    for (auto& [key, region] : regions_) region.file->close();
+    regions_.clear();
+    regionLru_.clear();
+    std::lock_guard<std::mutex> pendingLock(mutex_);
+    dirtyRegions_.clear();
+}
+
+// ─── Saving ─────────────────────────────────────────────────────────────────
+
+void AnvilChunkLoader::queueChunkSave(const Chunk& chunk) {
+    // Java: NBTTagCompound root; root.setTag("Level", level). The root is
+    // written around the Level tag so the Level compound is not copied:
+    // TAG_Compound "" { <Level> } TAG_End
+    std::shared_ptr<nbt::NBTTagCompound> level = chunk.writeToNBT();
+    std::vector<uint8_t> nbt = {10, 0, 0};
+    std::vector<uint8_t> body = nbt::serializeNBT(*level, "Level");
+    nbt.insert(nbt.end(), body.begin(), body.end());
+    nbt.push_back(0);
+    queueChunkSave(chunk.xPosition, chunk.zPosition, std::move(nbt));
+}
+
+void AnvilChunkLoader::queueChunkSave(int32_t x, int32_t z, std::vector<uint8_t> nbt) {
+    auto data = std::make_shared<const std::vector<uint8_t>>(std::move(nbt));
+    int64_t key = chunkKey(x, z);
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.savesQueued;
+        PendingSave& entry = pending_[key];
+        if (entry.data) ++stats_.savesCoalesced;
+        entry.data = std::move(data);
+        ++entry.version;
+        // A chunk being written is requeued when that write is done
+        if (!entry.queued && !entry.writing) {
+            entry.queued = true;
+            queue_.push_back(key);
+            wake = true;
+        }
+    }
+    if (wake) workCv_.notify_one();
+}
+
+void AnvilChunkLoader::takeBatchLocked(std::vector<SaveJob>& batch) {
+    batch.clear();
+    while (!queue_.empty() && batch.size() < MAX_BATCH) {
+        int64_t key = queue_.front();
+        queue_.pop_front();
+        PendingSave& entry = pending_[key];
+        entry.queued = false;
+        entry.writing = true;
+        batch.push_back({key, static_cast<int32_t>(key & 0xFFFFFFFF), static_cast<int32_t>(key >> 32),
+                         entry.version, entry.data});
+    }
+    inFlight_ += batch.size();
+}
+
+bool AnvilChunkLoader::writeBatch(std::vector<SaveJob>& batch) {
+    // One writeChunks() call per region, so its writes go out together
+    std::sort(batch.begin(), batch.end(), [](const SaveJob& a, const SaveJob& b) {
+        return std::make_pair(a.z >> 5, a.x >> 5) < std::make_pair(b.z >> 5, b.x >> 5);
+    });
+
+    bool ok = true;
+    uint64_t written = 0, failed = 0, bytes = 0, batches = 0, syncs = 0;
+    std::vector<RegionFile::ChunkWrite> writes;
+    // Regions written without a sync, held until they are marked dirty so
+    // an eviction in between cannot close them unsynced
+    std::vector<std::pair<int64_t, std::shared_ptr<RegionFile>>> touched;
+    for (size_t begin = 0; begin < batch.size();) {
+        int32_t rx = batch[begin].x >> 5;
+        int32_t rz = batch[begin].z >> 5;
+        size_t end = begin;
+        writes.clear();
+        for (; end < batch.size() && batch[end].x >> 5 == rx && batch[end].z >> 5 == rz; ++end) {
+            writes.push_back({batch[end].x & 31, batch[end].z & 31, batch[end].data.get()});
+            bytes += batch[end].data->size();
+        }
+
+        std::shared_ptr<RegionFile> region = getRegion(rx, rz, true);
+        size_t done = region ? region->writeChunks(writes) : 0;
+        ++batches;
+        written += done;
+        if (done < writes.size()) {
+            // Java: ThreadedFileIOBase logs the exception and drops the chunk
+            failed += writes.size() - done;
+            ok = false;
+            std::cerr << "[ChunkIO] " << (writes.size() - done) << " of " << writes.size()
+                      << " chunk writes failed in r." << rx << "." << rz << ".mca\n";
+        }
+        if (region && config_.sync == ChunkSyncPolicy::PerRegion) {
+            if (region->flush(true)) {
+                ++syncs;
+            } else {
+                ok = false;
+                std::cerr << "[ChunkIO] Failed to sync r." << rx << "." << rz << ".mca\n";
+            }
+        } else if (region) {
+            touched.emplace_back(chunkKey(rx, rz), region);
+        }
+        begin = end;
+    }
+
+    // Written chunks leave the pending map unless they were saved again
+    // meanwhile; loads now find them in the region file
+    bool requeued = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const SaveJob& job : batch) {
+            auto it = pending_.find(job.key);
+            it->second.writing = false;
+            if (it->second.version == job.version) {
+                pending_.erase(it);
+            } else {
+                it->second.queued = true;
+                queue_.push_back(job.key);
+                requeued = true;
+            }
+        }
+        inFlight_ -= batch.size();
+        for (const auto& [key, region] : touched) dirtyRegions_.insert(key);
+        stats_.chunksWritten += written;
+        stats_.writeFailures += failed;
+        stats_.bytesWritten += bytes;
+        stats_.batches += batches;
+        stats_.syncs += syncs;
+    }
+    if (requeued) workCv_.notify_one();
+    idleCv_.notify_all();
+    return ok;
+}
+
+void AnvilChunkLoader::workerLoop() {
+    std::vector<SaveJob> batch;
+    for (;;) {
+        bool syncDue = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto ready = [this] { return stopping_ || !queue_.empty(); };
+            if (config_.sync == ChunkSyncPolicy::Periodic) {
+                workCv_.wait_until(lock, nextSync_, ready);
+            } else {
+                workCv_.wait(lock, ready);
+            }
+            if (stopping_) return;
+            // One thread claims each periodic sync
+            auto now = std::chrono::steady_clock::now();
+            if (config_.sync == ChunkSyncPolicy::Periodic && now >= nextSync_) {
+                nextSync_ = now + std::chrono::milliseconds(config_.syncIntervalMs);
+                syncDue = true;
+            }
+            takeBatchLocked(batch);
+        }
+        if (!batch.empty()) writeBatch(batch);
+        if (syncDue) syncDirtyRegions();
+    }
+}
+
+void AnvilChunkLoader::syncDirtyRegions() {
+    // Held until synced, so none of them is evicted meanwhile; a dirty
+    // region evicted before was synced then
+    std::vector<std::shared_ptr<RegionFile>> dirty;
+    {
+        std::lock_guard<std::mutex> regionLock(regionMutex_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int64_t key : dirtyRegions_) {
+            auto it = regions_.find(key);
+            if (it != regions_.end()) dirty.push_back(it->second.file);
+        }
+        dirtyRegions_.clear();
+    }
+    uint64_t syncs = 0;
+    for (const auto& region : dirty) {
+        if (region->flush(true)) {
+            ++syncs;
+        } else {
+            std::cerr << "[ChunkIO] Periodic region sync failed\n";
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.syncs += syncs;
+}
+
+bool AnvilChunkLoader::flushAllPending() {
+    bool ok = true;
+    std::vector<SaveJob> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idleCv_.wait(lock, [this] { return !queue_.empty() || inFlight_ == 0; });
+            if (queue_.empty()) break;
+            takeBatchLocked(batch);
+        }
+        ok &= writeBatch(batch);
+    }
+
+    // Java: RegionFileCache.clearRegionFileReferences() — here the files
+    // stay open; their headers are written, and regions written to since
+    // their last sync are synced unless the policy is None
+    std::unordered_set<int64_t> dirty;
+    uint64_t syncs = 0;
+    {
+        std::lock_guard<std::mutex> regionLock(regionMutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dirty.swap(dirtyRegions_);
+        }
+        for (auto& [key, region] : regions_) {
+            bool sync = config_.sync != ChunkSyncPolicy::None && dirty.count(key);
+            if (!region.file->flush(sync)) {
+                ok = false;
+            } else if (sync) {
+                ++syncs;
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.syncs += syncs;
+    return ok;
+}
+
+// ─── Loading ────────────────────────────────────────────────────────────────
+
+std::shared_ptr<const std::vector<uint8_t>> AnvilChunkLoader::loadChunkData(int32_t x, int32_t z) {
+    // Java: AnvilChunkLoader.loadChunk() — the pending saves first
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(chunkKey(x, z));
+        if (it != pending_.end()) {
+            ++stats_.loadsPending;
+            return it->second.data;
+        }
+    }
+
+    std::shared_ptr<RegionFile> region = getRegion(x >> 5, z >> 5, false);
+    if (!region) return nullptr;
+    auto data = region->readChunkData(x & 31, z & 31);
+    if (!data) return nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.loadsDisk;
+    }
+    return std::make_shared<const std::vector<uint8_t>>(std::move(*data));
+}
+
+std::unique_ptr<Chunk> AnvilChunkLoader::loadChunk(int32_t x, int32_t z) {
+    auto data = loadChunkData(x, z);
+    if (!data) return nullptr;
+
+    // Java reference: AnvilChunkLoader.checkedReadChunkFromNBT()
+    std::unique_ptr<Chunk> chunk;
+    try {
+        auto root = nbt::deserializeNBT(data->data(), data->size());
+        const nbt::NBTTagCompound* level = root ? root->getCompoundTag("Level") : nullptr;
+        if (!level) {
+            std::cerr << "[ChunkIO] Chunk file at " << x << "," << z
+                      << " is missing level data, skipping\n";
+            return nullptr;
+        }
+        if (!level->hasKey("Sections", 9)) {
+            std::cerr << "[ChunkIO] Chunk file at " << x << "," << z
+                      << " is missing block data, skipping\n";
+            return nullptr;
+        }
+        chunk = Chunk::readFromNBT(*level);
+    } catch (const std::exception& e) {
+        std::cerr << "[ChunkIO] Chunk file at " << x << "," << z << " is unreadable: " << e.what() << "\n";
+        return nullptr;
+    }
+
+    if (chunk->xPosition != x || chunk->zPosition != z) {
+        std::cerr << "[ChunkIO] Chunk file at " << x << "," << z
+                  << " is in the wrong location; relocating. (Expected " << x << ", " << z
+                  << ", got " << chunk->xPosition << ", " << chunk->zPosition << ")\n";
+        chunk->xPosition = x;
+        chunk->zPosition = z;
+    }
+    return chunk;
+}
+
+// ─── Region files ───────────────────────────────────────────────────────────
+
+std::shared_ptr<RegionFile> AnvilChunkLoader::getRegion(int32_t rx, int32_t rz, bool create) {
+    // Java reference: RegionFileCache.createOrLoadRegionFile()
+    int64_t key = chunkKey(rx, rz);
+    EvictedRegion evicted;
+    std::shared_ptr<RegionFile> region;
+    {
+        std::unique_lock<std::mutex> lock(regionMutex_);
+        // A region still being closed by an eviction would be opened twice
+        regionClosedCv_.wait(lock, [&] { return closingRegions_.count(key) == 0; });
+        auto it = regions_.find(key);
+        if (it != regions_.end()) {
+            regionLru_.splice(regionLru_.begin(), regionLru_, it->second.lru);
+            return it->second.file;
+        }
+
+        std::string path = regionDirectory_ + "/r." + std::to_string(rx) + "." + std::to_string(rz) + ".mca";
+        std::error_code ec;
+        if (!create && !std::filesystem::exists(path, ec)) return nullptr;
+        if (create) std::filesystem::create_directories(regionDirectory_, ec);
+
+        // Java: clearRegionFileReferences() once 256 files are open; here only
+        // the least recently used one goes
+        if (regions_.size() >= config_.maxOpenRegions) evicted = evictRegionLocked();
+
+        region = std::make_shared<RegionFile>(path, config_.ioMode,
+                                              config_.sync != ChunkSyncPolicy::None);
+        if (region->isOpen()) {
+            regionLru_.push_front(key);
+            regions_.emplace(key, OpenRegion{region, regionLru_.begin()});
+        } else {
+            region.reset();
+        }
+    }
+    // The sync of the evicted region must not stall other getRegion() callers
+    if (evicted.file) closeEvictedRegion(std::move(evicted));
+    return region;
+}
+
+AnvilChunkLoader::EvictedRegion AnvilChunkLoader::evictRegionLocked() {
+    // A region another thread holds stays open: reopening it while that
+    // thread writes would give the file two sector allocators. If all of
+    // them are held, the cache grows past its limit for a while.
+    EvictedRegion evicted;
+    for (auto lru = regionLru_.rbegin(); lru != regionLru_.rend(); ++lru) {
+        auto it = regions_.find(*lru);
+        if (it->second.file.use_count() > 1) continue;
+
+        evicted.key = *lru;
+        evicted.file = std::move(it->second.file);
+        {
+            // Taken together with the removal, so a periodic sync that no
+            // longer finds the region cannot drop its dirty mark meanwhile
+            std::lock_guard<std::mutex> lock(mutex_);
+            evicted.sync = dirtyRegions_.erase(evicted.key) > 0 &&
+                           config_.sync != ChunkSyncPolicy::None;
+        }
+        regionLru_.erase(std::next(lru).base());
+        regions_.erase(it);
+        closingRegions_.insert(evicted.key);
+        break;
+    }
+    return evicted;
+}
+
+void AnvilChunkLoader::closeEvictedRegion(EvictedRegion evicted) {
+    bool synced = evicted.sync && evicted.file->flush(true);
+    if (evicted.sync && !synced) {
+        std::cerr << "[ChunkIO] Failed to sync r." << static_cast<int32_t>(evicted.key & 0xFFFFFFFF) << "."
+                  << static_cast<int32_t>(evicted.key >> 32) << ".mca before closing it\n";
+    }
+    evicted.file->close();
+    evicted.file.reset();
+    if (synced) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.syncs;
+    }
+    {
+        std::lock_guard<std::mutex> lock(regionMutex_);
+        closingRegions_.erase(evicted.key);
+    }
+    regionClosedCv_.notify_all();
+}
+
+// ─── Accessors ──────────────────────────────────────────────────────────────
+
+bool AnvilChunkLoader::hasPendingSave(int32_t x, int32_t z) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.count(chunkKey(x, z)) > 0;
+}
+
+int32_t AnvilChunkLoader::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int32_t>(pending_.size());
+}
+
+ChunkIoStats AnvilChunkLoader::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ChunkIoStats stats = stats_;
+    stats.pending = pending_.size();
+    return stats;
+}
+
+} // namespace mccpp
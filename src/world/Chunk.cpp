@@ -9,34 +9,190 @@
  *   net.minecraft.world.chunk.storage.AnvilChunkLoader
  *
  * Implements:
+ *   - NibbleArray: uniform form, shared constant buffers
+ *   - BlockStateStorage: palette-compressed block IDs + metadata
  *   - ChunkSection: 16x16x16 block storage with nibble arrays
  *   - Chunk: 16 sections + biomes + NBT serialize/deserialize
- *   - RegionFile: Anvil .mca file reader/writer with zlib compression
+ *   - RegionFile: Anvil .mca file reader/writer with zlib compression,
+ *     positional I/O, an optional io_uring batch path, bitmap sector
+ *     allocation and compaction
  */
 
 #include "world/Chunk.h"
+#include "world/IoUring.h"
 
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <cstring>
+#include <fcntl.h>
 #include <iostream>
 #include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // zlib for region file compression
 #include <zlib.h>
 
 namespace mccpp {
 
+// ═════════════════════════════════════════════════════════════════════════════
+// NibbleArray
+// ═════════════════════════════════════════════════════════════════════════════
+
+bool NibbleArray::compact() {
+    if (data_.empty()) return true;
+    if (length_ > MAX_SHARED_BYTES) return false;
+    uint8_t first = data_[0];
+    if ((first >> 4) != (first & 0x0F)) return false;
+    for (uint8_t b : data_) {
+        if (b != first) return false;
+    }
+    uniform_ = first & 0x0F;
+    data_.clear();
+    data_.shrink_to_fit();
+    return true;
+}
+
+const uint8_t* NibbleArray::sharedBytes(int value) {
+    static const auto buffers = [] {
+        std::array<std::array<uint8_t, MAX_SHARED_BYTES>, 16> b{};
+        for (int v = 0; v < 16; ++v) b[v].fill(static_cast<uint8_t>(v * 0x11));
+        return b;
+    }();
+    return buffers[value & 0x0F].data();
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// BlockStateStorage
+// ═════════════════════════════════════════════════════════════════════════════
+
+void BlockStateStorage::setBits(int bits) {
+    bits_ = static_cast<uint8_t>(bits);
+    if (bits == 0) return;
+    bitsLog2_ = static_cast<uint8_t>(bits == 1 ? 0 : bits == 2 ? 1 : bits == 4 ? 2 : bits == 8 ? 3 : 4);
+    wordShift_ = static_cast<uint8_t>(6 - bitsLog2_);
+    slotMask_ = static_cast<uint8_t>((64 >> bitsLog2_) - 1);
+    valueMask_ = (1u << bits) - 1;
+}
+
+void BlockStateStorage::set(int index, uint16_t state) {
+    if (bits_ == 0) {
+        if (state == single_) return;
+        palette_ = {single_, state};
+        setBits(1);
+        words_.assign(SIZE / 64, 0);
+        write(index, 1);
+        return;
+    }
+    if (bits_ == DIRECT_BITS) {
+        write(index, state);
+        return;
+    }
+
+    size_t slot = 0;
+    while (slot < palette_.size() && palette_[slot] != state) ++slot;
+    if (slot == palette_.size()) {
+        if (palette_.size() == (size_t{1} << bits_)) {
+            // Full: re-encode without unused states and with room for this one
+            uint16_t states[SIZE];
+            decode(states);
+            rebuild(states, 1);
+            set(index, state);
+            return;
+        }
+        palette_.push_back(state);
+    }
+    write(index, static_cast<uint32_t>(slot));
+}
+
+void BlockStateStorage::decode(uint16_t* out) const {
+    if (bits_ == 0) {
+        std::fill(out, out + SIZE, single_);
+        return;
+    }
+    const int bits = bits_, perWord = 64 >> bitsLog2_;
+    const uint64_t mask = valueMask_;
+    uint16_t* dst = out;
+    if (bits == DIRECT_BITS) {
+        for (uint64_t word : words_) {
+            for (int i = 0; i < perWord; ++i, word >>= bits) *dst++ = static_cast<uint16_t>(word);
+        }
+        return;
+    }
+    const uint16_t* palette = palette_.data();
+    for (uint64_t word : words_) {
+        for (int i = 0; i < perWord; ++i, word >>= bits) *dst++ = palette[word & mask];
+    }
+}
+
+void BlockStateStorage::rebuild(const uint16_t* states, size_t reserve) {
+    constexpr size_t MAX_PALETTE = size_t{1} << MAX_PALETTE_BITS;
+    std::vector<uint16_t> palette;
+    uint8_t slots[SIZE];
+    bool direct = false;
+    size_t last = 0;
+    for (int i = 0; i < SIZE && !direct; ++i) {
+        uint16_t state = states[i];
+        if (palette.empty() || palette[last] != state) {
+            last = 0;
+            while (last < palette.size() && palette[last] != state) ++last;
+            if (last == palette.size()) {
+                if (palette.size() == MAX_PALETTE) direct = true;
+                else palette.push_back(state);
+            }
+        }
+        slots[i] = static_cast<uint8_t>(last);
+    }
+
+    size_t needed = palette.size() + reserve;
+    palette_.clear();
+    palette_.shrink_to_fit();
+    if (direct || needed > MAX_PALETTE) {
+        setBits(DIRECT_BITS);
+        words_.assign(static_cast<size_t>(SIZE) * DIRECT_BITS / 64, 0);
+        words_.shrink_to_fit();
+        for (int i = 0; i < SIZE; ++i) write(i, states[i]);
+        return;
+    }
+    if (needed == 1) {
+        single_ = palette[0];
+        setBits(0);
+        words_.clear();
+        words_.shrink_to_fit();
+        return;
+    }
+
+    int bits = 1;
+    while ((size_t{1} << bits) < needed) bits <<= 1;
+    setBits(bits);
+    palette_.swap(palette);
+    palette_.shrink_to_fit();
+    words_.assign(static_cast<size_t>(SIZE) * bits / 64, 0);
+    words_.shrink_to_fit();
+    for (int i = 0; i < SIZE; ++i) write(i, slots[i]);
+}
+
+bool BlockStateStorage::hasHighIds() const {
+    if (bits_ == 0) return single_ > 0xFFF;
+    if (bits_ != DIRECT_BITS) {
+        return std::any_of(palette_.begin(), palette_.end(), [](uint16_t s) { return s > 0xFFF; });
+    }
+    for (uint64_t word : words_) {
+        // Any of the four 16-bit states with an ID > 255
+        if (word & 0xF000F000F000F000ull) return true;
+    }
+    return false;
+}
+
 // ═════════════════════════════════════════════════════════════════════════════
 // ChunkSection (ExtendedBlockStorage)
 // ═════════════════════════════════════════════════════════════════════════════
 
 ChunkSection::ChunkSection(int yBase, bool hasSkylight)
     : yBase_(yBase)
-    , metadata_(4096, 4)
     , blocklight_(4096, 4)
 {
-    blockLSB_.fill(0);
     if (hasSkylight) {
         skylight_ = std::make_unique<NibbleArray>(4096, 4);
     }
@@ -44,58 +200,47 @@ ChunkSection::ChunkSection(int yBase, bool hasSkylight)
 
 Block* ChunkSection::getBlock(int x, int y, int z) const {
     // Java: ExtendedBlockStorage.getBlockByExtId(x, y, z)
-    // Index: y << 8 | z << 4 | x
-    int id = blockLSB_[y << 8 | z << 4 | x] & 0xFF;
-    if (blockMSB_) {
-        id |= (blockMSB_->get(x, y, z) << 8);
-    }
-    return Block::getBlockById(id);
+    return Block::getBlockById(blocks_.get(y << 8 | z << 4 | x) >> 4);
 }
 
 void ChunkSection::setBlock(int x, int y, int z, Block* block) {
     // Java: ExtendedBlockStorage.setExtBlockID(x, y, z, block)
     int idx = y << 8 | z << 4 | x;
+    uint16_t old = blocks_.get(idx);
+    int oldId = old >> 4;
+    int newId = block ? Block::getIdFromBlock(block) & 0xFFF : 0;
 
-    // Decrement counts for old block
-    int oldId = blockLSB_[idx] & 0xFF;
-    if (blockMSB_) {
-        oldId |= (blockMSB_->get(x, y, z) << 8);
-    }
-    Block* oldBlock = Block::getBlockById(oldId);
-    if (oldBlock && oldBlock->getMaterial() != Material::Air) {
+    // Ref counts from the property tables: non-air blocks, random tickers
+    if (!BlockProperties::isAir(oldId)) {
         --blockRefCount_;
-        if (oldBlock->getTickRandomly()) {
+        if (BlockProperties::ticksRandomly[oldId]) {
             --tickRefCount_;
         }
     }
-
-    // Increment counts for new block
-    if (block && block->getMaterial() != Material::Air) {
+    if (!BlockProperties::isAir(newId)) {
         ++blockRefCount_;
-        if (block->getTickRandomly()) {
+        if (BlockProperties::ticksRandomly[newId]) {
             ++tickRefCount_;
         }
     }
 
-    int newId = block ? Block::getIdFromBlock(block) : 0;
-    blockLSB_[idx] = static_cast<uint8_t>(newId & 0xFF);
+    // Metadata is kept, as with Java's separate arrays
+    blocks_.set(idx, static_cast<uint16_t>(newId << 4 | (old & 0xF)));
+    ++modCount_;
+}
 
-    if (newId > 255) {
-        if (!blockMSB_) {
-            blockMSB_ = std::make_unique<NibbleArray>(4096, 4);
-        }
-        blockMSB_->set(x, y, z, (newId & 0xF00) >> 8);
-    } else if (blockMSB_) {
-        blockMSB_->set(x, y, z, 0);
-    }
+int ChunkSection::getBlockId(int x, int y, int z) const {
+    return blocks_.get(y << 8 | z << 4 | x) >> 4;
 }
 
 int ChunkSection::getBlockMetadata(int x, int y, int z) const {
-    return metadata_.get(x, y, z);
+    return blocks_.get(y << 8 | z << 4 | x) & 0xF;
 }
 
 void ChunkSection::setBlockMetadata(int x, int y, int z, int meta) {
-    const_cast<NibbleArray&>(metadata_).set(x, y, z, meta);
+    int idx = y << 8 | z << 4 | x;
+    blocks_.set(idx, static_cast<uint16_t>((blocks_.get(idx) & 0xFFF0) | (meta & 0xF)));
+    ++modCount_;
 }
 
 int ChunkSection::getBlockLight(int x, int y, int z) const {
@@ -104,6 +249,7 @@ int ChunkSection::getBlockLight(int x, int y, int z) const {
 
 void ChunkSection::setBlockLight(int x, int y, int z, int val) {
     const_cast<NibbleArray&>(blocklight_).set(x, y, z, val);
+    ++modCount_;
 }
 
 int ChunkSection::getSkyLight(int x, int y, int z) const {
@@ -112,30 +258,54 @@ int ChunkSection::getSkyLight(int x, int y, int z) const {
 
 void ChunkSection::setSkyLight(int x, int y, int z, int val) {
     if (skylight_) skylight_->set(x, y, z, val);
+    ++modCount_;
 }
 
 void ChunkSection::recalcRefCounts() {
     // Java: ExtendedBlockStorage.removeInvalidBlocks()
     blockRefCount_ = 0;
     tickRefCount_ = 0;
-    for (int y = 0; y < 16; ++y) {
-        for (int z = 0; z < 16; ++z) {
-            for (int x = 0; x < 16; ++x) {
-                Block* block = getBlock(x, y, z);
-                if (block && block->getMaterial() != Material::Air) {
-                    ++blockRefCount_;
-                    if (block->getTickRandomly()) {
-                        ++tickRefCount_;
-                    }
-                }
-            }
-        }
+    blocks_.forEachStateCount([this](uint16_t state, int count) {
+        int id = state >> 4;
+        if (!BlockProperties::isAir(id)) blockRefCount_ += count;
+        if (BlockProperties::ticksRandomly[id]) tickRefCount_ += count;
+    });
+}
+
+void ChunkSection::getBlockArrays(uint8_t* lsb, uint8_t* msb, uint8_t* meta) const {
+    if (blocks_.isSingleValue()) {
+        uint16_t state = blocks_.get(0);
+        std::memset(lsb, (state >> 4) & 0xFF, 4096);
+        std::memset(meta, (state & 0xF) * 0x11, 2048);
+        if (msb) std::memset(msb, (state >> 12) * 0x11, 2048);
+        return;
+    }
+    uint16_t states[BlockStateStorage::SIZE];
+    blocks_.decode(states);
+    for (int i = 0; i < BlockStateStorage::SIZE; i += 2) {
+        uint16_t even = states[i], odd = states[i + 1];
+        lsb[i] = static_cast<uint8_t>(even >> 4);
+        lsb[i + 1] = static_cast<uint8_t>(odd >> 4);
+        meta[i >> 1] = static_cast<uint8_t>((even & 0xF) | (odd & 0xF) << 4);
+        if (msb) msb[i >> 1] = static_cast<uint8_t>((even >> 12) | (odd >> 12) << 4);
+    }
+}
+
+void ChunkSection::setBlockArrays(const uint8_t* lsb, const uint8_t* msb, const uint8_t* meta) {
+    uint16_t states[BlockStateStorage::SIZE];
+    for (int i = 0; i < BlockStateStorage::SIZE; ++i) {
+        int shift = (i & 1) << 2;
+        int id = lsb[i] | (msb ? ((msb[i >> 1] >> shift) & 0xF) << 8 : 0);
+        states[i] = static_cast<uint16_t>(id << 4 | ((meta[i >> 1] >> shift) & 0xF));
     }
+    blocks_.assign(states);
+    ++modCount_;
 }
 
-void ChunkSection::setBlockLSBArray(const std::vector<uint8_t>& arr) {
-    size_t copyLen = std::min(arr.size(), blockLSB_.size());
-    std::memcpy(blockLSB_.data(), arr.data(), copyLen);
+size_t ChunkSection::getMemoryUsage() const {
+    size_t bytes = sizeof(ChunkSection) + blocks_.getHeapBytes() + blocklight_.getHeapBytes();
+    if (skylight_) bytes += sizeof(NibbleArray) + skylight_->getHeapBytes();
+    return bytes;
 }
 
 // ═════════════════════════════════════════════════════════════════════════════
@@ -156,10 +326,17 @@ void Chunk::setBlock(int x, int y, int z, Block* block) {
     if (!sections[sectionIdx]) {
         if (!block || block->getMaterial() == Material::Air) return;
         sections[sectionIdx] = std::make_unique<ChunkSection>(sectionIdx << 4, true);
+        ++modCount_;
     }
     sections[sectionIdx]->setBlock(x, y & 0xF, z, block);
 }
 
+int Chunk::getBlockId(int x, int y, int z) const {
+    int sectionIdx = y >> 4;
+    if (sectionIdx < 0 || sectionIdx >= SECTION_COUNT || !sections[sectionIdx]) return 0;
+    return sections[sectionIdx]->getBlockId(x, y & 0xF, z);
+}
+
 int Chunk::getBlockMetadata(int x, int y, int z) const {
     int sectionIdx = y >> 4;
     if (sectionIdx < 0 || sectionIdx >= SECTION_COUNT || !sections[sectionIdx]) return 0;
@@ -172,6 +349,14 @@ void Chunk::setBlockMetadata(int x, int y, int z, int meta) {
     sections[sectionIdx]->setBlockMetadata(x, y & 0xF, z, meta);
 }
 
+size_t Chunk::getMemoryUsage() const {
+    size_t bytes = sizeof(Chunk);
+    for (const auto& section : sections) {
+        if (section) bytes += section->getMemoryUsage();
+    }
+    return bytes;
+}
+
 std::shared_ptr<nbt::NBTTagCompound> Chunk::writeToNBT() const {
     // Java reference: AnvilChunkLoader.writeChunkToNBT()
     auto level = std::make_shared<nbt::NBTTagCompound>();
@@ -193,31 +378,25 @@ std::shared_ptr<nbt::NBTTagCompound> Chunk::writeToNBT() const {
 
         sectionTag->setByte("Y", static_cast<int8_t>((sections[i]->getYBase() >> 4) & 0xFF));
 
-        // Block LSB
-        const auto& lsb = sections[i]->getBlockLSBArray();
-        sectionTag->setByteArray("Blocks", std::vector<int8_t>(lsb.begin(), lsb.end()));
-
-        // Block MSB (Add) — optional
-        if (sections[i]->getBlockMSBArray()) {
-            const auto& msbData = sections[i]->getBlockMSBArray()->data;
-            sectionTag->setByteArray("Add", std::vector<int8_t>(msbData.begin(), msbData.end()));
-        }
-
-        // Metadata
-        const auto& metaData = sections[i]->getMetadataArray().data;
-        sectionTag->setByteArray("Data", std::vector<int8_t>(metaData.begin(), metaData.end()));
-
-        // Block light
-        const auto& blData = sections[i]->getBlocklightArray().data;
-        sectionTag->setByteArray("BlockLight", std::vector<int8_t>(blData.begin(), blData.end()));
-
-        // Sky light
-        if (sections[i]->getSkylightArray()) {
-            const auto& slData = sections[i]->getSkylightArray()->data;
-            sectionTag->setByteArray("SkyLight", std::vector<int8_t>(slData.begin(), slData.end()));
-        } else {
-            sectionTag->setByteArray("SkyLight", std::vector<int8_t>(2048, 0));
-        }
+        // Blocks, Add (optional) and Data, expanded from the palette
+        bool hasMsb = sections[i]->hasBlockMSB();
+        std::vector<int8_t> blocks(4096), add(hasMsb ? 2048 : 0), data(2048);
+        sections[i]->getBlockArrays(reinterpret_cast<uint8_t*>(blocks.data()),
+                                    hasMsb ? reinterpret_cast<uint8_t*>(add.data()) : nullptr,
+                                    reinterpret_cast<uint8_t*>(data.data()));
+        sectionTag->setByteArray("Blocks", std::move(blocks));
+        if (hasMsb) sectionTag->setByteArray("Add", std::move(add));
+        sectionTag->setByteArray("Data", std::move(data));
+
+        // Block light and sky light; uniform arrays are copied from the
+        // shared constant buffers, a missing sky light as zeros
+        auto nibbles = [](const NibbleArray* arr) {
+            const uint8_t* src = arr ? arr->bytes() : NibbleArray::sharedBytes(0);
+            size_t len = arr ? arr->size() : 2048;
+            return std::vector<int8_t>(src, src + len);
+        };
+        sectionTag->setByteArray("BlockLight", nibbles(&sections[i]->getBlocklightArray()));
+        sectionTag->setByteArray("SkyLight", nibbles(sections[i]->getSkylightArray()));
 
         sectionList->appendTag(std::move(sectionTag));
     }
@@ -262,30 +441,27 @@ std::unique_ptr<Chunk> Chunk::readFromNBT(const nbt::NBTTagCompound& levelTag) {
 
             auto section = std::make_unique<ChunkSection>(yIdx << 4, hasSkylight);
 
-            // Block LSB
-            auto blocks = sectionTag->getByteArray("Blocks");
-            section->setBlockLSBArray(std::vector<uint8_t>(blocks.begin(), blocks.end()));
-
-            // Block MSB (Add)
+            // Blocks, Add and Data; short arrays read as zeros
+            const auto& blocks = sectionTag->getByteArray("Blocks");
+            const auto& data = sectionTag->getByteArray("Data");
+            std::vector<uint8_t> lsb(4096, 0), meta(2048, 0), msb;
+            std::memcpy(lsb.data(), blocks.data(), std::min<size_t>(blocks.size(), lsb.size()));
+            std::memcpy(meta.data(), data.data(), std::min<size_t>(data.size(), meta.size()));
             if (sectionTag->hasKey("Add", 7)) {
-                auto add = sectionTag->getByteArray("Add");
-                section->setBlockMSBArray(std::make_unique<NibbleArray>(
-                    std::vector<uint8_t>(add.begin(), add.end()), 4));
+                const auto& add = sectionTag->getByteArray("Add");
+                msb.assign(2048, 0);
+                std::memcpy(msb.data(), add.data(), std::min<size_t>(add.size(), msb.size()));
             }
-
-            // Metadata
-            auto data = sectionTag->getByteArray("Data");
-            section->setMetadataArray(NibbleArray(std::vector<uint8_t>(data.begin(), data.end()), 4));
-
-            // Block light
-            auto bl = sectionTag->getByteArray("BlockLight");
-            section->setBlocklightArray(NibbleArray(std::vector<uint8_t>(bl.begin(), bl.end()), 4));
-
-            // Sky light
+            section->setBlockArrays(lsb.data(), msb.empty() ? nullptr : msb.data(), meta.data());
+
+            // Block light and sky light; uniform arrays keep no buffer
+            auto light = [](const std::vector<int8_t>& arr) {
+                if (arr.size() != 2048) return NibbleArray(4096, 4);
+                return NibbleArray(std::vector<uint8_t>(arr.begin(), arr.end()), 4);
+            };
+            section->setBlocklightArray(light(sectionTag->getByteArray("BlockLight")));
             if (hasSkylight) {
-                auto sl = sectionTag->getByteArray("SkyLight");
-                section->setSkylightArray(std::make_unique<NibbleArray>(
-                    std::vector<uint8_t>(sl.begin(), sl.end()), 4));
+                section->setSkylightArray(std::make_unique<NibbleArray>(light(sectionTag->getByteArray("SkyLight"))));
             }
 
             section->recalcRefCounts();
@@ -327,75 +503,63 @@ static void writeBE32(uint8_t* p, int32_t v) {
     p[3] = static_cast<uint8_t>(v & 0xFF);
 }
 
-RegionFile::RegionFile(const std::string& path) : path_(path) {
+namespace {
+
+// Current time as an Anvil timestamp (unix seconds)
+int32_t regionTimestamp() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<int32_t>(std::chrono::duration_cast<std::chrono::seconds>(now).count());
+}
+
+} // anonymous namespace
+
+RegionFile::RegionFile(const std::string& path, RegionIoMode mode, bool crashSafe)
+    : path_(path), mode_(mode), crashSafe_(crashSafe) {
     // Java reference: RegionFile constructor
-    file_.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "[RegionFile] Failed to open " << path << ": " << std::strerror(errno) << "\n";
+        return;
+    }
 
-    if (!file_.is_open()) {
-        // Create new file
-        file_.open(path, std::ios::out | std::ios::binary);
-        if (!file_.is_open()) {
-            std::cerr << "[RegionFile] Failed to create " << path << "\n";
-            return;
-        }
-        // Write empty header (8192 bytes = offsets + timestamps)
-        std::vector<uint8_t> header(8192, 0);
-        file_.write(reinterpret_cast<const char*>(header.data()), header.size());
-        file_.close();
-        file_.open(path, std::ios::in | std::ios::out | std::ios::binary);
-    }
-
-    // Read header
-    file_.seekg(0, std::ios::end);
-    auto fileLen = file_.tellg();
-
-    if (fileLen < 8192) {
-        // Pad to minimum size
-        file_.seekp(0, std::ios::end);
-        std::vector<uint8_t> pad(8192 - static_cast<int>(fileLen), 0);
-        file_.write(reinterpret_cast<const char*>(pad.data()), pad.size());
-        file_.flush();
-        fileLen = 8192;
-    }
-
-    // Pad to sector boundary
-    auto remainder = static_cast<int64_t>(fileLen) & 0xFFF;
-    if (remainder != 0) {
-        file_.seekp(0, std::ios::end);
-        std::vector<uint8_t> pad(4096 - static_cast<int>(remainder), 0);
-        file_.write(reinterpret_cast<const char*>(pad.data()), pad.size());
-        file_.flush();
-        fileLen = file_.tellp();
-    }
-
-    int totalSectors = static_cast<int>(static_cast<int64_t>(fileLen) / 4096);
-    sectorFree_.resize(totalSectors, true);
-    sectorFree_[0] = false; // offsets header
-    sectorFree_[1] = false; // timestamps header
-
-    // Read offsets
-    file_.seekg(0);
-    uint8_t buf[4];
+    struct stat st {};
+    ::fstat(fd_, &st);
+    int64_t fileLen = st.st_size;
+
+    // Java: a short file gets an empty header; a partial last sector is zero-padded
+    int64_t paddedLen = std::max<int64_t>(fileLen, SECTOR_BYTES * HEADER_SECTORS);
+    paddedLen = (paddedLen + SECTOR_BYTES - 1) & ~static_cast<int64_t>(SECTOR_BYTES - 1);
+    if (paddedLen != fileLen && ::ftruncate(fd_, paddedLen) != 0) {
+        std::cerr << "[RegionFile] Failed to pad " << path << ": " << std::strerror(errno) << "\n";
+    }
+
+    int totalSectors = static_cast<int>(paddedLen / SECTOR_BYTES);
+    // Everything but the offsets and timestamps headers starts out free
+    sectors_.resize(totalSectors);
+    sectors_.markFree(HEADER_SECTORS, totalSectors - HEADER_SECTORS);
+
+    // Read offsets and timestamps in one go
+    uint8_t header[SECTOR_BYTES * HEADER_SECTORS];
+    if (!readSectors(header, 0, HEADER_SECTORS)) {
+        std::memset(header, 0, sizeof(header));
+    }
     for (int i = 0; i < 1024; ++i) {
-        file_.read(reinterpret_cast<char*>(buf), 4);
-        offsets_[i] = readBE32(buf);
-
-        int offset = offsets_[i];
-        if (offset != 0) {
-            int sectorStart = offset >> 8;
-            int sectorCount = offset & 0xFF;
-            if (sectorStart + sectorCount <= totalSectors) {
-                for (int s = 0; s < sectorCount; ++s) {
-                    sectorFree_[sectorStart + s] = false;
-                }
-            }
+        int32_t offset = readBE32(header + i * 4);
+        timestamps_[i] = readBE32(header + SECTOR_BYTES + i * 4);
+
+        int sectorStart = offset >> 8;
+        int sectorCount = offset & 0xFF;
+        // Java: a slot without sectors or outside the file counts as empty
+        if (offset == 0 || sectorCount == 0 || sectorStart < HEADER_SECTORS ||
+            sectorStart + sectorCount > totalSectors) {
+            continue;
         }
+        slots_[i].store(static_cast<uint32_t>(offset), std::memory_order_relaxed);
+        sectors_.markUsed(sectorStart, sectorCount);
     }
 
-    // Read timestamps
-    for (int i = 0; i < 1024; ++i) {
-        file_.read(reinterpret_cast<char*>(buf), 4);
-        timestamps_[i] = readBE32(buf);
+    if (mode_ == RegionIoMode::IoUring && !IoUring::forThisThread()) {
+        mode_ = RegionIoMode::Sync;
     }
 }
 
@@ -404,200 +568,513 @@ RegionFile::~RegionFile() {
 }
 
 void RegionFile::close() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (file_.is_open()) {
-        file_.close();
-    }
+    if (fd_ < 0) return;
+    flush();
+    ::close(fd_);
+    fd_ = -1;
 }
 
 bool RegionFile::isChunkSaved(int localX, int localZ) const {
     if (outOfBounds(localX, localZ)) return false;
-    std::lock_guard<std::mutex> lock(mutex_);
-    return getOffset(localX, localZ) != 0;
+    return slotOffset(slots_[slotIndex(localX, localZ)].load(std::memory_order_acquire)) != 0;
 }
 
-std::optional<std::vector<uint8_t>> RegionFile::readChunkData(int localX, int localZ) {
-    if (outOfBounds(localX, localZ)) return std::nullopt;
+int RegionFile::getSectorCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sectors_.size();
+}
 
+int RegionFile::getFreeSectorCount() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (!file_.is_open()) return std::nullopt;
+    return sectors_.freeCount();
+}
 
-    int offset = getOffset(localX, localZ);
-    if (offset == 0) return std::nullopt;
+// ─── Data I/O ───────────────────────────────────────────────────────────────
+
+bool RegionFile::readSectors(uint8_t* dest, int sectorStart, int sectorCount) const {
+    size_t remaining = static_cast<size_t>(sectorCount) * SECTOR_BYTES;
+    off_t pos = static_cast<off_t>(sectorStart) * SECTOR_BYTES;
+    while (remaining > 0) {
+        ssize_t n = ::pread(fd_, dest, remaining, pos);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        dest += n;
+        pos += n;
+        remaining -= static_cast<size_t>(n);
+    }
+    return true;
+}
 
-    int sectorStart = offset >> 8;
-    int sectorCount = offset & 0xFF;
+bool RegionFile::writeSectors(const uint8_t* src, int sectorStart, int sectorCount) const {
+    size_t remaining = static_cast<size_t>(sectorCount) * SECTOR_BYTES;
+    off_t pos = static_cast<off_t>(sectorStart) * SECTOR_BYTES;
+    while (remaining > 0) {
+        ssize_t n = ::pwrite(fd_, src, remaining, pos);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            std::cerr << "[RegionFile] Write failed in " << path_ << ": " << std::strerror(errno) << "\n";
+            return false;
+        }
+        src += n;
+        pos += n;
+        remaining -= static_cast<size_t>(n);
+    }
+    return true;
+}
 
-    if (sectorStart + sectorCount > static_cast<int>(sectorFree_.size())) {
-        return std::nullopt;
+bool RegionFile::compressChunk(const std::vector<uint8_t>& data, SectorImage& image) {
+    // Compress straight into the sector image, behind the 5-byte chunk header
+    uLongf compLen = compressBound(static_cast<uLong>(data.size()));
+    size_t capacity = (5 + compLen + SECTOR_BYTES - 1) & ~static_cast<size_t>(SECTOR_BYTES - 1);
+    image.bytes.reset(new uint8_t[capacity]);
+    if (compress2(image.bytes.get() + 5, &compLen, data.data(),
+                  static_cast<uLong>(data.size()), Z_DEFAULT_COMPRESSION) != Z_OK) {
+        return false;
     }
 
-    // Seek to sector
-    file_.seekg(static_cast<int64_t>(sectorStart) * 4096);
+    // Sectors needed: 5 bytes header (4 len + 1 type) + data
+    size_t used = 5 + compLen;
+    image.sectors = static_cast<int>((used + SECTOR_BYTES - 1) / SECTOR_BYTES);
+    if (image.sectors > MAX_CHUNK_SECTORS) return false;
 
-    // Read length and compression type
-    uint8_t header[5];
-    file_.read(reinterpret_cast<char*>(header), 5);
-    int32_t dataLength = readBE32(header);
-    uint8_t compressionType = header[4];
+    writeBE32(image.bytes.get(), static_cast<int32_t>(compLen) + 1);
+    image.bytes[4] = 2; // zlib compression
+    std::memset(image.bytes.get() + used, 0, static_cast<size_t>(image.sectors) * SECTOR_BYTES - used);
+    return true;
+}
 
-    if (dataLength <= 0 || dataLength > 4096 * sectorCount) {
+std::optional<std::vector<uint8_t>> RegionFile::decodeChunk(const uint8_t* sectors, size_t length) {
+    // [length][type] and at least one byte of data
+    if (!sectors || length < 5) return std::nullopt;
+    int32_t dataLength = readBE32(sectors);
+    uint8_t compressionType = sectors[4];
+    if (dataLength <= 0 || static_cast<size_t>(dataLength) > length - 4) {
         return std::nullopt;
     }
+    if (compressionType != 1 && compressionType != 2) return std::nullopt;
 
-    // Read compressed data
-    std::vector<uint8_t> compressed(dataLength - 1);
-    file_.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
-
-    // Decompress
-    if (compressionType == 1) {
-        // GZip — not commonly used but supported
-        // TODO: gzip decompression if needed
+    // Inflate (type 1 = gzip, type 2 = zlib)
+    z_stream strm{};
+    strm.next_in = const_cast<uint8_t*>(sectors + 5);
+    strm.avail_in = static_cast<uInt>(dataLength - 1);
+    if (inflateInit2(&strm, compressionType == 1 ? 16 + MAX_WBITS : MAX_WBITS) != Z_OK) {
         return std::nullopt;
-    } else if (compressionType == 2) {
-        // Zlib (inflate)
-        std::vector<uint8_t> decompressed;
-        decompressed.resize(1024 * 1024); // 1MB max
+    }
 
-        z_stream strm{};
-        strm.next_in = compressed.data();
-        strm.avail_in = static_cast<uInt>(compressed.size());
-        strm.next_out = decompressed.data();
-        strm.avail_out = static_cast<uInt>(decompressed.size());
+    std::vector<uint8_t> decompressed(std::max<size_t>(65536, static_cast<size_t>(dataLength) * 8));
+    int ret = Z_OK;
+    while (ret == Z_OK) {
+        if (strm.total_out == decompressed.size()) decompressed.resize(decompressed.size() * 2);
+        strm.next_out = decompressed.data() + strm.total_out;
+        strm.avail_out = static_cast<uInt>(decompressed.size() - strm.total_out);
+        ret = inflate(&strm, Z_NO_FLUSH);
+        if (ret == Z_BUF_ERROR && strm.avail_out == 0) ret = Z_OK;
+    }
+    inflateEnd(&strm);
 
-        if (inflateInit(&strm) != Z_OK) return std::nullopt;
-        int ret = inflate(&strm, Z_FINISH);
-        inflateEnd(&strm);
+    if (ret != Z_STREAM_END) return std::nullopt;
+    decompressed.resize(strm.total_out);
+    return decompressed;
+}
 
-        if (ret != Z_STREAM_END) return std::nullopt;
+std::optional<std::vector<uint8_t>> RegionFile::readChunkData(int localX, int localZ) {
+    if (outOfBounds(localX, localZ) || fd_ < 0) return std::nullopt;
+    const auto& slot = slots_[slotIndex(localX, localZ)];
+
+    std::unique_ptr<uint8_t[]> buffer;
+    int capacity = 0;
+    while (true) {
+        uint64_t seen = slot.load(std::memory_order_acquire);
+        int offset = slotOffset(seen);
+        if (offset == 0) return std::nullopt;
+
+        int sectorStart = offset >> 8;
+        int sectorCount = offset & 0xFF;
+        if (sectorCount > capacity) {
+            buffer.reset(new uint8_t[static_cast<size_t>(sectorCount) * SECTOR_BYTES]);
+            capacity = sectorCount;
+        }
+        bool ok = readSectors(buffer.get(), sectorStart, sectorCount);
 
-        decompressed.resize(strm.total_out);
-        return decompressed;
+        // The chunk was rewritten while we read: its old sectors may be reused
+        if (slot.load(std::memory_order_acquire) != seen) continue;
+        if (!ok) return std::nullopt;
+        return decodeChunk(buffer.get(), static_cast<size_t>(sectorCount) * SECTOR_BYTES);
     }
-
-    return std::nullopt;
 }
 
 bool RegionFile::writeChunkData(int localX, int localZ, const std::vector<uint8_t>& data) {
-    if (outOfBounds(localX, localZ)) return false;
+    if (outOfBounds(localX, localZ) || fd_ < 0) return false;
 
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!file_.is_open()) return false;
+    SectorImage image;
+    if (!compressChunk(data, image)) return false;
 
-    // Compress with zlib (deflate)
-    std::vector<uint8_t> compressed(compressBound(static_cast<uLong>(data.size())));
-    uLongf compLen = static_cast<uLongf>(compressed.size());
-    if (compress2(compressed.data(), &compLen, data.data(),
-                  static_cast<uLong>(data.size()), Z_DEFAULT_COMPRESSION) != Z_OK) {
+    int sectorStart;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sectorStart = allocateSectors(image.sectors);
+    }
+
+    bool ok = writeSectors(image.bytes.get(), sectorStart, image.sectors);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ok) {
+        releaseSectors(sectorStart, image.sectors);
         return false;
     }
-    compressed.resize(compLen);
+    publish(slotIndex(localX, localZ), sectorStart, image.sectors);
+    if (headerUpdates_ >= HEADER_FLUSH_UPDATES) writeHeaderLocked(false);
+    return true;
+}
 
-    // Calculate sectors needed: 5 bytes header (4 len + 1 type) + data
-    int totalBytes = 5 + static_cast<int>(compressed.size());
-    int sectorsNeeded = (totalBytes + 4095) / 4096;
+// ─── Batched I/O ────────────────────────────────────────────────────────────
 
-    if (sectorsNeeded >= 256) return false;
+std::vector<std::optional<std::vector<uint8_t>>> RegionFile::readChunks(
+        const std::vector<std::pair<int, int>>& coords) {
+    std::vector<std::optional<std::vector<uint8_t>>> results(coords.size());
+    IoUring* ring = mode_ == RegionIoMode::IoUring && fd_ >= 0 ? IoUring::forThisThread() : nullptr;
+    if (!ring) {
+        for (size_t i = 0; i < coords.size(); ++i) {
+            results[i] = readChunkData(coords[i].first, coords[i].second);
+        }
+        return results;
+    }
+
+    struct PendingRead {
+        size_t index;
+        uint64_t slot;
+        uint32_t length;
+        int32_t result;
+        std::unique_ptr<uint8_t[]> buffer;
+    };
+    std::vector<PendingRead> batch;
+    batch.reserve(ring->getCapacity());
+
+    size_t next = 0;
+    while (next < coords.size()) {
+        if (!ring->isOpen()) {
+            // The ring failed on an earlier batch: finish with pread
+            for (; next < coords.size(); ++next) {
+                results[next] = readChunkData(coords[next].first, coords[next].second);
+            }
+            break;
+        }
+        batch.clear();
+        for (; next < coords.size() && batch.size() < ring->getCapacity(); ++next) {
+            auto [x, z] = coords[next];
+            if (outOfBounds(x, z)) continue;
+            uint64_t seen = slots_[slotIndex(x, z)].load(std::memory_order_acquire);
+            int offset = slotOffset(seen);
+            if (offset == 0) continue;
+
+            PendingRead read{next, seen, static_cast<uint32_t>(offset & 0xFF) * SECTOR_BYTES, -1, nullptr};
+            read.buffer.reset(new uint8_t[read.length]);
+            ring->queueRead(fd_, read.buffer.get(), read.length,
+                            static_cast<uint64_t>(offset >> 8) * SECTOR_BYTES, batch.size());
+            batch.push_back(std::move(read));
+        }
 
-    int oldOffset = getOffset(localX, localZ);
-    int oldSectorStart = oldOffset >> 8;
-    int oldSectorCount = oldOffset & 0xFF;
+        ring->submitAndWait([&](uint64_t tag, int32_t result) {
+            if (tag < batch.size()) batch[tag].result = result;
+        });
 
-    // Free old sectors
-    if (oldSectorStart != 0) {
-        for (int i = 0; i < oldSectorCount; ++i) {
-            if (oldSectorStart + i < static_cast<int>(sectorFree_.size())) {
-                sectorFree_[oldSectorStart + i] = true;
+        for (auto& read : batch) {
+            auto [x, z] = coords[read.index];
+            bool moved = slots_[slotIndex(x, z)].load(std::memory_order_acquire) != read.slot;
+            if (moved || read.result != static_cast<int32_t>(read.length)) {
+                // Rewritten meanwhile, short read or no completion: redo it on its own
+                results[read.index] = readChunkData(x, z);
+            } else {
+                results[read.index] = decodeChunk(read.buffer.get(), read.length);
             }
         }
     }
+    return results;
+}
 
-    // Find free space or append
-    int newSector = -1;
-
-    // Can reuse if same size
-    if (oldSectorStart != 0 && oldSectorCount == sectorsNeeded) {
-        newSector = oldSectorStart;
-    } else {
-        // Search for contiguous free sectors
-        int runStart = -1;
-        int runLen = 0;
-        for (int i = 2; i < static_cast<int>(sectorFree_.size()); ++i) {
-            if (sectorFree_[i]) {
-                if (runLen == 0) runStart = i;
-                ++runLen;
-                if (runLen >= sectorsNeeded) {
-                    newSector = runStart;
-                    break;
-                }
-            } else {
-                runLen = 0;
+size_t RegionFile::writeChunks(const std::vector<ChunkWrite>& writes) {
+    IoUring* ring = mode_ == RegionIoMode::IoUring && fd_ >= 0 ? IoUring::forThisThread() : nullptr;
+    size_t written = 0;
+    if (!ring) {
+        for (const auto& w : writes) {
+            if (writeChunkData(w.localX, w.localZ, *w.data)) ++written;
+        }
+        return written;
+    }
+
+    struct PendingWrite {
+        const ChunkWrite* write;
+        SectorImage image;
+        int sectorStart;
+        int32_t result;
+    };
+    std::vector<PendingWrite> batch;
+    batch.reserve(ring->getCapacity());
+
+    size_t next = 0;
+    while (next < writes.size()) {
+        if (!ring->isOpen()) {
+            // The ring failed on an earlier batch: finish with pwrite
+            for (; next < writes.size(); ++next) {
+                const ChunkWrite& w = writes[next];
+                if (writeChunkData(w.localX, w.localZ, *w.data)) ++written;
             }
+            break;
+        }
+        batch.clear();
+        for (; next < writes.size() && batch.size() < ring->getCapacity(); ++next) {
+            const ChunkWrite& w = writes[next];
+            PendingWrite pending{&w, {}, 0, -1};
+            if (outOfBounds(w.localX, w.localZ) || !compressChunk(*w.data, pending.image)) continue;
+            batch.push_back(std::move(pending));
         }
 
-        if (newSector == -1) {
-            // Append at end
-            newSector = static_cast<int>(sectorFree_.size());
-            file_.seekp(0, std::ios::end);
-            for (int i = 0; i < sectorsNeeded; ++i) {
-                std::vector<uint8_t> empty(4096, 0);
-                file_.write(reinterpret_cast<const char*>(empty.data()), empty.size());
-                sectorFree_.push_back(false);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& pending : batch) pending.sectorStart = allocateSectors(pending.image.sectors);
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const auto& pending = batch[i];
+            ring->queueWrite(fd_, pending.image.bytes.get(),
+                             static_cast<uint32_t>(pending.image.sectors) * SECTOR_BYTES,
+                             static_cast<uint64_t>(pending.sectorStart) * SECTOR_BYTES, i);
+        }
+        ring->submitAndWait([&](uint64_t tag, int32_t result) {
+            if (tag < batch.size()) batch[tag].result = result;
+        });
+
+        // Short writes and lost completions are finished synchronously
+        for (auto& pending : batch) {
+            int32_t expected = pending.image.sectors * SECTOR_BYTES;
+            if (pending.result != expected &&
+                writeSectors(pending.image.bytes.get(), pending.sectorStart, pending.image.sectors)) {
+                pending.result = expected;
             }
         }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& pending : batch) {
+            if (pending.result != pending.image.sectors * SECTOR_BYTES) {
+                releaseSectors(pending.sectorStart, pending.image.sectors);
+                continue;
+            }
+            publish(slotIndex(pending.write->localX, pending.write->localZ),
+                    pending.sectorStart, pending.image.sectors);
+            ++written;
+        }
+        if (headerUpdates_ >= HEADER_FLUSH_UPDATES) writeHeaderLocked(false);
     }
+    return written;
+}
+
+// ─── Sectors and header ─────────────────────────────────────────────────────
 
-    // Mark sectors as used
-    for (int i = 0; i < sectorsNeeded; ++i) {
-        sectorFree_[newSector + i] = false;
+int RegionFile::allocateSectors(int count) {
+    int start = sectors_.findBestFit(count);
+    if (start < 0) {
+        // Java: grows the file; here the data pwrite extends it. A free run
+        // at the very end is used as the start of the new chunk.
+        start = sectors_.size() - sectors_.trailingFree();
+        sectors_.resize(start + count);
     }
+    sectors_.markUsed(start, count);
+    return start;
+}
+
+void RegionFile::releaseSectors(int start, int count) {
+    sectors_.markFree(start, count);
+}
+
+void RegionFile::publish(int index, int sectorStart, int sectorCount, bool touch) {
+    uint64_t old = slots_[index].load(std::memory_order_relaxed);
+    uint64_t generation = (old >> 32) + 1;
+    slots_[index].store((generation << 32) | static_cast<uint32_t>((sectorStart << 8) | sectorCount),
+                        std::memory_order_release);
+
+    // The old copy stays allocated until the header on disk stops pointing at it
+    int oldOffset = slotOffset(old);
+    if (oldOffset != 0) pendingFree_.emplace_back(oldOffset >> 8, oldOffset & 0xFF);
+    if (touch) timestamps_[index] = regionTimestamp();
+    ++headerUpdates_;
+}
+
+bool RegionFile::flush(bool sync) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0) return false;
+    return writeHeaderLocked(sync);
+}
 
-    // Write data
-    file_.seekp(static_cast<int64_t>(newSector) * 4096);
-    uint8_t hdr[5];
-    writeBE32(hdr, static_cast<int32_t>(compressed.size()) + 1);
-    hdr[4] = 2; // zlib compression
-    file_.write(reinterpret_cast<const char*>(hdr), 5);
-    file_.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+bool RegionFile::writeHeaderLocked(bool sync) {
+    if (headerUpdates_ > 0) {
+        // Chunk data first, so the header never points at sectors not yet on disk
+        if (sync && ::fdatasync(fd_) != 0) return false;
 
-    // Pad to sector boundary
-    int written = 5 + static_cast<int>(compressed.size());
-    int padding = (sectorsNeeded * 4096) - written;
-    if (padding > 0) {
-        std::vector<uint8_t> pad(padding, 0);
-        file_.write(reinterpret_cast<const char*>(pad.data()), pad.size());
+        uint8_t header[SECTOR_BYTES * HEADER_SECTORS];
+        for (int i = 0; i < 1024; ++i) {
+            writeBE32(header + i * 4, slotOffset(slots_[i].load(std::memory_order_relaxed)));
+            writeBE32(header + SECTOR_BYTES + i * 4, timestamps_[i]);
+        }
+        if (!writeSectors(header, 0, HEADER_SECTORS)) return false;
+        headerUpdates_ = 0;
+        unsynced_ = true;
     }
 
-    // Update offset and timestamp
-    setOffset(localX, localZ, (newSector << 8) | sectorsNeeded);
+    // Until the new header is on disk, the last synced one may still point
+    // at the old copies; their sectors must not be overwritten before then.
+    // A region that is never synced has no such header to protect.
+    if (sync) {
+        if (unsynced_) {
+            if (::fdatasync(fd_) != 0) return false;
+            unsynced_ = false;
+        }
+    } else if (crashSafe_) {
+        return true;
+    }
 
-    auto now = std::chrono::system_clock::now();
-    auto epoch = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-    setTimestamp(localX, localZ, static_cast<int32_t>(epoch));
+    for (auto [start, count] : pendingFree_) releaseSectors(start, count);
+    pendingFree_.clear();
 
-    file_.flush();
+    // Give a free tail back to the file system. A reader still holding an
+    // old slot gets a short read there and retries, as for any moved chunk.
+    int usedEnd = std::max(sectors_.usedEnd(), static_cast<int>(HEADER_SECTORS));
+    if (usedEnd < sectors_.size() &&
+        ::ftruncate(fd_, static_cast<off_t>(usedEnd) * SECTOR_BYTES) == 0) {
+        sectors_.resize(usedEnd);
+    }
     return true;
 }
 
-void RegionFile::setOffset(int x, int z, int val) {
-    offsets_[x + z * 32] = val;
-    file_.seekp(static_cast<int64_t>(x + z * 32) * 4);
-    uint8_t buf[4];
-    writeBE32(buf, val);
-    file_.write(reinterpret_cast<const char*>(buf), 4);
-}
+// ─── Compaction ─────────────────────────────────────────────────────────────
+
+RegionCompactStats RegionFile::compact(int maxMoves) {
+    RegionCompactStats stats;
+    if (fd_ < 0) return stats;
+
+    struct Move {
+        int index;
+        uint64_t slot;
+        int from;
+        int to;
+        int count;
+    };
+    std::vector<Move> moves;
+    std::vector<std::pair<int, int>> order;   // (sector start, slot index), last first
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[static_cast<size_t>(MAX_CHUNK_SECTORS) * SECTOR_BYTES]);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writeHeaderLocked(true);
+        stats.sectorsBefore = sectors_.size();
+    }
+
+    while (maxMoves < 0 || stats.chunksMoved < maxMoves) {
+        // Plan: the chunks that end last, each into the best hole before it.
+        // Moves are planned against the current map, so one round never
+        // reuses sectors another move of the same round gives up.
+        moves.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            order.clear();
+            for (int i = 0; i < 1024; ++i) {
+                int offset = slotOffset(slots_[i].load(std::memory_order_relaxed));
+                if (offset != 0) order.emplace_back(offset >> 8, i);
+            }
+            std::sort(order.rbegin(), order.rend());
+            for (auto [start, index] : order) {
+                if (maxMoves >= 0 && stats.chunksMoved + static_cast<int>(moves.size()) >= maxMoves) break;
+                if (moves.size() == static_cast<size_t>(HEADER_FLUSH_UPDATES)) break;
+                uint64_t slot = slots_[index].load(std::memory_order_relaxed);
+                int count = slotOffset(slot) & 0xFF;
+                int to = sectors_.findBestFit(count, start);
+                if (to < 0) continue;
+                sectors_.markUsed(to, count);
+                moves.push_back({index, slot, start, to, count});
+            }
+        }
+        if (moves.empty()) break;
+
+        // Copy outside the lock
+        std::vector<char> copied(moves.size(), 0);
+        for (size_t m = 0; m < moves.size(); ++m) {
+            const Move& move = moves[m];
+            copied[m] = readSectors(buffer.get(), move.from, move.count) &&
+                        writeSectors(buffer.get(), move.to, move.count);
+        }
+
+        // Switch the slots that nobody rewrote meanwhile, then let the old
+        // sectors go with the synced header write
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t m = 0; m < moves.size(); ++m) {
+            const Move& move = moves[m];
+            if (copied[m] && slots_[move.index].load(std::memory_order_relaxed) == move.slot) {
+                publish(move.index, move.to, move.count, false);
+                ++stats.chunksMoved;
+            } else {
+                releaseSectors(move.to, move.count);
+            }
+        }
+        writeHeaderLocked(true);
+    }
 
-void RegionFile::setTimestamp(int x, int z, int val) {
-    timestamps_[x + z * 32] = val;
-    file_.seekp(4096 + static_cast<int64_t>(x + z * 32) * 4);
-    uint8_t buf[4];
-    writeBE32(buf, val);
-    file_.write(reinterpret_cast<const char*>(buf), 4);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.sectorsAfter = sectors_.size();
+    return stats;
 }
 
-void RegionFile::writeSector(int sectorNum, const uint8_t* data, int length) {
-    file_.seekp(static_cast<int64_t>(sectorNum) * 4096);
-    file_.write(reinterpret_cast<const char*>(data), length);
+bool RegionFile::compactFile(const std::string& path, RegionCompactStats* stats) {
+    RegionFile source(path);
+    if (!source.isOpen()) return false;
+
+    std::string tempPath = path + ".compact";
+    int out = ::open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        std::cerr << "[RegionFile] Failed to create " << tempPath << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    // Copy every chunk's sectors as they are, back to back in index order
+    uint8_t header[SECTOR_BYTES * HEADER_SECTORS] = {};
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[static_cast<size_t>(MAX_CHUNK_SECTORS) * SECTOR_BYTES]);
+    int next = HEADER_SECTORS;
+    int copied = 0;
+    bool ok = true;
+    for (int i = 0; i < 1024 && ok; ++i) {
+        int offset = slotOffset(source.slots_[i].load(std::memory_order_relaxed));
+        if (offset == 0) continue;
+        int count = offset & 0xFF;
+        if (!source.readSectors(buffer.get(), offset >> 8, count)) {
+            // Never lose a chunk to compaction: the original stays in place
+            std::cerr << "[RegionFile] Cannot read chunk " << (i & 31) << "," << (i >> 5)
+                      << " of " << path << ", leaving it uncompacted\n";
+            ::close(out);
+            ::unlink(tempPath.c_str());
+            return false;
+        }
+        size_t bytes = static_cast<size_t>(count) * SECTOR_BYTES;
+        ok = ::pwrite(out, buffer.get(), bytes, static_cast<off_t>(next) * SECTOR_BYTES) ==
+             static_cast<ssize_t>(bytes);
+        writeBE32(header + i * 4, (next << 8) | count);
+        writeBE32(header + SECTOR_BYTES + i * 4, source.timestamps_[i]);
+        next += count;
+        ++copied;
+    }
+    ok = ok && ::pwrite(out, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+    ok = ok && ::fdatasync(out) == 0;
+    ::close(out);
+
+    int sectorsBefore = source.getSectorCount();
+    source.close();
+    if (!ok || ::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "[RegionFile] Compacting " << path << " failed: " << std::strerror(errno) << "\n";
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+    if (stats) {
+        stats->chunksMoved = copied;
+        stats->sectorsBefore = sectorsBefore;
+        stats->sectorsAfter = next;
+    }
+    return true;
 }
 
 } // namespace mccpp
@@ -0,0 +1,206 @@
+/**
+ * IoUring.cpp — Raw-syscall io_uring ring (setup, SQE queueing, completion).
+ *
+ * Layout follows the kernel ABI (linux/io_uring.h): the SQ ring, CQ ring and
+ * SQE array are mmap()ed from the ring fd. The tail we publish and the head
+ * we consume are written with release stores; the indices the kernel moves
+ * are read with acquire loads.
+ */
+
+#include "world/IoUring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <linux/io_uring.h>
+#include <memory>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace mccpp {
+
+namespace {
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags,
+                                      nullptr, 0));
+}
+
+template <typename T>
+T* at(void* base, uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<uint8_t*>(base) + offset);
+}
+
+} // anonymous namespace
+
+IoUring::IoUring(unsigned entries) {
+    io_uring_params params{};
+    ringFd_ = ioUringSetup(entries, &params);
+    if (ringFd_ < 0) {
+        error_ = errno;
+        return;
+    }
+
+    sqEntries_ = params.sq_entries;
+    sqRingBytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingBytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMmap) sqRingBytes_ = cqRingBytes_ = std::max(sqRingBytes_, cqRingBytes_);
+
+    sqRing_ = ::mmap(nullptr, sqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ringFd_, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) sqRing_ = nullptr;
+    if (sqRing_ && singleMmap) {
+        cqRing_ = sqRing_;
+    } else if (sqRing_) {
+        cqRing_ = ::mmap(nullptr, cqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ringFd_, IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED) cqRing_ = nullptr;
+    }
+    sqesBytes_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, sqesBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ringFd_, IORING_OFF_SQES);
+    if (!sqRing_ || !cqRing_ || sqes == MAP_FAILED) {
+        error_ = errno;
+        if (sqes != MAP_FAILED) ::munmap(sqes, sqesBytes_);
+        sqesBytes_ = 0;
+        release();
+        return;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    sqHead_  = at<unsigned>(sqRing_, params.sq_off.head);
+    sqTail_  = at<unsigned>(sqRing_, params.sq_off.tail);
+    sqMask_  = at<unsigned>(sqRing_, params.sq_off.ring_mask);
+    sqArray_ = at<unsigned>(sqRing_, params.sq_off.array);
+    cqHead_  = at<unsigned>(cqRing_, params.cq_off.head);
+    cqTail_  = at<unsigned>(cqRing_, params.cq_off.tail);
+    cqMask_  = at<unsigned>(cqRing_, params.cq_off.ring_mask);
+    cqes_    = at<io_uring_cqe>(cqRing_, params.cq_off.cqes);
+}
+
+IoUring::~IoUring() {
+    release();
+}
+
+void IoUring::release() {
+    if (sqes_) ::munmap(sqes_, sqesBytes_);
+    if (cqRing_ && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingBytes_);
+    if (sqRing_) ::munmap(sqRing_, sqRingBytes_);
+    sqes_ = nullptr;
+    sqRing_ = cqRing_ = nullptr;
+    sqEntries_ = 0;
+    queued_ = 0;
+    if (ringFd_ >= 0) ::close(ringFd_);
+    ringFd_ = -1;
+}
+
+IoUring* IoUring::forThisThread() {
+    thread_local std::unique_ptr<IoUring> ring;
+    thread_local bool tried = false;
+    if (!tried) {
+        tried = true;
+        ring = std::make_unique<IoUring>(THREAD_RING_ENTRIES);
+        if (!ring->isOpen()) {
+            std::cerr << "[IoUring] Setup failed (" << std::strerror(ring->getError())
+                      << "), using pread/pwrite\n";
+            ring.reset();
+        }
+    }
+    // A ring released after a failed submit is not handed out again
+    return ring && ring->isOpen() ? ring.get() : nullptr;
+}
+
+// ─── Submission ─────────────────────────────────────────────────────────────
+
+io_uring_sqe* IoUring::nextSqe() {
+    if (queued_ >= sqEntries_) return nullptr;
+    unsigned tail = *sqTail_ + queued_;
+    unsigned index = tail & *sqMask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqArray_[index] = index;
+    ++queued_;
+    return sqe;
+}
+
+bool IoUring::queueRead(int fd, void* buffer, uint32_t length, uint64_t offset, uint64_t tag) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buffer);
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = tag;
+    return true;
+}
+
+bool IoUring::queueWrite(int fd, const void* buffer, uint32_t length, uint64_t offset,
+                         uint64_t tag) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buffer);
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = tag;
+    return true;
+}
+
+bool IoUring::submitAndWait(const std::function<void(uint64_t tag, int32_t result)>& onComplete) {
+    unsigned total = queued_;
+    if (total == 0) return true;
+
+    // Publish the queued SQEs; the kernel consumes them by moving sqHead
+    unsigned sqStart = *sqTail_;
+    __atomic_store_n(sqTail_, sqStart + queued_, __ATOMIC_RELEASE);
+    queued_ = 0;
+
+    unsigned completed = 0;
+    bool failed = false;
+    for (;;) {
+        unsigned consumed = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) - sqStart;
+        // After a failure only what the kernel already took is waited for:
+        // its buffers belong to the caller and must not be written later
+        if (completed == total || (failed && completed >= consumed)) break;
+
+        int ret = ioUringEnter(ringFd_, failed ? 0 : total - consumed, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            if (!failed) {
+                std::cerr << "[IoUring] io_uring_enter failed: " << std::strerror(errno)
+                          << ", draining " << (consumed - completed) << " requests\n";
+                failed = true;
+            } else {
+                // Cannot wait in the kernel any more; poll the completion ring
+                ::usleep(1000);
+            }
+        }
+
+        unsigned head = *cqHead_;
+        unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head, ++completed) {
+            const io_uring_cqe& cqe = cqes_[head & *cqMask_];
+            onComplete(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+    }
+
+    if (failed) {
+        // SQEs the kernel never took die with the ring; callers redo them
+        // synchronously, and this thread stays on pread/pwrite from now on
+        std::cerr << "[IoUring] " << (total - completed)
+                  << " requests not submitted, ring disabled for this thread\n";
+        release();
+    }
+    return !failed;
+}
+
+} // namespace mccpp
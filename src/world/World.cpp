@@ -8,7 +8,8 @@
  *
  * Implements:
  *   - ChunkProviderFlat: default superflat (bedrock + 2 dirt + grass)
- *   - ChunkProviderServer: chunk cache with load/generate, unload queue
+ *   - ChunkProviderServer: chunk cache with load/generate, unload queue,
+ *     saving through an optional AnvilChunkLoader
  *   - WorldServer: tick loop, block access, spawn initialization
  *
  * Multi-threading adaptations:
@@ -121,11 +122,16 @@ Chunk* ChunkProviderServer::loadChunk(int chunkX, int chunkZ) {
         }
     }
 
-    // Not loaded — generate new chunk
+    // Not loaded — read it from disk, else generate it
     std::unique_ptr<Chunk> chunk;
-    if (generator_) {
+    if (chunkLoader_) {
+        // Java: ChunkProviderServer.safeLoadChunk()
+        chunk = chunkLoader_->loadChunk(chunkX, chunkZ);
+        if (chunk) chunk->savedModificationCount = chunk->getModificationCount();
+    }
+    if (!chunk && generator_) {
         chunk = generator_->provideChunk(chunkX, chunkZ);
-    } else {
+    } else if (!chunk) {
         // Empty chunk fallback
         chunk = std::make_unique<Chunk>(chunkX, chunkZ);
     }
@@ -181,6 +187,16 @@ bool ChunkProviderServer::unloadQueuedChunks() {
 
     if (toUnload.empty()) return false;
 
+    // Java: ChunkProviderServer.safeSaveChunk() — queued while the chunks
+    // are still in the map, so a concurrent load never reads an older copy
+    if (chunkLoader_) {
+        std::shared_lock<std::shared_mutex> rlock(chunkMapMutex_);
+        for (int64_t key : toUnload) {
+            auto it = chunkMap_.find(key);
+            if (it != chunkMap_.end()) saveChunk(*it->second);
+        }
+    }
+
     std::unique_lock<std::shared_mutex> wlock(chunkMapMutex_);
     for (int64_t key : toUnload) {
         chunkMap_.erase(key);
@@ -189,6 +205,24 @@ bool ChunkProviderServer::unloadQueuedChunks() {
     return true;
 }
 
+int ChunkProviderServer::saveChunks(bool saveAll) {
+    // Java reference: ChunkProviderServer.saveChunks(boolean, IProgressUpdate)
+    if (!chunkLoader_) return 0;
+    int saved = 0;
+    for (Chunk* chunk : getLoadedChunks()) {
+        if (!saveChunk(*chunk)) continue;
+        if (++saved == SAVE_BATCH && !saveAll) break;
+    }
+    return saved;
+}
+
+bool ChunkProviderServer::saveChunk(Chunk& chunk) {
+    if (!chunkLoader_ || !chunk.needsSaving()) return false;
+    chunkLoader_->queueChunkSave(chunk);
+    chunk.savedModificationCount = chunk.getModificationCount();
+    return true;
+}
+
 int ChunkProviderServer::getLoadedChunkCount() const {
     std::shared_lock<std::shared_mutex> rlock(chunkMapMutex_);
     return static_cast<int>(chunkMap_.size());
@@ -216,6 +250,15 @@ WorldServer::WorldServer(int dimensionId, const std::string& worldName)
     // Create chunk provider with flat generator
     auto generator = std::make_unique<ChunkProviderFlat>();
     chunkProvider_ = std::make_unique<ChunkProviderServer>(this, std::move(generator));
+
+    // Java: PlayerManager loads a chunk for its first watcher and queues it
+    // for unloading (unless near spawn) when the last one leaves
+    playerManager_.onLoadChunk = [this](int32_t chunkX, int32_t chunkZ) {
+        chunkProvider_->loadChunk(chunkX, chunkZ);
+    };
+    playerManager_.onUnloadChunk = [this](int32_t chunkX, int32_t chunkZ) {
+        chunkProvider_->dropChunk(chunkX, chunkZ);
+    };
 }
 
 WorldServer::~WorldServer() = default;
@@ -258,6 +301,9 @@ void WorldServer::tick() {
     // Process chunk unloads
     chunkProvider_->unloadQueuedChunks();
 
+    // Java: thePlayerManager.updatePlayerInstances() — send block changes
+    playerManager_.updatePlayerInstances(totalWorldTime_, dimensionId_ == 0);
+
     // TODO: Weather updates
     // TODO: Scheduled block ticks
     // TODO: Entity ticking
@@ -278,6 +324,8 @@ void WorldServer::setBlock(int x, int y, int z, Block* block) {
     Chunk* chunk = getChunkFromBlockCoords(x, z);
     if (!chunk) return;
     chunk->setBlock(x & 15, y, z & 15, block);
+    // Java: World.setBlock → markBlockForUpdate
+    playerManager_.markBlockForUpdate(x, y, z);
 }
 
 int WorldServer::getBlockMetadata(int x, int y, int z) {
@@ -292,6 +340,7 @@ void WorldServer::setBlockMetadata(int x, int y, int z, int meta) {
     Chunk* chunk = getChunkFromBlockCoords(x, z);
     if (!chunk) return;
     chunk->setBlockMetadata(x & 15, y, z & 15, meta);
+    playerManager_.markBlockForUpdate(x, y, z);
 }
 
 Chunk* WorldServer::getChunkFromChunkCoords(int chunkX, int chunkZ) {